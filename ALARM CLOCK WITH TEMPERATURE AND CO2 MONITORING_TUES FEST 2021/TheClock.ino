@@ -2,14 +2,27 @@
 // Libraries: none
 // Project includes
 #include "hwconfig.h"     // hardware configuration - pins, speeds, buses, delays, timings, etc.
+#include "theNVM.h"       // settings storage in internal flash
+#include "theTime.h"      // epoch time and civil date conversions
+#include "theBus.h"       // I2C buses recovery
+#include "theAlarms.h"    // alarms schedule
 #include "theData.h"      // module that stored the data and provides it to display
+#include "theLog.h"       // readings log in internal flash
 #include "theRTC.h"       // Real Time Clock (DS3231) processing
 #include "theCO2.h"       // CO2 sensor (MH-Z19) processing
 #include "theTermo.h"     // Temperature sensors (DS18B20) processing
+#include "theMirror.h"    // Display (SH1107 OLED 128x64) stream check (development only)
+#include "thePanel.h"     // Display (SH1107 OLED 128x64) transfers
+#include "theBitmaps.h"   // Display (SH1107 OLED 128x64) digits and icons bitmaps
+#include "theCanvas.h"    // Display (SH1107 OLED 128x64) frame drawing
+#include "theChart.h"     // live chart of CO2 and temperature
+#include "theTrend.h"     // history of CO2 and temperature
 #include "theDisplay.h"   // Display (SH1107 OLED 128x64) processing
+#include "theSpeaker.h"   // sampled alarm sounds (DAC)
 #include "theBuzzer.h"    // buzzer PWM 4.7kHz
 #include "theKeys.h"      // buttons handling
 #include "theLED.h"       // LED handling
+#include "theStats.h"     // statistics report (development only)
 
 // initialization - called once on device start
 void setup() {
@@ -19,14 +32,27 @@ void setup() {
   Serial.begin(115200);
 
   // initialization of all the used modules
+  theTime_init();
+  theBus_init();
+  theNVM_init();       // before theData, as it reads the settings
+  theAlarms_init();    // before theData, as it sets the alarm
   theData_init();
+  theLog_init();
   theRTC_init();
   theCO2_init();
   theTermo_init();
+  theMirror_init();
+  thePanel_init();
+  theBitmaps_init();
+  theCanvas_init();
+  theChart_init();
+  theTrend_init();
   theDisplay_init();
+  theSpeaker_init();    // before theBuzzer, as it stops the speaker
   theBuzzer_init();
   theKeys_init();
   theLEDs_init();
+  theStats_init();
 }
 
 // this function is called constantly by arduino framework core
@@ -36,12 +62,20 @@ void loop() {
   const unsigned long timestamp = millis();
 
   // process all our modules one by one
+  theBus_process(timestamp);
   theData_process(timestamp);
+  theAlarms_process(timestamp);
+  theLog_process(timestamp);
   theRTC_process(timestamp);
   theCO2_process(timestamp);
   theTermo_process(timestamp);
   theDisplay_process(timestamp);
+  thePanel_process(timestamp);
+  theChart_process(timestamp);
+  theTrend_process(timestamp);
+  theSpeaker_process(timestamp);
   theBuzzer_process(timestamp);
   theKeys_process(timestamp);
   theLEDs_process(timestamp);
+  theStats_process(timestamp);
 }
@@ -5,7 +5,6 @@
 // Libraries: CO2 sensor driver ( Library: MH-Z19, by Jonathan Dempsey, version 1.5.3 )
 // Libraries: Display driver ( Library: Adafruit SH110x, by Adafruit, version 1.2.1 ) !!! +dependencies!!!
 // Libraries: temperature sensors driver ( Library: Dallas Temperature, by Miles Burton, version 3.9.0 ) !!! +dependencies!!!
-// Libraries: real-time clock and calendar ( Library: DS3231, by Andrew Wickert, version 1.0.7 )
 // Libraries: flash memory storage ( Library: DueFlashStorage, by Sebastian Nilsson, version 1.0.0 )
 
 
@@ -17,7 +16,12 @@
 #define BUTTON_SET            (10)
 #define BUTTON_PLUS           (11)
 #define BUTTON_MINUS          (12)
+#define RTC_INT               (7)           // DS3231 INT/SQW output (open drain, the alarm interrupts)
 #define LED_INTERNAL          (13)
+#define RTC_SDA               (20)          // WIRE_RTC pins, GPIO only for the bus recovery
+#define RTC_SCL               (21)
+#define DISPLAY_SDA           (70)          // WIRE_DISPLAY pins (SDA1, SCL1), GPIO only for the bus recovery
+#define DISPLAY_SCL           (71)
 
 // buzzer PWM used, pin 8 = C.21 = PWML4
 #define BUZZER_PWM_PIN        PWML4_PC21    // the actual PWM pin
@@ -25,13 +29,32 @@
 #define BUZZER_FREQUENCY      (2700)          // 2.7 kHz = 2700 Hz
 #define BUZZER_PERIOD         ((100000000) / (BUZZER_FREQUENCY))
 #define BUZZER_DUTY           (BUZZER_PERIOD / 2)     // 50% duty cycle = 1/2 time from BUZZER_PERIOD
+#define BUZZER_REST_PERIOD    (100000)      // 1ms PWM period of the silent steps (duty 0)
+
+// speaker (with the amplifier) for the sampled alarm sounds, the samples are triggered by TC0 channel 0
+#define SPEAKER_DAC_CHANNEL   (0)           // DAC0 pin
+#define SPEAKER_SAMPLE_RATE   (8000)        // samples per second, the clips are made for it
+#define SPEAKER_BUFFER        (256)         // samples per buffer (32ms), two buffers are sent by PDC in turn
 
 #define ADDRESS_DISPLAY       (0x3C)        // I2C Address for the display is 0x3C by default
+#define ADDRESS_RTC           (0x68)        // I2C Address of DS3231 (fixed)
+
+// display RAM geometry (SH1107 64x128, before the rotation to landscape; 128 columns for SH1107 128x128)
+#define DISPLAY_COLUMNS       (64)          // bytes per page
+#define DISPLAY_PAGES         (16)          // pages of 8 rows each
+#define DISPLAY_COLUMN_OFFSET (0)           // first visible column in SH1107 RAM
+// the frame is drawn and sent by strips of DISPLAY_STRIP_PAGES pages, only one strip is kept in RAM
+// (0 - the whole frame is kept; DISPLAY_PAGES should be divisible by the strip pages)
+#define DISPLAY_STRIP_PAGES   (0)
+#define STRIP_PAGES           ( ( DISPLAY_STRIP_PAGES > 0 ) ? (DISPLAY_STRIP_PAGES) : (DISPLAY_PAGES) )
+#define CONTRAST_DAY          (0x2F)        // SH1107 display contrast 0...255
+#define CONTRAST_NIGHT        (0x01)        // SH1107 display contrast at night
 
 // used Arduino communication list
 #define SERIAL_CO2            Serial3       // use UART3
-#define WIRE_RTC              Wire          // WARNING! Cannot be changed for RTC DS3231 Library!
+#define WIRE_RTC              Wire          // RTC DS3231
 #define WIRE_DISPLAY          Wire1         // Display
+#define TWI_DISPLAY           TWI0          // Display - the peripheral of WIRE_DISPLAY (Wire1 is TWI0)
 
 // temperature sensors count
 #define COUNT_TERMO           (4)           // we expect to have 4 sensors
@@ -46,16 +69,70 @@
 
 // period for executing the routines
 #define PERIOD_CO2            (1000)        // every 1 sec should be fine
-#define PERIOD_RTC            (500)         // every 0.5s should be good
+#define PERIOD_RTC            (500)         // every 0.5s should be good (only without the minute tick)
+#define PERIOD_RTC_SYNC       (600000)      // the time is counted by the minute tick, resync every 10 min
+#define PERIOD_RTC_TICK_LOST  (61500)       // no edge for 61.5 sec - the minute tick is lost, read by PERIOD_RTC
+#define PERIOD_RTC_WRITE      (300)         // the adjusted time is written to RTC 300ms after the last key press
 #define PERIOD_TERMO_INIT     (1500)        // time needed for DS18b20 to init the bus and read the sensors
 #define PERIOD_TERMO_REQUEST  (200)         // time needed for sent the request
 #define PERIOD_TERMO_READ     (100)         // time between reading the sensors
 #define PERIOD_DISPLAY_SHOW   (75)          // 75ms is ok, that will give us ~ 13fps
+#define PERIOD_DISPLAY_NIGHT  (1000)        // 1fps at night, the minutes are changed rarely
+#define PERIOD_DISPLAY_WAKE   (30000)       // at night, any key shows the day profile for 30 sec
 #define PERIOD_DISPLAY_FLASH  (500)         // 500ms ':' is flashing on the clock
 #define PERIOD_DISPLAY_BLINK  (300)         // 300ms is blinking element on the clock
 #define PERIOD_BEEP           (500)         // 500ms beep, 500ms silent
 #define PERIOD_ALARM          (60000)       // 1 min alarm sound
 #define PERIOD_LED            (1000)        // 1 second LED blink period
+#define PERIOD_NVM_COMMIT     (5000)        // settings are written to NVM after 5 sec without changes
+#define PERIOD_BUS_RETRY      (10)          // the first retry 10ms after I2C failure, then doubled...
+#define PERIOD_BUS_RETRY_MAX  (2000)        // ...up to 2 sec between the retries
+#define PERIOD_PANEL_TIMEOUT  (20)          // display transaction is ~2ms at 400kHz, 20ms - the bus has failed
+#define PERIOD_LOG            (60000)       // readings are logged once per RTC minute
+#define PERIOD_LOG_FLUSH      (3600000)     // the log page being filled is written to flash every hour
+#define PERIOD_STATS          (10000)       // statistics report every 10 sec
+#define PERIOD_CHART          (10000)       // chart sample every 10 sec, so the chart is ~21 min
+#define PERIOD_TREND          (240000)      // history sample every 4 min, so the history is 24 hours
+
+// live chart: one sample per display RAM row, fixed scales (the sent columns are never redrawn)
+#define CHART_COLUMNS         ( DISPLAY_PAGES * 8 )
+#define CHART_CO2_MIN         (400)         // ppm, the bottom of the CO2 chart
+#define CHART_CO2_MAX         (2000)        // ppm, the top of the CO2 chart
+#define CHART_TERMO_MIN       (1000)        // 1/100 Celsius, the bottom of the temperature chart
+#define CHART_TERMO_MAX       (3500)        // 1/100 Celsius, the top of the temperature chart
+
+// night profile of the display: lower frame rate, lower contrast, optionally the display is off
+#define NIGHT_START_HOUR      (22)          // the night starts at 22:00 (RTC time)
+#define NIGHT_END_HOUR        (7)           // the night ends at 07:00 (RTC time)
+#define NIGHT_DISPLAY_OFF     (0)           // 1 - the display is off at night, 0 - it is dimmed
+
+// alarms schedule, the slot 0 is the alarm shown on the clock (max 256 alarms)
+#define ALARMS_MAX            (256)
+#define ALARMS_KEYS           (4)           // the slots 0...3 are adjusted by the keys (max 99)
+// the schedule is filled with pseudo-random alarms in RAM for the statistics (1 - enabled, 0 - disabled)
+#define ALARMS_BENCHMARK      (0)
+
+// history of every channel (CO2, temperature sensors)
+#define TREND_SAMPLES         (360)         // 24 hours by PERIOD_TREND
+
+// statistics report to Serial (1 - enabled, 0 - disabled)
+#define STATS_ENABLED         (0)
+// display stream check by theMirror, the picture dumped with the statistics (1 - enabled, 0 - disabled)
+#define PANEL_MIRROR          (0)
+// I2C fault injection for the statistics: SDA of the buses in turn is held low (0 - disabled)
+#define BUS_FAULT_PERIOD      (0)           // ms between the injected faults, e.g. 30000
+#define BUS_FAULT_HOLD        (200)         // ms SDA is held low
+// theData snapshots published from SysTick interrupt and checked by the main loop (1 - enabled, 0 - disabled)
+#define DATA_STRESS           (0)
+
+// NVM (internal flash bank 1, used through DueFlashStorage) layout
+#define NVM_PAGE_SIZE         (256)         // flash page size of SAM3X8E
+#define NVM_CONFIG_OFFSET     (NVM_PAGE_SIZE * 1) // page 0 is the legacy settings area (offsets 0..5)
+#define NVM_CONFIG_PAGES      (8)           // ring of pages for settings records (8 x 32 records)
+#define NVM_CONFIG_KEYS       (8)           // max settings count, must be less than 1/2 of records in page
+#define NVM_ALARMS_OFFSET     (NVM_PAGE_SIZE * 9)  // alarms table, pages 9...12 (4 bytes per alarm)
+#define NVM_LOG_OFFSET        (NVM_PAGE_SIZE * 16) // readings log starts after 4KB of settings
+#define NVM_LOG_PAGES         (1008)        // 252KB for readings log, pages 16...1023 (the rest of the 256KB bank 1)
 
 #define MAGIC_NUMBER          (0x55)        // magic number to see if the value in nvm is OK
 #define NVM_TRUE              (0x01)        // just to vary from 0 and 1 values
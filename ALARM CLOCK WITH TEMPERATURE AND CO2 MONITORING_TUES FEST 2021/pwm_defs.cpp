@@ -58,7 +58,9 @@ namespace arduino_due
         17 // clock divisor 131072 
       };
 
-      const double max_periods[max_clocks+1]=
+      // computed by the compiler (constexpr), compared with the periods
+      // at runtime
+      const uint64_t max_periods[max_clocks+1]=
       {
         max_period(0), // no clock divisor
         max_period(1), // clock divisor 2
@@ -92,32 +94,15 @@ namespace arduino_due
         PWM_CMR_CPRE_CLKB
       };
 
-      const double tick_times[max_clocks+1]=
-      {
-        tick_time(0), // no clock divisor
-        tick_time(1), // clock divisor 2
-        tick_time(2), // clock divisor 4
-        tick_time(3), // clock divisor 8
-        tick_time(4), // clock divisor 16
-        tick_time(5), // clock divisor 32
-        tick_time(6), // clock divisor 64 
-        tick_time(7), // clock divisor 128 
-        tick_time(8), // clock divisor 256 
-        tick_time(9), // clock divisor 512 
-        tick_time(10), // clock divisor 1024 
-        tick_time(11), // clock divisor 2048 
-        tick_time(12) // clock divisor 131072 
-      };
- 
+      // no clock divisor is never used (as by the floating point version)
       bool find_clock(
-        uint32_t period, // usecs.
+        uint32_t period, // hundredths of usecs (1e-8 secs)
         uint32_t& clock
       ) noexcept
       {
         for( 
-          clock=0; 
-          (clock<=max_clocks) && 
-          (static_cast<double>(period)/100000000>max_periods[clock]);
+          clock=1; 
+          (clock<=max_clocks) && (period>max_periods[clock]);
           clock++
         ) { /* nothing */ }
 
@@ -157,31 +157,64 @@ namespace arduino_due
   
       constexpr uint32_t max_clocks=12;
       extern const uint32_t two_power_values[max_clocks+1];
-      extern const double max_periods[max_clocks+1];
-      extern const double tick_times[max_clocks+1];
+      extern const uint64_t max_periods[max_clocks+1];
       extern const uint32_t clock_masks[max_clocks+1];
-  
-      constexpr inline double tick_time(uint32_t clock) noexcept
+
+      // the same as two_power_values[clock], usable at compile time
+      constexpr inline uint32_t two_power(uint32_t clock) noexcept
+      { return (clock<max_clocks)? clock: 17; }
+
+      constexpr inline uint32_t gcd(uint32_t a, uint32_t b) noexcept
+      { return (b==0)? a: gcd(b,a%b); }
+
+      // periods and duties are in hundredths of usecs (1e-8 secs), one of
+      // them is ticks_num/ticks_den MCK ticks (84/100=21/25 for 84MHz MCK),
+      // so all the conversions are integer, no floating point
+      constexpr uint32_t units_per_second=100000000;
+      constexpr uint32_t ticks_num=
+        VARIANT_MCK/gcd(VARIANT_MCK,units_per_second);
+      constexpr uint32_t ticks_den=
+        units_per_second/gcd(VARIANT_MCK,units_per_second);
+
+      static_assert(
+        ((static_cast<uint64_t>(ticks_den)<<17)*ticks_num)<(1ULL<<32),
+        "to_ticks() remainder product should fit in 32 bits"
+      );
+
+      // the longest period (65536 ticks) of the clock, 1e-8 secs (rounded
+      // down); 0 for no clock divisor, it is not used
+      constexpr inline uint64_t max_period(uint32_t clock) noexcept
       {
-        return static_cast<double>(
-          ( (0<clock) && (clock<=max_clocks) )? 
-            static_cast<uint32_t>(1<<two_power_values[clock])/static_cast<double>(VARIANT_MCK):
-            -1
-        );
+        return ((0<clock) && (clock<=max_clocks))?
+          ((static_cast<uint64_t>(ticks_den)<<(16+two_power(clock)))/ticks_num):
+          0;
       }
 
-      inline double max_period(uint32_t clock) noexcept
+      inline static uint64_t max_period() noexcept
+      { return max_periods[max_clocks]; }
+
+      // the first clock covering the period, max_clocks+1 if there is none
+      constexpr inline uint32_t clock_for_period(
+        uint32_t period, // hundredths of usecs (1e-8 secs)
+        uint32_t clock = 1
+      ) noexcept
       {
-        return static_cast<double>(
-          ((0<clock) && (clock<=max_clocks))? 
-            (static_cast<uint64_t>(1)<<(16+two_power_values[clock]))
-            /static_cast<double>(VARIANT_MCK)
-            :-1
-        );
+        return ((clock>max_clocks) || (period<=max_period(clock)))?
+          clock: clock_for_period(period,clock+1);
       }
 
-      inline static double max_period() noexcept
-      { return max_period(max_clocks); }
+      // the period or the duty in ticks of the clock (rounded down):
+      // value = q*D + r, ticks = q*num + r*num/D, where D = den*2^power,
+      // so there are only 32-bit divisions (UDIV on Cortex-M3)
+      constexpr inline uint32_t to_ticks(
+        uint32_t value, // hundredths of usecs (1e-8 secs)
+        uint32_t clock
+      ) noexcept
+      {
+        return ((value/(ticks_den<<two_power(clock)))*ticks_num)
+          +(((value%(ticks_den<<two_power(clock)))*ticks_num)
+            /(ticks_den<<two_power(clock)));
+      }
 
       extern bool find_clock(
         uint32_t period, // hundredths of usecs (1e-8 secs)
@@ -73,6 +73,25 @@ namespace arduino_due
 	       return true;
        }
 
+       // the period and the duty known at compile time: the clock, CPRD
+       // and CDTY are computed by the compiler, only the registers are
+       // written at runtime
+       template<uint32_t PERIOD, uint32_t DUTY>
+       bool start()
+       {
+         constexpr uint32_t clock=pwm_core::clock_for_period(PERIOD);
+         static_assert(clock<=pwm_core::max_clocks,"the period is too long");
+         static_assert(DUTY<=PERIOD,"the duty is longer than the period");
+         constexpr uint32_t period_ticks=pwm_core::to_ticks(PERIOD,clock);
+         constexpr uint32_t duty_ticks=pwm_core::to_ticks(DUTY,clock);
+
+         if(_started_) return false;
+
+         _start_ticks_(PERIOD,DUTY,clock,period_ticks,duty_ticks);
+
+         return true;
+       }
+
        void stop() { if(_started_) _stop_(); }
 
        uint32_t get_duty() { return _duty_; }
@@ -86,10 +105,7 @@ namespace arduino_due
 	       pwm_core::pwmc_setdutycycle(
 	         PWM_INTERFACE,
 	         pin_info::channel,
-	         static_cast<uint32_t>(
-	           (static_cast<double>(duty)/100000000)/
-	           pwm_core::tick_times[_clock_]
-	         )
+	         pwm_core::to_ticks(duty,_clock_)
 	       );
              
 	       return true;
@@ -105,17 +121,13 @@ namespace arduino_due
 
          if(keep_clock)
          {
-           auto new_period=static_cast<double>(period)/100000000;
-
-           if(new_period>pwm_core::max_periods[_clock_]) return false;
+           if(period>pwm_core::max_periods[_clock_]) return false;
 
 	         _period_=period;
 	         PWMC_SetPeriod(
 	           PWM_INTERFACE,
 	           pin_info::channel,
-	           static_cast<uint32_t>(
-	             new_period/pwm_core::tick_times[_clock_]
-	           )
+	           pwm_core::to_ticks(period,_clock_)
 	         );
 
 	         set_duty(duty); 
@@ -131,10 +143,7 @@ namespace arduino_due
 	           PWMC_SetPeriod(
 	             PWM_INTERFACE,
 	             pin_info::channel,
-	             static_cast<uint32_t>(
-	               (static_cast<double>(period)/100000000)/
-	               pwm_core::tick_times[_clock_]
-	             )
+	             pwm_core::to_ticks(period,_clock_)
 	           );
 
 	           set_duty(duty); 
@@ -161,6 +170,23 @@ namespace arduino_due
 	       uint32_t period, // hundredths of usecs (1e-8 secs.)
 	       uint32_t duty, // hundredths of usecs (1e-8 secs.)
 	       uint32_t clock
+       )
+       {
+         _start_ticks_(
+           period,
+           duty,
+           clock,
+           pwm_core::to_ticks(period,clock),
+           pwm_core::to_ticks(duty,clock)
+         );
+       }
+
+       void _start_ticks_(
+	       uint32_t period, // hundredths of usecs (1e-8 secs.)
+	       uint32_t duty, // hundredths of usecs (1e-8 secs.)
+	       uint32_t clock,
+	       uint32_t period_ticks, // CPRD
+	       uint32_t duty_ticks // CDTY
        );
        
        void _stop_()
@@ -180,10 +206,12 @@ namespace arduino_due
    };
 
    template<pwm_pin PIN>
-   void pwm<PIN>::_start_(
+   void pwm<PIN>::_start_ticks_(
      uint32_t period, // hundredths of usecs (1e-8 secs.)
      uint32_t duty, // hundredths of usecs (1e-8 secs.)
-     uint32_t clock
+     uint32_t clock,
+     uint32_t period_ticks, // CPRD
+     uint32_t duty_ticks // CDTY
    )
    {
      _clock_=clock;
@@ -194,14 +222,14 @@ namespace arduino_due
      PWM->PWM_CLK=
        (
          1<<(
-           pwm_core::two_power_values[11]-pwm_core::two_power_values[10]
+           pwm_core::two_power(11)-pwm_core::two_power(10)
          )
        ) // clock A's DIVA value
        | (PWM_CMR_CPRE_MCK_DIV_1024<<8) //clock A's prescaler
        | (
            (
              1<<(
-               pwm_core::two_power_values[12]-pwm_core::two_power_values[10]
+               pwm_core::two_power(12)-pwm_core::two_power(10)
              )
            )<<16
          ) // clock B's DIVB value
@@ -232,24 +260,20 @@ namespace arduino_due
      PWMC_SetPeriod(
        PWM_INTERFACE,
        pin_info::channel,
-       static_cast<uint32_t>(
-	       (static_cast<double>(period)/100000000)/
-	       pwm_core::tick_times[_clock_]
-       )
+       period_ticks
      );
-    
-     PWMC_EnableChannel(PWM_INTERFACE,pin_info::channel);
 
+     // the duty is written before the channel is enabled, so the first
+     // period does not use the duty left by the previous start
      _duty_=duty;
      //PWMC_SetDutyCycle(
      pwm_core::pwmc_setdutycycle(
        PWM_INTERFACE,
        pin_info::channel,
-       static_cast<uint32_t>(
-	       (static_cast<double>(duty)/100000000)/
-	       pwm_core::tick_times[_clock_]
-       )
+       duty_ticks
      );
+    
+     PWMC_EnableChannel(PWM_INTERFACE,pin_info::channel);
 
      _started_=true;
    }
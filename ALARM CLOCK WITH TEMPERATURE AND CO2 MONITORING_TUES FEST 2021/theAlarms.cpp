@@ -0,0 +1,346 @@
+#include <Arduino.h>
+// Libraries: none
+// project includes
+#include "hwconfig.h"
+#include "theData.h"
+#include "theNVM.h"
+#include "theRTC.h"
+#include "theBuzzer.h"
+#include "theTime.h"
+// own declarations
+#include "theAlarms.h"
+
+// The alarms are kept by slots in RAM, and page by page in flash. All the enabled alarms are
+// expanded to their occurrences in the week, sorted by the minute of the week (Monday 00:00
+// is 0). Once a minute the next due occurrence (at this minute or later) is found by the binary
+// search, and only that one is programmed into DS3231 Alarm1 (the chip matches the day of week,
+// the hour and the minute). The armed occurrence is moved past only by theAlarms_fire(), when
+// the chip has matched it. The occurrences are rebuilt only after the alarms have changed.
+
+#if ( ALARMS_MAX > 256 )
+#error "the occurrence keeps the slot in one byte"
+#endif
+#if ( ( NVM_ALARMS_OFFSET + ( ALARMS_MAX * 4 ) ) > NVM_LOG_OFFSET )
+#error "the alarms table overlaps the readings log"
+#endif
+
+#define MINUTES_PER_DAY       (1440)
+#define DAYS_PER_WEEK         (7)
+#define NO_OCCURRENCE         (0xFFFF)
+#define NO_MINUTE             (0xFFFFFFFF)
+#define SLOTS_PER_PAGE        ( NVM_PAGE_SIZE / sizeof(theAlarms_alarm_t) )
+#define ALARMS_PAGES          ( ( ALARMS_MAX + SLOTS_PER_PAGE - 1 ) / SLOTS_PER_PAGE )
+
+// all the slots, the free one has an invalid hour
+static theAlarms_alarm_t alarms[ALARMS_MAX];
+
+// occurrences of the enabled alarms in the week, sorted by the minute of the week
+static uint16_t week_minute[ALARMS_MAX * DAYS_PER_WEEK];
+static uint8_t week_slot[ALARMS_MAX * DAYS_PER_WEEK];
+static unsigned int week_count = 0;
+
+// the minute of the week programmed into DS3231 Alarm1
+static bool bArmed = false;
+static uint16_t armed_minute = 0;
+
+// the alarms have changed: the occurrences should be rebuilt, the slots should be written to flash
+static bool bRebuild = true;
+static bool bDirty = false;
+
+// timestamp of the last change (for deferred flash commit)
+static unsigned long timer_commit = 0;
+// RTC minute (since 2000-01-01) of the last lookup
+static uint32_t last_minute = NO_MINUTE;
+
+static theAlarms_stats_t stats;
+
+// internal routines
+static inline bool is_valid(const theAlarms_alarm_t *const pAlarm);
+static inline bool is_active(const theAlarms_alarm_t *const pAlarm);
+static inline uint16_t minute_of_day(const theAlarms_alarm_t *const pAlarm);
+static unsigned int search(const uint16_t minute, const bool bAfter);
+static void changed(const unsigned int slot);
+static void rebuild(void);
+static void arm(const uint16_t minute, const bool bAfter);
+static void commit(void);
+static void fill_benchmark(void);
+
+//----------------------------------------------------------
+
+// initialization - called once at the device start (after theNVM, before theData)
+void theAlarms_init(void)
+{
+  memcpy(alarms, theNVM_address(NVM_ALARMS_OFFSET), sizeof(alarms));
+
+  // the damaged slots are free, the slot 0 is set by theData
+  for ( unsigned int slot = 0; slot < ALARMS_MAX; slot++ )
+  {
+    if ( ( slot == 0 ) || ( ! is_valid(&(alarms[slot])) ) )
+    {
+      memset(&(alarms[slot]), 0xFF, sizeof(theAlarms_alarm_t));
+    }
+  }
+
+  if ( ALARMS_BENCHMARK )
+  {
+    fill_benchmark();
+  }
+
+  bRebuild = true;
+}
+
+static inline bool is_valid(const theAlarms_alarm_t *const pAlarm)
+{
+  return ( pAlarm->hour < 24 ) && ( pAlarm->minute < 60 ) &&
+         ( ( pAlarm->flags & ALARM_SOUND_MASK ) < buzzer_sound_max );
+}
+
+// the alarm takes part in the schedule
+static inline bool is_active(const theAlarms_alarm_t *const pAlarm)
+{
+  return is_valid(pAlarm) && ( pAlarm->flags & ALARM_ENABLED ) && ( pAlarm->weekdays & ALARM_EVERY_DAY );
+}
+
+static inline uint16_t minute_of_day(const theAlarms_alarm_t *const pAlarm)
+{
+  return ( pAlarm->hour * 60 ) + pAlarm->minute;
+}
+
+bool theAlarms_get(const unsigned int slot, theAlarms_alarm_t *const pAlarm)
+{
+  if ( ( slot >= ALARMS_MAX ) || ( ! is_valid(&(alarms[slot])) ) ) return false;
+  *pAlarm = alarms[slot];
+  return true;
+}
+
+bool theAlarms_set(const unsigned int slot, const theAlarms_alarm_t *const pAlarm)
+{
+  theAlarms_alarm_t alarm;
+
+  if ( slot >= ALARMS_MAX ) return false;
+  if ( pAlarm == NULL )
+  {
+    memset(&alarm, 0xFF, sizeof(alarm));
+  }
+  else
+  {
+    if ( ! is_valid(pAlarm) ) return false;
+    alarm = *pAlarm;
+  }
+
+  // nothing has changed - nothing to rebuild and to write
+  if ( memcmp(&(alarms[slot]), &alarm, sizeof(alarm)) == 0 ) return true;
+
+  alarms[slot] = alarm;
+  changed(slot);
+  return true;
+}
+
+// the slot 0 belongs to theData, it keeps the alarm in its own settings
+static void changed(const unsigned int slot)
+{
+  bRebuild = true;
+  if ( slot == 0 ) return;
+  bDirty = true;
+  timer_commit = millis();
+}
+
+// the first occurrence after the minute of the week ('bAfter'), or at the minute or after it;
+// week_count if there is no such occurrence
+static unsigned int search(const uint16_t minute, const bool bAfter)
+{
+  unsigned int low = 0;
+  unsigned int high = week_count;
+
+  while ( low < high )
+  {
+    const unsigned int middle = ( low + high ) / 2;
+    if ( ( week_minute[middle] < minute ) || ( bAfter && ( week_minute[middle] == minute ) ) )
+    {
+      low = middle + 1;
+    }
+    else
+    {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+// expand the enabled alarms to their occurrences in the week: the alarms are sorted by the
+// minute of the day once (insertion sort, the changes are rare), and then taken day by day
+static void rebuild(void)
+{
+  uint8_t order[ALARMS_MAX];
+  unsigned int count = 0;
+
+  const unsigned long started = micros();
+
+  for ( unsigned int slot = 0; slot < ALARMS_MAX; slot++ )
+  {
+    if ( ! is_active(&(alarms[slot])) ) continue;
+
+    const uint16_t minute = minute_of_day(&(alarms[slot]));
+    unsigned int i = count++;
+    while ( ( i > 0 ) && ( minute_of_day(&(alarms[order[i - 1]])) > minute ) )
+    {
+      order[i] = order[i - 1];
+      --i;
+    }
+    order[i] = slot;
+  }
+
+  week_count = 0;
+  for ( unsigned int day = 0; day < DAYS_PER_WEEK; day++ )
+  {
+    for ( unsigned int i = 0; i < count; i++ )
+    {
+      if ( ( alarms[order[i]].weekdays & ( 1 << day ) ) == 0 ) continue;
+      week_minute[week_count] = ( day * MINUTES_PER_DAY ) + minute_of_day(&(alarms[order[i]]));
+      week_slot[week_count] = order[i];
+      ++week_count;
+    }
+  }
+
+  stats.rebuild_us = micros() - started;
+  stats.alarms = count;
+  stats.occurrences = week_count;
+  ++stats.rebuilds;
+}
+
+// find the next due occurrence after the minute of the week ('bAfter'), or at the minute or
+// after it, and program it into DS3231; the chip is accessed only if it is not the armed one
+static void arm(const uint16_t minute, const bool bAfter)
+{
+  const unsigned long started = micros();
+  unsigned int next = search(minute, bAfter);
+  // the occurrence of this very minute is still due only if it is the armed one (the chip
+  // matches it at ss=00, so the one programmed during the minute would be matched next week)
+  if ( ( next < week_count ) && ( week_minute[next] == minute ) && ( ( ! bArmed ) || ( armed_minute != minute ) ) )
+  {
+    next = search(minute, true);
+  }
+  // after the last one of the week - the first one of the next week
+  if ( next >= week_count ) next = 0;
+  const unsigned long lookup = micros() - started;
+
+  ++stats.lookups;
+  stats.lookup_us = lookup;
+  if ( lookup > stats.max_lookup_us ) stats.max_lookup_us = lookup;
+
+  const bool bEnabled = ( week_count > 0 );
+  const uint16_t next_minute = (bEnabled) ? (week_minute[next]) : (0);
+  if ( ( bEnabled == bArmed ) && ( next_minute == armed_minute ) ) return;
+
+  bArmed = bEnabled;
+  armed_minute = next_minute;
+  theRTC_setAlarm(bEnabled, ( next_minute / MINUTES_PER_DAY ) + 1, ( next_minute % MINUTES_PER_DAY ) / 60, next_minute % 60);
+  ++stats.armed;
+}
+
+// DS3231 has matched the armed minute: the first alarm of the minute sounds,
+// all the one-shot alarms of the minute are done, and the next occurrence is armed
+void theAlarms_fire(void)
+{
+  if ( ! bArmed ) return;
+
+  int sound = -1;
+  for ( unsigned int i = search(armed_minute, false); ( i < week_count ) && ( week_minute[i] == armed_minute ); i++ )
+  {
+    const unsigned int slot = week_slot[i];
+    if ( sound < 0 ) sound = alarms[slot].flags & ALARM_SOUND_MASK;
+    if ( alarms[slot].flags & ALARM_ONE_SHOT )
+    {
+      alarms[slot].flags &= ~ALARM_ENABLED;
+      changed(slot);
+    }
+  }
+
+  // the armed minute is done - only now the next occurrence is armed
+  arm(armed_minute, true);
+
+  // the schedule could be rebuilt after the alarm was armed
+  if ( sound < 0 ) return;
+
+  ++stats.fired;
+  if ( ! theBuzzer_isBuzzing() )
+  {
+    theBuzzer_start(sound);
+  }
+}
+
+// write the pages which differ from flash, the slot 0 is always written free
+static void commit(void)
+{
+  theAlarms_alarm_t page[SLOTS_PER_PAGE];
+
+  // the benchmark alarms are never stored
+  if ( ALARMS_BENCHMARK ) return;
+
+  for ( unsigned int index = 0; index < ALARMS_PAGES; index++ )
+  {
+    const unsigned int first = index * SLOTS_PER_PAGE;
+    const unsigned int count = ( ( ALARMS_MAX - first ) < SLOTS_PER_PAGE ) ? ( ALARMS_MAX - first ) : (SLOTS_PER_PAGE);
+
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, &(alarms[first]), count * sizeof(theAlarms_alarm_t));
+    if ( index == 0 ) memset(&(page[0]), 0xFF, sizeof(theAlarms_alarm_t));
+
+    const uint32_t offset = NVM_ALARMS_OFFSET + ( index * NVM_PAGE_SIZE );
+    if ( memcmp(theNVM_address(offset), page, sizeof(page)) == 0 ) continue;
+    if ( theNVM_program(offset, page, sizeof(page), true) ) ++stats.commits;
+  }
+}
+
+// the schedule of pseudo-random alarms (RAM only) - the lookup and rebuild times with all the slots used
+static void fill_benchmark(void)
+{
+  uint32_t random = 12345;
+
+  for ( unsigned int slot = 1; slot < ALARMS_MAX; slot++ )
+  {
+    random = ( random * 1103515245UL ) + 12345UL;
+    alarms[slot].hour = ( random >> 8 ) % 24;
+    alarms[slot].minute = ( random >> 13 ) % 60;
+    alarms[slot].weekdays = 1 + ( ( random >> 19 ) % ALARM_EVERY_DAY );
+    alarms[slot].flags = ALARM_ENABLED | ( ( random >> 27 ) % buzzer_sound_max );
+  }
+}
+
+void theAlarms_getStats(theAlarms_stats_t *const pStats)
+{
+  *pStats = stats;
+}
+
+// periodic function, called pretty fast, so we have to take
+// care execute it with specific periodicy
+void theAlarms_process(const unsigned long timestamp)
+{
+  // the alarms have changed - rebuild and look the next due alarm up right away
+  if ( bRebuild )
+  {
+    rebuild();
+    bRebuild = false;
+    last_minute = NO_MINUTE;
+  }
+
+  // the slots are written to flash when there were no changes for a while
+  if ( bDirty && ( ( timestamp - timer_commit ) >= PERIOD_NVM_COMMIT ) )
+  {
+    commit();
+    bDirty = false;
+  }
+
+  // once a minute (the time could be adjusted) - the next due alarm
+  theData_timestamp_t now;
+  theData_getTimestamp(&now);
+  // the time is not read from RTC yet
+  if ( now.rtc == 0 ) return;
+
+  const uint32_t minute = now.rtc / 60;
+  if ( minute == last_minute ) return;
+
+  last_minute = minute;
+  const int dow = theTime_dayOfWeek(now.rtc / TIME_SECONDS_PER_DAY);
+  arm( ( ( dow - 1 ) * MINUTES_PER_DAY ) + ( ( now.rtc % TIME_SECONDS_PER_DAY ) / 60 ), false );
+}
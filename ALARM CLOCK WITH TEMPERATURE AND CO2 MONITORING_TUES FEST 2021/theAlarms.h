@@ -0,0 +1,49 @@
+#if !defined(__THE_CLOCK_THE_ALARMS_HEADER_INCLUDED_)
+#define __THE_CLOCK_THE_ALARMS_HEADER_INCLUDED_
+
+extern void theAlarms_init(void);
+extern void theAlarms_process(const unsigned long timestamp);
+
+// weekdays mask: bit 0 - Monday ... bit 6 - Sunday (day of week 1...7 of RTC)
+#define ALARM_EVERY_DAY       (0x7F)
+
+// alarm flags, the sound pattern (theBuzzer_sound_t) is in the lower bits
+#define ALARM_ENABLED         (0x80)
+#define ALARM_ONE_SHOT        (0x40)        // the alarm is disabled after it has sounded once
+#define ALARM_SOUND_MASK      (0x0F)
+
+// a single alarm, 4 bytes, the same in RAM and in flash
+typedef struct {
+  uint8_t hour;             // 0...23, the slot is free otherwise (erased flash is 0xFF)
+  uint8_t minute;           // 0...59
+  uint8_t weekdays;         // ALARM_EVERY_DAY or any other mask
+  uint8_t flags;            // ALARM_ENABLED, ALARM_ONE_SHOT, the sound pattern
+} theAlarms_alarm_t;
+
+// the alarm in the slot 0...(ALARMS_MAX-1), returns 'false' if the slot is free
+extern bool theAlarms_get(const unsigned int slot, theAlarms_alarm_t *const pAlarm);
+// store the alarm to the slot (NULL frees the slot); the schedule is updated by the next process call,
+// flash is written PERIOD_NVM_COMMIT later. The slot 0 is the alarm of theData, it is not stored here.
+extern bool theAlarms_set(const unsigned int slot, const theAlarms_alarm_t *const pAlarm);
+
+// theData reports that DS3231 has matched the armed alarm
+extern void theAlarms_fire(void);
+
+// schedule statistics
+typedef struct {
+  uint32_t alarms;              // enabled alarms in the schedule
+  uint32_t occurrences;         // their occurrences in the week
+  uint32_t rebuilds;            // the schedule rebuilds (after the changes)
+  uint32_t rebuild_us;          // time of the last rebuild, microseconds
+  uint32_t lookups;             // the next due alarm lookups (once a minute)
+  uint32_t lookup_us;           // time of the last lookup, microseconds
+  uint32_t max_lookup_us;       // the longest lookup, microseconds
+  uint32_t armed;               // DS3231 Alarm1 reprogrammed
+  uint32_t fired;               // the alarms sounded
+  uint32_t commits;             // flash pages written
+} theAlarms_stats_t;
+
+extern void theAlarms_getStats(theAlarms_stats_t *const pStats);
+
+
+#endif // __THE_CLOCK_THE_ALARMS_HEADER_INCLUDED_
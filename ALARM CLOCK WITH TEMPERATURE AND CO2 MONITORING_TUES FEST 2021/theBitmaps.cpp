@@ -0,0 +1,261 @@
+#include <Arduino.h>
+// Libraries: none
+// project includes
+#include "hwconfig.h"
+// own declarations
+#include "theBitmaps.h"
+
+// The bitmaps are generated by the compiler (constexpr functions below) and stored in flash,
+// nothing is drawn or computed at runtime. The digits are the seven-segment ones with beveled
+// segments, so they are drawn for every size instead of being scaled; the icons are drawn
+// as the pictures right here.
+//
+// Geometry is computed in half-pixel units, so the pixel (x, y) has its center at
+// (2x + 1, 2y + 1), and the segment of thickness T is 2T half-pixels wide.
+
+// the digits characters
+#define GLYPH_COLON           (10)
+#define GLYPH_DASH            (11)
+#define GLYPH_SPACE           (12)
+#define GLYPHS                (13)
+
+// segments of the seven-segment digit
+#define SEG_A                 (0x01)        // top
+#define SEG_B                 (0x02)        // top right
+#define SEG_C                 (0x04)        // bottom right
+#define SEG_D                 (0x08)        // bottom
+#define SEG_E                 (0x10)        // bottom left
+#define SEG_F                 (0x20)        // top left
+#define SEG_G                 (0x40)        // middle
+
+// the shapes - all the bitmaps, SHAPE_DIGITS(size) + glyph, or SHAPE_ICON(icon)
+#define SHAPE_DIGITS(size)    ( (size) * 16 )
+#define SHAPE_ICON(icon)      ( ( bitmaps_digits_max * 16 ) + (icon) )
+
+static constexpr uint8_t glyph_segments[GLYPHS] = {
+  SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F,          // 0
+  SEG_B | SEG_C,                                          // 1
+  SEG_A | SEG_B | SEG_D | SEG_E | SEG_G,                  // 2
+  SEG_A | SEG_B | SEG_C | SEG_D | SEG_G,                  // 3
+  SEG_B | SEG_C | SEG_F | SEG_G,                          // 4
+  SEG_A | SEG_C | SEG_D | SEG_F | SEG_G,                  // 5
+  SEG_A | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G,          // 6
+  SEG_A | SEG_B | SEG_C,                                  // 7
+  SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G,  // 8
+  SEG_A | SEG_B | SEG_C | SEG_D | SEG_F | SEG_G,          // 9
+  0,                                                      // ':' - the dots, not segments
+  SEG_G,                                                  // '-'
+  0                                                       // ' '
+};
+
+// the digits sizes: width, height, segment thickness
+static constexpr uint8_t digits_width[bitmaps_digits_max]     = { 10, 6 };
+static constexpr uint8_t digits_height[bitmaps_digits_max]    = { 16, 11 };
+static constexpr uint8_t digits_thickness[bitmaps_digits_max] = { 2, 1 };
+
+// the icons pictures
+#define ICON_SUBSCRIPT_2_WIDTH  (4)
+#define ICON_SUBSCRIPT_2_HEIGHT (5)
+static constexpr char icon_subscript_2[] =
+  "###."
+  "...#"
+  ".##."
+  "#..."
+  "####";
+
+#define ICON_DEGREE_WIDTH     (4)
+#define ICON_DEGREE_HEIGHT    (4)
+static constexpr char icon_degree[] =
+  ".##."
+  "#..#"
+  "#..#"
+  ".##.";
+
+//----------------------------------------------------------
+// the compile time bitmaps generation
+
+static constexpr int iabs(const int v)
+{
+  return (v < 0) ? (-v) : (v);
+}
+
+// horizontal segment, its center row is yc, ends are beveled
+static constexpr bool hseg(const int X, const int Y, const int W2, const int yc, const int t)
+{
+  return ( iabs(Y - yc) < t ) && ( X >= ( iabs(Y - yc) + 1 ) ) && ( ( W2 - X ) >= ( iabs(Y - yc) + 1 ) );
+}
+
+// vertical segment from y0 to y1, its center column is xc, ends are beveled
+static constexpr bool vseg(const int X, const int Y, const int xc, const int y0, const int y1, const int t)
+{
+  return ( iabs(X - xc) < t ) && ( ( Y - y0 ) >= ( iabs(X - xc) + 1 ) ) && ( ( y1 - Y ) >= ( iabs(X - xc) + 1 ) );
+}
+
+// 2x2 pixels dot, its center is (xc, yc) - both even
+static constexpr bool dot(const int X, const int Y, const int xc, const int yc)
+{
+  return ( iabs(X - xc) < 2 ) && ( iabs(Y - yc) < 2 );
+}
+
+static constexpr bool segments_pixel(const int segments, const int X, const int Y, const int W2, const int H2, const int t)
+{
+  return ( ( segments & SEG_A ) && hseg(X, Y, W2, t, t) ) ||
+         ( ( segments & SEG_G ) && hseg(X, Y, W2, H2 / 2, t) ) ||
+         ( ( segments & SEG_D ) && hseg(X, Y, W2, H2 - t, t) ) ||
+         ( ( segments & SEG_F ) && vseg(X, Y, t, 0, H2 / 2, t) ) ||
+         ( ( segments & SEG_B ) && vseg(X, Y, W2 - t, 0, H2 / 2, t) ) ||
+         ( ( segments & SEG_E ) && vseg(X, Y, t, H2 / 2, H2, t) ) ||
+         ( ( segments & SEG_C ) && vseg(X, Y, W2 - t, H2 / 2, H2, t) );
+}
+
+static constexpr bool colon_pixel(const int X, const int Y, const int W2, const int H2)
+{
+  return dot(X, Y, W2 / 2, ( ( H2 * 3 ) / 10 ) & ~1) || dot(X, Y, W2 / 2, ( ( H2 * 7 ) / 10 ) & ~1);
+}
+
+static constexpr bool digit_pixel(const int size, const int glyph, const int x, const int y)
+{
+  return (glyph == GLYPH_COLON) ?
+    colon_pixel( (2 * x) + 1, (2 * y) + 1, 2 * digits_width[size], 2 * digits_height[size] ) :
+    segments_pixel( glyph_segments[glyph], (2 * x) + 1, (2 * y) + 1, 2 * digits_width[size], 2 * digits_height[size], digits_thickness[size] );
+}
+
+static constexpr int shape_width(const int shape)
+{
+  return (shape == SHAPE_ICON(bitmaps_icon_subscript_2)) ? (ICON_SUBSCRIPT_2_WIDTH) :
+         (shape == SHAPE_ICON(bitmaps_icon_degree))      ? (ICON_DEGREE_WIDTH) :
+         digits_width[shape / 16];
+}
+
+static constexpr int shape_height(const int shape)
+{
+  return (shape == SHAPE_ICON(bitmaps_icon_subscript_2)) ? (ICON_SUBSCRIPT_2_HEIGHT) :
+         (shape == SHAPE_ICON(bitmaps_icon_degree))      ? (ICON_DEGREE_HEIGHT) :
+         digits_height[shape / 16];
+}
+
+// the digits are 2 pixels apart, the icons 1 pixel
+static constexpr int shape_advance(const int shape)
+{
+  return shape_width(shape) + ( ( shape >= SHAPE_ICON(0) ) ? (1) : (2) );
+}
+
+static constexpr bool shape_pixel(const int shape, const int x, const int y)
+{
+  return (shape == SHAPE_ICON(bitmaps_icon_subscript_2)) ? ( icon_subscript_2[(y * ICON_SUBSCRIPT_2_WIDTH) + x] == '#' ) :
+         (shape == SHAPE_ICON(bitmaps_icon_degree))      ? ( icon_degree[(y * ICON_DEGREE_WIDTH) + x] == '#' ) :
+         digit_pixel(shape / 16, shape % 16, x, y);
+}
+
+// pixels of the row y from column x down to 0
+static constexpr uint16_t row_pixels(const int shape, const int y, const int x)
+{
+  return (x < 0) ? (0) : ( ( shape_pixel(shape, x, y) ? (1 << x) : (0) ) | row_pixels(shape, y, x - 1) );
+}
+
+static constexpr uint16_t row(const int shape, const int y)
+{
+  return row_pixels(shape, y, shape_width(shape) - 1);
+}
+
+// the row y starts a new entry (it is not the same as the previous one)
+static constexpr bool row_starts_entry(const int shape, const int y)
+{
+  return ( y == 0 ) || ( row(shape, y) != row(shape, y - 1) );
+}
+
+// entries count for the rows from y on
+static constexpr int entries(const int shape, const int y = 0)
+{
+  return ( y >= shape_height(shape) ) ? (0) : ( ( row_starts_entry(shape, y) ? (1) : (0) ) + entries(shape, y + 1) );
+}
+
+// the first row of the entry, looking from row y on
+static constexpr int entry_row(const int shape, const int entry, const int y = 0)
+{
+  return ( y >= shape_height(shape) ) ? ( shape_height(shape) ) :
+         ( ! row_starts_entry(shape, y) ) ? ( entry_row(shape, entry, y + 1) ) :
+         ( entry == 0 ) ? (y) : ( entry_row(shape, entry - 1, y + 1) );
+}
+
+static constexpr uint16_t entry_value(const int shape, const int entry)
+{
+  return ( ( entry_row(shape, entry + 1) - entry_row(shape, entry) - 1 ) << BITMAP_ROW_REPEAT ) | row(shape, entry_row(shape, entry));
+}
+
+// the entries arrays are built for the indices 0...count-1
+template <int... I> struct indices {};
+template <int N, int... I> struct make_indices : make_indices<N - 1, N - 1, I...> {};
+template <int... I> struct make_indices<0, I...> { typedef indices<I...> type; };
+
+template <int SHAPE, typename INDICES = typename make_indices<entries(SHAPE)>::type> struct shape_rows;
+template <int SHAPE, int... I> struct shape_rows<SHAPE, indices<I...> > {
+  static_assert(shape_width(SHAPE) <= BITMAP_WIDTH_MAX, "the bitmap is too wide");
+  static_assert(shape_height(SHAPE) <= BITMAP_HEIGHT_MAX, "the bitmap is too high");
+  static const uint16_t data[sizeof...(I)];
+};
+template <int SHAPE, int... I> const uint16_t shape_rows<SHAPE, indices<I...> >::data[sizeof...(I)] = { entry_value(SHAPE, I)... };
+
+#define BITMAP(shape)         { shape_width(shape), shape_height(shape), shape_advance(shape), entries(shape), shape_rows<(shape)>::data }
+#define BITMAP_DIGITS(size)   { BITMAP(SHAPE_DIGITS(size) + 0), BITMAP(SHAPE_DIGITS(size) + 1), BITMAP(SHAPE_DIGITS(size) + 2), \
+                                BITMAP(SHAPE_DIGITS(size) + 3), BITMAP(SHAPE_DIGITS(size) + 4), BITMAP(SHAPE_DIGITS(size) + 5), \
+                                BITMAP(SHAPE_DIGITS(size) + 6), BITMAP(SHAPE_DIGITS(size) + 7), BITMAP(SHAPE_DIGITS(size) + 8), \
+                                BITMAP(SHAPE_DIGITS(size) + 9), BITMAP(SHAPE_DIGITS(size) + GLYPH_COLON), \
+                                BITMAP(SHAPE_DIGITS(size) + GLYPH_DASH), BITMAP(SHAPE_DIGITS(size) + GLYPH_SPACE) }
+
+static const theBitmaps_bitmap_t digits[bitmaps_digits_max][GLYPHS] = {
+  BITMAP_DIGITS(bitmaps_digits_large),
+  BITMAP_DIGITS(bitmaps_digits_medium)
+};
+
+static const theBitmaps_bitmap_t icons[bitmaps_icon_max] = {
+  BITMAP(SHAPE_ICON(bitmaps_icon_subscript_2)),
+  BITMAP(SHAPE_ICON(bitmaps_icon_degree))
+};
+
+//----------------------------------------------------------
+
+void theBitmaps_init(void)
+{
+  // nothing to initialize, the bitmaps are in flash
+}
+
+const theBitmaps_bitmap_t *theBitmaps_getDigit(const theBitmaps_digits_t size, const char ch)
+{
+  unsigned int glyph;
+
+  if ( ( ch >= '0' ) && ( ch <= '9' ) ) glyph = ch - '0';
+  else if ( ch == ':' ) glyph = GLYPH_COLON;
+  else if ( ch == '-' ) glyph = GLYPH_DASH;
+  else if ( ch == ' ' ) glyph = GLYPH_SPACE;
+  else return NULL;
+
+  return &(digits[size][glyph]);
+}
+
+const theBitmaps_bitmap_t *theBitmaps_getIcon(const theBitmaps_icon_t icon)
+{
+  return &(icons[icon]);
+}
+
+void theBitmaps_getStats(theBitmaps_stats_t *const pStats)
+{
+  const theBitmaps_bitmap_t *const pAll[2] = { &(digits[0][0]), &(icons[0]) };
+  const unsigned int counts[2] = { bitmaps_digits_max * GLYPHS, bitmaps_icon_max };
+
+  pStats->bitmaps = 0;
+  pStats->flash_bytes = 0;
+  pStats->raw_bytes = 0;
+  pStats->table_bytes = sizeof(digits) + sizeof(icons);
+
+  for ( unsigned int table = 0; table < 2; table++ )
+  {
+    for ( unsigned int i = 0; i < counts[table]; i++ )
+    {
+      const theBitmaps_bitmap_t *const pBitmap = &(pAll[table][i]);
+      ++pStats->bitmaps;
+      pStats->flash_bytes += pBitmap->count * sizeof(uint16_t);
+      pStats->raw_bytes += pBitmap->height * ( ( pBitmap->width + 7 ) / 8 );
+    }
+  }
+}
@@ -0,0 +1,50 @@
+#if !defined(__THE_CLOCK_THE_BITMAPS_HEADER_INCLUDED_)
+#define __THE_CLOCK_THE_BITMAPS_HEADER_INCLUDED_
+
+// no periodic actions, the bitmaps are constant
+extern void theBitmaps_init(void);
+
+// The bitmap is stored by rows (landscape), the identical neighbour rows are stored once:
+// every entry is the row pixels (bit N is the column N) and how many times the row repeats.
+#define BITMAP_ROW_PIXELS     (0x0FFF)      // bits of the pixels in the entry
+#define BITMAP_ROW_REPEAT     (12)          // shift of (repeat count - 1) in the entry
+#define BITMAP_WIDTH_MAX      (12)
+#define BITMAP_HEIGHT_MAX     (16)
+
+typedef struct {
+  uint8_t width;                // pixels
+  uint8_t height;               // pixels
+  uint8_t advance;              // the next bitmap starts 'advance' pixels to the right
+  uint8_t count;                // entries count
+  const uint16_t *pRows;        // entries
+} theBitmaps_bitmap_t;
+
+// the digits sizes
+typedef enum {
+  bitmaps_digits_large,         // 10x16, the clock
+  bitmaps_digits_medium,        // 6x11, the alarm
+  bitmaps_digits_max
+} theBitmaps_digits_t;
+
+typedef enum {
+  bitmaps_icon_subscript_2,     // the '2' of CO2
+  bitmaps_icon_degree,          // the degree sign
+  bitmaps_icon_max
+} theBitmaps_icon_t;
+
+// the bitmap of the character - '0'...'9', ':', '-' and ' ' are available, NULL for others
+extern const theBitmaps_bitmap_t *theBitmaps_getDigit(const theBitmaps_digits_t digits, const char ch);
+extern const theBitmaps_bitmap_t *theBitmaps_getIcon(const theBitmaps_icon_t icon);
+
+// statistics of the bitmaps storage
+typedef struct {
+  uint32_t bitmaps;             // bitmaps count
+  uint32_t flash_bytes;         // flash used by the bitmaps entries
+  uint32_t raw_bytes;           // flash the bitmaps would use uncompressed (1 bit per pixel, byte per 8 pixels of the row)
+  uint32_t table_bytes;         // flash used by the bitmaps descriptions
+} theBitmaps_stats_t;
+
+extern void theBitmaps_getStats(theBitmaps_stats_t *const pStats);
+
+
+#endif // __THE_CLOCK_THE_BITMAPS_HEADER_INCLUDED_
@@ -0,0 +1,229 @@
+#include <Arduino.h>
+#include <Wire.h>
+// Libraries: none
+// project includes
+#include "hwconfig.h"
+// own declarations
+#include "theBus.h"
+
+// Every transaction of Wire library is bounded by its own timeouts (the loops count of waiting
+// for every byte), so the bus does not hang the device by itself. But a slave which has lost
+// the clock in the middle of the byte holds SDA low, and then every next transaction fails by
+// the timeout. After the failure the TWI peripheral is reset; if SDA is still low, SCL is
+// clocked out by GPIO (up to 9 clocks, the slave sends the rest of its byte and releases SDA),
+// and STOP is generated. The retries are backed off (doubled from PERIOD_BUS_RETRY up to
+// PERIOD_BUS_RETRY_MAX), so the failing bus stalls the main loop only once in a while.
+
+// the clocks to release SDA: the rest of the byte (8 bits) and ACK
+#define RECOVERY_CLOCKS       (9)
+// SCL half period of the recovery, microseconds (~100kHz)
+#define RECOVERY_HALF_US      (5)
+
+// the wires and the pins of the buses (the pins are given to GPIO only for the recovery)
+static const struct {
+  TwoWire *pWire;
+  uint32_t speed;
+  uint8_t sda;
+  uint8_t scl;
+} cBuses[bus_max] = {
+  { &WIRE_RTC,      SPEED_RTC,      RTC_SDA,      RTC_SCL },
+  { &WIRE_DISPLAY,  SPEED_DISPLAY,  DISPLAY_SDA,  DISPLAY_SCL },
+};
+
+// the state of the failing bus
+static struct {
+  bool bFailing;
+  unsigned long fault_millis;     // millis() of the first failure
+  unsigned long retry_millis;     // millis() of the last failure
+  unsigned long retry_delay;      // the next transaction is allowed this much after the last failure
+} buses[bus_max];
+
+// the injected fault: SDA of the bus is held low till 'inject_millis' + BUS_FAULT_HOLD
+static int inject_bus = -1;
+static unsigned int inject_next = 0;
+static unsigned long inject_millis = 0;
+
+// timestamp last called
+static unsigned long timer = 0;
+// micros() of the last process call (the main loop pass)
+static unsigned long loop_micros = 0;
+static bool bLoop = false;
+
+static theBus_stats_t stats;
+
+// internal routines
+static void reset(const unsigned int bus);
+static void recover(const unsigned int bus);
+static void hold(const unsigned int bus);
+static inline void scl(const unsigned int bus, const bool high);
+
+//----------------------------------------------------------
+
+// initialization - called once at the device start
+void theBus_init(void)
+{
+  // the buses are started by their users (theRTC, theDisplay)
+  timer = millis();
+}
+
+// the peripheral is reset (master mode, the pins are given back to it), the speed is set again
+static void reset(const unsigned int bus)
+{
+  cBuses[bus].pWire->begin();
+  cBuses[bus].pWire->setClock(cBuses[bus].speed);
+
+  // the injected fault holds SDA, as the slave would do
+  if ( inject_bus == (int)bus ) hold(bus);
+}
+
+// SCL is open drain: low is driven, high is released to the pull-up
+static inline void scl(const unsigned int bus, const bool high)
+{
+  if ( high )
+  {
+    pinMode(cBuses[bus].scl, INPUT_PULLUP);
+  }
+  else
+  {
+    pinMode(cBuses[bus].scl, OUTPUT);
+    digitalWrite(cBuses[bus].scl, LOW);
+  }
+  delayMicroseconds(RECOVERY_HALF_US);
+}
+
+// clock SCL out till the slave releases SDA, then STOP (SDA goes high while SCL is high)
+static void recover(const unsigned int bus)
+{
+  const unsigned long started = micros();
+  theBus_busStats_t *const pStats = &(stats.buses[bus]);
+
+  pinMode(cBuses[bus].sda, INPUT_PULLUP);
+  scl(bus, true);
+  for ( unsigned int i = 0; ( i < RECOVERY_CLOCKS ) && ( digitalRead(cBuses[bus].sda) == LOW ); i++ )
+  {
+    scl(bus, false);
+    scl(bus, true);
+  }
+
+  if ( digitalRead(cBuses[bus].sda) == HIGH )
+  {
+    ++pStats->recoveries;
+  }
+
+  // STOP: SDA low while SCL is low, then SCL high, then SDA high
+  scl(bus, false);
+  pinMode(cBuses[bus].sda, OUTPUT);
+  digitalWrite(cBuses[bus].sda, LOW);
+  scl(bus, true);
+  pinMode(cBuses[bus].sda, INPUT_PULLUP);
+  delayMicroseconds(RECOVERY_HALF_US);
+
+  reset(bus);
+
+  pStats->recovery_us = micros() - started;
+  if ( pStats->recovery_us > pStats->max_recovery_us ) pStats->max_recovery_us = pStats->recovery_us;
+}
+
+void theBus_failed(const unsigned int bus)
+{
+  if ( bus >= bus_max ) return;
+
+  theBus_busStats_t *const pStats = &(stats.buses[bus]);
+  const unsigned long now = millis();
+
+  ++pStats->failures;
+  if ( buses[bus].bFailing )
+  {
+    buses[bus].retry_delay = ( ( buses[bus].retry_delay * 2 ) < PERIOD_BUS_RETRY_MAX ) ? ( buses[bus].retry_delay * 2 ) : (PERIOD_BUS_RETRY_MAX);
+  }
+  else
+  {
+    ++pStats->faults;
+    buses[bus].bFailing = true;
+    buses[bus].fault_millis = now;
+    buses[bus].retry_delay = PERIOD_BUS_RETRY;
+  }
+  buses[bus].retry_millis = now;
+
+  // the peripheral could be stuck in the middle of the transaction - it releases the bus after the reset;
+  // if SDA is still low, it is held by the slave
+  reset(bus);
+  if ( digitalRead(cBuses[bus].sda) == LOW )
+  {
+    ++pStats->stuck;
+    recover(bus);
+  }
+}
+
+void theBus_succeeded(const unsigned int bus)
+{
+  if ( ( bus >= bus_max ) || ( ! buses[bus].bFailing ) ) return;
+
+  theBus_busStats_t *const pStats = &(stats.buses[bus]);
+
+  buses[bus].bFailing = false;
+  pStats->recovery_ms = millis() - buses[bus].fault_millis;
+  if ( pStats->recovery_ms > pStats->max_recovery_ms ) pStats->max_recovery_ms = pStats->recovery_ms;
+}
+
+bool theBus_isReady(const unsigned int bus)
+{
+  if ( bus >= bus_max ) return false;
+  return ( ! buses[bus].bFailing ) || ( ( millis() - buses[bus].retry_millis ) >= buses[bus].retry_delay );
+}
+
+// the injected fault: SDA is taken from the peripheral and driven low
+static void hold(const unsigned int bus)
+{
+  pinMode(cBuses[bus].sda, OUTPUT);
+  digitalWrite(cBuses[bus].sda, LOW);
+}
+
+void theBus_getStats(theBus_stats_t *const pStats)
+{
+  *pStats = stats;
+}
+
+// periodic function, called pretty fast, so we have to take
+// care execute it with specific periodicy
+void theBus_process(const unsigned long timestamp)
+{
+  // the main loop pass: from the previous call till this one
+  const unsigned long now = micros();
+  if ( bLoop )
+  {
+    const unsigned long loop_us = now - loop_micros;
+    if ( loop_us > stats.max_loop_us ) stats.max_loop_us = loop_us;
+
+    for ( unsigned int bus = 0; bus < bus_max; bus++ )
+    {
+      if ( buses[bus].bFailing && ( loop_us > stats.max_fault_loop_us ) ) stats.max_fault_loop_us = loop_us;
+    }
+  }
+  loop_micros = now;
+  bLoop = true;
+
+  // the fault injection is for development only, the buses are not touched by default
+  if ( BUS_FAULT_PERIOD == 0 ) return;
+
+  // the injected fault is over - SDA is given back to the peripheral
+  if ( ( inject_bus >= 0 ) && ( ( timestamp - inject_millis ) >= BUS_FAULT_HOLD ) )
+  {
+    const unsigned int bus = inject_bus;
+    inject_bus = -1;
+    reset(bus);
+  }
+
+  // the next fault, the buses in turn
+  if ( ( timestamp - timer ) >= BUS_FAULT_PERIOD )
+  {
+    inject_bus = inject_next;
+    inject_next = ( inject_next + 1 ) % bus_max;
+    inject_millis = timestamp;
+    hold(inject_bus);
+    ++stats.injected;
+
+    // remember when the function was executed last time
+    timer = timestamp;
+  }
+}
@@ -0,0 +1,44 @@
+#if !defined(__THE_CLOCK_THE_BUS_HEADER_INCLUDED_)
+#define __THE_CLOCK_THE_BUS_HEADER_INCLUDED_
+
+extern void theBus_init(void);
+extern void theBus_process(const unsigned long timestamp);
+
+// I2C buses of the device
+typedef enum {
+  bus_rtc,                  // WIRE_RTC - DS3231
+  bus_display,              // WIRE_DISPLAY - SH1107
+  bus_max
+} theBus_t;
+
+// the transaction on the bus (theBus_t) has failed: the peripheral is reset, the held low SDA
+// is released by clocking SCL out, and the next transactions are backed off
+extern void theBus_failed(const unsigned int bus);
+// the transaction on the bus has succeeded, the bus is not failing any more
+extern void theBus_succeeded(const unsigned int bus);
+// check if the next transaction could be started (the bus is not failing, or its retry is due)
+extern bool theBus_isReady(const unsigned int bus);
+
+// the faults and the recovery of one bus
+typedef struct {
+  uint32_t faults;              // the bus has started failing
+  uint32_t failures;            // failed transactions (the first one of the fault and the retries)
+  uint32_t stuck;               // SDA held low after the peripheral reset
+  uint32_t recoveries;          // SDA released by clocking SCL out
+  uint32_t recovery_us;         // the last SDA release (SCL clocking, STOP, peripheral reset), microseconds
+  uint32_t max_recovery_us;     // the longest SDA release, microseconds
+  uint32_t recovery_ms;         // the last fault till the first successful transaction, milliseconds
+  uint32_t max_recovery_ms;     // the longest fault, milliseconds
+} theBus_busStats_t;
+
+typedef struct {
+  theBus_busStats_t buses[bus_max];
+  uint32_t injected;            // the faults injected (BUS_FAULT_PERIOD)
+  uint32_t max_loop_us;         // the longest main loop pass, microseconds
+  uint32_t max_fault_loop_us;   // the longest main loop pass while any bus is failing, microseconds
+} theBus_stats_t;
+
+extern void theBus_getStats(theBus_stats_t *const pStats);
+
+
+#endif // __THE_CLOCK_THE_BUS_HEADER_INCLUDED_
@@ -4,29 +4,109 @@
 #include "pwm_lib.h"
 // project includes
 #include "hwconfig.h"
+#include "theSpeaker.h"
 // own declarations
 #include "theBuzzer.h"
 
+// The sounds are played by the PWM period interrupt, the main loop is not involved. Every sound
+// is a table of steps (the tone and its duration) in flash. The PWM channel runs for the whole
+// alarm: the silent steps have duty 0 and the period BUZZER_REST_PERIOD, so the interrupt keeps
+// counting the periods. The next step is written into the update registers at the last period
+// of the step, and PWM switches to it exactly at the period end. The durations are converted
+// to the periods in MCK cycles (the period is rounded to the whole ticks of the clock) with the
+// remainder carried to the next step, so the sound does not drift.
+
 // PWM channel
 arduino_due::pwm_lib::pwm<arduino_due::pwm_lib::pwm_pin::BUZZER_PWM_PIN> pwm_pin;
+#define PWM_CHANNEL_MASK      ( 1 << arduino_due::pwm_lib::pin_traits<arduino_due::pwm_lib::pwm_pin::BUZZER_PWM_PIN>::channel )
+
+// the step of the sound: PWM period of the tone (1e-8 secs) and the duration (ms)
+typedef struct {
+  uint32_t period;
+  uint16_t duration;
+} step_t;
+
+#define TONE(frequency)       ( 100000000UL / (frequency) )
+#define SILENCE               (0)
+
+// the sound patterns
+static constexpr step_t cBeep[] = {
+  { BUZZER_PERIOD, PERIOD_BEEP }, { SILENCE, PERIOD_BEEP },
+};
+static constexpr step_t cFast[] = {
+  { BUZZER_PERIOD, 100 }, { SILENCE, 100 },
+};
+static constexpr step_t cDouble[] = {
+  { BUZZER_PERIOD, 100 }, { SILENCE, 100 }, { BUZZER_PERIOD, 100 }, { SILENCE, 700 },
+};
+// C6, E6, G6, C7 arpeggio once per second
+static constexpr step_t cMelody[] = {
+  { TONE(1047), 150 }, { TONE(1319), 150 }, { TONE(1568), 150 }, { TONE(2093), 300 }, { SILENCE, 250 },
+};
+
+#define STEPS(steps)          { (steps), sizeof(steps) / sizeof((steps)[0]) }
+static const struct {
+  const step_t *pSteps;
+  unsigned int count;
+} cSounds[buzzer_sound_max] = {
+  STEPS(cBeep),             // buzzer_sound_beep
+  STEPS(cFast),             // buzzer_sound_fast
+  STEPS(cDouble),           // buzzer_sound_double
+  STEPS(cMelody),           // buzzer_sound_melody
+  { NULL, 0 },              // buzzer_sound_chime - sampled, played by theSpeaker
+};
+
+// the clock is chosen by the rest period, and it is kept for the tones (set_period_and_duty),
+// so every tone should fit the clock, and every step should last one period at least
+#define TONE_CLOCK            ( arduino_due::pwm_lib::pwm_core::clock_for_period(BUZZER_REST_PERIOD) )
+constexpr bool is_playable(const step_t *const pSteps, const unsigned int count)
+{
+  return ( count == 0 ) ||
+         ( ( pSteps->period <= arduino_due::pwm_lib::pwm_core::max_period(TONE_CLOCK) ) &&
+           ( ( pSteps->duration * 100000ULL ) >= ( ( pSteps->period == SILENCE ) ? (BUZZER_REST_PERIOD) : (pSteps->period) ) ) &&
+           is_playable(pSteps + 1, count - 1) );
+}
+static_assert(is_playable(cBeep, sizeof(cBeep) / sizeof(cBeep[0])), "the beep is not playable");
+static_assert(is_playable(cFast, sizeof(cFast) / sizeof(cFast[0])), "the fast beep is not playable");
+static_assert(is_playable(cDouble, sizeof(cDouble) / sizeof(cDouble[0])), "the double beep is not playable");
+static_assert(is_playable(cMelody, sizeof(cMelody) / sizeof(cMelody[0])), "the melody is not playable");
+
+#define BENCHMARK_COUNT       (100)         // PWM starts measured at start
 
-// timestamp that will be used for have 1/2 sec beep - 1/2 sec silent
-// in case when alarm is enabled
-static unsigned long timer = 0;
-// timestamp that will be used for have 1 minute total interval
-// for alarm sound (both 'beep' and 'silent')
-static unsigned long timer_beep = 0;
 // boolean flag to indicate whether alarm is currently active
-// (this 1 minute with 1/2 sec on / 1/2 sec off part is on-running)
-static bool bActive = false;
-// boolean flag to indicate if we are currently in this
-// 1/2 sec beep, or 1/2 sec silent part
-static bool bBuzzing = false;
+// (cleared by the interrupt after PERIOD_ALARM)
+static volatile bool bActive = false;
+// PWM is running (it is stopped by the main loop after the alarm)
+static bool bRunning = false;
+// the sound pattern and the step to be written into PWM next
+static uint8_t sound = buzzer_sound_beep;
+static unsigned int step = 0;
+
+// the state of the interrupt: PWM periods of the current step still to start, the part of the
+// steps not covered by the whole periods (MCK cycles), the step written and not started yet
+static uint32_t remaining = 0;
+static uint32_t carry = 0;
+static bool bEdge = false;
+// the ideal start of the written step and of the step after it, ms since the sound has started
+static uint32_t edge_ms = 0;
+static uint32_t next_edge_ms = 0;
+// micros() of the first step start
+static volatile bool bOrigin = false;
+static volatile unsigned long origin_micros = 0;
+
+// the main loop toggling (the previous implementation) replayed for the comparison:
+// millis() of the last step change, the step and its ideal start
+static unsigned long loop_timer = 0;
+static unsigned int loop_step = 0;
+static uint32_t loop_edge_ms = 0;
+
+static theBuzzer_stats_t stats;
 
 // internal routines - see description below
-static inline void buzzer_beep(void);
-static inline void buzzer_silent(void);
-static void buzzer_do(void);
+static void buzzer_next(void);
+static void buzzer_loop(const unsigned long timestamp);
+static uint32_t edge_error(const unsigned long now, const uint32_t ms);
+static void benchmark(void);
 
 //----------------------------------------------------------
 
@@ -40,97 +120,213 @@ void theBuzzer_init(void)
   // make sure the PWM is not running - in case if the routine will
   // be called from somewhere outside the initial setup
   theBuzzer_stop();
+
+  // the statistics are for development only, the start is not delayed by default
+  if ( STATS_ENABLED )
+  {
+    benchmark();
+  }
+
+  // the channel interrupt is enabled only while the sound is played
+  NVIC_EnableIRQ(PWM_IRQn);
 }
 
-// internal routine
-// run the PWM - make the buzzer beeping
-static inline void buzzer_beep(void)
+// measure PWM start by the cycle counter (DWT CYCCNT): the runtime path gets volatile period
+// and duty, so the compiler can not compute the clock and the ticks in advance; the PWM is
+// stopped after every start (not counted), the buzzer clicks for a few milliseconds
+static void benchmark(void)
 {
-  pwm_pin.start(BUZZER_PERIOD, BUZZER_DUTY);
+  volatile uint32_t period = BUZZER_PERIOD;
+  volatile uint32_t duty = BUZZER_DUTY;
+  uint32_t cycles = 0;
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  for ( int i = 0; i < BENCHMARK_COUNT; i++ )
+  {
+    const uint32_t started = DWT->CYCCNT;
+    pwm_pin.start(period, duty);
+    cycles += DWT->CYCCNT - started;
+    pwm_pin.stop();
+  }
+  stats.start_cycles = cycles / BENCHMARK_COUNT;
+
+  cycles = 0;
+  for ( int i = 0; i < BENCHMARK_COUNT; i++ )
+  {
+    const uint32_t started = DWT->CYCCNT;
+    pwm_pin.start<BUZZER_PERIOD, BUZZER_DUTY>();
+    cycles += DWT->CYCCNT - started;
+    pwm_pin.stop();
+  }
+  stats.start_const_cycles = cycles / BENCHMARK_COUNT;
 }
 
 // internal routine
-// stop the pwm - make the buzzer be silent
-static inline void buzzer_silent(void)
+// write the next step into the PWM update registers (it starts with the next period), or
+// silence the buzzer after PERIOD_ALARM; called by the interrupt and by theBuzzer_start()
+static void buzzer_next(void)
 {
-  pwm_pin.stop();
+  if ( next_edge_ms >= PERIOD_ALARM )
+  {
+    PWM_INTERFACE->PWM_IDR1 = PWM_CHANNEL_MASK;
+    pwm_pin.set_duty(0);
+    bActive = false;
+    return;
+  }
+
+  const step_t *const pStep = &(cSounds[sound].pSteps[step]);
+  const uint32_t period = ( pStep->period == SILENCE ) ? (BUZZER_REST_PERIOD) : (pStep->period);
+  // the period as PWM makes it: the whole ticks of the clock
+  const uint32_t period_cycles = arduino_due::pwm_lib::pwm_core::to_ticks(period, TONE_CLOCK) <<
+                                 arduino_due::pwm_lib::pwm_core::two_power(TONE_CLOCK);
+  const uint64_t length = ( pStep->duration * ( VARIANT_MCK / 1000ULL ) ) + carry;
+
+  remaining = length / period_cycles;
+  carry = length % period_cycles;
+  pwm_pin.set_period_and_duty(period, ( pStep->period == SILENCE ) ? (0) : ( period / 2 ));
+
+  edge_ms = next_edge_ms;
+  next_edge_ms += pStep->duration;
+  bEdge = true;
+  step = ( step + 1 ) % cSounds[sound].count;
 }
 
 // internal routine
-// make the buzzer beeping or silent, depends of 'bBuzzing'
-static void buzzer_do(void)
+// the distance of the step start from its ideal time, microseconds
+static uint32_t edge_error(const unsigned long now, const uint32_t ms)
+{
+  const long error = (long)( now - origin_micros - ( ms * 1000UL ) );
+  return ( error < 0 ) ? ( -error ) : (error);
+}
+
+// PWM period interrupt - the period of the buzzer channel has ended, the next one has started
+void PWM_Handler(void)
 {
-  if ( bBuzzing )
+  // the flags are cleared by reading
+  (void)PWM_INTERFACE->PWM_ISR1;
+  if ( ! bActive ) return;
+
+  // the written step has started
+  if ( bEdge )
   {
-    buzzer_beep();
+    const unsigned long now = micros();
+    bEdge = false;
+    if ( bOrigin )
+    {
+      stats.edge_error_us = edge_error(now, edge_ms);
+      if ( stats.edge_error_us > stats.max_edge_error_us ) stats.max_edge_error_us = stats.edge_error_us;
+    }
+    else
+    {
+      origin_micros = now;
+      bOrigin = true;
+    }
+    ++stats.edges;
   }
-  else
+
+  // the last period of the step has started - the next step is written
+  if ( --remaining == 0 )
   {
-    buzzer_silent();
+    buzzer_next();
   }
 }
 
-// periodic function, called pretty fast, so we have to take
-// care execute it with specific periodicy
-void theBuzzer_process(const unsigned long timestamp)
+// internal routine
+// the step changes as the main loop used to make them (the next step when its duration has
+// passed since the previous change), measured against the same ideal times
+static void buzzer_loop(const unsigned long timestamp)
 {
-  // nothing to do if buzzer is inactive
-  if ( ! bActive ) {
-    // no alarm active - just make sure all the timestamps
-    // are set to current values
-    timer = timestamp;
-    timer_beep = timestamp;
-    // alarm is inactive - nothing more to do here
-    return;
-  }
+  if ( ( timestamp - loop_timer ) < cSounds[sound].pSteps[loop_step].duration ) return;
+
+  loop_edge_ms += cSounds[sound].pSteps[loop_step].duration;
+  loop_step = ( loop_step + 1 ) % cSounds[sound].count;
+  loop_timer = timestamp;
+
+  stats.loop_edge_error_us = edge_error(micros(), loop_edge_ms);
+  if ( stats.loop_edge_error_us > stats.max_loop_edge_error_us ) stats.max_loop_edge_error_us = stats.loop_edge_error_us;
+}
 
-  // if the alarm is acttve and the time since last execution exceeds specified period (1/2 sec)
-  if ( ( timestamp - timer ) >= PERIOD_BEEP )
+// periodic function, called pretty fast - the sound is played by the interrupt,
+// only the PWM is stopped after the alarm
+void theBuzzer_process(const unsigned long timestamp)
+{
+  if ( bActive )
   {
-    // if we are already buzzing for PERIOD_ALARM (1 min?)
-    if ( ( timestamp - timer_beep) >= PERIOD_ALARM )
+    // the comparison is for development only
+    if ( STATS_ENABLED && bOrigin )
     {
-      // set the buzzer inactive
-      theBuzzer_stop();
-      // nothing more to do
-      return;
+      buzzer_loop(timestamp);
     }
+    return;
+  }
 
-    // if we were beeping during last second - make silence,
-    // if we were silent during last second - make it beeping.
-    bBuzzing = !bBuzzing;
-    buzzer_do();
-
-    // remember when the function was executed last time
-    timer = timestamp;
+  // the alarm is over - the silent PWM is stopped
+  if ( bRunning )
+  {
+    theBuzzer_stop();
   }
 }
 
 // the routine to activate the alarm.
 // should be called once, and during next 60 seconds
-// the buzzer will activates for 1/2 sec on / 1/2 sec off.
+// the buzzer will play the sound pattern (theBuzzer_sound_t).
 // use theBuzzer_stop() to stop it,
 // use theBuzzer_isBuzzing() to find out if the alarm is
 // currently active.
-void theBuzzer_start(void)
+void theBuzzer_start(const uint8_t newSound)
 {
-  bBuzzing = true;
-  bActive = true;
+  theBuzzer_stop();
+
+  // the sampled sound goes to the DAC
+  if ( newSound == buzzer_sound_chime )
+  {
+    theSpeaker_start(speaker_clip_chime);
+    return;
+  }
+
+  sound = ( newSound < buzzer_sound_max ) ? (newSound) : (buzzer_sound_beep);
+  step = 0;
+  carry = 0;
+  next_edge_ms = 0;
+  bOrigin = false;
+  loop_timer = millis();
+  loop_step = 0;
+  loop_edge_ms = 0;
 
-  buzzer_do();
+  // one silent period first, the clock of the rest period is kept for all the tones;
+  // the first step is written into the update registers and starts after it
+  pwm_pin.start<BUZZER_REST_PERIOD, 0>();
+  bRunning = true;
+  buzzer_next();
+
+  (void)PWM_INTERFACE->PWM_ISR1;
+  bActive = true;
+  PWM_INTERFACE->PWM_IER1 = PWM_CHANNEL_MASK;
 }
 
 // stops the alarm - see theBuzzer_start() for more details
 void theBuzzer_stop(void)
 {
-  bBuzzing = false;
-  bActive = false;
+  theSpeaker_stop();
 
-  buzzer_do();
+  PWM_INTERFACE->PWM_IDR1 = PWM_CHANNEL_MASK;
+  bActive = false;
+  pwm_pin.stop();
+  bRunning = false;
 }
 
 // check if the alarm is currently running - see theBuzzer_start() for details
 bool theBuzzer_isBuzzing(void)
 {
-  return bActive;
+  return bActive || theSpeaker_isPlaying();
+}
+
+void theBuzzer_getStats(theBuzzer_stats_t *const pStats)
+{
+  // the consistent copy of the interrupt statistics
+  noInterrupts();
+  *pStats = stats;
+  interrupts();
 }
@@ -4,9 +4,33 @@
 extern void theBuzzer_init(void);
 extern void theBuzzer_process(const unsigned long timestamp);
 
-extern void theBuzzer_start(void);
+// sound patterns of the alarm
+typedef enum {
+  buzzer_sound_beep,        // 1/2 sec on, 1/2 sec off
+  buzzer_sound_fast,        // 100ms on, 100ms off
+  buzzer_sound_double,      // two short beeps per second
+  buzzer_sound_melody,      // C6-E6-G6-C7 arpeggio once per second
+  buzzer_sound_chime,       // sampled bell chime once per second (theSpeaker)
+  buzzer_sound_max
+} theBuzzer_sound_t;
+
+extern void theBuzzer_start(const uint8_t sound);
 extern void theBuzzer_stop(void);
 extern bool theBuzzer_isBuzzing(void);
 
+// PWM start cost, measured at start when the statistics are enabled, and the timing of the steps
+// of the sound (the step start against its ideal time since the sound has started)
+typedef struct {
+  uint32_t start_cycles;            // start(period, duty) - the clock and the ticks computed at runtime, CPU cycles
+  uint32_t start_const_cycles;      // start<PERIOD, DUTY>() - computed by the compiler, CPU cycles
+  uint32_t edges;                   // steps started by the PWM period interrupt
+  uint32_t edge_error_us;           // the last step started by the interrupt, microseconds
+  uint32_t max_edge_error_us;       // the worst step started by the interrupt, microseconds
+  uint32_t loop_edge_error_us;      // the last step as it would be started by the main loop, microseconds
+  uint32_t max_loop_edge_error_us;  // the worst step as it would be started by the main loop, microseconds
+} theBuzzer_stats_t;
+
+extern void theBuzzer_getStats(theBuzzer_stats_t *const pStats);
+
 
 #endif // __THE_CLOCK_THE_BUZZER_HEADER_INCLUDED_
@@ -0,0 +1,407 @@
+#include <Arduino.h>
+// Libraries: none
+// project includes
+#include "hwconfig.h"
+#include "theBitmaps.h"
+// own declarations
+#include "theCanvas.h"
+
+// The display is rotated, so the landscape pixel (x, y) is the bit (x % 8) of the byte
+// [x / 8][CANVAS_HEIGHT - 1 - y] in the display RAM (page, column). One landscape row of
+// a glyph is one display column, and its pixels are the neighbouring bits of one or two
+// page bytes - so the glyphs are stored rotated (one byte per row, bit N is the column N),
+// and every glyph row is written to the frame with the byte operations.
+// In the strip mode the buffer is the strip of pages only: the drawing is clipped to the strip,
+// and the pages are indexed from the first page of the strip.
+
+// first and last character in the font
+#define FONT_FIRST            (0x20)
+#define FONT_LAST             (0x7E)
+
+#define FRAME_WORDS           ( ( STRIP_PAGES * DISPLAY_COLUMNS ) / sizeof(uint32_t) )
+
+// the frame, STRIP_PAGES pages of DISPLAY_COLUMNS bytes. It is stored as words,
+// to be restored from the background with the word-wide stores
+static uint32_t frame_words[FRAME_WORDS];
+static uint8_t (*const frame)[DISPLAY_COLUMNS] = (uint8_t (*)[DISPLAY_COLUMNS])frame_words;
+
+// the static layer of the frame, see theCanvas_saveBackground (not kept in the strip mode)
+static uint32_t background[ ( DISPLAY_STRIP_PAGES > 0 ) ? (1) : (FRAME_WORDS) ];
+
+// the strip being drawn: its first page and the landscape columns [left, right)
+static struct {
+  int page;
+  int left;
+  int right;
+} strip = { 0, 0, CANVAS_WIDTH };
+
+// nothing is drawn out of the clip rectangle: [left, right) x [top, bottom), it is always within the strip
+static struct {
+  int left;
+  int top;
+  int right;
+  int bottom;
+} clip = { 0, 0, CANVAS_WIDTH, CANVAS_HEIGHT };
+
+// 5x7 font (the same glyphs as the default Adafruit GFX font), rotated:
+// CANVAS_CHAR_HEIGHT rows per glyph, bit N of the row is column N of the glyph
+static const uint8_t font[(FONT_LAST - FONT_FIRST + 1) * CANVAS_CHAR_HEIGHT] = {
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,   // ' '
+  0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04, 0x00,   // '!'
+  0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00,   // '"'
+  0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A, 0x00,   // '#'
+  0x04, 0x1E, 0x05, 0x0E, 0x14, 0x0F, 0x04, 0x00,   // '$'
+  0x03, 0x13, 0x08, 0x04, 0x02, 0x19, 0x18, 0x00,   // '%'
+  0x02, 0x05, 0x05, 0x02, 0x15, 0x09, 0x16, 0x00,   // '&'
+  0x0C, 0x0C, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00,   // '''
+  0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08, 0x00,   // '('
+  0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02, 0x00,   // ')'
+  0x04, 0x15, 0x0E, 0x1F, 0x0E, 0x15, 0x04, 0x00,   // '*'
+  0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00, 0x00,   // '+'
+  0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x04, 0x02,   // ','
+  0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x00,   // '-'
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00,   // '.'
+  0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00,   // '/'
+  0x0E, 0x11, 0x19, 0x15, 0x13, 0x11, 0x0E, 0x00,   // '0'
+  0x04, 0x06, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00,   // '1'
+  0x0E, 0x11, 0x10, 0x0E, 0x01, 0x01, 0x1F, 0x00,   // '2'
+  0x1F, 0x10, 0x08, 0x0C, 0x10, 0x11, 0x0E, 0x00,   // '3'
+  0x08, 0x0C, 0x0A, 0x09, 0x1F, 0x08, 0x08, 0x00,   // '4'
+  0x1F, 0x01, 0x0F, 0x10, 0x10, 0x11, 0x0E, 0x00,   // '5'
+  0x1C, 0x02, 0x01, 0x0F, 0x11, 0x11, 0x0E, 0x00,   // '6'
+  0x1F, 0x10, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00,   // '7'
+  0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E, 0x00,   // '8'
+  0x0E, 0x11, 0x11, 0x1E, 0x10, 0x08, 0x07, 0x00,   // '9'
+  0x00, 0x00, 0x04, 0x00, 0x04, 0x00, 0x00, 0x00,   // ':'
+  0x00, 0x00, 0x04, 0x00, 0x04, 0x04, 0x02, 0x00,   // ';'
+  0x10, 0x08, 0x04, 0x02, 0x04, 0x08, 0x10, 0x00,   // '<'
+  0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00, 0x00,   // '='
+  0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02, 0x00,   // '>'
+  0x0E, 0x11, 0x10, 0x0C, 0x04, 0x00, 0x04, 0x00,   // '?'
+  0x0E, 0x11, 0x15, 0x1D, 0x0D, 0x01, 0x1E, 0x00,   // '@'
+  0x04, 0x0A, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x00,   // 'A'
+  0x0F, 0x11, 0x11, 0x0F, 0x11, 0x11, 0x0F, 0x00,   // 'B'
+  0x0E, 0x11, 0x01, 0x01, 0x01, 0x11, 0x0E, 0x00,   // 'C'
+  0x0F, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0F, 0x00,   // 'D'
+  0x1F, 0x01, 0x01, 0x0F, 0x01, 0x01, 0x1F, 0x00,   // 'E'
+  0x1F, 0x01, 0x01, 0x0F, 0x01, 0x01, 0x01, 0x00,   // 'F'
+  0x1E, 0x11, 0x01, 0x01, 0x19, 0x11, 0x1E, 0x00,   // 'G'
+  0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11, 0x00,   // 'H'
+  0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00,   // 'I'
+  0x1C, 0x08, 0x08, 0x08, 0x08, 0x09, 0x06, 0x00,   // 'J'
+  0x11, 0x09, 0x05, 0x03, 0x05, 0x09, 0x11, 0x00,   // 'K'
+  0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x1F, 0x00,   // 'L'
+  0x11, 0x1B, 0x15, 0x15, 0x15, 0x11, 0x11, 0x00,   // 'M'
+  0x11, 0x11, 0x13, 0x15, 0x19, 0x11, 0x11, 0x00,   // 'N'
+  0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00,   // 'O'
+  0x0F, 0x11, 0x11, 0x0F, 0x01, 0x01, 0x01, 0x00,   // 'P'
+  0x0E, 0x11, 0x11, 0x11, 0x15, 0x09, 0x16, 0x00,   // 'Q'
+  0x0F, 0x11, 0x11, 0x0F, 0x05, 0x09, 0x11, 0x00,   // 'R'
+  0x0E, 0x11, 0x01, 0x0E, 0x10, 0x11, 0x0E, 0x00,   // 'S'
+  0x1F, 0x15, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00,   // 'T'
+  0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00,   // 'U'
+  0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04, 0x00,   // 'V'
+  0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A, 0x00,   // 'W'
+  0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11, 0x00,   // 'X'
+  0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04, 0x00,   // 'Y'
+  0x1F, 0x10, 0x08, 0x0E, 0x02, 0x01, 0x1F, 0x00,   // 'Z'
+  0x1E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x1E, 0x00,   // '['
+  0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00,   // backslash
+  0x1E, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1E, 0x00,   // ']'
+  0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00,   // '^'
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x00,   // '_'
+  0x06, 0x06, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00,   // '`'
+  0x00, 0x00, 0x06, 0x08, 0x0E, 0x09, 0x1E, 0x00,   // 'a'
+  0x01, 0x01, 0x0D, 0x13, 0x11, 0x13, 0x0D, 0x00,   // 'b'
+  0x00, 0x00, 0x0E, 0x11, 0x01, 0x11, 0x0E, 0x00,   // 'c'
+  0x10, 0x10, 0x16, 0x19, 0x11, 0x19, 0x16, 0x00,   // 'd'
+  0x00, 0x00, 0x0E, 0x11, 0x1F, 0x01, 0x0E, 0x00,   // 'e'
+  0x08, 0x14, 0x04, 0x0E, 0x04, 0x04, 0x04, 0x00,   // 'f'
+  0x00, 0x00, 0x0E, 0x19, 0x19, 0x16, 0x10, 0x0E,   // 'g'
+  0x01, 0x01, 0x0D, 0x13, 0x11, 0x11, 0x11, 0x00,   // 'h'
+  0x04, 0x00, 0x06, 0x04, 0x04, 0x04, 0x0E, 0x00,   // 'i'
+  0x08, 0x00, 0x08, 0x08, 0x08, 0x09, 0x06, 0x00,   // 'j'
+  0x01, 0x01, 0x09, 0x05, 0x03, 0x05, 0x09, 0x00,   // 'k'
+  0x06, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00,   // 'l'
+  0x00, 0x00, 0x0B, 0x15, 0x15, 0x15, 0x15, 0x00,   // 'm'
+  0x00, 0x00, 0x0D, 0x13, 0x11, 0x11, 0x11, 0x00,   // 'n'
+  0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00,   // 'o'
+  0x00, 0x00, 0x0D, 0x13, 0x13, 0x0D, 0x01, 0x01,   // 'p'
+  0x00, 0x00, 0x16, 0x19, 0x19, 0x16, 0x10, 0x10,   // 'q'
+  0x00, 0x00, 0x0D, 0x13, 0x01, 0x01, 0x01, 0x00,   // 'r'
+  0x00, 0x00, 0x1E, 0x01, 0x0E, 0x10, 0x0F, 0x00,   // 's'
+  0x04, 0x04, 0x1F, 0x04, 0x04, 0x14, 0x08, 0x00,   // 't'
+  0x00, 0x00, 0x11, 0x11, 0x11, 0x19, 0x16, 0x00,   // 'u'
+  0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04, 0x00,   // 'v'
+  0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A, 0x00,   // 'w'
+  0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x00,   // 'x'
+  0x00, 0x00, 0x11, 0x11, 0x1E, 0x10, 0x11, 0x0E,   // 'y'
+  0x00, 0x00, 0x1F, 0x08, 0x04, 0x02, 0x1F, 0x00,   // 'z'
+  0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08, 0x00,   // '{'
+  0x04, 0x04, 0x04, 0x00, 0x04, 0x04, 0x04, 0x00,   // '|'
+  0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02, 0x00,   // '}'
+  0x02, 0x15, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00,   // '~'
+};
+
+static theCanvas_stats_t stats;
+
+// the glyph row with every pixel doubled, for size 2
+static const uint16_t doubled[32] = {
+  0x0000, 0x0003, 0x000C, 0x000F, 0x0030, 0x0033, 0x003C, 0x003F,
+  0x00C0, 0x00C3, 0x00CC, 0x00CF, 0x00F0, 0x00F3, 0x00FC, 0x00FF,
+  0x0300, 0x0303, 0x030C, 0x030F, 0x0330, 0x0333, 0x033C, 0x033F,
+  0x03C0, 0x03C3, 0x03CC, 0x03CF, 0x03F0, 0x03F3, 0x03FC, 0x03FF,
+};
+
+// internal routines
+static void put_row(const int x, const int y, uint32_t bits);
+static void draw_char(const int x, const int y, const unsigned int size, const char ch);
+
+//----------------------------------------------------------
+
+void theCanvas_init(void)
+{
+  theCanvas_beginStrip(0);
+  theCanvas_clear();
+  theCanvas_saveBackground();
+
+  stats.ram_bytes = sizeof(frame_words) + sizeof(background);
+}
+
+void theCanvas_clear(void)
+{
+  memset(frame_words, 0, sizeof(frame_words));
+}
+
+void theCanvas_beginStrip(const unsigned int first_page)
+{
+  strip.page = first_page;
+  strip.left = first_page * 8;
+  strip.right = strip.left + ( STRIP_PAGES * 8 );
+  theCanvas_resetClip();
+}
+
+void theCanvas_saveBackground(void)
+{
+  if ( DISPLAY_STRIP_PAGES > 0 ) return;
+  memcpy(background, frame_words, sizeof(background));
+}
+
+void theCanvas_restoreBackground(void)
+{
+  // no background in the strip mode, the static layer is drawn with every strip
+  if ( DISPLAY_STRIP_PAGES > 0 )
+  {
+    theCanvas_clear();
+    return;
+  }
+
+  const uint32_t *pFrom = background;
+  uint32_t *pTo = frame_words;
+
+  // 4 words per iteration, the frame is 256 words (512 for 128x128)
+  for ( unsigned int i = 0; i < ( FRAME_WORDS / 4 ); i++ )
+  {
+    pTo[0] = pFrom[0];
+    pTo[1] = pFrom[1];
+    pTo[2] = pFrom[2];
+    pTo[3] = pFrom[3];
+    pTo += 4;
+    pFrom += 4;
+  }
+}
+
+void theCanvas_setClip(const int x, const int y, const int w, const int h)
+{
+  clip.left = (x < strip.left) ? (strip.left) : (x);
+  clip.top = (y < 0) ? (0) : (y);
+  clip.right = ( (x + w) > strip.right ) ? (strip.right) : (x + w);
+  clip.bottom = ( (y + h) > CANVAS_HEIGHT ) ? (CANVAS_HEIGHT) : (y + h);
+}
+
+void theCanvas_resetClip(void)
+{
+  theCanvas_setClip(0, 0, CANVAS_WIDTH, CANVAS_HEIGHT);
+}
+
+const uint8_t *theCanvas_getBuffer(void)
+{
+  return &(frame[0][0]);
+}
+
+// set the pixels of the landscape row y from x on (bit 0 of bits is pixel x)
+static void put_row(const int x, const int y, uint32_t bits)
+{
+  if ( ( y < clip.top ) || ( y >= clip.bottom ) ) return;
+
+  // the pixels out of the clip are cut off
+  const int left = clip.left - x;
+  if ( left > 0 ) bits = ( left >= 32 ) ? (0) : ( bits & ~( ( 1UL << left ) - 1 ) );
+  const int right = clip.right - x;
+  if ( right < 32 ) bits = ( right <= 0 ) ? (0) : ( bits & ( ( 1UL << right ) - 1 ) );
+
+  const unsigned int column = CANVAS_HEIGHT - 1 - y;
+  // x from the left of the strip
+  const int offset = x - strip.left;
+  int page = offset >> 3;
+
+  // the part left from the strip is gone already, just move the rest
+  if ( offset < 0 )
+  {
+    bits >>= (-offset);
+    page = 0;
+  }
+  else
+  {
+    bits <<= ( offset & 7 );
+  }
+
+  // one byte per page, till the pixels are gone
+  for ( ; bits != 0; page++ )
+  {
+    frame[page][column] |= (uint8_t)bits;
+    bits >>= 8;
+  }
+}
+
+static void draw_char(const int x, const int y, const unsigned int size, const char ch)
+{
+  // the characters out of the font are drawn as '?'
+  const unsigned int index = ( ( ch < FONT_FIRST ) || ( ch > FONT_LAST ) ) ? ( '?' - FONT_FIRST ) : ( ch - FONT_FIRST );
+  const uint8_t *const pGlyph = &(font[index * CANVAS_CHAR_HEIGHT]);
+
+  for ( unsigned int row = 0; row < CANVAS_CHAR_HEIGHT; row++ )
+  {
+    if ( size == 1 )
+    {
+      put_row(x, y + row, pGlyph[row]);
+    }
+    else
+    {
+      const uint32_t bits = doubled[pGlyph[row] & 0x1F];
+      put_row(x, y + (row * 2), bits);
+      put_row(x, y + (row * 2) + 1, bits);
+    }
+  }
+}
+
+int theCanvas_text(const int x, const int y, const unsigned int size, const char *const pStr)
+{
+  const int advance = CANVAS_CHAR_WIDTH * ( (size > 1) ? (2) : (1) );
+  int cursor = x;
+
+  for ( const char *p = pStr; *p != '\0'; p++ )
+  {
+    draw_char(cursor, y, size, *p);
+    cursor += advance;
+  }
+
+  return cursor;
+}
+
+int theCanvas_bitmap(const int x, const int y, const theBitmaps_bitmap_t *const pBitmap)
+{
+  int row = y;
+
+  // every entry is the row repeated one or more times
+  for ( unsigned int entry = 0; entry < pBitmap->count; entry++ )
+  {
+    const uint16_t value = pBitmap->pRows[entry];
+    const uint32_t bits = value & BITMAP_ROW_PIXELS;
+
+    for ( unsigned int repeat = ( value >> BITMAP_ROW_REPEAT ); ; repeat-- )
+    {
+      put_row(x, row++, bits);
+      if ( repeat == 0 ) break;
+    }
+  }
+
+  ++stats.bitmaps;
+  return x + pBitmap->advance;
+}
+
+int theCanvas_digits(const int x, const int y, const theBitmaps_digits_t digits, const char *const pStr)
+{
+  const unsigned long started = micros();
+  int cursor = x;
+
+  for ( const char *p = pStr; *p != '\0'; p++ )
+  {
+    const theBitmaps_bitmap_t *const pBitmap = theBitmaps_getDigit(digits, *p);
+    if ( pBitmap != NULL )
+    {
+      cursor = theCanvas_bitmap(cursor, y, pBitmap);
+    }
+    else
+    {
+      const char str[2] = { *p, '\0' };
+      cursor = theCanvas_text(cursor, y, 1, str);
+    }
+  }
+
+  stats.bitmaps_us += micros() - started;
+  return cursor;
+}
+
+int theCanvas_icon(const int x, const int y, const theBitmaps_icon_t icon)
+{
+  const unsigned long started = micros();
+  const int next = theCanvas_bitmap(x, y, theBitmaps_getIcon(icon));
+  stats.bitmaps_us += micros() - started;
+  return next;
+}
+
+void theCanvas_hline(const int x, const int y, const int w)
+{
+  int left = (x < clip.left) ? (clip.left) : (x);
+  const int right = ( (x + w) > clip.right ) ? (clip.right) : (x + w);
+
+  if ( ( y < clip.top ) || ( y >= clip.bottom ) ) return;
+
+  const unsigned int column = CANVAS_HEIGHT - 1 - y;
+
+  // the whole bytes where possible, the masked ones at the ends
+  while ( left < right )
+  {
+    const int page = left >> 3;
+    const int first = left & 7;
+    const int last = ( ( right - (page * 8) ) > 8 ) ? (8) : ( right - (page * 8) );
+
+    frame[page - strip.page][column] |= (uint8_t)( ( 0xFF << first ) & ( 0xFF >> ( 8 - last ) ) );
+    left = (page * 8) + last;
+  }
+}
+
+void theCanvas_vline(const int x, const int y, const int h)
+{
+  if ( ( x < clip.left ) || ( x >= clip.right ) ) return;
+
+  const int top = (y < clip.top) ? (clip.top) : (y);
+  const int bottom = ( (y + h) > clip.bottom ) ? (clip.bottom) : (y + h);
+  const uint8_t mask = 1 << ( x & 7 );
+  uint8_t *const pPage = frame[(x >> 3) - strip.page];
+
+  // one bit in every column of the page
+  for ( int row = top; row < bottom; row++ )
+  {
+    pPage[CANVAS_HEIGHT - 1 - row] |= mask;
+  }
+}
+
+void theCanvas_clearColumn(const int x)
+{
+  if ( ( x < strip.left ) || ( x >= strip.right ) ) return;
+
+  const uint8_t mask = ~( 1 << ( x & 7 ) );
+  uint8_t *const pPage = frame[(x >> 3) - strip.page];
+
+  for ( unsigned int column = 0; column < DISPLAY_COLUMNS; column++ )
+  {
+    pPage[column] &= mask;
+  }
+}
+
+void theCanvas_getStats(theCanvas_stats_t *const pStats)
+{
+  *pStats = stats;
+}
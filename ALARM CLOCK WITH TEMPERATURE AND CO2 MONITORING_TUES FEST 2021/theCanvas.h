@@ -0,0 +1,60 @@
+#if !defined(__THE_CLOCK_THE_CANVAS_HEADER_INCLUDED_)
+#define __THE_CLOCK_THE_CANVAS_HEADER_INCLUDED_
+
+// The canvas coordinates are the landscape ones (the display is rotated):
+// x = 0..CANVAS_WIDTH-1 from the left, y = 0..CANVAS_HEIGHT-1 from the top.
+// The frame buffer itself is in the display RAM layout (see thePanel_show). In the strip mode
+// (DISPLAY_STRIP_PAGES) the buffer is STRIP_PAGES pages only - the frame is drawn strip by
+// strip, and whatever is drawn out of the current strip is cut off.
+#define CANVAS_WIDTH          ( DISPLAY_PAGES * 8 )
+#define CANVAS_HEIGHT         ( DISPLAY_COLUMNS )
+
+// character cell of the font (size 1), the glyph is 5x8 plus one column spacing
+#define CANVAS_CHAR_WIDTH     (6)
+#define CANVAS_CHAR_HEIGHT    (8)
+
+// no periodic actions, the frame is drawn by theDisplay
+extern void theCanvas_init(void);
+
+// the strip of STRIP_PAGES pages from first_page on is drawn next (the whole frame if it is not
+// the strip mode); the clip is reset. The strip is not cleared - it is up to the drawing
+extern void theCanvas_beginStrip(const unsigned int first_page);
+// clear the whole frame (the strip)
+extern void theCanvas_clear(void);
+// the frame becomes the background (the static layer, drawn once); not kept in the strip mode
+extern void theCanvas_saveBackground(void);
+// start the new frame from the background; in the strip mode the strip is cleared only
+extern void theCanvas_restoreBackground(void);
+// nothing is drawn out of the rectangle, till the next call or theCanvas_resetClip
+extern void theCanvas_setClip(const int x, const int y, const int w, const int h);
+extern void theCanvas_resetClip(void);
+// draw the text with its top left corner at (x, y), size 1 or 2;
+// returns x right after the text, to continue drawing from there
+extern int theCanvas_text(const int x, const int y, const unsigned int size, const char *const pStr);
+// draw the bitmap with its top left corner at (x, y); returns x where the next bitmap starts
+extern int theCanvas_bitmap(const int x, const int y, const theBitmaps_bitmap_t *const pBitmap);
+// draw the string with the digits bitmaps, the characters without the bitmap are drawn by the font;
+// returns x right after the string
+extern int theCanvas_digits(const int x, const int y, const theBitmaps_digits_t digits, const char *const pStr);
+// draw the icon; returns x where the next bitmap starts
+extern int theCanvas_icon(const int x, const int y, const theBitmaps_icon_t icon);
+// draw the horizontal line of width w starting at (x, y)
+extern void theCanvas_hline(const int x, const int y, const int w);
+// draw the vertical line of height h starting at (x, y)
+extern void theCanvas_vline(const int x, const int y, const int h);
+// clear the column x (the whole height of the canvas)
+extern void theCanvas_clearColumn(const int x);
+// the frame (the strip) in the display RAM layout, STRIP_PAGES * DISPLAY_COLUMNS bytes
+extern const uint8_t *theCanvas_getBuffer(void);
+
+// statistics of the bitmaps drawing
+typedef struct {
+  uint32_t bitmaps;             // bitmaps drawn
+  uint32_t bitmaps_us;          // time of all the bitmaps drawing, microseconds
+  uint32_t ram_bytes;           // RAM used for the frame (the strip) and the background
+} theCanvas_stats_t;
+
+extern void theCanvas_getStats(theCanvas_stats_t *const pStats);
+
+
+#endif // __THE_CLOCK_THE_CANVAS_HEADER_INCLUDED_
@@ -0,0 +1,121 @@
+#include <Arduino.h>
+// Libraries: none
+// project includes
+#include "hwconfig.h"
+#include "theData.h"
+#include "theBitmaps.h"
+#include "theCanvas.h"
+// own declarations
+#include "theChart.h"
+
+// The chart is drawn in the display RAM ring: the sample N is always the canvas column
+// N % CHART_COLUMNS, and the display start line makes the newest column the rightmost one.
+// So the new sample changes only one column (the bits of one page), the rest of the chart
+// is scrolled by the display itself.
+
+#if ( CHART_COLUMNS != CANVAS_WIDTH )
+#error "the chart ring should be exactly the display RAM rows"
+#endif
+
+// the upper half is CO2, the lower half is temperature, the grid line between them
+#define BAND_HEIGHT           ( ( CANVAS_HEIGHT / 2 ) - 1 )
+#define CO2_TOP               (0)
+#define GRID_Y                ( BAND_HEIGHT )
+#define TERMO_TOP             ( BAND_HEIGHT + 1 )
+#define GRID_STEP             (4)           // grid line is dotted, every 4th column
+
+#define NO_VALUE              (INT16_MIN)
+
+typedef struct {
+  int16_t co2;                      // ppm
+  int16_t termo[COUNT_TERMO];       // 1/100 of Celsius
+} column_t;
+
+// the last CHART_COLUMNS samples
+static column_t columns[CHART_COLUMNS];
+static uint32_t count = 0;
+
+// timestamp last called
+static unsigned long timer = 0;
+
+// internal routines
+static int16_t get_value(const unsigned int channel);
+static int scale(const int32_t value, const int32_t min, const int32_t max);
+
+//----------------------------------------------------------
+
+void theChart_init(void)
+{
+  count = 0;
+}
+
+uint32_t theChart_getCount(void)
+{
+  return count;
+}
+
+// the sample value, NO_VALUE if it is invalid
+static int16_t get_value(const unsigned int channel)
+{
+  theData_sample_t sample;
+  if ( ! theData_getSample(channel, &sample) ) return NO_VALUE;
+  return (int16_t)sample.value;
+}
+
+// the value to the pixels above the band bottom, 0...BAND_HEIGHT-1
+static int scale(const int32_t value, const int32_t min, const int32_t max)
+{
+  if ( value <= min ) return 0;
+  if ( value >= max ) return BAND_HEIGHT - 1;
+  return ( ( value - min ) * ( BAND_HEIGHT - 1 ) ) / ( max - min );
+}
+
+bool theChart_drawColumn(const uint32_t sample)
+{
+  if ( ( sample >= count ) || ( ( count - sample ) > CHART_COLUMNS ) ) return false;
+
+  const column_t *const pColumn = &(columns[sample % CHART_COLUMNS]);
+  const int x = sample % CHART_COLUMNS;
+
+  theCanvas_clearColumn(x);
+
+  if ( pColumn->co2 != NO_VALUE )
+  {
+    const int height = scale(pColumn->co2, CHART_CO2_MIN, CHART_CO2_MAX) + 1;
+    theCanvas_vline(x, CO2_TOP + BAND_HEIGHT - height, height);
+  }
+
+  if ( ( sample % GRID_STEP ) == 0 )
+  {
+    theCanvas_vline(x, GRID_Y, 1);
+  }
+
+  for ( unsigned int i = 0; i < COUNT_TERMO; i++ )
+  {
+    if ( pColumn->termo[i] == NO_VALUE ) continue;
+    theCanvas_vline(x, TERMO_TOP + BAND_HEIGHT - 1 - scale(pColumn->termo[i], CHART_TERMO_MIN, CHART_TERMO_MAX), 1);
+  }
+
+  return true;
+}
+
+// periodic function, called pretty fast, so we have to take
+// care execute it with specific periodicy
+void theChart_process(const unsigned long timestamp)
+{
+  // if the time since last execution exceeds specified period
+  if ( ( timestamp - timer ) >= PERIOD_CHART )
+  {
+    column_t *const pColumn = &(columns[count % CHART_COLUMNS]);
+
+    pColumn->co2 = get_value(data_channel_co2);
+    for ( unsigned int i = 0; i < COUNT_TERMO; i++ )
+    {
+      pColumn->termo[i] = get_value(data_channel_termo_0 + i);
+    }
+    ++count;
+
+    // remember when the function was executed last time
+    timer = timestamp;
+  }
+}
@@ -0,0 +1,15 @@
+#if !defined(__THE_CLOCK_THE_CHART_HEADER_INCLUDED_)
+#define __THE_CLOCK_THE_CHART_HEADER_INCLUDED_
+
+extern void theChart_init(void);
+extern void theChart_process(const unsigned long timestamp);
+
+// samples taken since the start, one per PERIOD_CHART
+extern uint32_t theChart_getCount(void);
+// draw the sample (0...count-1) as the canvas column (sample % CHART_COLUMNS):
+// CO2 as a bar in the upper half, temperature sensors as dots in the lower half.
+// Returns false if the sample is not kept any more (or not taken yet)
+extern bool theChart_drawColumn(const uint32_t sample);
+
+
+#endif // __THE_CLOCK_THE_CHART_HEADER_INCLUDED_
@@ -6,32 +6,35 @@
 #include "hwconfig.h"
 #include "theRTC.h"
 #include "theBuzzer.h"
+#include "theNVM.h"
+#include "theAlarms.h"
+#include "theTime.h"
 // own declarations
 #include "theData.h"
 
 DueFlashStorage storage;
 
-// in order to not reference the DS18B20 library
-#define INVALID_TEMPERATURE     (-7040)
-// these 2 routines have forward declaraions below
-//static float toCelsius(int16_t raw);
-//static float toFahrenheit(int16_t raw);
+#if ( ALARMS_KEYS < 1 ) || ( ALARMS_KEYS > 99 ) || ( ALARMS_KEYS > ALARMS_MAX )
+#error "the alarm slots adjusted by the keys should be 1...99, and not more than ALARMS_MAX"
+#endif
 
 // timestamp last called
-static unsigned long timer_flash = 0;
 static unsigned long timer_blink = 0;
+// timestamp of the last settings change (for deferred NVM commit)
+static unsigned long timer_nvm = 0;
 
 typedef enum {
   adj_none,
   adj_year,
   adj_month,
   adj_day,
-  adj_dow,
   adj_hour,
   adj_minute,
+  adj_alarm_slot,
   adj_alarm_enable,
   adj_alarm_hour,
   adj_alarm_minute,
+  adj_alarm_sound,
   adj_max
 } blink_element_t;
 
@@ -43,10 +46,9 @@ static blink_element_t blink_element = adj_none;
 
 #define DOW_LEN           3
 #define MNS_LEN           3
-#define CO2_LEN           5
 
-#define DATE_LEN          16
-#define TIME_LEN          16
+#define DATE_LEN          DATA_DATE_LEN
+#define TIME_LEN          DATA_TIME_LEN
 
 // some useful constants for date
 static const char cstrDayOfWeek[DOW_LEN * (DAYS_OF_WEEK + 1) + 1] = { "???MonTueWedThuFriSatSun" };
@@ -60,66 +62,124 @@ static char strDate[DATE_LEN + 1] = "---, -- --- 20--";
 static const char cstrTime_failure[TIME_LEN + 1] = "--:--";
 static char strTime[TIME_LEN + 1] = "--:--";
 
+// RTC transaction has failed: the failure strings are shown instead of the date and time (which
+// are still counted by theRTC) till the next successful read out of the registers
+static bool bRtcFailed = false;
+
 // flashing dot in the clock
 static bool flashing_dot = false;
 
 // alarm representation
 static const char *const cstrAlarmEnabled[2] = { "--OFF--", "-alarm-" };
+static const char cstrAlarmSlot[] = "alarm";    // the slot number follows
+// the sound names, by theBuzzer_sound_t
+static const char *const cstrAlarmSounds[buzzer_sound_max] = { "beep", "fast", "double", "melody", "chime" };
 static char strAlarm[TIME_LEN + 1] = "--:--";
 
-// CO2 string representation
-static const char* const cstrCO2_failure = "----";
-static char strCO2[CO2_LEN + 1] = "     ";
-
-// temperature sensors values
-#define TEMP_LEN                7
-static const char* const cstrTemp_failure = "-------";
+// typed samples for all the measurement channels (CO2 + temperature sensors),
+// all of them are invalid until the first report
+static theData_sample_t samples[data_channel_max];
 static unsigned int reported_temp_count = 0;
-static int16_t reported_temps[COUNT_TERMO];
-static char strTemp[COUNT_TERMO][TEMP_LEN+1];
+
+// last time reported by RTC, used to timestamp the samples
+static unsigned long rtc_days = 0;        // days since 2000-01-01
+static unsigned long rtc_seconds = 0;     // seconds since 2000-01-01 00:00:00
+static unsigned long rtc_millis = 0;      // millis() when 'rtc_seconds' was reported
 
 // here's what do we need to flash with adjusting value
 static bool isFahrenheit = false;
 static bool blink_adjustment = false;
 
-// the 'alarm' data storage
+// published snapshots - readers copy the one selected by the latest sequence, while the
+// writer prepares the other one. The sequence is odd while the writer works (see theData_getSnapshot)
+static theData_snapshot_t snapshots[2];
+static volatile uint32_t snapshot_sequence = 0;
+static volatile uint32_t snapshot_retries = 0;   // readers copies repeated
+static theData_stressStats_t stress_stats;
+// something was changed since the last publication
+static bool bChanged = true;
+
+// the 'alarm' data storage: the alarm of the slot shown and adjusted by the keys (the slot 0 is
+// kept in the settings, the other slots are kept by theAlarms); the slot 0 is shown out of the adjustment
 static struct {
   bool enabled;
   uint8_t hour;
   uint8_t minute;
+  uint8_t sound;            // theBuzzer_sound_t
+  uint8_t weekdays;         // the slot 0 sounds every day, the other slots keep their days
+  uint8_t one_shot;         // ALARM_ONE_SHOT of the other slots, kept as is
 } alarm;
+static unsigned int alarm_slot = 0;
+
+// settings keys in the config store (theNVM)
+typedef enum {
+  nvm_key_alarm_enabled,
+  nvm_key_alarm_hour,
+  nvm_key_alarm_minute,
+  nvm_key_fahrenheit,
+  nvm_key_alarm_sound,
+  nvm_key_max
+} nvm_key_t;
+
+// settings changes are kept in RAM and committed to NVM later, all of them at once
+static bool bNvmChanged = false;      // changed since last theData_process() call
+static bool bNvmPending = false;      // changed since last commit
+static theData_nvmStats_t nvm_stats;
+
+// the adjusting key press: micros() and the first snapshot which could show the new value
+static bool bAdjustShown = true;
+static unsigned long adjust_micros = 0;
+static uint32_t adjust_sequence = 0;
+static theData_adjustStats_t adjust_stats;
 
 // internal routines - see description below
 // configuration storing / reading
 static void read_nvm_config(void);
 static void write_nvm_alarm(void);
+static void schedule_alarm(void);
+static void load_alarm(const unsigned int slot);
 static void write_nvm_degrees(void);
+static void commit_nvm(void);
 // string manipulations
 static void inline set_int(char* const pStr, const unsigned int pos, const unsigned int value, const char leadingZero);
 static void inline set_char(char* const pStr, unsigned int pos, unsigned int count, const char space);
 static void inline set_str(char *const pStr, const unsigned int pos, 
      char const* const pSubStr, const unsigned int size, const unsigned int value, const unsigned int max);
-// string manipulations for temperature
-static void set_string_temp(char* const pStr, const int16_t value, const bool isFahrenheitP);
+// samples manipulations
+static void set_sample(const unsigned int channel, const int32_t value, const theData_unit_t unit);
+static void set_sample_failure(const unsigned int channel);
 // temperature conversions
-static float toCelsius(int16_t raw);
-static float toFahrenheit(int16_t raw);
+static int32_t toCentiCelsius(const int16_t raw);
 // alarm string manipulations
 static void theData_set_alarm_string(void);
+// snapshot preparation and publication
+static void build_date(char *const pStr);
+static void build_time(char *const pStr);
+static void build_alarm(char *const pStr);
+static unsigned int snapshot_index(const uint32_t sequence);
+static theData_snapshot_t *publish_begin(void);
+static void publish_end(theData_snapshot_t *const pSnapshot);
+static void publish_snapshot(void);
+static void stress_publish(void);
+static void stress_check(void);
 // alarm adjustments
 static void theData_alarm_enable(const bool increment);
 static inline int adjust(const int value, const int min, const int max, const bool increment);
 static void theData_alarm_hr(const bool increment);
 static void theData_alarm_min(const bool increment);
+static void theData_alarm_slot(const bool increment);
+static void theData_alarm_sound(const bool increment);
+static void adjust_pressed(void);
 
 //----------------------------------------------------------
 
 // reads the configuration from non-volatile storage
 // (alarm data and degrees representation)
-// should be called once on startup
+// should be called once on startup, after theNVM_init()
 static void read_nvm_config(void)
 {
-  // we will use magic number approach to find out if there is real data
+  // the settings stored before the config store was introduced are at fixed offsets,
+  // we will use magic number approach to find out if there is real data there
   // (after flash erase all the values will be 0xFF, and if we have something
   // already stored by us, we will set one extra byte to 'magic number' value,
   // and that is how we can find out if the stored data are actual)
@@ -134,21 +194,112 @@ static void read_nvm_config(void)
   {
     isFahrenheit = (storage.read(5) == NVM_TRUE);
   }
+
+  // the config store has the latest values
+  uint16_t value;
+  if ( theNVM_read(nvm_key_alarm_enabled, &value) ) alarm.enabled = (value == NVM_TRUE);
+  if ( theNVM_read(nvm_key_alarm_hour,    &value) ) alarm.hour = value;
+  if ( theNVM_read(nvm_key_alarm_minute,  &value) ) alarm.minute = value;
+  if ( theNVM_read(nvm_key_alarm_sound,   &value) ) alarm.sound = value;
+  if ( theNVM_read(nvm_key_fahrenheit,    &value) ) isFahrenheit = (value == NVM_TRUE);
+  alarm.weekdays = ALARM_EVERY_DAY;
 }
 
-// write the alarm data to non-volatile storage
+// the alarm data should be written to non-volatile storage,
+// it will be done by commit_nvm() later (theAlarms stores the other slots); the schedule is updated right away
 static void write_nvm_alarm(void)
 {
-  storage.write(1, (alarm.enabled) ? (NVM_TRUE) : (NVM_FALSE) );
-  storage.write(2, alarm.hour);
-  storage.write(3, alarm.minute);
-  storage.write(0, MAGIC_NUMBER);
+  schedule_alarm();
+  if ( alarm_slot != 0 ) return;
+  bNvmChanged = true;
+  ++nvm_stats.changes;
 }
 
+// the alarm is put to its slot of theAlarms schedule
+static void schedule_alarm(void)
+{
+  const theAlarms_alarm_t slot = {
+    (uint8_t)alarm.hour, (uint8_t)alarm.minute, (uint8_t)alarm.weekdays,
+    (uint8_t)( ( (alarm.enabled) ? (ALARM_ENABLED) : (0) ) | alarm.one_shot | alarm.sound )
+  };
+  theAlarms_set(alarm_slot, &slot);
+}
+
+// take the alarm of the slot from theAlarms schedule to be shown and adjusted,
+// the free slot is the disabled alarm sounding every day
+static void load_alarm(const unsigned int slot)
+{
+  theAlarms_alarm_t stored;
+
+  alarm_slot = slot;
+  if ( theAlarms_get(slot, &stored) )
+  {
+    alarm.enabled = ( ( stored.flags & ALARM_ENABLED ) != 0 );
+    alarm.hour = stored.hour;
+    alarm.minute = stored.minute;
+    alarm.sound = stored.flags & ALARM_SOUND_MASK;
+    alarm.weekdays = stored.weekdays;
+    alarm.one_shot = stored.flags & ALARM_ONE_SHOT;
+  }
+  else
+  {
+    alarm.enabled = false;
+    alarm.sound = buzzer_sound_beep;
+    alarm.weekdays = ALARM_EVERY_DAY;
+    alarm.one_shot = 0;
+  }
+  theData_set_alarm_string();
+}
+
+// the degrees representation should be written to non-volatile storage,
+// it will be done by commit_nvm() later
 static void write_nvm_degrees(void)
 {
-  storage.write(5, (isFahrenheit) ? (NVM_TRUE) : (NVM_FALSE) );
-  storage.write(4, MAGIC_NUMBER);
+  bNvmChanged = true;
+  ++nvm_stats.changes;
+}
+
+// write all the pending settings to non-volatile storage with a single write
+// (every single flash write stalls the CPU for milliseconds)
+static void commit_nvm(void)
+{
+  if ( ! bNvmPending ) return;
+
+  // the alarm of the slot 0 is taken from the schedule, another slot could be adjusted now
+  theAlarms_alarm_t slot;
+  theAlarms_get(0, &slot);
+
+  const theNVM_setting_t settings[nvm_key_max] = {
+    { nvm_key_alarm_enabled, (uint16_t)( ( slot.flags & ALARM_ENABLED ) ? (NVM_TRUE) : (NVM_FALSE) ) },
+    { nvm_key_alarm_hour,    slot.hour },
+    { nvm_key_alarm_minute,  slot.minute },
+    { nvm_key_fahrenheit,    (uint16_t)( (isFahrenheit) ? (NVM_TRUE) : (NVM_FALSE) ) },
+    { nvm_key_alarm_sound,   (uint16_t)( slot.flags & ALARM_SOUND_MASK ) }
+  };
+
+  // the config store appends only the changed values, all of them with one page write
+  const unsigned long started = micros();
+  theNVM_write(settings, nvm_key_max);
+  const unsigned long stall = micros() - started;
+
+  // statistics for this user session (all the changes since the previous commit)
+  ++nvm_stats.commits;
+  nvm_stats.session_changes = nvm_stats.changes - nvm_stats.committed_changes;
+  nvm_stats.committed_changes = nvm_stats.changes;
+  nvm_stats.last_stall_us = stall;
+  if ( stall > nvm_stats.max_stall_us ) nvm_stats.max_stall_us = stall;
+
+  bNvmPending = false;
+}
+
+void theData_getNvmStats(theData_nvmStats_t *const pStats)
+{
+  *pStats = nvm_stats;
+}
+
+void theData_getAdjustStats(theData_adjustStats_t *const pStats)
+{
+  *pStats = adjust_stats;
 }
 
 // initialization - called once at the device start
@@ -159,29 +310,86 @@ void theData_init(void)
   read_nvm_config();
   // prepare the alarm presentation string
   theData_set_alarm_string(); // init the alarm string representation
+  // the alarm is the slot 0 of the schedule
+  schedule_alarm();
   // all the termo sensors are "failure" before we read any data
   theData_reportTermo_sensorCount(0);
+  // readers should never see the empty snapshot (the stress mode writer is SysTick interrupt)
+  if ( ! DATA_STRESS ) publish_snapshot();
 }
 
 // periodic function, called pretty fast, so we have to take
 // care execute it with specific periodicy
 void theData_process(const unsigned long timestamp)
 {
+  // settings were changed - restart the idle timer before committing them to NVM
+  if ( bNvmChanged )
+  {
+    bNvmChanged = false;
+    bNvmPending = true;
+    timer_nvm = timestamp;
+  }
+
+  // no more settings changes for a while - commit them
+  if ( bNvmPending && ( ( timestamp - timer_nvm ) >= PERIOD_NVM_COMMIT ) )
+  {
+    commit_nvm();
+  }
+
   // if adjustment is active - check the timer and change the blinking state
   if ( (blink_element != adj_none) && ( ( timestamp - timer_blink ) >= PERIOD_DISPLAY_BLINK ) )
   {
     blink_adjustment = !blink_adjustment;
     timer_blink = timestamp;
+    bChanged = true;
+  }
+
+  // the dot in the clock is on for the first PERIOD_DISPLAY_FLASH of every RTC second
+  // (millis(), not the timestamp - the second could be reported after the timestamp was taken)
+  const bool dot = ( ( ( millis() - rtc_millis ) % 1000 ) < PERIOD_DISPLAY_FLASH );
+  if ( dot != flashing_dot )
+  {
+    flashing_dot = dot;
+    bChanged = true;
+  }
+
+  // the stress mode replaces the publication by the check of the interrupt writer snapshots
+  if ( DATA_STRESS )
+  {
+    stress_check();
+    return;
   }
 
-  // if the time since last execution exceeds specified period - flash the dot in the clock
-  if ( ( timestamp - timer_flash ) >= PERIOD_DISPLAY_FLASH ) 
+  // once per update - give the readers a new consistent view of all the data
+  if ( bChanged )
   {
-    flashing_dot = !flashing_dot;
-    timer_flash = timestamp;
+    publish_snapshot();
+    bChanged = false;
   }
 }
 
+// store the value to the channel's sample and stamp it with the
+// last RTC time plus the milliseconds passed since that RTC report
+static void set_sample(const unsigned int channel, const int32_t value, const theData_unit_t unit)
+{
+  theData_sample_t *const pSample = &(samples[channel]);
+
+  pSample->value = value;
+  pSample->unit = unit;
+  pSample->valid = true;
+  pSample->time.rtc = rtc_seconds;
+  pSample->time.ms = millis() - rtc_millis;
+
+  bChanged = true;
+}
+
+// mark the channel's sample as invalid, the timestamp still tells when the failure was reported
+static void set_sample_failure(const unsigned int channel)
+{
+  set_sample(channel, 0, data_unit_none);
+  samples[channel].valid = false;
+}
+
 void theData_reportCO2_value(const int value)
 {
   // if we have received invalid value
@@ -190,17 +398,36 @@ void theData_reportCO2_value(const int value)
     theData_reportCO2_failure();
     return;
   }
-  sprintf(strCO2, "%d", value);
+  set_sample(data_channel_co2, value, data_unit_ppm);
 }
 
 void theData_reportCO2_failure(void)
 {
-  memcpy(strCO2, cstrCO2_failure, CO2_LEN);
+  set_sample_failure(data_channel_co2);
+}
+
+void theData_getTimestamp(theData_timestamp_t *const pTime)
+{
+  pTime->rtc = rtc_seconds;
+  pTime->ms = millis() - rtc_millis;
 }
 
-const char* const theData_getDisplay_CO2(void)
+bool theData_getSample(const unsigned int channel, theData_sample_t *const pSample)
 {
-  return strCO2;
+  if ( channel >= data_channel_max ) return false;
+
+  // the same protocol as theData_getSnapshot(), but only one sample is copied
+  uint32_t sequence;
+  for ( ;; ) {
+    sequence = snapshot_sequence;
+    __sync_synchronize();
+    *pSample = snapshots[snapshot_index(sequence)].samples[channel];
+    __sync_synchronize();
+    if ( ( ( sequence & 1 ) == 0 ) && ( snapshot_sequence == sequence ) ) break;
+    ++snapshot_retries;
+  }
+
+  return pSample->valid;
 }
 
 // helper function to set int value to string, changes 2 chars: [pos] and [pos+1]. 'leadingZero' is char to replace leading zero
@@ -229,166 +456,290 @@ static void inline set_str(char *const pStr, const unsigned int pos, char const*
   memcpy( &(pStr[pos]), &(pSubStr[pos_substr]), size);
 }
 
+// 'year' is 0..99 as the RTC provides it
 void theData_reportRTC_date(const int year, const int month, const int day, const int dow)
 {
+  if ( ( month >= 1 ) && ( month <= MONTHS ) && ( year >= 0 ) && ( day >= 1 ) )
+  {
+    rtc_days = theTime_daysFromCivil(TIME_EPOCH_YEAR + year, month, day);
+  }
+
   set_str(strDate, 0, cstrDayOfWeek, DOW_LEN, dow, 7);    // day of week
   set_int(strDate, 5, day, ' ');                          // day
   set_str(strDate, 8, cstrMonths,    MNS_LEN, month, 12); // month
   set_int(strDate, 14, year, '0');                        // year
+
+  bChanged = true;
 }
 
-void theData_reportRTC_time(const int hour, const int minute, const int seconds)
+// 'edge_millis' is millis() when the second has started (or when it was read out)
+void theData_reportRTC_time(const int hour, const int minute, const int seconds, const unsigned long edge_millis)
 {
-  static bool bAlarmReady = true;
-
   set_int(strTime, 0, hour,  '0');      // hour
-  // flashing dot - handled in theData_getDisplay_getTime()
+  // flashing dot - handled in build_time()
   set_int(strTime, 3, minute, '0');     // minute
+  bChanged = true;
 
-  // if alarm is not enabled - it is never ready to proceed
-  if ( ! alarm.enabled ) {
-    bAlarmReady = false;
-    return;
-  }
-
-  // if alarm is enabled - 
-  if ( ( alarm.hour != hour ) || (alarm.minute != minute) )
-  {
-    bAlarmReady = true;
-  }
+  // the timestamp for all the samples reported from now on
+  rtc_seconds = (rtc_days * 86400UL) + (hour * 3600UL) + (minute * 60UL) + seconds;
+  rtc_millis = edge_millis;
+}
 
-  if ( ( alarm.hour == hour ) && (alarm.minute == minute) && ( bAlarmReady ) && ( ! theBuzzer_isBuzzing() ) ) 
-  {
-    bAlarmReady = false;
-    theBuzzer_start();
-  }
+// DS3231 has matched the armed alarm of theAlarms
+void theData_reportRTC_alarm(void)
+{
+  theAlarms_fire();
 }
 
 void theData_reportRTC_failure(void)
 {
-  memcpy(strDate, cstrDate_failure, DATE_LEN);
-  memcpy(strTime, cstrTime_failure, TIME_LEN);
+  bRtcFailed = true;
+  bChanged = true;
 }
 
-const char* const theData_getDisplay_getDate(void)
+// the registers are read out, the failure (if any) is over
+void theData_reportRTC_readout(void)
 {
-  if ( ( (int)blink_element < (int)adj_year ) || ( (int)blink_element > (int)adj_dow ) || ( ! blink_adjustment ) )
+  if ( ! bRtcFailed ) return;
+
+  bRtcFailed = false;
+  bChanged = true;
+}
+
+// date string with the adjusting element blinked out
+static void build_date(char *const pStr)
+{
+  if ( bRtcFailed )
   {
-    return strDate;
+    memcpy(pStr, cstrDate_failure, DATE_LEN + 1);
+    return;
   }
 
-  static char strBlinkDate[DATE_LEN + 1];
-  memcpy(strBlinkDate, strDate, DATE_LEN + 1);
+  memcpy(pStr, strDate, DATE_LEN + 1);
 
-  switch ( blink_element ) {
-  case adj_year:  set_char(strBlinkDate, 12, 4, ' '); break;
-  case adj_month: set_char(strBlinkDate,  8, 3, ' '); break;
-  case adj_day:   set_char(strBlinkDate,  5, 2, ' '); break;
-  case adj_dow:   set_char(strBlinkDate,  0, 3, ' '); break;
+  if ( ( (int)blink_element < (int)adj_year ) || ( (int)blink_element > (int)adj_day ) || ( ! blink_adjustment ) )
+  {
+    return;
   }
 
-  return strBlinkDate;
+  switch ( blink_element ) {
+  case adj_year:  set_char(pStr, 12, 4, ' '); break;
+  case adj_month: set_char(pStr,  8, 3, ' '); break;
+  case adj_day:   set_char(pStr,  5, 2, ' '); break;
+  }
 }
 
-const char *const theData_getDisplay_getTime(void)
+// time string with flashing dot and the adjusting element blinked out
+static void build_time(char *const pStr)
 {
+  if ( bRtcFailed )
+  {
+    memcpy(pStr, cstrTime_failure, TIME_LEN + 1);
+    return;
+  }
+
+  memcpy(pStr, strTime, TIME_LEN + 1);
+
   // flashing dot
-  strTime[2] = (flashing_dot) ? (':') : (' ');
+  pStr[2] = (flashing_dot) ? (':') : (' ');
 
   if ( ( (int)blink_element < (int)adj_hour ) || ( (int)blink_element > (int)adj_minute ) || ( ! blink_adjustment ) )
   {
-    return strTime;
+    return;
   }
 
-  static char strBlinkTime[TIME_LEN + 1];
-  memcpy(strBlinkTime, strTime, TIME_LEN + 1);
-
   switch ( blink_element ) {
-  case adj_hour:  set_char(strBlinkTime,  0, 2, ' '); break;
-  case adj_minute:set_char(strBlinkTime,  3, 2, ' '); break;
+  case adj_hour:  set_char(pStr,  0, 2, ' '); break;
+  case adj_minute:set_char(pStr,  3, 2, ' '); break;
   }
-
-  return strBlinkTime;
 }
 
-const char *const theData_getDisplay_getAlarm(void)
+// alarm string, or empty string if there's nothing to show
+static void build_alarm(char *const pStr)
 {
+  pStr[0] = '\0';
+
+  if ( blink_element == adj_alarm_slot )
+  {
+    if ( ! blink_adjustment ) {
+      strcpy(pStr, cstrAlarmSlot);
+      set_int(pStr, sizeof(cstrAlarmSlot) - 1, alarm_slot + 1, ' ');
+      pStr[sizeof(cstrAlarmSlot) + 1] = '\0';
+    }
+    return;
+  }
+
   if ( blink_element == adj_alarm_enable )
   {
     if ( ! blink_adjustment ) {
-      return cstrAlarmEnabled[(alarm.enabled) ? (1) : (0)];
+      strcpy(pStr, cstrAlarmEnabled[(alarm.enabled) ? (1) : (0)]);
     }
-    return NULL;
+    return;
   }
 
-  if ( ! alarm.enabled ) return NULL;
+  if ( blink_element == adj_alarm_sound )
+  {
+    if ( ! blink_adjustment ) {
+      strcpy(pStr, cstrAlarmSounds[alarm.sound]);
+    }
+    return;
+  }
+
+  if ( ! alarm.enabled ) return;
+
+  memcpy(pStr, strAlarm, TIME_LEN + 1);
 
   if ( ( ( blink_element != adj_alarm_hour ) && ( blink_element != adj_alarm_minute ) ) || ( ! blink_adjustment ) )
   {
-    return strAlarm;
+    return;
   }
 
-  static char strBlinkAlarm[TIME_LEN + 1];
-  memcpy(strBlinkAlarm, strAlarm, TIME_LEN + 1);
-
   switch ( blink_element ) {
-  case adj_alarm_hour:  set_char(strBlinkAlarm,  0, 2, ' '); break;
-  case adj_alarm_minute:set_char(strBlinkAlarm,  3, 2, ' '); break;
+  case adj_alarm_hour:  set_char(pStr,  0, 2, ' '); break;
+  case adj_alarm_minute:set_char(pStr,  3, 2, ' '); break;
   }
+}
 
-  return strBlinkAlarm;
+// the snapshot buffer of the sequence: the even sequences (published) use the buffers in turn,
+// the odd one (being written) selects the buffer of the next even sequence
+static unsigned int snapshot_index(const uint32_t sequence)
+{
+  return ( ( sequence + 1 ) >> 1 ) & 1;
 }
 
-void theData_reportTermo_sensorCount(const unsigned int count)
+// the writer makes the sequence odd, prepares the snapshot which is not visible to readers now,
+// and then makes the sequence even again, so the new snapshot is the current one
+static theData_snapshot_t *publish_begin(void)
 {
-  reported_temp_count = count;
-  if ( reported_temp_count > COUNT_TERMO )  reported_temp_count = COUNT_TERMO;
+  const uint32_t sequence = snapshot_sequence + 1;
+  snapshot_sequence = sequence;
+  // the readers must see the odd sequence before the snapshot content is changed
+  __sync_synchronize();
+  return &(snapshots[snapshot_index(sequence)]);
+}
 
-  for(int i = reported_temp_count; i < COUNT_TERMO; i++ )
-  {
-    theData_reportTermo_failure(i);
-  }
+static void publish_end(theData_snapshot_t *const pSnapshot)
+{
+  const uint32_t sequence = snapshot_sequence + 1;
+  pSnapshot->sequence = sequence;
+  // the snapshot content must be in memory before the readers can see the new sequence
+  __sync_synchronize();
+  snapshot_sequence = sequence;
 }
 
-static void set_string_temp(char* const pStr, const int16_t value, const bool isFahrenheitP)
+// called only from theData_process(), so there is a single writer
+static void publish_snapshot(void)
 {
-  const float temp = (isFahrenheitP) ? ( toFahrenheit(value) ) : ( toCelsius(value) );
-  sprintf(pStr, "%.2f ", temp);
+  theData_snapshot_t *const pSnapshot = publish_begin();
+
+  build_date(pSnapshot->date);
+  build_time(pSnapshot->time);
+  build_alarm(pSnapshot->alarm);
+  memcpy(pSnapshot->samples, samples, sizeof(samples));
+  pSnapshot->termo_count = reported_temp_count;
+  pSnapshot->isCelsius = (isFahrenheit == false);
+
+  publish_end(pSnapshot);
 }
 
-void theData_reportTermo_value(const unsigned int sensor, const int16_t value)
+// copy the latest published snapshot. The copy is repeated while the writer works (odd sequence)
+// or when it published anything during the copy, so the copy is never a mix of two publications.
+// The reader must not preempt the writer (an interrupt reader would wait for theData_process forever)
+void theData_getSnapshot(theData_snapshot_t *const pSnapshot)
 {
-  if ( sensor >= COUNT_TERMO) return;
+  uint32_t sequence;
+  for ( ;; ) {
+    sequence = snapshot_sequence;
+    __sync_synchronize();
+    memcpy(pSnapshot, &(snapshots[snapshot_index(sequence)]), sizeof(theData_snapshot_t));
+    __sync_synchronize();
+    if ( ( ( sequence & 1 ) == 0 ) && ( snapshot_sequence == sequence ) ) break;
+    ++snapshot_retries;
+  }
+}
+
+// the stress mode (DATA_STRESS): the writer is the SysTick interrupt (every millisecond), every
+// field of its snapshot is derived from the sequence, so a mixed copy is seen by the reader
+static void stress_publish(void)
+{
+  theData_snapshot_t *const pSnapshot = publish_begin();
+  const uint32_t sequence = snapshot_sequence + 1;
+  const char c = 'A' + ( ( sequence >> 1 ) % 26 );
 
-  reported_temps[sensor] = value;
-  set_string_temp(strTemp[sensor], value, isFahrenheit);
+  memset(pSnapshot->date, c, DATA_DATE_LEN);
+  pSnapshot->date[DATA_DATE_LEN] = 0;
+  memset(pSnapshot->time, c, DATA_TIME_LEN);
+  pSnapshot->time[DATA_TIME_LEN] = 0;
+  memset(pSnapshot->alarm, c, DATA_TIME_LEN);
+  pSnapshot->alarm[DATA_TIME_LEN] = 0;
+  for ( int channel = 0; channel < data_channel_max; channel++ )
+  {
+    pSnapshot->samples[channel].value = sequence;
+    pSnapshot->samples[channel].valid = true;
+  }
+  pSnapshot->termo_count = sequence & 0xFF;
+
+  publish_end(pSnapshot);
+  ++stress_stats.publications;
 }
 
-void theData_reportTermo_failure(const unsigned int sensor)
+// the stress mode reader (theData_process): the copy must be the one publication
+static void stress_check(void)
 {
-  if ( sensor >= COUNT_TERMO) return;
+  theData_snapshot_t snapshot;
+  theData_getSnapshot(&snapshot);
 
-  reported_temps[sensor] = INVALID_TEMPERATURE;
-  memcpy(&(strTemp[sensor][0]), cstrTemp_failure, TEMP_LEN+1);
+  const uint32_t sequence = snapshot.sequence;
+  const char c = 'A' + ( ( sequence >> 1 ) % 26 );
+  bool consistent = ( ( sequence & 1 ) == 0 ) && ( snapshot.termo_count == ( sequence & 0xFF ) );
+  for ( int i = 0; i < DATA_DATE_LEN; i++ ) consistent = consistent && ( snapshot.date[i] == c );
+  for ( int i = 0; i < DATA_TIME_LEN; i++ ) consistent = consistent && ( snapshot.time[i] == c ) && ( snapshot.alarm[i] == c );
+  for ( int channel = 0; channel < data_channel_max; channel++ )
+  {
+    consistent = consistent && ( snapshot.samples[channel].value == (int32_t)sequence );
+  }
+
+  ++stress_stats.checks;
+  if ( ! consistent ) ++stress_stats.torn;
 }
 
-unsigned int theData_getDisplay_getTermoSensorsCount(void)
+// the Arduino core calls it from SysTick_Handler every millisecond
+extern "C" int sysTickHook(void)
 {
-  return reported_temp_count;
+  if ( DATA_STRESS ) stress_publish();
+  return 0;   // the core continues with its own tick
 }
 
-const char* const theData_getDisplay_getTermoString(const unsigned int sensor, unsigned int *const type)
+void theData_getStressStats(theData_stressStats_t *const pStats)
 {
-  if ( (sensor >= COUNT_TERMO) ) return cstrTemp_failure;
+  *pStats = stress_stats;
+  pStats->retries = snapshot_retries;
+}
 
-  if( reported_temps[sensor] == INVALID_TEMPERATURE )
+void theData_reportTermo_sensorCount(const unsigned int count)
+{
+  reported_temp_count = count;
+  if ( reported_temp_count > COUNT_TERMO )  reported_temp_count = COUNT_TERMO;
+  bChanged = true;
+
+  for(int i = reported_temp_count; i < COUNT_TERMO; i++ )
   {
-    *type = 2;
-    return cstrTemp_failure;
+    theData_reportTermo_failure(i);
   }
+}
+
+void theData_reportTermo_value(const unsigned int sensor, const int16_t value)
+{
+  if ( sensor >= COUNT_TERMO) return;
 
-  *type = (isFahrenheit) ? (0) : (1);
-  return strTemp[sensor];
+  set_sample(data_channel_termo_0 + sensor, toCentiCelsius(value), data_unit_centiCelsius);
+}
+
+void theData_reportTermo_failure(const unsigned int sensor)
+{
+  if ( sensor >= COUNT_TERMO) return;
+
+  set_sample_failure(data_channel_termo_0 + sensor);
 }
 
 bool theData_isCelsius(void)
@@ -399,37 +750,42 @@ bool theData_isCelsius(void)
 void theData_setCelsius(const bool isCelsius)
 {
   isFahrenheit = (isCelsius == false);
-  for(unsigned int i = 0; i < reported_temp_count; i++ ) {
-    theData_reportTermo_value(i, reported_temps[i]);
-  }
+  bChanged = true;
   write_nvm_degrees();
 }
 
-// convert from raw to Celsius
-static float toCelsius(int16_t raw) 
-{
-	// C = RAW/128
-	return (float) raw * 0.0078125f;
-}
-
-// convert from raw to Fahrenheit
-static float toFahrenheit(int16_t raw) 
+// convert from raw to 1/100 of Celsius, rounded to the nearest
+static int32_t toCentiCelsius(const int16_t raw)
 {
-	// F = (C*1.8)+32 = (RAW/128*1.8)+32 = (RAW*0.0140625)+32
-	return ((float) raw * 0.0140625f) + 32.0f;
+  // C = RAW/128, so C*100 = RAW*100/128 = RAW*25/32
+  const int32_t scaled = (int32_t)raw * 25;
+  return ( scaled + ( (scaled < 0) ? (-16) : (16) ) ) / 32;
 }
 
 void theData_stopBlinker(void)
 {
   blink_adjustment = false;
   blink_element = adj_none;
+  bChanged = true;
+
+  // the slot 0 is shown out of the adjustment
+  if ( alarm_slot != 0 ) load_alarm(0);
+
+  // the adjustment is over - no need to wait for the idle timeout
+  if ( bNvmChanged )
+  {
+    bNvmChanged = false;
+    bNvmPending = true;
+  }
+  commit_nvm();
 }
 
 void theData_nextBlinker(void)
 {
   blink_element = (blink_element_t)((int)blink_element + 1);
+  bChanged = true;
 
-  const int max_element = (alarm.enabled) ? ((int)adj_alarm_minute) : ((int)adj_alarm_enable);
+  const int max_element = (alarm.enabled) ? ((int)adj_alarm_sound) : ((int)adj_alarm_enable);
 
   if ( (int)blink_element > max_element )
   {
@@ -444,14 +800,17 @@ static void theData_set_alarm_string(void)
     alarm.minute = 59;
     alarm.enabled = false;
   }
+  if ( alarm.sound >= buzzer_sound_max ) alarm.sound = buzzer_sound_beep;
   set_int(strAlarm, 0, alarm.hour,   '0');      // alarm hour
   set_int(strAlarm, 3, alarm.minute, '0');      // alarm minute
+  bChanged = true;
 }
 
 static void theData_alarm_enable(const bool increment)
 {
   (void)increment;
   alarm.enabled = !alarm.enabled;
+  bChanged = true;
   write_nvm_alarm();
 }
 
@@ -468,6 +827,7 @@ static void theData_alarm_hr(const bool increment)
 {
   alarm.hour = adjust(alarm.hour, 0, 23, increment);
   set_int(strAlarm, 0, alarm.hour,   '0');      // alarm hour
+  bChanged = true;
   write_nvm_alarm();
 }
 
@@ -475,39 +835,80 @@ static void theData_alarm_min(const bool increment)
 {
   alarm.minute = adjust(alarm.minute, 0, 59, increment);
   set_int(strAlarm, 3, alarm.minute, '0');      // alarm minute
+  bChanged = true;
+  write_nvm_alarm();
+}
+
+// the slot is only selected, it is not changed
+static void theData_alarm_slot(const bool increment)
+{
+  load_alarm(adjust(alarm_slot, 0, ALARMS_KEYS - 1, increment));
+  bChanged = true;
+}
+
+static void theData_alarm_sound(const bool increment)
+{
+  alarm.sound = adjust(alarm.sound, 0, buzzer_sound_max - 1, increment);
+  bChanged = true;
   write_nvm_alarm();
 }
 
+// the new value is published by the next theData_process() call, in the next snapshot
+static void adjust_pressed(void)
+{
+  bAdjustShown = false;
+  adjust_micros = micros();
+  adjust_sequence = ( snapshot_sequence | 1 ) + 1;   // the next even (published) sequence
+  ++adjust_stats.adjustments;
+}
+
+// the frame is drawn from the snapshot: the first one after the key press gives the latency
+void theData_reportShown(const uint32_t sequence)
+{
+  if ( bAdjustShown || ( (int32_t)( sequence - adjust_sequence ) < 0 ) ) return;
+
+  const unsigned long latency = micros() - adjust_micros;
+  bAdjustShown = true;
+  adjust_stats.latency_us = latency;
+  if ( latency > adjust_stats.max_latency_us ) adjust_stats.max_latency_us = latency;
+}
+
 void theData_nextValue(void)
 {
+  adjust_pressed();
+
   switch(blink_element) {
 
   case adj_year:        theRTC_adjust_year(true);       break;
   case adj_month:       theRTC_adjust_month(true);      break;
   case adj_day:         theRTC_adjust_day(true);        break;
-  case adj_dow:         theRTC_adjust_day_of_week(true);break;
   case adj_hour:        theRTC_adjust_hour(true);       break;
   case adj_minute:      theRTC_adjust_minute(true);     break;
+  case adj_alarm_slot:  theData_alarm_slot(true);       break;
   case adj_alarm_enable:theData_alarm_enable(true);     break;
   case adj_alarm_hour:  theData_alarm_hr(true);         break;
   case adj_alarm_minute:theData_alarm_min(true);        break;
+  case adj_alarm_sound: theData_alarm_sound(true);      break;
 
   }
 }
 
 void theData_prevValue(void)
 {
+  adjust_pressed();
+
   switch(blink_element) {
 
   case adj_year:        theRTC_adjust_year(false);        break;
   case adj_month:       theRTC_adjust_month(false);       break;
   case adj_day:         theRTC_adjust_day(false);         break;
-  case adj_dow:         theRTC_adjust_day_of_week(false); break;
   case adj_hour:        theRTC_adjust_hour(false);        break;
   case adj_minute:      theRTC_adjust_minute(false);      break;
+  case adj_alarm_slot:  theData_alarm_slot(false);        break;
   case adj_alarm_enable:theData_alarm_enable(false);      break;
   case adj_alarm_hour:  theData_alarm_hr(false);          break;
   case adj_alarm_minute:theData_alarm_min(false);         break;
+  case adj_alarm_sound: theData_alarm_sound(false);       break;
 
   }
 }
@@ -4,22 +4,69 @@
 extern void theData_init(void);
 extern void theData_process(const unsigned long timestamp);
 
+// measurement channels - CO2 and then one channel per temperature sensor
+typedef enum {
+  data_channel_co2,
+  data_channel_termo_0,
+  data_channel_max = data_channel_termo_0 + COUNT_TERMO
+} theData_channel_t;
+
+// units of the sample value
+typedef enum {
+  data_unit_none,           // no value (failure)
+  data_unit_ppm,            // CO2 in parts-per-million
+  data_unit_centiCelsius    // temperature in 1/100 of Celsius degree
+} theData_unit_t;
+
+// when the sample was taken: last time read from RTC plus the milliseconds passed since then
+typedef struct {
+  uint32_t rtc;             // seconds since 2000-01-01 00:00:00
+  uint32_t ms;              // milliseconds after 'rtc'
+} theData_timestamp_t;
+
+// typed sample for a single measurement channel
+typedef struct {
+  int32_t value;
+  theData_timestamp_t time;
+  uint8_t unit;             // theData_unit_t
+  bool valid;
+} theData_sample_t;
+
+#define DATA_DATE_LEN     16
+#define DATA_TIME_LEN     16
+
+// consistent view of all the data, published once per update by theData_process()
+typedef struct {
+  char date[DATA_DATE_LEN + 1];     // date, the adjusting element is blinking
+  char time[DATA_TIME_LEN + 1];     // time with flashing dot, the adjusting element is blinking
+  char alarm[DATA_TIME_LEN + 1];    // alarm, empty string when nothing should be shown
+  theData_sample_t samples[data_channel_max];
+  uint8_t termo_count;              // temperature sensors count
+  bool isCelsius;                   // temperature representation
+  uint32_t sequence;                // even, increments by 2 on every publication
+} theData_snapshot_t;
+
+// any module could get the copy of the latest snapshot, it never gets the mix of two different
+// updates. Not from interrupts: the copy is repeated while theData_process publishes
+extern void theData_getSnapshot(theData_snapshot_t *const pSnapshot);
+
+// current time: last time read from RTC plus the milliseconds passed since then
+extern void theData_getTimestamp(theData_timestamp_t *const pTime);
+
+// any module could get the latest published sample of the channel (theData_channel_t),
+// returns 'true' if the sample is valid
+extern bool theData_getSample(const unsigned int channel, theData_sample_t *const pSample);
+
 // theCO2 module should report to us
 extern void theData_reportCO2_value(const int value);
 extern void theData_reportCO2_failure(void);
 
-// theDisplay module should get the CO2 values for displaying
-extern const char* const theData_getDisplay_CO2(void);
-
 // theRTC module should report to us
 extern void theData_reportRTC_date(const int year, const int month, const int day, const int dow);
-extern void theData_reportRTC_time(const int hour, const int minute, const int seconds);
+extern void theData_reportRTC_time(const int hour, const int minute, const int seconds, const unsigned long edge_millis);
+extern void theData_reportRTC_alarm(void);
 extern void theData_reportRTC_failure(void);
-
-// theDisplay module should get the Date and Time values for displaying
-extern const char* const theData_getDisplay_getDate(void);
-extern const char* const theData_getDisplay_getTime(void);
-extern const char* const theData_getDisplay_getAlarm(void);
+extern void theData_reportRTC_readout(void);
 
 // theTermo module should report to us
 extern void theData_reportTermo_sensorCount(const unsigned int count);
@@ -28,10 +75,40 @@ extern void theData_reportTermo_failure(const unsigned int sensor);
 extern bool theData_isCelsius(void);
 extern void theData_setCelsius(const bool isCelsius);
 
-// theDisplay module should get the sensor count, temperatures and its type for displaying
-extern unsigned int theData_getDisplay_getTermoSensorsCount(void);
-// here type will return '0' for Celsius, '1' for Fahrenheit, and '2' for failure state
-extern const char* const theData_getDisplay_getTermoString(const unsigned int sensor, unsigned int *const type);
+
+// settings NVM commits statistics
+typedef struct {
+  uint32_t changes;             // settings changes in total
+  uint32_t committed_changes;   // settings changes committed to NVM
+  uint32_t session_changes;     // settings changes coalesced into the last commit
+  uint32_t commits;             // NVM writes in total
+  uint32_t last_stall_us;       // CPU stall of the last NVM write, microseconds
+  uint32_t max_stall_us;        // the longest CPU stall of NVM write, microseconds
+} theData_nvmStats_t;
+
+extern void theData_getNvmStats(theData_nvmStats_t *const pStats);
+
+// theDisplay reports the snapshot (its sequence) which is drawn and given to the display
+extern void theData_reportShown(const uint32_t sequence);
+
+// the adjustment key press to display latency
+typedef struct {
+  uint32_t adjustments;         // the values adjusted by the keys
+  uint32_t latency_us;          // the last key press till its frame is given to the display, microseconds
+  uint32_t max_latency_us;      // the longest latency, microseconds
+} theData_adjustStats_t;
+
+extern void theData_getAdjustStats(theData_adjustStats_t *const pStats);
+
+// the snapshot readers statistics, the stress mode (DATA_STRESS) fills the checks
+typedef struct {
+  uint32_t retries;             // the copies repeated as the writer was publishing
+  uint32_t publications;        // the snapshots published by SysTick interrupt
+  uint32_t checks;              // the copies checked by theData_process
+  uint32_t torn;                // the copies mixed from two publications (must be 0)
+} theData_stressStats_t;
+
+extern void theData_getStressStats(theData_stressStats_t *const pStats);
 
 // theKeys will control the time/date/alarm adjustment through the following routines
 extern void theData_stopBlinker(void);      // exit the adjustment mode
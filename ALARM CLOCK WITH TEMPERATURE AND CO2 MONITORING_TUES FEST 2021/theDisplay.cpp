@@ -6,23 +6,141 @@
 // project includes
 #include "hwconfig.h"
 #include "theData.h"
+#include "thePanel.h"
+#include "theBitmaps.h"
+#include "theCanvas.h"
+#include "theChart.h"
+#include "theTrend.h"
+#include "theBuzzer.h"
 // own declarations
 #include "theDisplay.h"
 
-// display class instance
+// display class instance (used for the display initialization only, then it is deleted
+// together with its frame buffer; the frame is drawn by theCanvas)
 static Adafruit_SH110X *pDisplay = NULL;
 
+// the fields of the frame - every field is drawn only within its rectangle
+typedef enum {
+  field_date,
+  field_time,
+  field_co2,
+  field_termo,          // the first sensor, the next ones are TERMO_ROW_STEP pixels lower
+  field_alarm,
+  field_max
+} field_t;
+
+typedef struct {
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+} rect_t;
+
+#define TERMO_ROW_STEP    10
+
+// the layout of the dynamic fields (the static layer is drawn around them by draw_background)
+static const rect_t layout[field_max] = {
+  {  0,  0, 128,  8 },    // field_date - "Mon, 01 Jan 2021"
+  {  2, 18,  60, 16 },    // field_time - "12:34", large digits
+  { 99, 11,  29,  8 },    // field_co2 - right after the "CO2: " label
+  { 70, 25,  58,  8 },    // field_termo - "23.50 " + degree sign + "C"
+  { 10, 42,  60, 11 }     // field_alarm - "07:30" medium digits, or the alarm state text
+};
+
+// the views switched by theDisplay_nextView()
+typedef enum {
+  view_clock,           // date, time, CO2, temperature, alarm
+  view_chart,           // live chart of CO2 and temperature
+  view_co2,             // CO2 history
+  view_termo,           // temperature history
+  view_stats,           // the lowest and highest values of the history
+  view_max
+} view_t;
+
+// the history views: title row, then the chart
+#define TITLE_HEIGHT      10
+#define STATS_ROW_STEP    10
+
+// the display profiles: the day one, and the night one with the lower frame rate,
+// the lower contrast and optionally the display off (see NIGHT_* in hwconfig.h)
+typedef enum {
+  profile_day,
+  profile_night
+} profile_t;
+
+static profile_t profile = profile_day;
+// at night, the key shows the day profile for PERIOD_DISPLAY_WAKE
+static bool bWake = false;            // the key is pressed, not handled yet
+static bool bAwake = false;
+static unsigned long wake_timer = 0;
+
+// the profile statistics are counted from here (the time, thePanel bytes, the drawing and the transfers time)
+static unsigned long account_timer = 0;
+static uint32_t account_bytes = 0;
+static uint32_t account_cpu_us = 0;
+
+static view_t view = view_clock;
+static bool bViewChanged = false;
+// chart samples already drawn on the canvas
+static uint32_t chart_drawn = 0;
+// chart samples already sent to the display
+static uint32_t chart_shown = 0;
+
+// the frame being drawn - the view, the chart samples and the data are taken when it is started,
+// so all the strips of the frame show the same (see theCanvas_beginStrip)
+static bool bFrame = false;
+static view_t frame_view = view_clock;
+static bool bNewView = false;
+static uint32_t chart_count = 0;
+static bool bChartUpdate = false;
+static unsigned long frame_started = 0;
+static uint32_t frame_bytes = 0;            // thePanel bytes when the frame is started
+// the strip of the frame being drawn, and if it is drawn already (and waits to be sent)
+static unsigned int strip = 0;
+static bool bStripReady = false;
+
 // our static functions
 static void deinit(void);
+static profile_t get_profile(const unsigned long timestamp);
+static void set_profile(const profile_t newProfile);
+static void account(const unsigned long timestamp);
+static void begin_frame(void);
+static void process_strips(void);
+static void end_frame(void);
+static void draw_view(void);
+static void draw_background(void);
+static void draw_static(void);
+static void draw_clock(void);
+static void draw_chart(void);
+static void draw_history(const unsigned int first_channel, const unsigned int channels, const char *const pTitle);
+static void draw_stats(void);
+static void format_range(char *const pStr, const unsigned int channel, const int32_t min, const int32_t max);
+static const rect_t *begin_field(const field_t field, const int offset_y);
 static void theDisplay_showTime(void);
 static void theDisplay_showDate(void);
 static void theDisplay_showCO2(void);
 static void theDisplay_showTermo(void);
 static void theDisplay_showAlarm(void);
+static bool is_time(const char *const pStr);
+static void format_CO2(char *const pStr, const theData_sample_t *const pSample);
+static void format_temperature(char *const pStr, const theData_sample_t *const pSample, const bool isCelsius);
+
+// the strings for values - the values are formatted right before drawing
+#define CO2_LEN           5
+#define TEMP_LEN          7
+#define RANGE_LEN         ( (2 * TEMP_LEN) + 8 )
+
+static const char* const cstrCO2_failure = "----";
+static const char* const cstrTemp_failure = "-------";
 
 // timestamp last called
 static unsigned long timer  = 0;
 
+// all the data for the frame being drawn
+static theData_snapshot_t snapshot;
+
+static theDisplay_stats_t stats;
+
 //----------------------------------------------------------
 
 static void deinit(void)
@@ -39,97 +157,505 @@ void theDisplay_init(void)
   deinit();   // to avoid memory leaks
 
   WIRE_DISPLAY.begin(SPEED_DISPLAY);
-  pDisplay = new Adafruit_SH110X(64, 128, &WIRE_DISPLAY);
+  pDisplay = new Adafruit_SH110X(DISPLAY_COLUMNS, DISPLAY_PAGES * 8, &WIRE_DISPLAY);
 
   pDisplay->begin(ADDRESS_DISPLAY, true);
-  pDisplay->clearDisplay();
-  pDisplay->display();
+  // the library could leave the bus at lower speed after initialization
+  WIRE_DISPLAY.setClock(SPEED_DISPLAY);
+
+  // the library is not needed anymore, its frame buffer is released
+  deinit();
+
+  // the static layer is drawn only once
+  draw_background();
+
+  // the display content is unknown after the re-initialization, the first frame is sent completely
+  thePanel_invalidate();
+}
+
+// the static layer of the frame is drawn once and kept as the background (not in the strip mode)
+static void draw_background(void)
+{
+  theCanvas_beginStrip(0);
+  theCanvas_clear();
+  draw_static();
+  theCanvas_saveBackground();
+}
+
+// the static layer of the frame - the separators and the labels
+static void draw_static(void)
+{
+  // date separator
+  theCanvas_hline(0, 9, 128);
+  // time separator
+  theCanvas_hline(0, 38, 62);
+
+  // "CO2: " label, the value field follows it
+  int x = theCanvas_text(70, 11, 1, "CO");
+  x = theCanvas_icon(x, 11 + 3, bitmaps_icon_subscript_2);
+  theCanvas_text(x, 11, 1, ": ");
+}
+
+void theDisplay_nextView(void)
+{
+  view = (view_t)( ( view + 1 ) % view_max );
+  bViewChanged = true;
+}
+
+bool theDisplay_wake(void)
+{
+  bWake = true;
+  return ( ( profile == profile_night ) && NIGHT_DISPLAY_OFF );
+}
+
+// the profile by RTC time, the key pressed and the alarm
+static profile_t get_profile(const unsigned long timestamp)
+{
+  // the key was pressed at night recently
+  if ( bAwake && ( ( timestamp - wake_timer ) < PERIOD_DISPLAY_WAKE ) ) return profile_day;
+  bAwake = false;
+
+  // the alarm should be seen
+  if ( theBuzzer_isBuzzing() ) return profile_day;
+
+  theData_timestamp_t now;
+  theData_getTimestamp(&now);
+  // the time is not read from RTC yet
+  if ( now.rtc == 0 ) return profile_day;
+
+  const unsigned int hour = ( ( now.rtc + ( now.ms / 1000 ) ) / 3600 ) % 24;
+  bool bNight;
+  // the night is over the midnight, or within one day
+  if ( NIGHT_START_HOUR > NIGHT_END_HOUR )
+  {
+    bNight = ( hour >= NIGHT_START_HOUR ) || ( hour < NIGHT_END_HOUR );
+  }
+  else
+  {
+    bNight = ( hour >= NIGHT_START_HOUR ) && ( hour < NIGHT_END_HOUR );
+  }
+
+  return bNight ? (profile_night) : (profile_day);
+}
+
+// the contrast and the display on/off are sent with the next frame, the display RAM is
+// kept while the display is off, so it is switched on without the full frame
+static void set_profile(const profile_t newProfile)
+{
+  profile = newProfile;
+  thePanel_setContrast( ( profile == profile_night ) ? (CONTRAST_NIGHT) : (CONTRAST_DAY) );
+  thePanel_setPower( ( profile == profile_day ) || ( ! NIGHT_DISPLAY_OFF ) );
+}
+
+// add the time, the I2C bytes and the CPU time since the last call to the current profile
+static void account(const unsigned long timestamp)
+{
+  thePanel_stats_t panel;
+  thePanel_getStats(&panel);
+  const uint32_t cpu_us = panel.total_cpu_us + stats.total_render_us;
+
+  theDisplay_profileStats_t *const pProfile = ( profile == profile_night ) ? &(stats.night) : &(stats.day);
+  pProfile->ms += timestamp - account_timer;
+  pProfile->bytes += panel.total_bytes - account_bytes;
+  pProfile->cpu_us += cpu_us - account_cpu_us;
+
+  account_timer = timestamp;
+  account_bytes = panel.total_bytes;
+  account_cpu_us = cpu_us;
+}
+
+static void draw_clock(void)
+{
+  // the static layer first, then only the fields
+  theCanvas_restoreBackground();
+  if ( DISPLAY_STRIP_PAGES > 0 ) draw_static();
+
+  theDisplay_showTime();
+  theDisplay_showDate();
+  theDisplay_showCO2();
+  theDisplay_showTermo();
+  theDisplay_showAlarm();
+
+  theCanvas_resetClip();
+}
+
+// the chart is drawn column by column, only the new samples are drawn (and sent),
+// the display scrolls the rest by the start line
+static void draw_chart(void)
+{
+  const uint32_t first = ( chart_count > CHART_COLUMNS ) ? ( chart_count - CHART_COLUMNS ) : (0);
+
+  // the whole chart, when it is just shown (or every strip, as the strip is not kept)
+  if ( bNewView || ( DISPLAY_STRIP_PAGES > 0 ) )
+  {
+    theCanvas_clear();
+    chart_drawn = first;
+  }
+
+  for ( ; chart_drawn < chart_count; chart_drawn++ )
+  {
+    theChart_drawColumn(chart_drawn);
+  }
+
+  // the newest sample is the rightmost column
+  thePanel_setStartLine(chart_count % CHART_COLUMNS);
+}
+
+// the history of the channels: the title with the lowest and the highest value, and the chart
+// of all the channels with the same scale. The whole view is drawn every frame, but only
+// the changes (after the new sample) are sent to the display
+static void draw_history(const unsigned int first_channel, const unsigned int channels, const char *const pTitle)
+{
+  int32_t min = 0;
+  int32_t max = 0;
+  bool bFound = false;
+
+  theCanvas_clear();
+
+  for ( unsigned int channel = first_channel; channel < ( first_channel + channels ); channel++ )
+  {
+    int32_t channel_min;
+    int32_t channel_max;
+    if ( ! theTrend_getExtents(channel, &channel_min, &channel_max) ) continue;
+    if ( ( ! bFound ) || ( channel_min < min ) ) min = channel_min;
+    if ( ( ! bFound ) || ( channel_max > max ) ) max = channel_max;
+    bFound = true;
+  }
+
+  int x = theCanvas_text(0, 0, 1, pTitle);
+  theCanvas_hline(0, TITLE_HEIGHT - 1, CANVAS_WIDTH);
+  if ( ! bFound ) return;
+
+  char strRange[RANGE_LEN + 1];
+  format_range(strRange, first_channel, min, max);
+  theCanvas_text(x + CANVAS_CHAR_WIDTH, 0, 1, strRange);
+
+  // flat history is drawn in the middle
+  if ( max == min )
+  {
+    --min;
+    ++max;
+  }
+
+  for ( unsigned int channel = first_channel; channel < ( first_channel + channels ); channel++ )
+  {
+    theTrend_draw(channel, 0, TITLE_HEIGHT + 1, CANVAS_WIDTH, CANVAS_HEIGHT - TITLE_HEIGHT - 1, min, max);
+  }
+}
+
+// the lowest and the highest values of every channel history
+static void draw_stats(void)
+{
+  theCanvas_clear();
+
+  theCanvas_text(0, 0, 1, "min - max");
+  theCanvas_hline(0, TITLE_HEIGHT - 1, CANVAS_WIDTH);
 
-  pDisplay->setRotation(1);
-  pDisplay->setTextColor(SH110X_WHITE);
+  const unsigned int channels = data_channel_termo_0 + snapshot.termo_count;
+  for ( unsigned int channel = 0; channel < channels; channel++ )
+  {
+    static const char* const cstrChannel[data_channel_max] = { "CO2", "T1", "T2", "T3", "T4" };
+
+    const int y = TITLE_HEIGHT + 2 + ( STATS_ROW_STEP * channel );
+    int32_t min;
+    int32_t max;
+
+    const int x = theCanvas_text(0, y, 1, cstrChannel[channel]);
+    if ( theTrend_getExtents(channel, &min, &max) )
+    {
+      char strRange[RANGE_LEN + 1];
+      format_range(strRange, channel, min, max);
+      theCanvas_text(x + CANVAS_CHAR_WIDTH, y, 1, strRange);
+    }
+  }
+}
+
+// "min - max" of the channel values, in its units
+static void format_range(char *const pStr, const unsigned int channel, const int32_t min, const int32_t max)
+{
+  theData_sample_t sample;
+  sample.valid = true;
+
+  if ( channel == data_channel_co2 )
+  {
+    char strMin[CO2_LEN + 1];
+    char strMax[CO2_LEN + 1];
+    sample.value = min;
+    format_CO2(strMin, &sample);
+    sample.value = max;
+    format_CO2(strMax, &sample);
+    snprintf(pStr, RANGE_LEN + 1, "%s - %s ppm", strMin, strMax);
+  }
+  else
+  {
+    // the temperature strings end with the space already
+    char strMin[TEMP_LEN + 1];
+    char strMax[TEMP_LEN + 1];
+    sample.value = min;
+    format_temperature(strMin, &sample, snapshot.isCelsius);
+    sample.value = max;
+    format_temperature(strMax, &sample, snapshot.isCelsius);
+    snprintf(pStr, RANGE_LEN + 1, "%s- %s%s", strMin, strMax, (snapshot.isCelsius) ? ("C") : ("F"));
+  }
+}
+
+// the drawing is limited to the field rectangle (moved down by offset_y)
+static const rect_t *begin_field(const field_t field, const int offset_y)
+{
+  const rect_t *const pRect = &(layout[field]);
+  theCanvas_setClip(pRect->x, pRect->y + offset_y, pRect->w, pRect->h);
+  return pRect;
+}
+
+void theDisplay_getStats(theDisplay_stats_t *const pStats)
+{
+  *pStats = stats;
 }
 
 // periodic function, called pretty fast, so we have to take
 // care execute it with specific periodicy
 void theDisplay_process(const unsigned long timestamp)
 {
-  // if the time since last execution exceeds specified period
-  if ( ( timestamp - timer ) >= PERIOD_DISPLAY_SHOW ) 
+  const unsigned long period = ( profile == profile_night ) ? (PERIOD_DISPLAY_NIGHT) : (PERIOD_DISPLAY_SHOW);
+
+  // if the time since last execution exceeds specified period, or the key is pressed
+  // (and the previous frame is drawn - its last strip could still be sent to the display,
+  // thePanel sends its own copy, so the canvas is free for the next frame)
+  if ( ( ( ( timestamp - timer ) >= period ) || bWake ) && ( ! bFrame ) )
   {
-    pDisplay->clearDisplay();
+    // the key shows the day profile right now, not after the night frame period
+    if ( bWake )
+    {
+      bWake = false;
+      bAwake = true;
+      wake_timer = timestamp;
+    }
+
+    account(timestamp);
+    const profile_t newProfile = get_profile(timestamp);
+    if ( newProfile != profile ) set_profile(newProfile);
 
-    theDisplay_showTime();
-    theDisplay_showDate();
-    theDisplay_showCO2();
-    theDisplay_showTermo();
-    theDisplay_showAlarm();
+    // the display is off - nothing to draw, the changed commands are sent only
+    // (if the panel is still busy, they are sent by the next frame)
+    if ( ( profile == profile_night ) && NIGHT_DISPLAY_OFF )
+    {
+      if ( ! thePanel_isBusy() ) thePanel_showPages(DISPLAY_PAGES, 0, NULL);
+      timer = timestamp;
+      return;
+    }
 
-    pDisplay->display();
+    begin_frame();
 
     // remember when the function was executed last time
     timer = timestamp;
   }
+
+  // the frame is drawn and sent strip by strip (in one go if it is not the strip mode)
+  if ( bFrame )
+  {
+    process_strips();
+  }
+}
+
+// the frame is started: the data, the view and the chart samples are taken for all its strips
+static void begin_frame(void)
+{
+  thePanel_stats_t panel;
+  thePanel_getStats(&panel);
+
+  theData_getSnapshot(&snapshot);
+  chart_count = theChart_getCount();
+  frame_view = view;
+  bNewView = bViewChanged;
+  bViewChanged = false;
+  bChartUpdate = ( frame_view == view_chart ) && ( chart_count != chart_shown );
+
+  // the live chart is scrolled by the display, the other views are not
+  if ( ( frame_view != view_chart ) && bNewView )
+  {
+    thePanel_setStartLine(0);
+  }
+
+  frame_started = micros();
+  frame_bytes = panel.total_bytes;
+  stats.render_us = 0;
+
+  bFrame = true;
+  strip = 0;
+  bStripReady = false;
+}
+
+// the next strip is drawn while the previous one is being sent, only giving it to thePanel waits
+static void process_strips(void)
+{
+  if ( ! bStripReady )
+  {
+    const unsigned long started = micros();
+    theCanvas_beginStrip(strip * STRIP_PAGES);
+    draw_view();
+    theCanvas_resetClip();
+    stats.render_us += micros() - started;
+    bStripReady = true;
+  }
+
+  if ( thePanel_isBusy() ) return;
+
+  // only the changed parts of the strip are sent to the display, in the background
+  thePanel_showPages(strip * STRIP_PAGES, STRIP_PAGES, theCanvas_getBuffer());
+  bStripReady = false;
+
+  if ( ++strip < ( DISPLAY_PAGES / STRIP_PAGES ) ) return;
+
+  bFrame = false;
+  end_frame();
+}
+
+// all the strips of the frame are given to thePanel
+static void end_frame(void)
+{
+  thePanel_stats_t panel;
+  thePanel_getStats(&panel);
+
+  stats.frame_us = micros() - frame_started;
+  if ( stats.render_us > stats.max_render_us ) stats.max_render_us = stats.render_us;
+  stats.total_render_us += stats.render_us;
+  ++stats.frames;
+  bNewView = false;
+  theData_reportShown(snapshot.sequence);
+
+  // the chart update cost
+  if ( bChartUpdate )
+  {
+    ++stats.chart_updates;
+    stats.chart_bytes = panel.total_bytes - frame_bytes;
+    stats.total_chart_bytes += stats.chart_bytes;
+  }
+  if ( frame_view == view_chart )
+  {
+    chart_shown = chart_count;
+  }
+}
+
+// the view of the frame, into the current strip
+static void draw_view(void)
+{
+  switch ( frame_view ) {
+  case view_chart:
+    draw_chart();
+    break;
+  case view_co2:
+    draw_history(data_channel_co2, 1, "CO2");
+    break;
+  case view_termo:
+    draw_history(data_channel_termo_0, snapshot.termo_count, "T");
+    break;
+  case view_stats:
+    draw_stats();
+    break;
+  default:
+    draw_clock();
+    break;
+  }
 }
 
 static void theDisplay_showTime(void)
 {
-  pDisplay->setCursor(2,18);
-  pDisplay->setTextSize(2);
-  pDisplay->print(theData_getDisplay_getTime());
-  
-  pDisplay->drawFastHLine(0, 38, 62, SH110X_WHITE);
+  const rect_t *const pRect = begin_field(field_time, 0);
+  theCanvas_digits(pRect->x, pRect->y, bitmaps_digits_large, snapshot.time);
 }
 
 static void theDisplay_showDate(void)
 {
-  pDisplay->setCursor(0,0);
-  pDisplay->setTextSize(1);
-  pDisplay->print(theData_getDisplay_getDate());
-
-  pDisplay->drawFastHLine(0, 9, 128, SH110X_WHITE);
+  const rect_t *const pRect = begin_field(field_date, 0);
+  theCanvas_text(pRect->x, pRect->y, 1, snapshot.date);
 }
 
 static void theDisplay_showCO2(void)
 {
-  pDisplay->setCursor(70,11);
-  pDisplay->setTextSize(1);
-  pDisplay->print("CO");
-  pDisplay->setCursor(pDisplay->getCursorX(), pDisplay->getCursorY() + 4);
-  pDisplay->print("2");
-  pDisplay->setCursor(pDisplay->getCursorX(), pDisplay->getCursorY() - 4);
-  pDisplay->print(": ");
-  pDisplay->print(theData_getDisplay_CO2());
+  char strCO2[CO2_LEN + 1];
+  format_CO2(strCO2, &(snapshot.samples[data_channel_co2]));
+
+  const rect_t *const pRect = begin_field(field_co2, 0);
+  theCanvas_text(pRect->x, pRect->y, 1, strCO2);
 }
 
 static void theDisplay_showTermo(void)
 {
   static const char* const cstrDegree[2] = { "F", "C" };
 
-  const unsigned int count = theData_getDisplay_getTermoSensorsCount();
+  const unsigned int count = snapshot.termo_count;
+  const bool isCelsius = snapshot.isCelsius;
 
   for( int i = 0; i < count; i++ )
   {
-    unsigned int type = 3;
-    pDisplay->setCursor(70, 25 + (10 * i));
-    pDisplay->print(theData_getDisplay_getTermoString(i, &type));
-    if( type < 2)
+    const theData_sample_t *const pSample = &(snapshot.samples[data_channel_termo_0 + i]);
+    char strTemp[TEMP_LEN + 1];
+    format_temperature(strTemp, pSample, isCelsius);
+
+    const int offset_y = TERMO_ROW_STEP * i;
+    const rect_t *const pRect = begin_field(field_termo, offset_y);
+    const int y = pRect->y + offset_y;
+    int x = theCanvas_text(pRect->x, y, 1, strTemp);
+    if( pSample->valid )
     {
-      pDisplay->setCursor(pDisplay->getCursorX(), pDisplay->getCursorY() - 4);
-      pDisplay->print("o");
-      pDisplay->setCursor(pDisplay->getCursorX(), pDisplay->getCursorY() + 4);
-      pDisplay->print(cstrDegree[type]);
+      x = theCanvas_icon(x, y, bitmaps_icon_degree);
+      theCanvas_text(x, y, 1, cstrDegree[(isCelsius) ? (1) : (0)]);
     }
   }
 }
 
 static void theDisplay_showAlarm(void)
 {
-  const char* const pAlarm = theData_getDisplay_getAlarm();
+  if ( snapshot.alarm[0] != '\0' )
+  {
+    const rect_t *const pRect = begin_field(field_alarm, 0);
 
-  if ( pAlarm != NULL )
+    // the alarm time is drawn by the digits, the alarm state by the text
+    if ( is_time(snapshot.alarm) )
+    {
+      theCanvas_digits(pRect->x, pRect->y, bitmaps_digits_medium, snapshot.alarm);
+    }
+    else
+    {
+      theCanvas_text(pRect->x, pRect->y, 1, snapshot.alarm);
+    }
+  }
+}
+
+// check if the string is the time (or its blinked version) - it has only digits, ':', '-' and ' '
+static bool is_time(const char *const pStr)
+{
+  for ( const char *p = pStr; *p != '\0'; p++ )
   {
-    pDisplay->setCursor(10, 42);
-    pDisplay->setTextSize(1);
-    pDisplay->print(pAlarm);
+    if ( ( ( *p < '0' ) || ( *p > '9' ) ) && ( *p != ':' ) && ( *p != '-' ) && ( *p != ' ' ) ) return false;
   }
+  return true;
+}
+
+// CO2 sample to string, "----" when the sample is invalid
+static void format_CO2(char *const pStr, const theData_sample_t *const pSample)
+{
+  if ( ! pSample->valid )
+  {
+    strcpy(pStr, cstrCO2_failure);
+    return;
+  }
+  snprintf(pStr, CO2_LEN + 1, "%d", (int)pSample->value);
+}
+
+// temperature sample (1/100 of Celsius) to string with 2 decimals
+// in Celsius or Fahrenheit, "-------" when the sample is invalid
+static void format_temperature(char *const pStr, const theData_sample_t *const pSample, const bool isCelsius)
+{
+  if ( ! pSample->valid )
+  {
+    strcpy(pStr, cstrTemp_failure);
+    return;
+  }
+
+  // F = (C*1.8)+32, in hundredths: F*100 = (C*100)*9/5 + 3200
+  const int32_t centi = (isCelsius) ? (pSample->value) : ( ( (pSample->value * 9) / 5 ) + 3200 );
+  const int32_t absolute = (centi < 0) ? (-centi) : (centi);
+
+  snprintf(pStr, TEMP_LEN + 1, "%s%d.%02d ", (centi < 0) ? "-" : "", (int)(absolute / 100), (int)(absolute % 100));
 }
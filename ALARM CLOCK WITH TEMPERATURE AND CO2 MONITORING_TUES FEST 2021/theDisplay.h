@@ -4,5 +4,35 @@
 extern void theDisplay_init(void);
 extern void theDisplay_process(const unsigned long timestamp);
 
+// switch to the next view (clock, live chart, CO2 history, temperature history, min/max)
+extern void theDisplay_nextView(void);
+// any key is pressed: at night the day profile is shown for a while.
+// Returns 'true' if the display was off (so the key only switches it on)
+extern bool theDisplay_wake(void);
+
+// the time and the cost of the display profile (day or night), accumulated since the start
+// (64 bits: the bytes and the microseconds would wrap 32 bits in days)
+typedef struct {
+  uint64_t ms;                  // time spent in the profile, milliseconds
+  uint64_t bytes;               // I2C bytes sent to the display in the profile
+  uint64_t cpu_us;              // main loop time of the drawing and the transfers in the profile, microseconds
+} theDisplay_profileStats_t;
+
+// statistics of the frame drawing
+typedef struct {
+  uint32_t frames;              // frames drawn
+  uint32_t render_us;           // drawing time of the last frame (all its strips), microseconds
+  uint32_t frame_us;            // the last frame from its start till all its strips are given to thePanel, microseconds
+  uint32_t max_render_us;       // the longest drawing, microseconds
+  uint32_t total_render_us;     // drawing time of all the frames, microseconds
+  uint32_t chart_updates;       // frames with the new chart samples
+  uint32_t chart_bytes;         // I2C bytes of the last chart update
+  uint32_t total_chart_bytes;   // I2C bytes of all the chart updates
+  theDisplay_profileStats_t day;
+  theDisplay_profileStats_t night;
+} theDisplay_stats_t;
+
+extern void theDisplay_getStats(theDisplay_stats_t *const pStats);
+
 
 #endif // __THE_CLOCK_THE_DISPLAY_HEADER_INCLUDED_
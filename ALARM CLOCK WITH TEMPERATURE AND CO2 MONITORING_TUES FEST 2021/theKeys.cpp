@@ -4,6 +4,7 @@
 #include "hwconfig.h"
 #include "theData.h"
 #include "theBuzzer.h"
+#include "theDisplay.h"
 // own declarations
 #include "theKeys.h"
 
@@ -15,6 +16,7 @@ static bool btnMinus = false;
 // internal functions
 static bool btnPressed(const int pin, bool &oldState);
 static bool inline isStopBuzzer(void);
+static bool inline isWakeDisplay(void);
 
 //----------------------------------------------------------
 
@@ -54,6 +56,13 @@ static bool inline isStopBuzzer(void)
   return true;
 }
 
+// helper routine to wake the display up by pressing any key at night,
+// it will return true if the display was off - the key only switches it on
+static bool inline isWakeDisplay(void)
+{
+  return theDisplay_wake();
+}
+
 void theKeys_process(const unsigned long timestamp)
 {
   // we are not using timestamp now, so we will tell the compiler that we are aware of it
@@ -62,8 +71,8 @@ void theKeys_process(const unsigned long timestamp)
   // process "SET" button
   if ( btnPressed(BUTTON_SET, btnSet) )
   {
-    // if the alarm was started - stop it, otherwise ...
-    if ( ! isStopBuzzer() )
+    // if the alarm was started - stop it, if the display was off - switch it on, otherwise ...
+    if ( ( ! isStopBuzzer() ) && ( ! isWakeDisplay() ) )
     // ... start adjustment or switch to next element
     {
       theData_nextBlinker();
@@ -73,8 +82,8 @@ void theKeys_process(const unsigned long timestamp)
   // process "+" button
   if ( btnPressed(BUTTON_PLUS, btnPlus) )
   {
-    // if the alarm was started - stop it, otherwise ...
-    if ( ! isStopBuzzer() ) 
+    // if the alarm was started - stop it, if the display was off - switch it on, otherwise ...
+    if ( ( ! isStopBuzzer() ) && ( ! isWakeDisplay() ) )
     {
       // ... if currently we are adjusting clock/alarm - do it
       if ( theData_isAdjusting() ) 
@@ -92,8 +101,8 @@ void theKeys_process(const unsigned long timestamp)
   // process "-" button
   if ( btnPressed(BUTTON_MINUS, btnMinus) )
   {
-    // if the alarm was started - stop it, otherwise ...
-    if ( ! isStopBuzzer() ) 
+    // if the alarm was started - stop it, if the display was off - switch it on, otherwise ...
+    if ( ( ! isStopBuzzer() ) && ( ! isWakeDisplay() ) )
     {
       // ... if currently we are adjusting clock/alarm - do it
       if ( theData_isAdjusting() ) 
@@ -101,9 +110,9 @@ void theKeys_process(const unsigned long timestamp)
         theData_prevValue();
       }
       else
-      // otherwise switch between Celsius and Farenheit
+      // otherwise switch to the next view
       {
-        theData_setCelsius(!theData_isCelsius());
+        theDisplay_nextView();
       }
     }
   }
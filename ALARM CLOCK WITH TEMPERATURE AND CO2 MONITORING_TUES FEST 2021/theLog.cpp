@@ -0,0 +1,557 @@
+#include <Arduino.h>
+// Libraries: none
+// project includes
+#include "hwconfig.h"
+#include "theData.h"
+#include "theNVM.h"
+// own declarations
+#include "theLog.h"
+
+// The readings of all the channels are logged once per RTC minute (PERIOD_LOG) as bit-packed
+// rows in the ring of flash pages. Every page starts with a header and can be decoded on its own.
+// The rows have no timestamps: the row N of the page is logged N slots (PERIOD_LOG) after the
+// page time, and only the slots skipped (or repeated) by a reset or a clock adjustment are coded.
+// A row is (bits, most significant bit first):
+//   events:       '1' '0' EG0(zigzag(slots skipped))  - the slot is not the next one after the previous row
+//                 '1' '1' <valid mask, data_channel_max bits>  - the valid channels have changed
+//   end:          '0'
+//   values:       for every valid channel, the value delta is coded as
+//                 EGk(zigzag(delta))                       - the channel changes at most rows
+//                 '0' or '1' EGk(zigzag(delta) - 1)         - the channel is unchanged at half of the rows or more
+// EGk is Exp-Golomb code of order k. The code of every channel adapts to its recent deltas:
+// k is the smallest with 2^k * count >= sum of the deltas (as LOCO-I does), and the unchanged
+// value of the steady channel costs 1 bit. The first value of the page is EGk with LOG_K_FIRST.
+// The rows are collected in RAM and the page is written to flash when it is full. Every
+// PERIOD_LOG_FLUSH the page being filled is written to its place in the ring too, so a reset
+// loses the rows of PERIOD_LOG_FLUSH at most (the next page starts after the flushed one).
+
+#if ( (1 + COUNT_TERMO) > 8 )
+#error "the readings log valid mask has room for 8 channels only"
+#endif
+
+#if ( ( NVM_LOG_OFFSET + ( NVM_LOG_PAGES * NVM_PAGE_SIZE ) ) > ( 256 * 1024 ) )
+#error "the readings log does not fit the flash bank 1"
+#endif
+
+#if ( ( PERIOD_LOG % 1000 ) != 0 )
+#error "the readings log slot should be whole seconds"
+#endif
+
+#define LOG_MAGIC             (0x4C48)      // 'LH' - the pages of the older byte-aligned format ('LG') are ignored
+#define LOG_SECONDS           ( PERIOD_LOG / 1000 )
+#define LOG_PAGE_BITS         ( NVM_PAGE_SIZE * 8 )
+#define LOG_CODE_MAX          (72)          // the longest EGk code, bits (32-bit value)
+#define LOG_ROW_MAX           ( ( 2 + LOG_CODE_MAX + 2 + 8 + 1 + ( LOG_CODE_MAX * data_channel_max ) + 7 ) / 8 )  // bytes
+#define LOG_K_FIRST           (8)           // EGk order of the first value of the page
+#define LOG_SUM_FIRST         (4)           // the deltas sum after the first value (k = 2 for the next delta)
+#define LOG_COUNT_MAX         (32)          // the deltas sum and counts are halved, so the code follows the changes
+#define LOG_VALUE_BITS        (32)          // the widest coded value, the longer EGk prefix is a damaged page
+#define LOG_CHECK_PERIOD      (1000)        // how often the RTC slot is checked, milliseconds
+
+// page header
+typedef struct {
+  uint16_t magic;
+  uint16_t used;                // bits of the page used (header included)
+  uint32_t sequence;            // page sequence number, grows with every page written
+  uint32_t time;                // time of the first row of the page, seconds since 2000-01-01
+} log_page_t;
+
+// encoder (or decoder) state, it starts from zeros at every page
+typedef struct {
+  uint32_t slot;                // slot of the previous row (time / LOG_SECONDS)
+  bool bFirst;                  // no row in the page yet
+  int32_t values[data_channel_max];
+  uint32_t sums[data_channel_max];    // zigzag deltas sum since the last halving
+  uint8_t counts[data_channel_max];   // deltas count since the last halving, 0 - no value in the page yet
+  uint8_t zeros[data_channel_max];    // zero deltas count since the last halving
+  uint8_t valid;
+} log_state_t;
+
+// the page which is being filled, it is written to flash when it is full
+// (the row which does not fit the page is encoded past its end, and then taken back)
+static uint8_t page[NVM_PAGE_SIZE + LOG_ROW_MAX];
+static unsigned int page_index = 0;         // page in the ring the RAM page will be written to
+static uint32_t page_sequence = 0;
+static log_state_t encoder;
+static bool bPageStarted = false;
+static bool bPageDirty = false;             // rows appended since the page was written to flash
+static uint32_t last_slot = 0;              // the slot of the last row appended
+static bool bLogged = false;                // a row was appended since the start
+
+// timestamp last called
+static unsigned long timer = 0;
+static unsigned long timer_flush = 0;
+
+static theLog_stats_t stats;
+
+// internal routines
+static inline uint32_t zigzag(const int32_t value);
+static inline int32_t unzigzag(const uint32_t value);
+static inline unsigned int order(const uint32_t count, const uint32_t sum);
+static inline bool is_sparse(const log_state_t *const pState, const unsigned int channel);
+static inline uint32_t changed_sum(const log_state_t *const pState, const unsigned int channel);
+static inline void adapt(log_state_t *const pState, const unsigned int channel, const uint32_t code);
+static void put_bits(uint8_t *const pData, unsigned int *const pPosition, const uint64_t value, const unsigned int count);
+static void put_code(uint8_t *const pData, unsigned int *const pPosition, const uint32_t value, const unsigned int k);
+static void put_value(unsigned int *const pPosition, const unsigned int channel, const int32_t value);
+static inline unsigned int get_bit(const uint8_t *const pData, unsigned int *const pPosition, const unsigned int limit);
+static uint64_t get_bits(const uint8_t *const pData, unsigned int *const pPosition, const unsigned int limit, const unsigned int count);
+static uint32_t get_code(const uint8_t *const pData, unsigned int *const pPosition, const unsigned int limit, const unsigned int k);
+static void get_value(log_state_t *const pState, const uint8_t *const pData, unsigned int *const pPosition,
+     const unsigned int limit, const unsigned int channel);
+static inline const log_page_t* flash_page(const unsigned int index);
+static void start_page(const uint32_t slot);
+static void write_page(void);
+static void flush_page(void);
+static void encode_row(unsigned int *const pPosition, const uint32_t slot, const int32_t *const pValues, const uint8_t valid);
+static void append(const uint32_t slot, const int32_t *const pValues, const uint8_t valid);
+static inline bool is_page(const log_page_t *const pPage);
+static unsigned int decode_page(const log_page_t *const pPage, const uint32_t from, const uint32_t to,
+     theLog_callback_t callback, void *const pContext, unsigned int *const pFound);
+
+//----------------------------------------------------------
+
+// signed to unsigned, small absolute values give small results: 0, -1, 1, -2, 2 ... -> 0, 1, 2, 3, 4 ...
+static inline uint32_t zigzag(const int32_t value)
+{
+  return ( (uint32_t)value << 1 ) ^ (uint32_t)( value >> 31 );
+}
+
+static inline int32_t unzigzag(const uint32_t value)
+{
+  return (int32_t)( value >> 1 ) ^ -(int32_t)( value & 1 );
+}
+
+// EGk order for the codes of the sum and count given
+static inline unsigned int order(const uint32_t count, const uint32_t sum)
+{
+  unsigned int k = 0;
+  while ( ( k < LOG_VALUE_BITS ) && ( ( (uint64_t)count << k ) < sum ) ) k++;
+  return k;
+}
+
+// the channel is unchanged at half of the recent rows or more - the zero delta is a single bit
+static inline bool is_sparse(const log_state_t *const pState, const unsigned int channel)
+{
+  return ( pState->zeros[channel] * 2 ) >= pState->counts[channel];
+}
+
+// the sum of the non-zero codes less one each (the halving could round it below zero)
+static inline uint32_t changed_sum(const log_state_t *const pState, const unsigned int channel)
+{
+  const uint32_t changed = pState->counts[channel] - pState->zeros[channel];
+  return ( pState->sums[channel] > changed ) ? ( pState->sums[channel] - changed ) : (0);
+}
+
+// the coded delta (zigzag) is taken into the channel statistics
+static inline void adapt(log_state_t *const pState, const unsigned int channel, const uint32_t code)
+{
+  if ( pState->counts[channel] == 0 )
+  {
+    pState->sums[channel] = LOG_SUM_FIRST;
+    pState->counts[channel] = 1;
+    pState->zeros[channel] = 0;
+    return;
+  }
+
+  pState->sums[channel] += code;
+  if ( code == 0 ) ++pState->zeros[channel];
+  if ( ++pState->counts[channel] >= LOG_COUNT_MAX )
+  {
+    pState->sums[channel] >>= 1;
+    pState->counts[channel] >>= 1;
+    pState->zeros[channel] >>= 1;
+  }
+}
+
+// the bits of the value, most significant first (the page is erased to ones, so both are written)
+static void put_bits(uint8_t *const pData, unsigned int *const pPosition, const uint64_t value, const unsigned int count)
+{
+  for ( unsigned int bit = count; bit-- > 0; )
+  {
+    const unsigned int position = (*pPosition)++;
+    const uint8_t mask = 0x80 >> ( position & 7 );
+    if ( ( value >> bit ) & 1 )
+    {
+      pData[position >> 3] |= mask;
+    }
+    else
+    {
+      pData[position >> 3] &= ~mask;
+    }
+  }
+}
+
+// Exp-Golomb code of order k: the zeros, then value + 2^k in binary (its top bit is the end of the zeros)
+static void put_code(uint8_t *const pData, unsigned int *const pPosition, const uint32_t value, const unsigned int k)
+{
+  const uint64_t shifted = (uint64_t)value + ( (uint64_t)1 << k );
+  unsigned int top = k;
+  while ( ( shifted >> ( top + 1 ) ) != 0 ) top++;
+
+  put_bits(pData, pPosition, 0, top - k);
+  put_bits(pData, pPosition, shifted, top + 1);
+}
+
+// the value of the channel into the RAM page (the encoder state is updated)
+static void put_value(unsigned int *const pPosition, const unsigned int channel, const int32_t value)
+{
+  const uint32_t code = zigzag(value - encoder.values[channel]);
+  const uint32_t count = encoder.counts[channel];
+  const uint32_t changed = count - encoder.zeros[channel];
+
+  if ( count == 0 )
+  {
+    put_code(page, pPosition, code, LOG_K_FIRST);
+  }
+  else if ( is_sparse(&encoder, channel) )
+  {
+    put_bits(page, pPosition, ( code != 0 ) ? (1) : (0), 1);
+    if ( code != 0 ) put_code(page, pPosition, code - 1, order(changed, changed_sum(&encoder, channel)));
+  }
+  else
+  {
+    put_code(page, pPosition, code, order(count, encoder.sums[channel]));
+  }
+
+  adapt(&encoder, channel, code);
+  encoder.values[channel] = value;
+}
+
+// the bits past the limit are ones, so the damaged code ends there
+static inline unsigned int get_bit(const uint8_t *const pData, unsigned int *const pPosition, const unsigned int limit)
+{
+  const unsigned int position = (*pPosition)++;
+  if ( position >= limit ) return 1;
+  return ( pData[position >> 3] >> ( 7 - ( position & 7 ) ) ) & 1;
+}
+
+static uint64_t get_bits(const uint8_t *const pData, unsigned int *const pPosition, const unsigned int limit, const unsigned int count)
+{
+  uint64_t value = 0;
+  for ( unsigned int i = 0; i < count; i++ )
+  {
+    value = ( value << 1 ) | get_bit(pData, pPosition, limit);
+  }
+  return value;
+}
+
+static uint32_t get_code(const uint8_t *const pData, unsigned int *const pPosition, const unsigned int limit, const unsigned int k)
+{
+  unsigned int zeros = 0;
+  while ( ( ( zeros + k ) <= LOG_VALUE_BITS ) && ( get_bit(pData, pPosition, limit) == 0 ) ) zeros++;
+
+  // the top bit (one) is read already (or the prefix is too long - the page is damaged)
+  const uint64_t shifted = ( (uint64_t)1 << ( zeros + k ) ) | get_bits(pData, pPosition, limit, zeros + k);
+  return (uint32_t)( shifted - ( (uint64_t)1 << k ) );
+}
+
+// the value of the channel from the page, the same way put_value() has coded it
+static void get_value(log_state_t *const pState, const uint8_t *const pData, unsigned int *const pPosition,
+     const unsigned int limit, const unsigned int channel)
+{
+  const uint32_t count = pState->counts[channel];
+  const uint32_t changed = count - pState->zeros[channel];
+  uint32_t code = 0;
+
+  if ( count == 0 )
+  {
+    code = get_code(pData, pPosition, limit, LOG_K_FIRST);
+  }
+  else if ( is_sparse(pState, channel) )
+  {
+    if ( get_bit(pData, pPosition, limit) ) code = get_code(pData, pPosition, limit, order(changed, changed_sum(pState, channel))) + 1;
+  }
+  else
+  {
+    code = get_code(pData, pPosition, limit, order(count, pState->sums[channel]));
+  }
+
+  adapt(pState, channel, code);
+  pState->values[channel] += unzigzag(code);
+}
+
+// the page in flash is read directly from memory-mapped flash
+static inline const log_page_t* flash_page(const unsigned int index)
+{
+  return (const log_page_t*)theNVM_address(NVM_LOG_OFFSET + (index * NVM_PAGE_SIZE));
+}
+
+// start filling the RAM page, the encoder starts from scratch
+static void start_page(const uint32_t slot)
+{
+  log_page_t *const pHeader = (log_page_t*)page;
+
+  memset(page, 0xFF, sizeof(page));
+  pHeader->magic = LOG_MAGIC;
+  pHeader->used = sizeof(log_page_t) * 8;
+  pHeader->sequence = page_sequence;
+  pHeader->time = slot * LOG_SECONDS;
+
+  memset(&encoder, 0, sizeof(encoder));
+  encoder.slot = slot;
+  encoder.bFirst = true;
+  bPageStarted = true;
+
+  stats.bits += sizeof(log_page_t) * 8;
+}
+
+// write the RAM page to flash (the oldest page in the ring is overwritten)
+static void write_page(void)
+{
+  theNVM_program(NVM_LOG_OFFSET + (page_index * NVM_PAGE_SIZE), page, NVM_PAGE_SIZE, true);
+
+  page_index = (page_index + 1) % NVM_LOG_PAGES;
+  ++page_sequence;
+  ++stats.pages;
+  bPageStarted = false;
+  bPageDirty = false;
+}
+
+// write the page being filled to its place in the ring, it stays in RAM and will be written again
+static void flush_page(void)
+{
+  if ( ! bPageDirty ) return;
+
+  theNVM_program(NVM_LOG_OFFSET + (page_index * NVM_PAGE_SIZE), page, NVM_PAGE_SIZE, true);
+
+  ++stats.flushes;
+  bPageDirty = false;
+}
+
+// encode the row into the RAM page at the position and update the encoder state
+static void encode_row(unsigned int *const pPosition, const uint32_t slot, const int32_t *const pValues, const uint8_t valid)
+{
+  // the first row of the page is at the page time
+  const int32_t skipped = (encoder.bFirst) ? (0) : ( (int32_t)( slot - encoder.slot ) - 1 );
+  if ( skipped != 0 )
+  {
+    put_bits(page, pPosition, 2, 2);
+    put_code(page, pPosition, zigzag(skipped), 0);
+  }
+  encoder.slot = slot;
+  encoder.bFirst = false;
+
+  if ( valid != encoder.valid )
+  {
+    put_bits(page, pPosition, 3, 2);
+    put_bits(page, pPosition, valid, data_channel_max);
+    encoder.valid = valid;
+  }
+  put_bits(page, pPosition, 0, 1);
+
+  for ( unsigned int channel = 0; channel < data_channel_max; channel++ )
+  {
+    // invalid values are not stored, the previous value is kept
+    if ( ( ( valid >> channel ) & 1 ) == 0 ) continue;
+
+    put_value(pPosition, channel, pValues[channel]);
+  }
+}
+
+// append the row to the RAM page, the full page is written to flash
+static void append(const uint32_t slot, const int32_t *const pValues, const uint8_t valid)
+{
+  log_page_t *const pHeader = (log_page_t*)page;
+
+  if ( ! bPageStarted ) start_page(slot);
+
+  const log_state_t previous = encoder;
+  unsigned int position = pHeader->used;
+  encode_row(&position, slot, pValues, valid);
+
+  if ( position > LOG_PAGE_BITS )
+  {
+    // no room for the row - it is taken back (erased to ones), the row will start the next page
+    page[pHeader->used >> 3] |= 0xFF >> ( pHeader->used & 7 );
+    memset(&(page[( pHeader->used >> 3 ) + 1]), 0xFF, sizeof(page) - ( pHeader->used >> 3 ) - 1);
+    encoder = previous;
+    write_page();
+    start_page(slot);
+    position = pHeader->used;
+    encode_row(&position, slot, pValues, valid);
+  }
+
+  ++stats.rows;
+  stats.bits += position - pHeader->used;
+  pHeader->used = position;
+  bPageDirty = true;
+
+  for ( unsigned int channel = 0; channel < data_channel_max; channel++ )
+  {
+    if ( ( valid >> channel ) & 1 ) ++stats.samples;
+  }
+}
+
+// the page was written completely (reset during the flash write could leave garbage)
+static inline bool is_page(const log_page_t *const pPage)
+{
+  return ( pPage->magic == LOG_MAGIC ) && ( pPage->used >= ( sizeof(log_page_t) * 8 ) ) && ( pPage->used <= LOG_PAGE_BITS );
+}
+
+// decode the rows of the page (directly from flash or RAM), call 'callback' for the rows
+// in the time range and count them in 'pFound', returns the count of decoded rows
+static unsigned int decode_page(const log_page_t *const pPage, const uint32_t from, const uint32_t to,
+     theLog_callback_t callback, void *const pContext, unsigned int *const pFound)
+{
+  const uint8_t *const pData = (const uint8_t*)pPage;
+  const unsigned int limit = pPage->used;
+  unsigned int position = sizeof(log_page_t) * 8;
+  unsigned int rows = 0;
+  log_state_t decoder;
+
+  memset(&decoder, 0, sizeof(decoder));
+  decoder.slot = pPage->time / LOG_SECONDS;
+  decoder.bFirst = true;
+
+  while ( position < limit )
+  {
+    uint32_t slot = (decoder.bFirst) ? (decoder.slot) : ( decoder.slot + 1 );
+    while ( get_bit(pData, &position, limit) )
+    {
+      if ( get_bit(pData, &position, limit) )
+      {
+        decoder.valid = (uint8_t)get_bits(pData, &position, limit, data_channel_max);
+      }
+      else
+      {
+        slot += unzigzag(get_code(pData, &position, limit, 0));
+      }
+      if ( position >= limit ) break;
+    }
+    decoder.slot = slot;
+    decoder.bFirst = false;
+
+    for ( unsigned int channel = 0; channel < data_channel_max; channel++ )
+    {
+      if ( ( ( decoder.valid >> channel ) & 1 ) == 0 ) continue;
+      get_value(&decoder, pData, &position, limit, channel);
+    }
+    // the damaged row (past the used bits) is not given
+    if ( position > limit ) break;
+
+    ++rows;
+    const uint32_t time = slot * LOG_SECONDS;
+    if ( time > to ) break;
+    if ( time >= from )
+    {
+      callback(time, decoder.values, decoder.valid, pContext);
+      ++(*pFound);
+    }
+  }
+
+  return rows;
+}
+
+// initialization - called once at the device start (after theNVM_init)
+void theLog_init(void)
+{
+  // find the newest page in the ring, the next page will be written after it
+  bool found = false;
+  uint32_t newest = 0;
+
+  for ( unsigned int index = 0; index < NVM_LOG_PAGES; index++ )
+  {
+    const log_page_t *const pPage = flash_page(index);
+    if ( ! is_page(pPage) ) continue;
+
+    if ( ( ! found ) || ( (int32_t)( pPage->sequence - newest ) > 0 ) )
+    {
+      found = true;
+      newest = pPage->sequence;
+      page_index = (index + 1) % NVM_LOG_PAGES;
+    }
+  }
+
+  page_sequence = (found) ? (newest + 1) : (0);
+  bPageStarted = false;
+  bPageDirty = false;
+}
+
+// periodic function, called pretty fast, so we have to take
+// care execute it with specific periodicy
+void theLog_process(const unsigned long timestamp)
+{
+  // if the time since last execution exceeds specified period
+  if ( ( timestamp - timer ) >= LOG_CHECK_PERIOD )
+  {
+    theData_timestamp_t now;
+    int32_t values[data_channel_max];
+    uint8_t valid = 0;
+
+    theData_getTimestamp(&now);
+    // no time from RTC yet - nothing to log; the row is logged once per slot of the RTC time,
+    // so the rows follow the fixed cadence the encoder expects
+    const uint32_t slot = ( now.rtc + (now.ms / 1000) ) / LOG_SECONDS;
+    if ( ( now.rtc != 0 ) && ( ( ! bLogged ) || ( slot != last_slot ) ) )
+    {
+      for ( unsigned int channel = 0; channel < data_channel_max; channel++ )
+      {
+        theData_sample_t sample;
+        values[channel] = 0;
+        if ( theData_getSample(channel, &sample) )
+        {
+          values[channel] = sample.value;
+          valid |= ( 1 << channel );
+        }
+      }
+
+      const unsigned long started = micros();
+      append(slot, values, valid);
+      last_slot = slot;
+      bLogged = true;
+      stats.append_us = micros() - started;
+      if ( stats.append_us > stats.max_append_us ) stats.max_append_us = stats.append_us;
+    }
+
+    // remember when the function was executed last time
+    timer = timestamp;
+  }
+
+  // the rows in RAM are lost on reset - keep the flash copy of the page not older than PERIOD_LOG_FLUSH
+  if ( ( timestamp - timer_flush ) >= PERIOD_LOG_FLUSH )
+  {
+    flush_page();
+    timer_flush = timestamp;
+  }
+}
+
+unsigned int theLog_query(const uint32_t from, const uint32_t to, theLog_callback_t callback, void *const pContext)
+{
+  const unsigned long started = micros();
+  unsigned int rows = 0;
+  unsigned int found = 0;
+
+  // pages in flash, oldest first: the ring starts right after the newest page
+  for ( unsigned int i = 0; i < NVM_LOG_PAGES; i++ )
+  {
+    const unsigned int index = (page_index + i) % NVM_LOG_PAGES;
+    const log_page_t *const pPage = flash_page(index);
+    if ( ! is_page(pPage) ) continue;
+    // the flushed copy of the page being filled, the RAM page is decoded instead
+    if ( bPageStarted && ( pPage->sequence == page_sequence ) ) continue;
+    if ( pPage->time > to ) break;
+
+    // the page could be skipped if the next page starts before the range
+    const log_page_t *const pNext = flash_page((index + 1) % NVM_LOG_PAGES);
+    if ( ( ( i + 1 ) < NVM_LOG_PAGES ) && is_page(pNext) && ( pNext->sequence == ( pPage->sequence + 1 ) ) && ( pNext->time < from ) ) continue;
+
+    rows += decode_page(pPage, from, to, callback, pContext, &found);
+  }
+
+  // and the page which is still in RAM
+  if ( bPageStarted )
+  {
+    rows += decode_page((const log_page_t*)page, from, to, callback, pContext, &found);
+  }
+
+  stats.query_rows = rows;
+  stats.query_us = micros() - started;
+
+  return found;
+}
+
+void theLog_getStats(theLog_stats_t *const pStats)
+{
+  *pStats = stats;
+}
@@ -0,0 +1,32 @@
+#if !defined(__THE_CLOCK_THE_LOG_HEADER_INCLUDED_)
+#define __THE_CLOCK_THE_LOG_HEADER_INCLUDED_
+
+extern void theLog_init(void);
+extern void theLog_process(const unsigned long timestamp);
+
+// called for every logged row found by the query:
+// time is seconds since 2000-01-01, values are indexed by theData_channel_t,
+// bit N of 'valid' is set if the value of the channel N is valid
+typedef void (*theLog_callback_t)(const uint32_t time, const int32_t *const pValues, const uint8_t valid, void *const pContext);
+
+// call 'callback' for every row logged in the time range [from, to], oldest first,
+// returns the count of rows found
+extern unsigned int theLog_query(const uint32_t from, const uint32_t to, theLog_callback_t callback, void *const pContext);
+
+// readings log statistics
+typedef struct {
+  uint32_t rows;                // rows appended since start
+  uint32_t samples;             // valid channel values in these rows
+  uint32_t bits;                // encoded bits of these rows (including pages headers)
+  uint32_t pages;               // pages written to flash since start
+  uint32_t flushes;             // the page being filled was written to flash (PERIOD_LOG_FLUSH)
+  uint32_t append_us;           // time of the last append (encoding + flash write, if any), microseconds
+  uint32_t max_append_us;       // the longest append, microseconds
+  uint32_t query_rows;          // rows decoded by the last query
+  uint32_t query_us;            // time of the last query, microseconds
+} theLog_stats_t;
+
+extern void theLog_getStats(theLog_stats_t *const pStats);
+
+
+#endif // __THE_CLOCK_THE_LOG_HEADER_INCLUDED_
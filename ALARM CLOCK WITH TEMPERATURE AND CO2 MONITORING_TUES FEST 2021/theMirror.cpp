@@ -0,0 +1,184 @@
+#include <Arduino.h>
+// Libraries: none
+// project includes
+#include "hwconfig.h"
+// own declarations
+#include "theMirror.h"
+
+// The mirror of the display (SH1107) for the development: it decodes the same I2C stream
+// which is sent to the display (control bytes, commands, data) into its own copy of the
+// display RAM. So it is checked without looking at the panel that the frame is really on the
+// display after the changed parts are sent, and the picture could be dumped to Serial to be
+// compared with the expected (golden) one. Enabled by PANEL_MIRROR in hwconfig.h.
+
+// I2C control byte bits
+#define CONTROL_CONTINUATION  (0x80)        // one byte follows, then the next control byte
+#define CONTROL_DATA          (0x40)        // data (display RAM) bytes, otherwise commands
+
+// SH1107 commands
+#define SH1107_SET_COLUMN_LO  (0x00)        // 0x00...0x0F
+#define SH1107_SET_COLUMN_HI  (0x10)        // 0x10...0x17
+#define SH1107_SET_PAGE       (0xB0)        // 0xB0...0xBF
+#define SH1107_DISPLAY_OFF    (0xAE)
+#define SH1107_DISPLAY_ON     (0xAF)
+#define SH1107_SET_CONTRAST   (0x81)        // the argument follows
+#define SH1107_SET_START_LINE (0xDC)        // the argument follows
+
+// the commands with the argument byte (the argument is not decoded if the command is not known)
+static const uint8_t cDoubleByteCommands[] = { 0x81, 0xA8, 0xAD, 0xD3, 0xD5, 0xD9, 0xDA, 0xDB, 0xDC };
+
+// the display RAM mirror and the addressing
+static uint8_t ram[DISPLAY_PAGES][DISPLAY_COLUMNS];
+static unsigned int page = 0;
+static unsigned int column = 0;
+static uint8_t start_line = 0;
+static bool bDisplayOn = true;     // the display is switched on by its initialization in theDisplay
+static uint8_t contrast = 0;
+
+// the command which waits for its argument byte
+static uint8_t pending = 0;
+
+static theMirror_stats_t stats;
+
+// internal routines
+static void command(const uint8_t value);
+static void data(const uint8_t value);
+
+//----------------------------------------------------------
+
+void theMirror_init(void)
+{
+  memset(ram, 0, sizeof(ram));
+}
+
+static void command(const uint8_t value)
+{
+  // the argument of the previous command
+  if ( pending != 0 )
+  {
+    if ( pending == SH1107_SET_START_LINE ) start_line = value & 0x7F;
+    if ( pending == SH1107_SET_CONTRAST ) contrast = value;
+    pending = 0;
+    return;
+  }
+
+  if ( value <= ( SH1107_SET_COLUMN_LO + 0x0F ) )
+  {
+    column = ( column & 0xF0 ) | ( value & 0x0F );
+  }
+  else if ( ( value >= SH1107_SET_COLUMN_HI ) && ( value <= ( SH1107_SET_COLUMN_HI + 0x07 ) ) )
+  {
+    column = ( ( value & 0x07 ) << 4 ) | ( column & 0x0F );
+  }
+  else if ( ( value >= SH1107_SET_PAGE ) && ( value <= ( SH1107_SET_PAGE + 0x0F ) ) )
+  {
+    page = value & 0x0F;
+  }
+  else if ( ( value == SH1107_DISPLAY_OFF ) || ( value == SH1107_DISPLAY_ON ) )
+  {
+    bDisplayOn = ( value == SH1107_DISPLAY_ON );
+  }
+  else if ( memchr(cDoubleByteCommands, value, sizeof(cDoubleByteCommands)) != NULL )
+  {
+    pending = value;
+    if ( ( value != SH1107_SET_START_LINE ) && ( value != SH1107_SET_CONTRAST ) ) ++stats.unknown_commands;
+  }
+  else
+  {
+    ++stats.unknown_commands;
+  }
+}
+
+// the data byte is written at the current page and column, the column is incremented
+static void data(const uint8_t value)
+{
+  const unsigned int visible = column - DISPLAY_COLUMN_OFFSET;
+
+  if ( ( column < DISPLAY_COLUMN_OFFSET ) || ( visible >= DISPLAY_COLUMNS ) || ( page >= DISPLAY_PAGES ) )
+  {
+    ++stats.overruns;
+  }
+  else
+  {
+    ram[page][visible] = value;
+  }
+
+  ++column;
+  ++stats.data_bytes;
+}
+
+void theMirror_feed(const uint8_t *const pTransaction, const unsigned int size)
+{
+  unsigned int i = 0;
+
+  ++stats.transactions;
+  stats.bytes += 1 + size;     // the address byte is not in the transaction
+
+  while ( i < size )
+  {
+    const uint8_t control = pTransaction[i++];
+    const bool bData = ( ( control & CONTROL_DATA ) != 0 );
+
+    // one byte, then the next control byte
+    if ( control & CONTROL_CONTINUATION )
+    {
+      if ( i >= size ) break;
+      if ( bData ) data(pTransaction[i++]); else command(pTransaction[i++]);
+      continue;
+    }
+
+    // all the rest of the transaction
+    while ( i < size )
+    {
+      if ( bData ) data(pTransaction[i++]); else command(pTransaction[i++]);
+    }
+  }
+}
+
+bool theMirror_verify(const unsigned int first, const unsigned int count, const uint8_t *const pPages)
+{
+  // the commands only (e.g. the display is off at night) - nothing to compare
+  if ( ( count == 0 ) || ( pPages == NULL ) ) return true;
+  if ( ( first + count ) > DISPLAY_PAGES ) return false;
+
+  const bool bSame = ( memcmp(&(ram[first][0]), pPages, count * DISPLAY_COLUMNS) == 0 );
+
+  ++stats.frames;
+  if ( ! bSame ) ++stats.mismatches;
+
+  return bSame;
+}
+
+void theMirror_dump(Print *const pOut)
+{
+  const unsigned int width = DISPLAY_PAGES * 8;
+  const unsigned int height = DISPLAY_COLUMNS;
+
+  // binary PBM: the header, then the rows from the top, 8 pixels per byte, the leftmost is bit 7
+  pOut->print("P4\n");
+  pOut->print(width);
+  pOut->print(" ");
+  pOut->print(height);
+  pOut->print("\n");
+
+  for ( unsigned int y = 0; y < height; y++ )
+  {
+    for ( unsigned int x = 0; x < width; x += 8 )
+    {
+      uint8_t pixels = 0;
+      for ( unsigned int bit = 0; bit < 8; bit++ )
+      {
+        // the panel is rotated, and it shows the RAM rows from the start line
+        const unsigned int row = ( x + bit + start_line ) % width;
+        const bool bPixel = bDisplayOn && ( ram[row >> 3][height - 1 - y] & ( 1 << ( row & 7 ) ) );
+        if ( bPixel ) pixels |= ( 0x80 >> bit );
+      }
+      pOut->write(pixels);
+    }
+  }
+}
+
+void theMirror_getStats(theMirror_stats_t *const pStats)
+{
+  *pStats = stats;
+}
@@ -0,0 +1,30 @@
+#if !defined(__THE_CLOCK_THE_MIRROR_HEADER_INCLUDED_)
+#define __THE_CLOCK_THE_MIRROR_HEADER_INCLUDED_
+
+// no periodic actions, the mirror is fed by thePanel
+extern void theMirror_init(void);
+
+// decode the I2C transaction (without the address byte) sent to the display
+// into the mirror of the display RAM
+extern void theMirror_feed(const uint8_t *const pTransaction, const unsigned int size);
+// the pages [first, first + count) are completely sent - compare the mirror with them
+// (they are in the display RAM layout), no pages (the commands only) is not a frame
+extern bool theMirror_verify(const unsigned int first, const unsigned int count, const uint8_t *const pPages);
+// print the picture of the mirror (as the panel shows it) as PBM image (P4, 128x64)
+extern void theMirror_dump(Print *const pOut);
+
+// display stream statistics, as decoded by the mirror
+typedef struct {
+  uint32_t frames;              // frames verified
+  uint32_t mismatches;          // frames which are not the same as the mirror after they were sent
+  uint32_t transactions;        // I2C transactions, all the frames
+  uint32_t bytes;               // I2C bytes (addresses, control bytes, commands and data), all the frames
+  uint32_t data_bytes;          // display RAM bytes written, all the frames
+  uint32_t unknown_commands;    // commands the mirror does not decode
+  uint32_t overruns;            // data written out of the display RAM
+} theMirror_stats_t;
+
+extern void theMirror_getStats(theMirror_stats_t *const pStats);
+
+
+#endif // __THE_CLOCK_THE_MIRROR_HEADER_INCLUDED_
@@ -0,0 +1,305 @@
+#include <Arduino.h>
+// Libraries: flash memory storage ( Library: DueFlashStorage, by Sebastian Nilsson, version 1.0.0 )
+#include <DueFlashStorage.h>
+// project includes
+#include "hwconfig.h"
+// own declarations
+#include "theNVM.h"
+
+// The settings are stored as append-only log of records in the ring of flash pages.
+// Every record has a sequence number and CRC, so the latest valid record for a key wins,
+// and the record damaged by the reset during the write is just ignored. One page after
+// the current one is always kept erased, so the ring can move on; before that page is
+// erased, the latest records still located there are copied to the current page.
+
+static DueFlashStorage storage;
+
+// a single record in flash, 8 bytes - the page contains NVM_SLOTS records
+typedef struct {
+  uint16_t sequence;
+  uint8_t key;
+  uint8_t reserved;         // always 0x00 - the record can never look like erased flash
+  uint16_t value;
+  uint16_t crc;             // CRC-16 of all the fields above
+} nvm_record_t;
+
+#define NVM_SLOTS             ( NVM_PAGE_SIZE / sizeof(nvm_record_t) )
+#define NVM_SLOT_NONE         (0xFFFF)
+#define NVM_ERASED            (0xFF)
+
+// RAM index - the latest record of each key
+static struct {
+  uint16_t slot;            // page * NVM_SLOTS + record in page, NVM_SLOT_NONE if not stored
+  uint16_t sequence;
+  uint16_t value;
+} index_keys[NVM_CONFIG_KEYS];
+
+// where the next record will be appended
+static unsigned int current_page = 0;
+static unsigned int current_slot = 0;
+static uint16_t next_sequence = 0;
+
+static theNVM_stats_t stats;
+
+// internal routines
+static uint16_t crc16(const uint8_t *pData, unsigned int size);
+static inline bool is_newer(const uint16_t sequence, const uint16_t than);
+static inline const nvm_record_t* record_at(const unsigned int page, const unsigned int slot);
+static bool is_erased(const uint8_t *pData, unsigned int size);
+static bool is_valid(const nvm_record_t *const pRecord);
+static bool flash_program(const unsigned int page, const unsigned int slot, const void *const pData, const unsigned int size, const bool erase);
+static inline uint32_t slot_offset(const unsigned int page, const unsigned int slot);
+static bool append(const theNVM_setting_t *const pSettings, const unsigned int count);
+static void prepare_spare(void);
+static void scan(void);
+
+//----------------------------------------------------------
+
+// CRC-16/CCITT, bit by bit - records are small and written rarely
+static uint16_t crc16(const uint8_t *pData, unsigned int size)
+{
+  uint16_t crc = 0xFFFF;
+  while ( size-- )
+  {
+    crc ^= (uint16_t)(*pData++) << 8;
+    for ( int bit = 0; bit < 8; bit++ )
+    {
+      crc = ( crc & 0x8000 ) ? ( (crc << 1) ^ 0x1021 ) : ( crc << 1 );
+    }
+  }
+  return crc;
+}
+
+// sequence numbers are wrapping, but all the records in the ring are
+// much less than 32768 sequences away from each other
+static inline bool is_newer(const uint16_t sequence, const uint16_t than)
+{
+  return ( (int16_t)(sequence - than) > 0 );
+}
+
+// offset of the record from the beginning of the storage
+static inline uint32_t slot_offset(const unsigned int page, const unsigned int slot)
+{
+  return NVM_CONFIG_OFFSET + (page * NVM_PAGE_SIZE) + (slot * sizeof(nvm_record_t));
+}
+
+// the record is read directly from memory-mapped flash
+static inline const nvm_record_t* record_at(const unsigned int page, const unsigned int slot)
+{
+  return (const nvm_record_t*)theNVM_address(slot_offset(page, slot));
+}
+
+static bool is_erased(const uint8_t *pData, unsigned int size)
+{
+  while ( size-- )
+  {
+    if ( *pData++ != NVM_ERASED ) return false;
+  }
+  return true;
+}
+
+static bool is_valid(const nvm_record_t *const pRecord)
+{
+  return ( pRecord->key < NVM_CONFIG_KEYS ) && ( pRecord->reserved == 0 ) &&
+         ( pRecord->crc == crc16((const uint8_t*)pRecord, sizeof(nvm_record_t) - sizeof(uint16_t)) );
+}
+
+// program the data to flash starting from the slot. Without 'erase' the slots must be
+// erased already (the new records are programmed, the rest of the page keeps its content),
+// with 'erase' the whole page is erased and programmed.
+static bool flash_program(const unsigned int page, const unsigned int slot, const void *const pData, const unsigned int size, const bool erase)
+{
+  stats.flash_bytes += (erase) ? (NVM_PAGE_SIZE) : (size);
+  return theNVM_program(slot_offset(page, slot), pData, size, erase);
+}
+
+// append the records to the current page with one flash write, and update the index
+static bool append(const theNVM_setting_t *const pSettings, const unsigned int count)
+{
+  nvm_record_t records[NVM_CONFIG_KEYS];
+
+  if ( count > NVM_CONFIG_KEYS ) return false;
+  if ( ( current_slot + count ) > NVM_SLOTS )
+  {
+    // the page is full - move to the spare page, and prepare the next spare
+    current_page = (current_page + 1) % NVM_CONFIG_PAGES;
+    current_slot = 0;
+    prepare_spare();
+  }
+
+  for ( unsigned int i = 0; i < count; i++ )
+  {
+    records[i].sequence = next_sequence + i;
+    records[i].key = pSettings[i].key;
+    records[i].reserved = 0;
+    records[i].value = pSettings[i].value;
+    records[i].crc = crc16((const uint8_t*)&(records[i]), sizeof(nvm_record_t) - sizeof(uint16_t));
+  }
+
+  // the failed program could leave the slots programmed partly - they are never used again
+  const bool result = flash_program(current_page, current_slot, records, count * sizeof(nvm_record_t), false);
+  next_sequence += count;
+  current_slot += count;
+  if ( ! result ) return false;
+
+  for ( unsigned int i = 0; i < count; i++ )
+  {
+    index_keys[records[i].key].slot = (current_page * NVM_SLOTS) + current_slot + i;
+    index_keys[records[i].key].sequence = records[i].sequence;
+    index_keys[records[i].key].value = records[i].value;
+  }
+
+  stats.records += count;
+  return true;
+}
+
+// make sure the page after the current one is erased: copy the latest
+// records still located there to the current page, then erase it
+static void prepare_spare(void)
+{
+  const unsigned int spare = (current_page + 1) % NVM_CONFIG_PAGES;
+  if ( is_erased((const uint8_t*)record_at(spare, 0), NVM_PAGE_SIZE) ) return;
+
+  theNVM_setting_t live[NVM_CONFIG_KEYS];
+  unsigned int count = 0;
+  for ( unsigned int key = 0; key < NVM_CONFIG_KEYS; key++ )
+  {
+    if ( ( index_keys[key].slot != NVM_SLOT_NONE ) && ( ( index_keys[key].slot / NVM_SLOTS ) == spare ) )
+    {
+      live[count].key = key;
+      live[count].value = index_keys[key].value;
+      ++count;
+    }
+  }
+
+  uint8_t erased[NVM_PAGE_SIZE];
+  memset(erased, NVM_ERASED, NVM_PAGE_SIZE);
+
+  if ( ( current_slot + count ) > NVM_SLOTS )
+  {
+    // no room for the copies (possible only after reset during compaction) - the values
+    // are in RAM index, so the spare is erased and becomes the current page right away
+    flash_program(spare, 0, erased, NVM_PAGE_SIZE, true);
+    ++stats.compactions;
+    current_page = spare;
+    current_slot = 0;
+    append(live, count);
+    prepare_spare();
+    return;
+  }
+
+  if ( count > 0 ) append(live, count);
+  flash_program(spare, 0, erased, NVM_PAGE_SIZE, true);
+  ++stats.compactions;
+}
+
+// scan all the pages and build the index: the latest valid record for every key,
+// and the position after the newest record for appending
+static void scan(void)
+{
+  bool found = false;
+  uint16_t newest = 0;
+
+  for ( unsigned int key = 0; key < NVM_CONFIG_KEYS; key++ )
+  {
+    index_keys[key].slot = NVM_SLOT_NONE;
+  }
+
+  for ( unsigned int page = 0; page < NVM_CONFIG_PAGES; page++ )
+  {
+    for ( unsigned int slot = 0; slot < NVM_SLOTS; slot++ )
+    {
+      const nvm_record_t *const pRecord = record_at(page, slot);
+      if ( ! is_valid(pRecord) ) continue;
+
+      ++stats.boot_records;
+
+      if ( ( index_keys[pRecord->key].slot == NVM_SLOT_NONE ) || is_newer(pRecord->sequence, index_keys[pRecord->key].sequence) )
+      {
+        index_keys[pRecord->key].slot = (page * NVM_SLOTS) + slot;
+        index_keys[pRecord->key].sequence = pRecord->sequence;
+        index_keys[pRecord->key].value = pRecord->value;
+      }
+
+      if ( ( ! found ) || is_newer(pRecord->sequence, newest) )
+      {
+        found = true;
+        newest = pRecord->sequence;
+        current_page = page;
+      }
+    }
+  }
+
+  next_sequence = (found) ? (newest + 1) : (0);
+
+  // append after the last used slot of the current page (damaged records are skipped too)
+  current_slot = 0;
+  for ( unsigned int slot = 0; slot < NVM_SLOTS; slot++ )
+  {
+    if ( ! is_erased((const uint8_t*)record_at(current_page, slot), sizeof(nvm_record_t)) )
+    {
+      current_slot = slot + 1;
+    }
+  }
+}
+
+// initialization - called once at the device start
+void theNVM_init(void)
+{
+  const unsigned long started = micros();
+  scan();
+  stats.boot_scan_us = micros() - started;
+
+  // the reset could happen before the spare page was erased
+  prepare_spare();
+}
+
+bool theNVM_read(const uint8_t key, uint16_t *const pValue)
+{
+  if ( ( key >= NVM_CONFIG_KEYS ) || ( index_keys[key].slot == NVM_SLOT_NONE ) ) return false;
+
+  *pValue = index_keys[key].value;
+  return true;
+}
+
+bool theNVM_write(const theNVM_setting_t *const pSettings, const unsigned int count)
+{
+  theNVM_setting_t changed[NVM_CONFIG_KEYS];
+  unsigned int changed_count = 0;
+
+  for ( unsigned int i = 0; i < count; i++ )
+  {
+    uint16_t value;
+    if ( pSettings[i].key >= NVM_CONFIG_KEYS ) return false;
+    if ( theNVM_read(pSettings[i].key, &value) && ( value == pSettings[i].value ) ) continue;
+    if ( changed_count >= NVM_CONFIG_KEYS ) return false;
+    changed[changed_count++] = pSettings[i];
+  }
+
+  // key + value are the useful bytes
+  stats.user_bytes += changed_count * ( sizeof(uint8_t) + sizeof(uint16_t) );
+  if ( changed_count == 0 ) return true;
+
+  return append(changed, changed_count);
+}
+
+const uint8_t* theNVM_address(const uint32_t offset)
+{
+  return storage.readAddress(offset);
+}
+
+bool theNVM_program(const uint32_t offset, const void *const pData, const unsigned int size, const bool erase)
+{
+  const uint32_t address = (uint32_t)(uintptr_t)theNVM_address(offset);
+
+  if ( flash_unlock(address, address + size - 1, 0, 0) != FLASH_RC_OK ) return false;
+  const bool result = ( flash_write(address, pData, size, (erase) ? (1) : (0)) == FLASH_RC_OK );
+  flash_lock(address, address + size - 1, 0, 0);
+
+  return result;
+}
+
+void theNVM_getStats(theNVM_stats_t *const pStats)
+{
+  *pStats = stats;
+}
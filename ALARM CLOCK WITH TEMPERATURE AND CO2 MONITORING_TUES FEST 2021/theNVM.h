@@ -0,0 +1,37 @@
+#if !defined(__THE_CLOCK_THE_NVM_HEADER_INCLUDED_)
+#define __THE_CLOCK_THE_NVM_HEADER_INCLUDED_
+
+// no periodic actions, the settings are read and written on request
+extern void theNVM_init(void);
+
+// a single setting: key is 0..(NVM_CONFIG_KEYS-1)
+typedef struct {
+  uint8_t key;
+  uint16_t value;
+} theNVM_setting_t;
+
+// get the latest stored value of the setting, returns 'false' if it was never stored
+extern bool theNVM_read(const uint8_t key, uint16_t *const pValue);
+// store the settings with a single flash write (unchanged values are skipped),
+// returns 'false' if the settings could not be stored
+extern bool theNVM_write(const theNVM_setting_t *const pSettings, const unsigned int count);
+
+// raw access to the internal flash used for storage (offset is from the beginning of the storage):
+// memory-mapped address for reading, and programming with or without erasing the pages first
+extern const uint8_t* theNVM_address(const uint32_t offset);
+extern bool theNVM_program(const uint32_t offset, const void *const pData, const unsigned int size, const bool erase);
+
+// config store statistics
+typedef struct {
+  uint32_t boot_scan_us;        // time of the boot scan which builds the index, microseconds
+  uint32_t boot_records;        // valid records found by the boot scan
+  uint32_t user_bytes;          // bytes of the settings requested to be stored
+  uint32_t flash_bytes;         // bytes programmed or erased in flash (write amplification = flash/user)
+  uint32_t records;             // records appended (including records copied by compaction)
+  uint32_t compactions;         // pages erased to be reused
+} theNVM_stats_t;
+
+extern void theNVM_getStats(theNVM_stats_t *const pStats);
+
+
+#endif // __THE_CLOCK_THE_NVM_HEADER_INCLUDED_
@@ -0,0 +1,485 @@
+#include <Arduino.h>
+#include <Wire.h>
+// Libraries: none
+// project includes
+#include "hwconfig.h"
+#include "theMirror.h"
+#include "theBus.h"
+// own declarations
+#include "thePanel.h"
+
+// The frame is sent in the background by the PDC (DMA) of the TWI peripheral.
+// thePanel_show() compares the frame with the copy of what is on the display and prepares
+// the stream of I2C transactions: one transaction per changed column range, with the
+// page/column commands and the data. Then thePanel_process() only checks the TWI status and
+// starts the next transaction when the previous one is completed, the bytes are moved by PDC.
+// (TWI interrupt handler is already defined by Wire library, so the status is polled.)
+// The transaction not moved on for PERIOD_PANEL_TIMEOUT (or not acknowledged) drops the frame:
+// the bus is recovered by theBus, and the next frame waits for its retry and is sent completely.
+// In the strip mode (DISPLAY_STRIP_PAGES) the frame comes by strips, and the copy of the
+// display is not kept: only the checksums of its segments are, the changed segments are sent.
+
+// SH1107 commands
+#define SH1107_SET_PAGE       (0xB0)        // + page number
+#define SH1107_SET_COLUMN_LO  (0x00)        // + low nibble of column
+#define SH1107_SET_COLUMN_HI  (0x10)        // + high nibble of column
+#define SH1107_SET_START_LINE (0xDC)        // the line (0...127) is the next byte
+#define SH1107_SET_CONTRAST   (0x81)        // the contrast (0...255) is the next byte
+#define SH1107_DISPLAY_OFF    (0xAE)        // sleep, the display RAM is kept
+#define SH1107_DISPLAY_ON     (0xAF)
+
+// I2C control bytes
+#define CONTROL_COMMAND       (0x80)        // single command, another control byte follows
+#define CONTROL_DATA          (0x40)        // all the bytes till the end of transaction are data
+#define CONTROL_COMMANDS      (0x00)        // all the bytes till the end of transaction are commands
+
+// the unchanged columns between two changed ranges are sent anyway if there are
+// less of them than the cost of starting a new range (commands + transaction)
+#define RANGE_MERGE_GAP       (8)
+// the range transaction: 3 x (command control byte + command), data control byte, data
+#define RANGE_OVERHEAD        (7)
+// ranges are more than RANGE_MERGE_GAP columns away from each other
+#define RANGES_MAX            ( STRIP_PAGES * ( ( DISPLAY_COLUMNS / (RANGE_MERGE_GAP + 2) ) + 1 ) )
+// the commands transaction (after the frame data): control byte and the commands
+// (start line, contrast, display on/off)
+#define COMMANDS_MAX          (5)
+#define TRANSACTIONS_MAX      ( RANGES_MAX + 1 )
+#define STREAM_SIZE           ( (STRIP_PAGES * DISPLAY_COLUMNS) + (RANGES_MAX * RANGE_OVERHEAD) + 1 + COMMANDS_MAX )
+
+// the strip mode: the checksum is kept per segment of SEGMENT_COLUMNS columns of the page
+#define SEGMENT_COLUMNS       (16)
+#define SEGMENTS              ( DISPLAY_COLUMNS / SEGMENT_COLUMNS )
+
+#if ( ( DISPLAY_PAGES % STRIP_PAGES ) != 0 ) || ( ( DISPLAY_COLUMNS % SEGMENT_COLUMNS ) != 0 )
+#error "The display pages should be divisible by the strip pages, the columns - by the segment columns"
+#endif
+
+// the invalid pages are the bits of uint32_t, and the mask of all the pages is ( 1 << DISPLAY_PAGES ) - 1
+#if ( DISPLAY_PAGES >= 32 )
+#error "The display pages should be less than 32"
+#endif
+
+// what is currently on the display (or is being sent to it): the copy of the frame,
+// or the checksums of the segments in the strip mode
+static uint8_t shadow[ ( DISPLAY_STRIP_PAGES > 0 ) ? (1) : (DISPLAY_PAGES) ][DISPLAY_COLUMNS];
+static uint32_t checksums[ ( DISPLAY_STRIP_PAGES > 0 ) ? (DISPLAY_PAGES) : (1) ][SEGMENTS];
+// the pages which are not known to be on the display, bit N is page N
+static uint32_t invalid_pages = 0;
+
+// the display start line (the display RAM row shown at the top of the panel)
+static uint8_t start_line = 0;
+static bool bStartLine = false;       // should be sent with the next frame
+
+// the display contrast and on/off state, sent with the next frame when changed
+static uint8_t contrast = CONTRAST_DAY;
+static bool bContrast = false;
+static bool bPowerOn = true;
+static bool bPower = false;
+
+// the stream of transactions being sent - the frame is copied here, so the
+// next frame could be drawn while this one is being sent
+static uint8_t stream[STREAM_SIZE];
+static unsigned int stream_size = 0;
+static struct {
+  uint16_t offset;
+  uint16_t size;
+} transactions[TRANSACTIONS_MAX];
+static unsigned int transactions_count = 0;
+static unsigned int transaction = 0;
+
+// transfer state machine states
+typedef enum {
+  state_idle,       // nothing to send
+  state_pdc,        // PDC is sending all the bytes of transaction except the last one
+  state_last,       // waiting to send the last byte with STOP
+  state_complete    // waiting for the transaction to complete
+} state_t;
+
+static volatile state_t state = state_idle;
+
+static thePanel_stats_t stats;
+static unsigned long started = 0;
+// millis() when the current transaction has started, or has moved to its next step
+static unsigned long transaction_millis = 0;
+
+// internal routines
+static void add_range(const unsigned int page, const unsigned int first, const unsigned int last, const uint8_t *const pData);
+static void add_changed_ranges(const unsigned int page, const uint8_t *const pPage);
+static void add_changed_segments(const unsigned int page, const uint8_t *const pPage);
+static uint32_t checksum(const uint8_t *const pSegment);
+static void add_commands(const uint8_t *const pCommands, const unsigned int count);
+static void add_changed_commands(void);
+static void start_transaction(void);
+static void finish_frame(void);
+static void fail_frame(void);
+
+//----------------------------------------------------------
+
+void thePanel_init(void)
+{
+  // the display itself is initialized by theDisplay, here we just know nothing about its content
+  thePanel_invalidate();
+
+  // every page is one range: address byte, commands, data
+  stats.full_bytes = DISPLAY_PAGES * ( 1 + RANGE_OVERHEAD + DISPLAY_COLUMNS );
+  stats.ram_bytes = sizeof(shadow) + sizeof(checksums) + sizeof(stream) + sizeof(transactions);
+}
+
+void thePanel_invalidate(void)
+{
+  invalid_pages = ( 1UL << DISPLAY_PAGES ) - 1;
+  bStartLine = true;
+  bContrast = true;
+  bPower = true;
+}
+
+void thePanel_setStartLine(const uint8_t line)
+{
+  if ( line == start_line ) return;
+  start_line = line;
+  bStartLine = true;
+}
+
+void thePanel_setContrast(const uint8_t value)
+{
+  if ( value == contrast ) return;
+  contrast = value;
+  bContrast = true;
+}
+
+void thePanel_setPower(const bool isOn)
+{
+  if ( isOn == bPowerOn ) return;
+  bPowerOn = isOn;
+  bPower = true;
+}
+
+// the bus is failing - the next frame waits for the retry
+bool thePanel_isBusy(void)
+{
+  return ( state != state_idle ) || ( ! theBus_isReady(bus_display) );
+}
+
+// add the transaction for columns [first, last] of the page to the stream
+static void add_range(const unsigned int page, const unsigned int first, const unsigned int last, const uint8_t *const pData)
+{
+  const unsigned int column = first + DISPLAY_COLUMN_OFFSET;
+  const unsigned int count = last - first + 1;
+  uint8_t *const pStream = &(stream[stream_size]);
+
+  pStream[0] = CONTROL_COMMAND;
+  pStream[1] = SH1107_SET_PAGE + page;
+  pStream[2] = CONTROL_COMMAND;
+  pStream[3] = SH1107_SET_COLUMN_HI + (column >> 4);
+  pStream[4] = CONTROL_COMMAND;
+  pStream[5] = SH1107_SET_COLUMN_LO + (column & 0x0F);
+  pStream[6] = CONTROL_DATA;
+  memcpy(&(pStream[RANGE_OVERHEAD]), &(pData[first]), count);
+
+  transactions[transactions_count].offset = stream_size;
+  transactions[transactions_count].size = RANGE_OVERHEAD + count;
+  ++transactions_count;
+  stream_size += RANGE_OVERHEAD + count;
+
+  // the shadow is what will be on the display after this transaction
+  if ( DISPLAY_STRIP_PAGES > 0 )
+  {
+    for ( unsigned int segment = first / SEGMENT_COLUMNS; segment <= last / SEGMENT_COLUMNS; segment++ )
+    {
+      checksums[page][segment] = checksum(&(pData[segment * SEGMENT_COLUMNS]));
+    }
+  }
+  else
+  {
+    memcpy(&(shadow[page][first]), &(pData[first]), count);
+  }
+}
+
+// add the changed column ranges of the page, comparing it with the shadow
+static void add_changed_ranges(const unsigned int page, const uint8_t *const pPage)
+{
+  unsigned int column = 0;
+  while ( column < DISPLAY_COLUMNS )
+  {
+    // skip unchanged columns
+    if ( pPage[column] == shadow[page][column] )
+    {
+      ++column;
+      continue;
+    }
+
+    // the range lasts until RANGE_MERGE_GAP unchanged columns in a row (or the page end)
+    const unsigned int first = column;
+    unsigned int last = column;
+    for ( ; column < DISPLAY_COLUMNS; column++ )
+    {
+      if ( pPage[column] != shadow[page][column] ) last = column;
+      else if ( ( column - last ) > RANGE_MERGE_GAP ) break;
+    }
+
+    add_range(page, first, last, pPage);
+  }
+}
+
+// the strip mode: add the changed segments of the page, the neighbouring ones are one range
+static void add_changed_segments(const unsigned int page, const uint8_t *const pPage)
+{
+  unsigned int segment = 0;
+  while ( segment < SEGMENTS )
+  {
+    if ( checksum(&(pPage[segment * SEGMENT_COLUMNS])) == checksums[page][segment] )
+    {
+      ++segment;
+      continue;
+    }
+
+    const unsigned int first = segment;
+    while ( ( segment < SEGMENTS ) && ( checksum(&(pPage[segment * SEGMENT_COLUMNS])) != checksums[page][segment] ) )
+    {
+      ++segment;
+    }
+
+    add_range(page, first * SEGMENT_COLUMNS, ( segment * SEGMENT_COLUMNS ) - 1, pPage);
+  }
+}
+
+// FNV-1a hash of the segment
+static uint32_t checksum(const uint8_t *const pSegment)
+{
+  uint32_t hash = 2166136261UL;
+  for ( unsigned int i = 0; i < SEGMENT_COLUMNS; i++ )
+  {
+    hash = ( hash ^ pSegment[i] ) * 16777619UL;
+  }
+  return hash;
+}
+
+// add the transaction with the commands to the stream
+static void add_commands(const uint8_t *const pCommands, const unsigned int count)
+{
+  uint8_t *const pStream = &(stream[stream_size]);
+
+  pStream[0] = CONTROL_COMMANDS;
+  memcpy(&(pStream[1]), pCommands, count);
+
+  transactions[transactions_count].offset = stream_size;
+  transactions[transactions_count].size = 1 + count;
+  ++transactions_count;
+  stream_size += 1 + count;
+}
+
+// the commands are sent after the data, so the new rows and the scroll are shown together,
+// and the display is switched on with the new picture already in its RAM
+static void add_changed_commands(void)
+{
+  uint8_t commands[COMMANDS_MAX];
+  unsigned int count = 0;
+
+  if ( bStartLine )
+  {
+    commands[count++] = SH1107_SET_START_LINE;
+    commands[count++] = start_line;
+    bStartLine = false;
+  }
+  if ( bContrast )
+  {
+    commands[count++] = SH1107_SET_CONTRAST;
+    commands[count++] = contrast;
+    bContrast = false;
+  }
+  if ( bPower )
+  {
+    commands[count++] = bPowerOn ? (SH1107_DISPLAY_ON) : (SH1107_DISPLAY_OFF);
+    bPower = false;
+  }
+
+  if ( count > 0 )
+  {
+    add_commands(commands, count);
+  }
+}
+
+// start the PDC transfer of the current transaction (all the bytes but the last one)
+static void start_transaction(void)
+{
+  const unsigned int offset = transactions[transaction].offset;
+  const unsigned int size = transactions[transaction].size;
+
+  TWI_DISPLAY->TWI_MMR = TWI_MMR_DADR(ADDRESS_DISPLAY);
+  TWI_DISPLAY->TWI_TPR = (uint32_t)(uintptr_t)&(stream[offset]);
+  TWI_DISPLAY->TWI_TCR = size - 1;
+  TWI_DISPLAY->TWI_PTCR = TWI_PTCR_TXTEN;
+
+  transaction_millis = millis();
+  state = state_pdc;
+}
+
+static void finish_frame(void)
+{
+  state = state_idle;
+
+  stats.busy_us = micros() - started;
+  if ( stats.busy_us > stats.max_busy_us ) stats.max_busy_us = stats.busy_us;
+}
+
+// the frame is dropped, its content on the display is unknown now
+static void fail_frame(void)
+{
+  TWI_DISPLAY->TWI_PTCR = TWI_PTCR_TXTDIS;
+  ++stats.failures;
+  theBus_failed(bus_display);
+  thePanel_invalidate();
+  finish_frame();
+}
+
+void thePanel_show(const uint8_t *const pFrame)
+{
+  thePanel_showPages(0, DISPLAY_PAGES, pFrame);
+}
+
+void thePanel_showPages(const unsigned int first, const unsigned int count, const uint8_t *const pPages)
+{
+  // the previous pages are still being sent - the caller should wait for thePanel_isBusy() == false
+  if ( thePanel_isBusy() ) return;
+
+  const unsigned long cpu_started = micros();
+
+  stream_size = 0;
+  transactions_count = 0;
+  transaction = 0;
+
+  for ( unsigned int i = 0; i < count; i++ )
+  {
+    const unsigned int page = first + i;
+    const uint8_t *const pPage = &(pPages[i * DISPLAY_COLUMNS]);
+
+    if ( invalid_pages & ( 1UL << page ) )
+    {
+      add_range(page, 0, DISPLAY_COLUMNS - 1, pPage);
+      invalid_pages &= ~( 1UL << page );
+    }
+    else if ( DISPLAY_STRIP_PAGES > 0 )
+    {
+      add_changed_segments(page, pPage);
+    }
+    else
+    {
+      add_changed_ranges(page, pPage);
+    }
+  }
+
+  // the commands are sent with the last page of the frame
+  if ( ( first + count ) >= DISPLAY_PAGES )
+  {
+    add_changed_commands();
+  }
+
+  // development check: the stream decoded into the mirror of the display RAM must give the pages
+  if ( PANEL_MIRROR )
+  {
+    for ( unsigned int i = 0; i < transactions_count; i++ )
+    {
+      theMirror_feed(&stream[transactions[i].offset], transactions[i].size);
+    }
+    theMirror_verify(first, count, pPages);
+  }
+
+  // statistics: every transaction is the address byte plus the stream bytes
+  ++stats.frames;
+  stats.transactions = transactions_count;
+  stats.bytes = stream_size + transactions_count;
+  stats.total_bytes += stats.bytes;
+  if ( stats.bytes > stats.max_bytes ) stats.max_bytes = stats.bytes;
+
+  started = micros();
+  if ( transactions_count > 0 )
+  {
+    start_transaction();
+  }
+  else
+  {
+    finish_frame();
+  }
+
+  stats.cpu_us = micros() - cpu_started;
+  stats.total_cpu_us += stats.cpu_us;
+}
+
+// periodic function, called pretty fast - moves the transfer state machine on
+void thePanel_process(const unsigned long timestamp)
+{
+  (void)timestamp;
+
+  if ( state == state_idle ) return;
+
+  const unsigned long cpu_started = micros();
+  const uint32_t status = TWI_DISPLAY->TWI_SR;
+  const state_t state_before = state;
+  const unsigned int transaction_before = transaction;
+
+  // the display did not acknowledge - drop the frame
+  if ( status & TWI_SR_NACK )
+  {
+    fail_frame();
+    return;
+  }
+
+  switch ( state ) {
+
+  case state_pdc:
+    // PDC has sent all the bytes but the last one
+    if ( ( status & TWI_SR_ENDTX ) == 0 ) break;
+    TWI_DISPLAY->TWI_PTCR = TWI_PTCR_TXTDIS;
+    state = state_last;
+    // no break - check if the last byte could be sent right away
+
+  case state_last:
+    // the status read above is used: reading TWI_SR again would clear NACK unseen
+    if ( ( status & TWI_SR_TXRDY ) == 0 ) break;
+    TWI_DISPLAY->TWI_CR = TWI_CR_STOP;
+    TWI_DISPLAY->TWI_THR = stream[transactions[transaction].offset + transactions[transaction].size - 1];
+    state = state_complete;
+    break;
+
+  case state_complete:
+    if ( ( status & TWI_SR_TXCOMP ) == 0 ) break;
+    theBus_succeeded(bus_display);
+    // the next transaction, or the frame is done
+    if ( ++transaction < transactions_count )
+    {
+      start_transaction();
+    }
+    else
+    {
+      finish_frame();
+    }
+    break;
+
+  default:
+    finish_frame();
+    break;
+  }
+
+  // the steps done are taken from the status first (after a stall of the main loop the transfer
+  // is usually complete), the transaction which has not moved on for the timeout is stuck
+  if ( state != state_idle )
+  {
+    if ( ( state != state_before ) || ( transaction != transaction_before ) )
+    {
+      transaction_millis = millis();
+    }
+    else if ( ( millis() - transaction_millis ) >= PERIOD_PANEL_TIMEOUT )
+    {
+      fail_frame();
+    }
+  }
+
+  const unsigned long cpu_us = micros() - cpu_started;
+  stats.cpu_us += cpu_us;
+  stats.total_cpu_us += cpu_us;
+}
+
+void thePanel_getStats(thePanel_stats_t *const pStats)
+{
+  *pStats = stats;
+}
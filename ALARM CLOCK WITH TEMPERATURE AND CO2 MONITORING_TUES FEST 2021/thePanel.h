@@ -0,0 +1,49 @@
+#if !defined(__THE_CLOCK_THE_PANEL_HEADER_INCLUDED_)
+#define __THE_CLOCK_THE_PANEL_HEADER_INCLUDED_
+
+extern void thePanel_init(void);
+extern void thePanel_process(const unsigned long timestamp);
+
+// send the frame to the display. The frame is in the display RAM layout:
+// DISPLAY_PAGES pages, DISPLAY_COLUMNS bytes each, bit N of the byte is row (page * 8 + N).
+// Only the changed part of every page is sent. The frame is copied, and it is sent in the
+// background, so the caller could draw the next frame right away. The frame is ignored
+// if the previous one is still being sent.
+extern void thePanel_show(const uint8_t *const pFrame);
+// send the pages [first, first + count) of the frame, the same way as thePanel_show() (the strip
+// mode: the frame is sent by strips). The changed commands (start line, contrast, on/off) are
+// sent with the last page of the display; thePanel_showPages(DISPLAY_PAGES, 0, NULL) sends only them
+extern void thePanel_showPages(const unsigned int first, const unsigned int count, const uint8_t *const pPages);
+// check if the frame is still being sent
+extern bool thePanel_isBusy(void);
+// the next frame will be sent completely (e.g. after the display re-initialization)
+extern void thePanel_invalidate(void);
+// the display RAM row shown at the top (the left side in landscape) of the panel, 0...127;
+// it is sent with the next frame. It scrolls the whole picture without sending it.
+extern void thePanel_setStartLine(const uint8_t line);
+// the display contrast, 0...255; it is sent with the next frame
+extern void thePanel_setContrast(const uint8_t value);
+// switch the display off (sleep) or on; it is sent with the next frame. The display RAM is
+// kept while it is off, so it is switched on without the re-initialization and the full frame
+extern void thePanel_setPower(const bool isOn);
+
+// display transfer statistics
+typedef struct {
+  uint32_t frames;              // frames shown (strips in the strip mode)
+  uint32_t bytes;               // I2C bytes of the last frame (addresses, commands and data)
+  uint32_t transactions;        // I2C transactions of the last frame
+  uint32_t busy_us;             // bus busy time of the last frame, microseconds
+  uint32_t cpu_us;              // main loop time spent for the last frame (preparation and transfer), microseconds
+  uint32_t max_bytes;           // the biggest frame, I2C bytes
+  uint32_t max_busy_us;         // the longest frame, microseconds
+  uint32_t total_bytes;         // I2C bytes of all the frames
+  uint32_t full_bytes;          // I2C bytes of the frame sent completely
+  uint32_t total_cpu_us;        // main loop time spent for all the frames, microseconds
+  uint32_t ram_bytes;           // RAM used for the display content and the transfers
+  uint32_t failures;            // frames dropped (not acknowledged, or the transaction timeout)
+} thePanel_stats_t;
+
+extern void thePanel_getStats(thePanel_stats_t *const pStats);
+
+
+#endif // __THE_CLOCK_THE_PANEL_HEADER_INCLUDED_
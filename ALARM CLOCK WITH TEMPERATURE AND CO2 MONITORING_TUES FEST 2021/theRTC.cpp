@@ -1,94 +1,485 @@
 #include <Arduino.h>
 #include <Wire.h>
-// Libraries: real-time clock and calendar ( Library: DS3231, by Andrew Wickert, version 1.0.7 )
-#include <DS3231.h>
+// Libraries: none (DS3231 registers are accessed directly)
 // project includes
 #include "hwconfig.h"
 #include "theData.h"
+#include "theTime.h"
+#include "theBus.h"
 // own declarations
 #include "theRTC.h"
 
-// real-time clock and calendar
-static DS3231 rtc;
+// DS3231 time and date registers, read out by one burst from register 0x00
+typedef enum {
+  reg_seconds,
+  reg_minutes,
+  reg_hours,
+  reg_dow,
+  reg_date,
+  reg_month,
+  reg_year,
+  reg_max
+} reg_t;
+
+// BCD bits of every register (the rest are flags: 12h mode and PM in hours, century in month)
+static const uint8_t cRegisterBCD[reg_max] = { 0x7F, 0x7F, 0x3F, 0x07, 0x3F, 0x1F, 0xFF };
+// the bits compared by the read back after the write: the written ones (the hours mode is written
+// as well), not the century flag and the unused bits - the chip could have them set
+static const uint8_t cRegisterWritten[reg_max] = { 0x7F, 0x7F, 0x7F, 0x07, 0x3F, 0x1F, 0xFF };
+// the tens of the BCD value, by its high nibble
+static const uint8_t cTens[16] = { 0, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 110, 120, 130, 140, 150 };
+
+#define HOURS_12H             (0x40)        // 12h mode bit of hours register
+#define HOURS_PM              (0x20)        // PM bit of hours register in 12h mode
+#define HOURS_12H_BCD         (0x1F)        // BCD bits of hours register in 12h mode
+
+// alarm registers: Alarm1 is the next due alarm of theAlarms (day of week, hh:mm:00),
+// Alarm2 is the minute tick (every minute at ss=00)
+#define REG_ALARM1            (0x07)        // seconds, minutes, hours, day/date
+#define REG_ALARM2            (0x0B)        // minutes, hours, day/date
+#define REG_CONTROL           (0x0E)
+#define REG_STATUS            (0x0F)
+#define ALARM_MASK            (0x80)        // AxMy bit - the register is not compared
+#define ALARM_DAY_OF_WEEK     (0x40)        // DY/DT bit - the day of week is compared, not the date
+// control register: oscillator on, INT/SQW pin is the alarm interrupt (INTCN), Alarm2 interrupt is on
+#define CONTROL_INTCN         (0x04)
+#define CONTROL_A2IE          (0x02)
+#define CONTROL_A1IE          (0x01)
+#define CONTROL_CONV          (0x20)        // the temperature conversion is running, set by the chip too
+// status register: alarm flags, the INT/SQW pin is low until they are cleared
+#define STATUS_A2F            (0x02)
+#define STATUS_A1F            (0x01)
 
 // timestamp last called
 static unsigned long timer = 0;
+// timestamp of the last registers read out
+static unsigned long timer_sync = 0;
+// timestamp of the last adjustment (for the deferred write)
+static unsigned long timer_write = 0;
 
-// internal routines
-static void process_theRTC_readDate(void);
-static void process_theRTC_readTime(void);
-static inline int adjust(const int value, const int min, const int max, const bool increment);
+// INT/SQW falling edges counted by the interrupt, millis() and micros() of the last one
+static volatile uint32_t edges = 0;
+static volatile unsigned long edge_millis = 0;
+static volatile unsigned long edge_micros = 0;
 
-//----------------------------------------------------------
+// the registers are read out and the software clock is set
+static bool bSynced = false;
+// the edges already handled
+static uint32_t edges_counted = 0;
+// millis() when the current second of the software clock has started
+static unsigned long second_millis = 0;
+// the hours register is in 12h mode (the alarm hours should be in the same mode)
+static bool bHours12 = false;
+// the software clock was adjusted: the write is restarted, it is pending till the keys are idle
+static bool bAdjusted = false;
+static bool bWritePending = false;
+// a transaction has failed: the registers are read out as soon as the bus is ready
+// (theData shows the failure till then)
+static bool bFailed = false;
 
-// time and date - we need it in order to adjust the values easily
+// the next due alarm of theAlarms, programmed into Alarm1 by the next process call
 static struct {
-  int year;
-  int month;
-  int day;
+  bool enabled;
   int dow;
   int hour;
   int minute;
-  int seconds;
-} myDateTime;
+  bool bPending;
+} alarm;
+
+static theRTC_stats_t stats;
+
+// internal routines
+static void int_edge(void);
+static bool process_theRTC_read(uint8_t *const raw);
+static void process_theRTC_sync(const uint32_t edges_before, const unsigned long millis_before, const bool bTicks);
+static bool process_theRTC_flags(const unsigned long micros_before);
+static void process_theRTC_minute(const unsigned long millis_before);
+static void process_theRTC_alarm(void);
+static void process_theRTC_write(void);
+static void report(void);
+static void set_clock(const int32_t days, const uint32_t time);
+static void set_date(const int year, const int month, const int day);
+static bool transaction(const bool bSucceeded);
+static inline int bcd(const uint8_t value, const uint8_t mask);
+static inline uint8_t to_bcd(const int value);
+static inline uint8_t to_hours(const int hour);
+static inline int adjust(const int value, const int min, const int max, const bool increment);
+static bool is_written(const uint8_t *const pRaw, const uint8_t *const pRegisters);
+
+//----------------------------------------------------------
+
+// the software clock: seconds since 2000-01-01 00:00:00 (theTime)
+static uint32_t seconds = 0;
 
 // initialization - called once at the device start
 void theRTC_init(void)
 {
   WIRE_RTC.begin();
   WIRE_RTC.setClock(SPEED_RTC);
+
+  // the output is open drain, active low; the alarm registers are programmed after the first read out
+  pinMode(RTC_INT, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(RTC_INT), int_edge, FALLING);
+  alarm.bPending = true;
 }
 
-static void process_theRTC_readDate(void)
+// interrupt - the alarm flag is set (the next minute has started)
+static void int_edge(void)
 {
-  // read the date from RTC
-  const int year = rtc.getYear();
-  bool century = false;
-  const int month = rtc.getMonth(century);
-  const int day = rtc.getDate();
-  const int dow = rtc.getDoW();
+  edge_millis = millis();
+  edge_micros = micros();
+  ++edges;
+}
 
-  // store the values for adjustments
-  myDateTime.year = year;
-  myDateTime.month = month;
-  myDateTime.day = day;
-  myDateTime.dow = dow;
+// theAlarms has the new next due alarm, it will be programmed into DS3231 by the next process call
+void theRTC_setAlarm(const bool enabled, const int dow, const int hour, const int minute)
+{
+  alarm.enabled = enabled;
+  alarm.dow = dow;
+  alarm.hour = hour;
+  alarm.minute = minute;
+  alarm.bPending = true;
+}
+
+// every transaction is counted; the failure is reported, and the bus is recovered
+// (the next transactions are backed off by theBus)
+static bool transaction(const bool bSucceeded)
+{
+  ++stats.transactions;
+  if ( bSucceeded )
+  {
+    theBus_succeeded(bus_rtc);
+    return true;
+  }
 
-  // report the readed out values to theDisplay
-  theData_reportRTC_date(year, month, day, dow);
+  ++stats.failures;
+  bFailed = true;
+  theData_reportRTC_failure();
+  theBus_failed(bus_rtc);
+  return false;
 }
 
-static void process_theRTC_readTime(void)
+static inline int bcd(const uint8_t value, const uint8_t mask)
 {
-  // read the time from RTC
-  bool h12, pm;
-  const int hr = rtc.getHour(h12, pm);
-  const int hour = ( h12 && pm && (hour != 12) ) ? (hr + 12) : hr;
-  const int minute = rtc.getMinute();
-  const int seconds = rtc.getSecond();
+  const uint8_t bits = value & mask;
+  return cTens[bits >> 4] + ( bits & 0x0F );
+}
 
-  // store the time for adjustments
-  myDateTime.hour = hour;
-  myDateTime.minute = minute;
-  myDateTime.seconds = seconds;
+static inline uint8_t to_bcd(const int value)
+{
+  return (uint8_t)( ( ( value / 10 ) << 4 ) | ( value % 10 ) );
+}
 
-  // report the readed out values to theDisplay
-  theData_reportRTC_time(hour, minute, seconds);
+// the hours register value in the mode the chip is in (12h or 24h)
+static inline uint8_t to_hours(const int hour)
+{
+  if ( ! bHours12 ) return to_bcd(hour);
+
+  const int hour12 = ( ( hour % 12 ) == 0 ) ? (12) : ( hour % 12 );
+  return HOURS_12H | ( ( hour >= 12 ) ? (HOURS_PM) : (0) ) | to_bcd(hour12);
 }
 
+// all the time and date registers are read by one I2C transaction (register address,
+// repeated start, 7 bytes), so the date and the time are of the same instant
+static bool process_theRTC_read(uint8_t *const raw)
+{
+  const unsigned long started = micros();
+  const unsigned int count = WIRE_RTC.requestFrom((uint8_t)ADDRESS_RTC, (uint8_t)reg_max, (uint32_t)reg_seconds, (uint8_t)1, (uint8_t)true);
+  for ( unsigned int i = 0; ( i < count ) && ( i < reg_max ); i++ )
+  {
+    raw[i] = WIRE_RTC.read();
+  }
+  stats.read_us = micros() - started;
+  if ( stats.read_us > stats.max_read_us ) stats.max_read_us = stats.read_us;
+  ++stats.reads;
+
+  // the bus or the chip does not respond
+  if ( ! transaction(count >= reg_max) ) return false;
+  bFailed = false;
+  theData_reportRTC_readout();
+
+  // the hours could be in 12h mode
+  int hour;
+  bHours12 = ( ( raw[reg_hours] & HOURS_12H ) != 0 );
+  if ( bHours12 )
+  {
+    hour = ( bcd(raw[reg_hours], HOURS_12H_BCD) % 12 ) + ( ( raw[reg_hours] & HOURS_PM ) ? (12) : (0) );
+  }
+  else
+  {
+    hour = bcd(raw[reg_hours], cRegisterBCD[reg_hours]);
+  }
+
+  // the software clock is set to the read out instant
+  const int32_t days = theTime_daysFromCivil(TIME_EPOCH_YEAR + bcd(raw[reg_year], cRegisterBCD[reg_year]),
+                                             bcd(raw[reg_month], cRegisterBCD[reg_month]),
+                                             bcd(raw[reg_date], cRegisterBCD[reg_date]));
+  seconds = theTime_seconds(days, hour, bcd(raw[reg_minutes], cRegisterBCD[reg_minutes]), bcd(raw[reg_seconds], cRegisterBCD[reg_seconds]));
+
+  // the day of week is computed, the register is corrected (DS3231 Alarm1 matches it);
+  // if the write fails, it is corrected by the next read out
+  const int dow = theTime_dayOfWeek(days);
+  if ( bcd(raw[reg_dow], cRegisterBCD[reg_dow]) != dow )
+  {
+    WIRE_RTC.beginTransmission(ADDRESS_RTC);
+    WIRE_RTC.write(reg_dow);
+    WIRE_RTC.write((uint8_t)dow);
+    transaction(WIRE_RTC.endTransmission() == 0);
+  }
+
+  return true;
+}
+
+// report the software clock to theData
+static void report(void)
+{
+  const int32_t days = seconds / TIME_SECONDS_PER_DAY;
+  const uint32_t time = seconds % TIME_SECONDS_PER_DAY;
+  const theTime_date_t date = theTime_civilFromDays(days);
+
+  theData_reportRTC_date(date.year - TIME_EPOCH_YEAR, date.month, date.day, theTime_dayOfWeek(days));
+  theData_reportRTC_time(time / 3600, ( time / 60 ) % 60, time % 60, second_millis);
+}
+
+// read the registers out and set the software clock; the read out is valid only if there
+// was no edge during it (the registers could be updated in the middle), otherwise it is
+// repeated on the next call
+static void process_theRTC_sync(const uint32_t edges_before, const unsigned long millis_before, const bool bTicks)
+{
+  uint8_t raw[reg_max];
+  const uint32_t counted = seconds;
+  const bool bWasSynced = bSynced;
+
+  if ( ! process_theRTC_read(raw) ) return;
+  if ( edges != edges_before )
+  {
+    bSynced = false;
+    return;
+  }
+
+  bSynced = true;
+  edges_counted = edges_before;
+  if ( bTicks )
+  {
+    // the minute has started on the last edge
+    second_millis = millis_before + ( ( seconds % 60 ) * 1000UL );
+  }
+  else if ( ( ! bWasSynced ) || ( seconds != counted ) )
+  {
+    // no edges: the second has started before the read out, the phase is moved only when
+    // the RTC seconds differ from the counted ones, so it is free-running between the read outs
+    // (the flashing dot follows it)
+    second_millis = millis();
+  }
+  ++stats.syncs;
+  report();
+}
+
+// read the alarm flags and clear them (so INT/SQW pin goes high and is ready for the next edge),
+// 2 I2C transactions; Alarm1 flag is the armed alarm of theAlarms. Returns false if the flags
+// are not read or not cleared (they are read again when the bus is ready)
+static bool process_theRTC_flags(const unsigned long micros_before)
+{
+  const unsigned int count = WIRE_RTC.requestFrom((uint8_t)ADDRESS_RTC, (uint8_t)1, (uint32_t)REG_STATUS, (uint8_t)1, (uint8_t)true);
+  if ( ! transaction(count >= 1) ) return false;
+  const uint8_t status = WIRE_RTC.read();
+  if ( ( status & ( STATUS_A1F | STATUS_A2F ) ) == 0 ) return true;
+
+  // the rest of the status bits are kept
+  WIRE_RTC.beginTransmission(ADDRESS_RTC);
+  WIRE_RTC.write(REG_STATUS);
+  WIRE_RTC.write(status & ~( STATUS_A1F | STATUS_A2F ));
+  if ( ! transaction(WIRE_RTC.endTransmission() == 0) ) return false;
+
+  if ( status & STATUS_A1F )
+  {
+    theData_reportRTC_alarm();
+
+    // from the edge (or from the read out, if there is no edge) to the buzzer start
+    const unsigned long latency = micros() - micros_before;
+    ++stats.alarms;
+    stats.alarm_latency_us = latency;
+    if ( latency > stats.max_alarm_latency_us ) stats.max_alarm_latency_us = latency;
+  }
+  return true;
+}
+
+// the edge is ss=00 of the next minute: the software clock is aligned to it
+// (it is a bit ahead or behind by millis())
+static void process_theRTC_minute(const unsigned long millis_before)
+{
+  ++stats.minutes;
+  const uint32_t second = seconds % 60;
+  seconds += ( second >= 30 ) ? ( 60 - second ) : (0);
+  seconds -= ( seconds % 60 );
+  second_millis = millis_before;
+  report();
+}
+
+// program the next due alarm into Alarm1, the minute tick into Alarm2,
+// and enable the interrupts - all by one I2C transaction (registers 0x07...0x0E),
+// then read them back: the chip has really taken the alarm and the minute tick
+static void process_theRTC_alarm(void)
+{
+  const uint8_t registers[] = {
+    // Alarm1: seconds, minutes, hours and day of week are compared
+    0x00, to_bcd(alarm.minute), to_hours(alarm.hour), (uint8_t)( ALARM_DAY_OF_WEEK | alarm.dow ),
+    // Alarm2: minutes, hours, day/date are not compared - every minute
+    ALARM_MASK, ALARM_MASK, ALARM_MASK,
+    // control
+    (uint8_t)( CONTROL_INTCN | CONTROL_A2IE | ( (alarm.enabled) ? (CONTROL_A1IE) : (0) ) )
+  };
+
+  WIRE_RTC.beginTransmission(ADDRESS_RTC);
+  WIRE_RTC.write(REG_ALARM1);
+  WIRE_RTC.write(registers, sizeof(registers));
+  // the alarm is programmed again by the next call, if the write has failed
+  if ( ! transaction(WIRE_RTC.endTransmission() == 0) ) return;
+
+  uint8_t raw[sizeof(registers)];
+  const unsigned int count = WIRE_RTC.requestFrom((uint8_t)ADDRESS_RTC, (uint8_t)sizeof(raw), (uint32_t)REG_ALARM1, (uint8_t)1, (uint8_t)true);
+  if ( ! transaction(count >= sizeof(raw)) ) return;
+  for ( unsigned int i = 0; i < sizeof(raw); i++ ) raw[i] = WIRE_RTC.read();
+  raw[sizeof(raw) - 1] &= ~CONTROL_CONV;
+
+  // not programmed again, the next alarm change does it (the mismatch is seen in the statistics)
+  if ( memcmp(raw, registers, sizeof(raw)) != 0 ) ++stats.alarm_mismatches;
+  alarm.bPending = false;
+}
+
+// write the software clock into all the time and date registers by one I2C transaction, and read
+// them back: if the chip has not taken them, the software clock is set by the chip (the display
+// shows what the chip counts). The seconds are written too - otherwise the chip could carry
+// to the next minute between the adjustment and the write; writing them restarts the second
+// of the chip, so the software second is restarted as well. The write is pending till both
+// transactions succeed, so a failed one is repeated when theBus allows the retry
+static void process_theRTC_write(void)
+{
+  const int32_t days = seconds / TIME_SECONDS_PER_DAY;
+  const uint32_t time = seconds % TIME_SECONDS_PER_DAY;
+  const theTime_date_t date = theTime_civilFromDays(days);
+
+  const uint8_t registers[reg_max] = {
+    to_bcd(time % 60), to_bcd(( time / 60 ) % 60), to_hours(time / 3600), (uint8_t)theTime_dayOfWeek(days),
+    to_bcd(date.day), to_bcd(date.month), to_bcd(date.year - TIME_EPOCH_YEAR)
+  };
+
+  ++stats.writes;
+
+  WIRE_RTC.beginTransmission(ADDRESS_RTC);
+  WIRE_RTC.write(reg_seconds);
+  WIRE_RTC.write(registers, reg_max);
+  if ( ! transaction(WIRE_RTC.endTransmission() == 0) ) return;
+  second_millis = millis();
+
+  // not read back - written again (the software clock is still counted from the adjustment)
+  uint8_t raw[reg_max];
+  if ( ! process_theRTC_read(raw) ) return;
+  bWritePending = false;
+
+  // the read out has set the software clock to the chip time (the adjustment is reverted)
+  if ( ! is_written(raw, registers) )
+  {
+    ++stats.reverts;
+  }
+  report();
+}
+
+// the registers read back have the written values
+static bool is_written(const uint8_t *const pRaw, const uint8_t *const pRegisters)
+{
+  for ( unsigned int reg = 0; reg < reg_max; reg++ )
+  {
+    if ( ( pRaw[reg] ^ pRegisters[reg] ) & cRegisterWritten[reg] ) return false;
+  }
+  return true;
+}
+
+void theRTC_getStats(theRTC_stats_t *const pStats)
+{
+  *pStats = stats;
+}
 
 // periodic function, called pretty fast, so we have to take
 // care execute it with specific periodicy
 void theRTC_process(const unsigned long timestamp)
 {
-  // if the time since last execution exceeds specified period
-  if ( ( timestamp - timer ) >= PERIOD_RTC ) 
+  // the consistent copy of the interrupt counters
+  noInterrupts();
+  const uint32_t edges_now = edges;
+  const unsigned long millis_now = edge_millis;
+  const unsigned long micros_now = edge_micros;
+  interrupts();
+
+  // without the minute tick (not connected, no edge for a while) the registers and the flags are read out by PERIOD_RTC
+  const bool bTicks = ( edges_now != 0 ) && ( ( millis() - millis_now ) < PERIOD_RTC_TICK_LOST );
+
+  // the bus has failed - no transactions till the retry is due, the seconds are still counted
+  const bool bBus = theBus_isReady(bus_rtc);
+
+  // the alarm flags are set: the next minute has started (and maybe the alarm as well);
+  // the flags are cleared first of all, otherwise INT/SQW pin stays low and there is no next edge.
+  // The edge is handled only when the flags are cleared: if the bus has failed, it stays pending
+  // and the flags are read again as soon as the retry is due
+  if ( bBus && ( edges_now != edges_counted ) )
+  {
+    if ( process_theRTC_flags(micros_now) )
+    {
+      edges_counted = edges_now;
+      process_theRTC_minute(millis_now);
+    }
+    return;
+  }
+
+  // the software clock was adjusted - restart the idle timer before writing it to the chip
+  if ( bAdjusted )
+  {
+    bAdjusted = false;
+    bWritePending = true;
+    timer_write = timestamp;
+  }
+
+  // no more adjustments for a while - all of them are written at once
+  if ( bBus && bWritePending && ( ( timestamp - timer_write ) >= PERIOD_RTC_WRITE ) )
+  {
+    process_theRTC_write();
+    return;
+  }
+
+  // the alarm is programmed when the hours mode is known (after the read out)
+  if ( bBus && alarm.bPending && bSynced )
+  {
+    process_theRTC_alarm();
+    return;
+  }
+
+  // at start, after the failure, on the slow schedule - read the registers out
+  // (not while the adjustment is pending, the read out would revert it)
+  if ( bBus && ( ! bWritePending ) &&
+       ( ( ! bSynced ) || bFailed || ( ( timestamp - timer_sync ) >= PERIOD_RTC_SYNC ) ||
+         ( ( ! bTicks ) && ( ( timestamp - timer ) >= PERIOD_RTC ) ) ) )
   {
-    process_theRTC_readDate();
-    process_theRTC_readTime();
+    process_theRTC_sync(edges_now, millis_now, bTicks);
+    // (not if the day of week correction has just failed - theBus backs the retry off)
+    if ( bSynced && ( ! bTicks ) && theBus_isReady(bus_rtc) ) process_theRTC_flags(micros());
 
     // remember when the function was executed last time
     timer = timestamp;
+    timer_sync = timestamp;
+    return;
+  }
+
+  // between the edges (and while the adjustment is pending, or the read outs are failing)
+  // the seconds are counted by millis(), no bus traffic
+  if ( bSynced || bWritePending )
+  {
+    while ( ( millis() - second_millis ) >= 1000 )
+    {
+      second_millis += 1000;
+      ++seconds;
+      ++stats.ticks;
+      report();
+    }
   }
 }
 
@@ -101,50 +492,53 @@ static inline int adjust(const int value, const int min, const int max, const bo
   return (value > min) ? (value - 1) : (max);
 }
 
-// For the time/date adjustment, we will just change the value
-// in the RTC module, and then the new value will be read-out
-// from RTC module and presented on display
+// For the time/date adjustment, the software clock is changed and
+// presented on display right away; all the changes are written to
+// the RTC module together, when the keys are idle for PERIOD_RTC_WRITE
 
-void theRTC_adjust_year(const bool increment)
+static void set_clock(const int32_t days, const uint32_t time)
 {
-  rtc.setYear(adjust(myDateTime.year, 0, 99, increment));
+  seconds = theTime_seconds(days, 0, 0, 0) + time;
+  bAdjusted = true;
+  ++stats.adjustments;
+  report();
 }
 
-void theRTC_adjust_month(const bool increment)
+// the day is limited by the month length (31 January -> 28/29 February)
+static void set_date(const int year, const int month, const int day)
 {
-  rtc.setMonth(adjust(myDateTime.month, 1, 12, increment));
+  const int max = theTime_daysInMonth(TIME_EPOCH_YEAR + year, month);
+  const int valid_day = (day > max) ? (max) : (day);
+
+  set_clock(theTime_daysFromCivil(TIME_EPOCH_YEAR + year, month, valid_day), seconds % TIME_SECONDS_PER_DAY);
 }
 
-void theRTC_adjust_day(const bool increment)
+void theRTC_adjust_year(const bool increment)
 {
-  int max = 31; // most of months are 31 day
-
-  switch(myDateTime.month) {
-  case 2: // February - let's consider all the years to be leap
-    max = 29;
-    break;
-  case 4: // April     = 30 days
-  case 6: // June      = 30 days
-  case 9: // September = 30 days
-  case 11:// November  = 30 days
-    max = 30;
-    break;
-  }
+  const theTime_date_t date = theTime_civilFromDays(seconds / TIME_SECONDS_PER_DAY);
+  set_date(adjust(date.year - TIME_EPOCH_YEAR, 0, 99, increment), date.month, date.day);
+}
 
-  rtc.setDate(adjust(myDateTime.day, 1, max, increment));
+void theRTC_adjust_month(const bool increment)
+{
+  const theTime_date_t date = theTime_civilFromDays(seconds / TIME_SECONDS_PER_DAY);
+  set_date(date.year - TIME_EPOCH_YEAR, adjust(date.month, 1, 12, increment), date.day);
 }
 
-void theRTC_adjust_day_of_week(const bool increment)
+void theRTC_adjust_day(const bool increment)
 {
-  rtc.setDoW(adjust(myDateTime.dow, 1, 7, increment));
+  const theTime_date_t date = theTime_civilFromDays(seconds / TIME_SECONDS_PER_DAY);
+  set_date(date.year - TIME_EPOCH_YEAR, date.month, adjust(date.day, 1, theTime_daysInMonth(date.year, date.month), increment));
 }
 
 void theRTC_adjust_hour(const bool increment)
 {
-  rtc.setHour(adjust(myDateTime.hour, 0, 23, increment));
+  const uint32_t time = seconds % TIME_SECONDS_PER_DAY;
+  set_clock(seconds / TIME_SECONDS_PER_DAY, ( adjust(time / 3600, 0, 23, increment) * 3600UL ) + ( time % 3600 ));
 }
 
 void theRTC_adjust_minute(const bool increment)
 {
-  rtc.setMinute(adjust(myDateTime.minute, 0, 59, increment));
+  const uint32_t time = seconds % TIME_SECONDS_PER_DAY;
+  set_clock(seconds / TIME_SECONDS_PER_DAY, ( ( time / 3600 ) * 3600UL ) + ( adjust(( time / 60 ) % 60, 0, 59, increment) * 60UL ) + ( time % 60 ));
 }
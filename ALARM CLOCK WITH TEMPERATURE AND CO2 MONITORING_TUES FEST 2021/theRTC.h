@@ -4,15 +4,39 @@
 extern void theRTC_init(void);
 extern void theRTC_process(const unsigned long timestamp);
 
-// routines for adjusting the RTC (ds3231)
+// routines for adjusting the RTC (ds3231), the day of week is computed from the date;
+// the adjusted value is reported at once, it is written to the chip when the keys are idle
 // when 'increment' is true, we are incrementing,
 // when 'increment' is false, we are decrementing the value
 extern void theRTC_adjust_year(const bool increment);
 extern void theRTC_adjust_month(const bool increment);
 extern void theRTC_adjust_day(const bool increment);
-extern void theRTC_adjust_day_of_week(const bool increment);
 extern void theRTC_adjust_hour(const bool increment);
 extern void theRTC_adjust_minute(const bool increment);
 
+// theAlarms reports the next due alarm (dow 1...7), it is matched by DS3231 itself
+extern void theRTC_setAlarm(const bool enabled, const int dow, const int hour, const int minute);
+
+// RTC read out, the minute tick and the alarm statistics
+typedef struct {
+  uint32_t reads;               // time and date read outs
+  uint32_t syncs;               // read outs which have set the software clock
+  uint32_t minutes;             // minutes counted by the INT/SQW edges
+  uint32_t ticks;               // seconds counted by the software clock
+  uint32_t alarms;              // the alarms matched by DS3231
+  uint32_t alarm_latency_us;    // from the INT/SQW edge to the buzzer start, microseconds
+  uint32_t max_alarm_latency_us;// the longest alarm latency, microseconds
+  uint32_t transactions;        // I2C transactions of all the read outs (and the setup)
+  uint32_t failures;            // transactions without the answer (the bus is recovered by theBus)
+  uint32_t read_us;             // bus time of the last read out, microseconds
+  uint32_t max_read_us;         // the longest read out, microseconds
+  uint32_t adjustments;         // the time and date adjustments (key presses)
+  uint32_t writes;              // the adjustments written to the chip (coalesced, the retries too)
+  uint32_t reverts;             // the writes not taken by the chip (read back differs)
+  uint32_t alarm_mismatches;    // the alarm registers read back differ from the programmed ones (must be 0)
+} theRTC_stats_t;
+
+extern void theRTC_getStats(theRTC_stats_t *const pStats);
+
 
 #endif // __THE_CLOCK_THE_RTC_HEADER_INCLUDED_
@@ -0,0 +1,413 @@
+#include <Arduino.h>
+// Libraries: none
+// project includes
+#include "hwconfig.h"
+// own declarations
+#include "theSpeaker.h"
+
+// The clips are stored in flash as IMA-ADPCM (4 bits per sample, 1/4 of 16-bit PCM) and sent to
+// the DAC by PDC from two RAM buffers in turn. The DAC converts a sample on every TC0 channel 0
+// period (TIOA0 is the DACC trigger), so the CPU does not touch the samples. When PDC has sent
+// one buffer, it continues with the other one, and the interrupt (ENDTX) decodes the next
+// SPEAKER_BUFFER samples into the sent one and gives it back to PDC as the next buffer - once
+// per 32ms. The clip is followed by the silent gap (not stored) and repeated for PERIOD_ALARM.
+
+#if ( SPEAKER_DAC_CHANNEL > 1 )
+#error "DACC has the channels 0 (DAC0) and 1 (DAC1)"
+#endif
+
+#define DAC_MIDSCALE          (0x800)       // 12-bit DAC, the silence
+#define SAMPLES_CHANNEL       (0)           // TC0 channel 0, TIOA0 triggers the DAC
+#define DACC_TRIGGER_TIOA0    (1)           // DACC_MR TRGSEL of TIOA0
+#define ADPCM_INDEX_MAX       (88)
+
+// the clip: IMA-ADPCM samples (the low nibble first), the silent samples after them and the
+// decoder state of the first sample
+typedef struct {
+  const uint8_t *pData;
+  uint32_t samples;
+  uint32_t gap;
+  int16_t predictor;
+  uint8_t index;
+} clip_t;
+
+// IMA-ADPCM tables: the quantizer step of the index, and the index change of the code
+static const int16_t cSteps[ADPCM_INDEX_MAX + 1] = {
+  7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66,
+  73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449,
+  494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272,
+  2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493,
+  10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+static const int8_t cIndexes[16] = {
+  -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+// bell chime at 8kHz, 500ms: E5 (659Hz) with the partials 2.0 and 2.76, exponential decay
+static const uint8_t cChime[] = {
+  0x70, 0x77, 0x77, 0xF0, 0xDF, 0x99, 0x75, 0x85, 0x9B, 0x00, 0xCC, 0x28, 0x43, 0x24, 0xDB, 0x19,
+  0xD8, 0x1B, 0x36, 0x80, 0xA0, 0x9B, 0x90, 0x9D, 0x74, 0x81, 0x89, 0x98, 0x8A, 0x98, 0x61, 0x04,
+  0xAA, 0x00, 0xBA, 0x1A, 0x43, 0x34, 0xD8, 0x0A, 0xA0, 0x8E, 0x43, 0x01, 0x90, 0xBA, 0x00, 0xBD,
+  0x71, 0x03, 0x99, 0x90, 0xAA, 0xA8, 0x58, 0x27, 0xA9, 0x19, 0xA9, 0x8B, 0x32, 0x45, 0xB1, 0x8C,
+  0x91, 0xBC, 0x52, 0x22, 0x80, 0xBB, 0x08, 0xFA, 0x49, 0x15, 0x98, 0x88, 0x9A, 0x98, 0x1A, 0x47,
+  0xA0, 0x09, 0xA8, 0x9A, 0x10, 0x64, 0x92, 0xAB, 0x01, 0xCC, 0x38, 0x24, 0x01, 0xC9, 0x1A, 0xC8,
+  0x2C, 0x35, 0x90, 0x88, 0xAA, 0x99, 0x9B, 0x67, 0x81, 0x8A, 0x88, 0x9B, 0x08, 0x62, 0x04, 0xBA,
+  0x18, 0xD9, 0x19, 0x33, 0x23, 0xE8, 0x8A, 0xA1, 0x8E, 0x53, 0x01, 0x89, 0xA9, 0x89, 0xBA, 0x72,
+  0x06, 0x8A, 0x88, 0xA9, 0x08, 0x30, 0x27, 0xB9, 0x09, 0xB0, 0x8C, 0x43, 0x32, 0xB0, 0x9D, 0x81,
+  0xAD, 0x61, 0x02, 0x90, 0xA9, 0x09, 0xC9, 0x69, 0x14, 0xA8, 0x88, 0xA9, 0x99, 0x38, 0x47, 0xA0,
+  0x8A, 0x90, 0x9D, 0x31, 0x33, 0xA3, 0xAD, 0x00, 0xCC, 0x48, 0x14, 0x00, 0xB9, 0x0A, 0xB9, 0x2C,
+  0x47, 0x90, 0x89, 0xA8, 0x99, 0x09, 0x65, 0x81, 0x8B, 0x90, 0xAB, 0x38, 0x63, 0x03, 0xCB, 0x08,
+  0xD9, 0x2A, 0x35, 0x00, 0xA8, 0x9B, 0xB0, 0x8D, 0x65, 0x91, 0x88, 0x99, 0x99, 0x89, 0x72, 0x03,
+  0xBA, 0x00, 0xCB, 0x19, 0x52, 0x14, 0xC8, 0x09, 0xB8, 0x8C, 0x44, 0x11, 0xA0, 0x9B, 0x88, 0xAD,
+  0x72, 0x83, 0x98, 0xA8, 0x99, 0xA9, 0x78, 0x15, 0xA9, 0x08, 0xA9, 0x8A, 0x31, 0x36, 0xC1, 0x8A,
+  0xA0, 0xAC, 0x52, 0x13, 0x91, 0xBB, 0x08, 0xCD, 0x58, 0x14, 0x88, 0xA8, 0x99, 0xA9, 0x3A, 0x67,
+  0x98, 0x09, 0x98, 0x9A, 0x10, 0x54, 0x91, 0x9B, 0x91, 0xDB, 0x30, 0x24, 0x02, 0xCB, 0x09, 0xD9,
+  0x3A, 0x36, 0x90, 0x98, 0xAA, 0xA8, 0x8B, 0x67, 0x91, 0x89, 0x98, 0x9A, 0x08, 0x73, 0x83, 0xBA,
+  0x00, 0xCB, 0x2A, 0x25, 0x13, 0xC9, 0x8A, 0xC0, 0x0C, 0x54, 0x81, 0x88, 0xAA, 0x88, 0xAB, 0x73,
+  0x05, 0x8A, 0x98, 0xA9, 0x98, 0x61, 0x14, 0xB9, 0x08, 0xB9, 0x0C, 0x43, 0x33, 0xC0, 0x8C, 0x90,
+  0x9D, 0x52, 0x12, 0x88, 0xBA, 0x88, 0xCB, 0x78, 0x14, 0xA8, 0x88, 0x9A, 0x99, 0x38, 0x47, 0xA0,
+  0x8A, 0xA0, 0x9C, 0x31, 0x44, 0x91, 0x9C, 0x80, 0xCB, 0x40, 0x24, 0x80, 0xAA, 0x8A, 0xC9, 0x3A,
+  0x57, 0x88, 0x89, 0x99, 0x99, 0x19, 0x55, 0x91, 0x8A, 0x98, 0xAB, 0x38, 0x54, 0x03, 0xAC, 0x08,
+  0xDA, 0x29, 0x25, 0x01, 0xB8, 0x8B, 0xB8, 0x0E, 0x45, 0x81, 0x99, 0xA8, 0x99, 0x9A, 0x74, 0x83,
+  0x9A, 0x88, 0xAB, 0x09, 0x73, 0x23, 0xCA, 0x09, 0xC8, 0x1B, 0x34, 0x23, 0xB8, 0x9D, 0xA0, 0xAC,
+  0x64, 0x02, 0x89, 0xA9, 0x99, 0xB9, 0x71, 0x15, 0xA9, 0x88, 0xA9, 0x89, 0x31, 0x37, 0xB8, 0x8A,
+  0xB0, 0x9D, 0x43, 0x23, 0xA1, 0xAC, 0x88, 0xCC, 0x51, 0x14, 0x98, 0xA8, 0x8A, 0xB9, 0x59, 0x36,
+  0xA8, 0x89, 0xA9, 0x9A, 0x38, 0x47, 0x91, 0x9B, 0x90, 0xAC, 0x30, 0x35, 0x82, 0xCB, 0x09, 0xDA,
+  0x39, 0x26, 0x81, 0xA9, 0x9A, 0xB8, 0x1B, 0x67, 0x91, 0x89, 0xA8, 0x99, 0x09, 0x64, 0x82, 0xAA,
+  0x80, 0xBB, 0x29, 0x45, 0x12, 0xC9, 0x0A, 0xC8, 0x0B, 0x36, 0x02, 0x99, 0xAB, 0xA8, 0xAC, 0x75,
+  0x01, 0x99, 0x98, 0x99, 0x99, 0x62, 0x14, 0xB9, 0x88, 0xB9, 0x0B, 0x44, 0x24, 0xB8, 0x8B, 0xB8,
+  0x9E, 0x63, 0x02, 0x90, 0xAA, 0x98, 0xBB, 0x71, 0x06, 0x98, 0x88, 0x9A, 0x89, 0x48, 0x35, 0xB8,
+  0x89, 0xB8, 0x9C, 0x41, 0x44, 0x90, 0x9B, 0x88, 0xAD, 0x50, 0x23, 0x80, 0xBA, 0x0A, 0xDB, 0x49,
+  0x17, 0x80, 0x99, 0x99, 0x99, 0x2A, 0x47, 0x90, 0x99, 0xA0, 0xAA, 0x28, 0x45, 0x83, 0xAC, 0x80,
+  0xCA, 0x39, 0x25, 0x02, 0xC9, 0x89, 0xB9, 0x1C, 0x37, 0x91, 0x98, 0x9A, 0x9A, 0x8A, 0x75, 0x82,
+  0x8A, 0x98, 0xBA, 0x08, 0x73, 0x13, 0xBA, 0x09, 0xDA, 0x1A, 0x34, 0x14, 0xB8, 0x9B, 0xB8, 0x9D,
+  0x45, 0x83, 0x98, 0xAA, 0x99, 0xAB, 0x72, 0x07, 0x98, 0x98, 0x99, 0x89, 0x31, 0x27, 0xA9, 0x89,
+  0xA8, 0x8C, 0x42, 0x33, 0xB1, 0xAC, 0x90, 0xAD, 0x61, 0x13, 0x90, 0xAA, 0x8A, 0xCA, 0x58, 0x26,
+  0x98, 0x89, 0xAA, 0x99, 0x38, 0x47, 0x90, 0x9A, 0xA0, 0xAB, 0x40, 0x35, 0x81, 0xBB, 0x89, 0xEB,
+  0x38, 0x26, 0x81, 0xB9, 0x8A, 0xB9, 0x2B, 0x67, 0x91, 0x89, 0x99, 0xA9, 0x08, 0x55, 0x92, 0x9A,
+  0x88, 0xBB, 0x39, 0x45, 0x03, 0xCA, 0x09, 0xCA, 0x1A, 0x36, 0x02, 0xA9, 0x9B, 0xA9, 0x8D, 0x55,
+  0x82, 0x99, 0xA8, 0x9A, 0x8A, 0x73, 0x05, 0xA9, 0x88, 0xB9, 0x09, 0x62, 0x23, 0xB9, 0x8B, 0xC8,
+  0x8C, 0x44, 0x22, 0xA8, 0xAB, 0x98, 0xAD, 0x72, 0x13, 0x99, 0x99, 0xAA, 0xA9, 0x70, 0x15, 0x98,
+  0x89, 0xB9, 0x9A, 0x42, 0x35, 0xB1, 0x9B, 0xA8, 0x9E, 0x41, 0x33, 0x91, 0xCB, 0x89, 0xDB, 0x58,
+  0x24, 0x80, 0x9A, 0xAA, 0xA9, 0x4A, 0x47, 0x90, 0x99, 0xA8, 0xAA, 0x20, 0x46, 0x81, 0x9B, 0x98,
+  0xCB, 0x38, 0x26, 0x02, 0xBA, 0x8A, 0xCA, 0x3B, 0x47, 0x00, 0x99, 0x9A, 0xA9, 0x0A, 0x47, 0x92,
+  0x99, 0xA8, 0xAA, 0x19, 0x64, 0x03, 0xBA, 0x88, 0xCB, 0x1A, 0x45, 0x12, 0xB8, 0x8B, 0xC9, 0x8B,
+  0x46, 0x02, 0x98, 0xAA, 0x9A, 0xAB, 0x74, 0x04, 0x99, 0x98, 0xAA, 0x89, 0x61, 0x15, 0xA8, 0x89,
+  0xB9, 0x8B, 0x63, 0x33, 0xB0, 0x9C, 0x98, 0x9D, 0x61, 0x12, 0x80, 0xBA, 0x99, 0xBA, 0x70, 0x15,
+  0x90, 0x99, 0xA9, 0x9A, 0x48, 0x36, 0xA0, 0x8A, 0xA9, 0x9C, 0x40, 0x44, 0x91, 0xBA, 0x88, 0xBC,
+  0x40, 0x25, 0x81, 0xB9, 0x9A, 0xC9, 0x3A, 0x47, 0x91, 0x99, 0xA9, 0xA9, 0x29, 0x56, 0x81, 0x9A,
+  0x98, 0xBB, 0x38, 0x55, 0x02, 0xBA, 0x89, 0xDA, 0x19, 0x26, 0x02, 0xA9, 0x9A, 0xB9, 0x0C, 0x46,
+  0x82, 0x99, 0xA9, 0xA9, 0x8A, 0x74, 0x03, 0xA9, 0x89, 0xBB, 0x0A, 0x64, 0x23, 0xB9, 0x9A, 0xC9,
+  0x8B, 0x45, 0x23, 0xA8, 0x9C, 0x99, 0xAC, 0x73, 0x13, 0x89, 0xAA, 0xA9, 0xAA, 0x71, 0x15, 0x98,
+  0x99, 0xA9, 0x9A, 0x51, 0x25, 0xA0, 0x9A, 0xA8, 0x9D, 0x51, 0x23, 0x91, 0xBB, 0x99, 0xCC, 0x50,
+  0x15, 0x80, 0x9A, 0xA9, 0xA9, 0x49, 0x27, 0x90, 0x89, 0xA9, 0x9B, 0x38, 0x37, 0x92, 0x9B, 0x99,
+  0xBC, 0x48, 0x35, 0x82, 0xCA, 0x89, 0xCA, 0x39, 0x36, 0x01, 0xAA, 0xAA, 0xB9, 0x1B, 0x77, 0x81,
+  0x99, 0x98, 0x9A, 0x19, 0x73, 0x02, 0xAA, 0x88, 0xBB, 0x19, 0x55, 0x12, 0xB9, 0x8A, 0xC9, 0x0B,
+  0x55, 0x02, 0xA8, 0x9A, 0xA9, 0x9B, 0x74, 0x03, 0xA8, 0x99, 0xBA, 0x8A, 0x73, 0x15, 0x99, 0x99,
+  0xB9, 0x8A, 0x63, 0x14, 0xA0, 0x8B, 0xA9, 0x9C, 0x72, 0x22, 0x98, 0xAA, 0x99, 0xBB, 0x71, 0x15,
+  0x90, 0x99, 0xAA, 0xA9, 0x50, 0x35, 0xA0, 0x9A, 0xA9, 0x9C, 0x31, 0x37, 0x90, 0xAA, 0xA8, 0xCB,
+  0x50, 0x24, 0x81, 0xBA, 0x99, 0xCB, 0x49, 0x27, 0x80, 0x99, 0xA9, 0x9A, 0x29, 0x47, 0x81, 0x9A,
+  0x99, 0xAB, 0x28, 0x46, 0x02, 0xAB, 0x89, 0xDB, 0x29, 0x35, 0x03, 0xBA, 0xAA, 0xD9, 0x1A, 0x46,
+  0x82, 0x99, 0x9A, 0xAA, 0x8A, 0x56, 0x83, 0xA9, 0xA8, 0xBA, 0x1A, 0x64, 0x04, 0xB8, 0x89, 0xC9,
+  0x0A, 0x44, 0x13, 0xA8, 0xAB, 0xB9, 0x8D, 0x73, 0x03, 0x98, 0x9A, 0xAA, 0xAA, 0x72, 0x15, 0x98,
+  0x99, 0xB9, 0x8A, 0x61, 0x24, 0xA0, 0x9A, 0xB9, 0x9C, 0x52, 0x24, 0xA1, 0xBA, 0xA8, 0xBC, 0x71,
+  0x23, 0x80, 0xBA, 0x9A, 0xBB, 0x78, 0x25, 0x90, 0x99, 0xB9, 0xAA, 0x30, 0x57, 0x91, 0x9A, 0x98,
+  0xAB, 0x48, 0x44, 0x01, 0xAB, 0x99, 0xCB, 0x49, 0x35, 0x01, 0xAA, 0x9B, 0xCA, 0x2A, 0x47, 0x81,
+  0x99, 0xA9, 0xAA, 0x08, 0x56, 0x82, 0xA9, 0x89, 0xBB, 0x29, 0x55, 0x12, 0xB9, 0x9A, 0xCA, 0x1A,
+  0x36, 0x13, 0xB9, 0xAB, 0xC9, 0x8B, 0x56, 0x03, 0x99, 0xAA, 0xAA, 0x8A, 0x73, 0x15, 0x99, 0x99,
+  0xB9, 0x8A, 0x73, 0x23, 0xB8, 0x9A, 0xB9, 0x8D, 0x62, 0x13, 0x90, 0xAB, 0xA9, 0xAC, 0x72, 0x14,
+  0x98, 0x99, 0xAA, 0xA9, 0x51, 0x26, 0x98, 0x99, 0xB9, 0x9A, 0x41, 0x36, 0x90, 0x9B, 0xA9, 0xAC,
+  0x51, 0x24, 0x81, 0xBA, 0x9A, 0xCB, 0x58, 0x35, 0x80, 0xAA, 0xAA, 0xAA, 0x39, 0x67, 0x91, 0x99,
+  0xA8, 0x9A, 0x28, 0x45, 0x82, 0xAA, 0x99, 0xCB, 0x39, 0x36, 0x03, 0xBA, 0x9B, 0xCB, 0x2B, 0x57,
+  0x01, 0x99, 0x9A, 0x9A, 0x0A, 0x65, 0x82, 0x99, 0x99, 0xAA, 0x1A, 0x54, 0x04, 0xA9, 0x99, 0xC9,
+  0x09, 0x44, 0x13, 0xB8, 0x9B, 0xBA, 0x8D, 0x64, 0x02, 0xA0, 0xA9, 0x9A, 0x9B, 0x73, 0x05, 0x98,
+  0x89, 0xAA, 0x8A, 0x52, 0x25, 0xA8, 0x8A, 0xAA, 0x8C, 0x52, 0x33, 0xA1, 0xAC, 0xA9, 0xBB, 0x72,
+  0x15, 0x80, 0xAA, 0x99, 0xBA, 0x60, 0x25, 0x88, 0x9A, 0xA9, 0xAA, 0x40, 0x36, 0x91, 0x9B, 0xB9,
+  0xBB, 0x60, 0x34, 0x82, 0xBB, 0xA9, 0xCC, 0x48, 0x25, 0x82, 0xAA, 0xAA, 0xBA, 0x4A, 0x37, 0x82,
+  0xAA, 0xB9, 0xBA, 0x29, 0x57, 0x82, 0xA9, 0x99, 0xBB, 0x28, 0x55, 0x03, 0xAA, 0x9A, 0xDA, 0x19,
+  0x35, 0x13, 0xB9, 0xAB, 0xCA, 0x0B, 0x56, 0x03, 0xA9, 0xA9, 0xBA, 0x8A, 0x65, 0x13, 0xA9, 0x9A,
+  0xCA, 0x89, 0x73, 0x13, 0xA8, 0x9A, 0xBA, 0x8C, 0x44, 0x14, 0xA0, 0xAA, 0xA9, 0x9C, 0x72, 0x13,
+  0x90, 0xAA, 0xBA, 0xAA, 0x72, 0x25, 0x98, 0x9A, 0xA9, 0x9B, 0x61, 0x24, 0xA1, 0xAA, 0xA9, 0xAC,
+  0x52, 0x24, 0x81, 0xBB, 0xA9, 0xCB, 0x50, 0x35, 0x80, 0xAA, 0xAA, 0xAB, 0x59, 0x36, 0x81, 0xAA,
+  0xB9, 0xBB, 0x30, 0x57, 0x82, 0xAA, 0x99, 0xBB, 0x48, 0x35, 0x83, 0xBA, 0xAA, 0xDB, 0x29, 0x37,
+  0x82, 0xA9, 0xAA, 0xBA, 0x1A, 0x57, 0x02, 0x9A, 0xA9, 0xBA, 0x19, 0x55, 0x13, 0xAA, 0x9A, 0xCB,
+  0x1A, 0x45, 0x23, 0xB9, 0x9B, 0xCA, 0x0B, 0x55, 0x13, 0xA8, 0xAB, 0xAA, 0x8C, 0x73, 0x14, 0x99,
+  0x99, 0xAA, 0x8A, 0x72, 0x23, 0xA8, 0x9A, 0xCA, 0x8B, 0x63, 0x24, 0xA0, 0xAA, 0xB9, 0x9C, 0x62,
+  0x14, 0x80, 0xAA, 0xAA, 0xBA, 0x71, 0x24, 0x90, 0xA9, 0xAA, 0x9B, 0x50, 0x36, 0x90, 0x9A, 0xAA,
+  0xAB, 0x50, 0x35, 0x92, 0xAB, 0x9A, 0xAD, 0x40, 0x44, 0x81, 0xAA, 0x9A, 0xBB, 0x48, 0x37, 0x81,
+  0x9A, 0xBA, 0xAA, 0x29, 0x57, 0x01, 0x9A, 0xA9, 0xAA, 0x29, 0x46, 0x02, 0xAA, 0x99, 0xCB, 0x29,
+  0x45, 0x12, 0xB9, 0xAA, 0xBA, 0x1B, 0x57, 0x02, 0x99, 0xAA, 0xAA, 0x0A, 0x65, 0x12, 0xA9, 0x99,
+  0xBB, 0x09, 0x64, 0x23, 0xA9, 0x9B, 0xCA, 0x0B, 0x54, 0x23, 0xB0, 0xAB, 0xBA, 0x8D, 0x73, 0x13,
+  0x98, 0xAA, 0xBA, 0xAA, 0x73, 0x25, 0x98, 0x9A, 0xAA, 0x9A, 0x61, 0x34, 0xA0, 0xAA, 0xB9, 0x9C,
+  0x61, 0x33, 0x91, 0xBB, 0xAA, 0xAD, 0x51, 0x25, 0x80, 0xAA, 0x9A, 0xAB, 0x58, 0x36, 0x80, 0x9A,
+  0xBA, 0xAB, 0x40, 0x46, 0x81, 0xAA, 0x99, 0xBB, 0x48, 0x36, 0x01, 0xBA, 0xA9, 0xCB, 0x39, 0x37,
+  0x02, 0xAA, 0xBA, 0xBA, 0x2A, 0x67, 0x01, 0x99, 0xA9, 0xAA, 0x19, 0x55, 0x02, 0xA9, 0xA9, 0xBA,
+  0x2A, 0x55, 0x13, 0xB9, 0xAA, 0xCA, 0x0A, 0x46, 0x12, 0xA8, 0xBA, 0xB9, 0x8B, 0x65, 0x13, 0xA8,
+  0xAA, 0xBA, 0x8B, 0x74, 0x23, 0x99, 0xAA, 0xCA, 0x8A, 0x63, 0x24, 0xA8, 0x9A, 0xB9, 0x8C, 0x62,
+  0x23, 0x90, 0xAB, 0xAB, 0x9C, 0x71, 0x14, 0x90, 0xA9, 0xAA, 0x9A, 0x60, 0x34, 0x90, 0x9A, 0xBA,
+  0x9C, 0x50, 0x34, 0x92, 0xBB, 0xB9, 0xAC, 0x50, 0x35, 0x81, 0xBA, 0xAA, 0xBB, 0x69, 0x35, 0x81,
+  0xB9, 0xAA, 0xBB, 0x49, 0x47, 0x81, 0xA9, 0xA9, 0xAA, 0x39, 0x46, 0x02, 0xAA, 0x9A, 0xCB, 0x29,
+  0x36, 0x03, 0xB9, 0xAB, 0xCA, 0x1A, 0x47, 0x02, 0xA9, 0xA9, 0xAB, 0x0A, 0x56, 0x12, 0xA9, 0xA9,
+  0xAB, 0x0A, 0x55, 0x23, 0xB9, 0x9A, 0xCB, 0x0A, 0x54, 0x14, 0xA8, 0x9A, 0xBA, 0x8B, 0x74, 0x22,
+  0x98, 0xAA, 0xBA, 0x9A, 0x73, 0x15, 0x98, 0x99, 0xAA, 0x8B, 0x62, 0x24, 0xA0, 0x9A, 0xBA, 0x9B,
+  0x72, 0x24, 0x90, 0xAA, 0xAA, 0xAB, 0x71, 0x24, 0x80, 0xAA, 0xAA, 0xAB, 0x60, 0x25, 0x91, 0xA9,
+  0xBA, 0xAA, 0x58, 0x36, 0x91, 0x9A, 0xAA, 0xAC, 0x30, 0x37, 0x81, 0xB9, 0xA9, 0xCB, 0x38, 0x37,
+  0x01, 0xAA, 0xAA, 0xBA, 0x3A, 0x57, 0x01, 0x99, 0xAA, 0xAA, 0x19, 0x46, 0x03, 0xAA, 0xA9, 0xAC,
+  0x19, 0x55, 0x02, 0xA8, 0xAA, 0xBA, 0x1A, 0x46, 0x13, 0xA9, 0xAB, 0xCA, 0x0A, 0x55, 0x03, 0x98,
+  0xAB, 0xBA, 0x0B, 0x74, 0x23, 0x99, 0xAA, 0xBB, 0x8B, 0x74, 0x23, 0xA8, 0xAA, 0xBA, 0x8C, 0x63,
+  0x14, 0x90, 0xAA, 0xAA, 0xAB, 0x73, 0x24, 0x90, 0xAA, 0xBA, 0xAA, 0x62, 0x35, 0xA0, 0xA9, 0xBA,
+  0x9B, 0x61, 0x44, 0x80, 0xAA, 0xAA, 0xAB, 0x61, 0x34, 0x91, 0xAA, 0xAB, 0xBB, 0x68, 0x26, 0x81,
+  0xA9, 0xBA, 0xAA, 0x38, 0x57, 0x81, 0xA9, 0xA9, 0xAA, 0x38, 0x46, 0x01, 0x9A, 0xAA, 0xBB, 0x38,
+  0x47, 0x01, 0xB8, 0x9A, 0xBB, 0x29, 0x47, 0x02, 0xA9, 0xAA, 0xBA, 0x19, 0x56, 0x02, 0xA8, 0xAA,
+  0xBA, 0x1A, 0x65, 0x12, 0xA8, 0xAA, 0xCA, 0x09, 0x54, 0x22, 0xA8, 0xAB, 0xBA, 0x0C, 0x54, 0x23,
+  0xA8, 0xBA, 0xBB, 0x9B, 0x74, 0x14, 0x90, 0xAA, 0xBA, 0x8A, 0x72, 0x24, 0x98, 0x9A, 0xBA, 0x8B,
+  0x72, 0x33, 0x90, 0xBB, 0xBA, 0xAC, 0x72, 0x33, 0x91, 0xBB, 0xBA, 0xAC, 0x61, 0x25, 0x80, 0xAA,
+  0xAA, 0x9B, 0x50, 0x35, 0x81, 0xBA, 0xBA, 0xBB, 0x60, 0x35, 0x92, 0xAA, 0xBA, 0xCB, 0x48, 0x36,
+  0x01, 0xAA, 0xAB, 0xCA, 0x38, 0x46, 0x01, 0xA9, 0xAA, 0xAB, 0x29, 0x47, 0x02, 0xA9, 0xAA, 0xBB,
+  0x29, 0x47, 0x02, 0xA9, 0x9A, 0xBB, 0x2A, 0x56, 0x02, 0xA8, 0xAA, 0xBA, 0x0A, 0x56, 0x12, 0xA8,
+  0xAA, 0xAB, 0x0B, 0x65, 0x13, 0x99, 0xAA, 0xBB, 0x0A, 0x64, 0x23, 0xB0, 0xBA, 0xCA, 0x8B, 0x64,
+  0x23, 0x98, 0xAB, 0xAB, 0x9C, 0x73, 0x23, 0x90, 0xAB, 0xBB, 0x9B, 0x72, 0x16, 0x90, 0x99, 0xAA,
+  0x9A, 0x51, 0x25, 0x90, 0xA9, 0xAA, 0x9C, 0x41, 0x25, 0x81, 0xAA, 0xBA, 0xBB, 0x61, 0x25, 0x81,
+  0xB9, 0xAA, 0xBB, 0x58, 0x36, 0x81, 0xA9, 0xAB, 0x9C, 0x38, 0x46, 0x82, 0xAA, 0xB9, 0xAB, 0x38,
+  0x47, 0x82, 0xA9, 0xAA, 0xBA, 0x29, 0x47, 0x02, 0xA9, 0xAA, 0xAB, 0x2A, 0x47, 0x02, 0x99, 0xBA,
+};
+
+static const clip_t cClips[speaker_clip_max] = {
+  { cChime, sizeof(cChime) * 2, SPEAKER_SAMPLE_RATE / 2, 0, 0 },    // speaker_clip_chime
+};
+
+// PDC buffers, the one sent last is decoded next
+static uint16_t buffers[2][SPEAKER_BUFFER];
+static unsigned int next_buffer = 0;
+
+// the clip is played (the interrupt decodes the buffers), the DAC is running
+static volatile bool bPlaying = false;
+static bool bRunning = false;
+
+// the decoder state: the clip, the sample of the clip (the gap follows the clip samples),
+// the predicted sample and the step index, and the samples till the end of the alarm
+static const clip_t *pClip = &(cClips[speaker_clip_chime]);
+static uint32_t position = 0;
+static int32_t predictor = 0;
+static int32_t step_index = 0;
+static uint32_t left = 0;
+
+// CYCCNT of the last interrupt, the interrupt cycles and all the cycles since the start
+static uint32_t last_cycles = 0;
+static uint64_t busy_cycles = 0;
+static uint64_t elapsed_cycles = 0;
+
+static theSpeaker_stats_t stats;
+
+// internal routines
+static unsigned int decode(uint16_t *const pBuffer);
+static unsigned int prime(void);
+
+//----------------------------------------------------------
+
+// initialization - called once at the device start
+void theSpeaker_init(void)
+{
+  // the samples clock: TIOA0 is cleared by RA compare and set by RC compare (the period)
+  pmc_enable_periph_clk(ID_TC0);
+  TC0->TC_CHANNEL[SAMPLES_CHANNEL].TC_CMR = TC_CMR_TCCLKS_TIMER_CLOCK1 | TC_CMR_WAVE | TC_CMR_WAVSEL_UP_RC |
+                                       TC_CMR_ACPA_CLEAR | TC_CMR_ACPC_SET;
+  TC0->TC_CHANNEL[SAMPLES_CHANNEL].TC_RC = ( VARIANT_MCK / 2 ) / SPEAKER_SAMPLE_RATE;
+  TC0->TC_CHANNEL[SAMPLES_CHANNEL].TC_RA = ( VARIANT_MCK / 4 ) / SPEAKER_SAMPLE_RATE;
+
+  // the DAC converts the half-words written by PDC on the trigger
+  pmc_enable_periph_clk(ID_DACC);
+  DACC->DACC_CR = DACC_CR_SWRST;
+  DACC->DACC_MR = DACC_MR_TRGEN_EN | DACC_MR_TRGSEL(DACC_TRIGGER_TIOA0) | ( SPEAKER_DAC_CHANNEL << DACC_MR_USER_SEL_Pos ) |
+                  DACC_MR_REFRESH(8) | DACC_MR_STARTUP_1024;
+  DACC->DACC_IDR = 0xFFFFFFFF;
+  DACC->DACC_CHER = ( 1 << SPEAKER_DAC_CHANNEL );
+  NVIC_EnableIRQ(DACC_IRQn);
+
+  // the cycles of the interrupt are counted for the statistics
+  if ( STATS_ENABLED )
+  {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  }
+}
+
+// decode the next samples of the alarm into the buffer, returns the samples count (0 - the end)
+static unsigned int decode(uint16_t *const pBuffer)
+{
+  const unsigned int count = ( left < SPEAKER_BUFFER ) ? (left) : (SPEAKER_BUFFER);
+  left -= count;
+
+  for ( unsigned int i = 0; i < count; i++ )
+  {
+    if ( position < pClip->samples )
+    {
+      const unsigned int code = ( pClip->pData[position >> 1] >> ( ( position & 1 ) << 2 ) ) & 0x0F;
+      const int32_t step = cSteps[step_index];
+
+      int32_t difference = step >> 3;
+      if ( code & 4 ) difference += step;
+      if ( code & 2 ) difference += step >> 1;
+      if ( code & 1 ) difference += step >> 2;
+      predictor += ( code & 8 ) ? ( -difference ) : (difference);
+      if ( predictor > 32767 ) predictor = 32767;
+      if ( predictor < -32768 ) predictor = -32768;
+
+      step_index += cIndexes[code];
+      if ( step_index < 0 ) step_index = 0;
+      if ( step_index > ADPCM_INDEX_MAX ) step_index = ADPCM_INDEX_MAX;
+
+      // 16-bit signed to 12-bit DAC
+      pBuffer[i] = ( predictor + 32768 ) >> 4;
+    }
+    else
+    {
+      pBuffer[i] = DAC_MIDSCALE;
+    }
+
+    // the end of the gap - the clip again
+    if ( ++position >= ( pClip->samples + pClip->gap ) )
+    {
+      position = 0;
+      predictor = pClip->predictor;
+      step_index = pClip->index;
+    }
+  }
+  return count;
+}
+
+// both buffers are decoded ahead and given to PDC (the current and the next one),
+// returns the samples count of the first one (0 - the end)
+static unsigned int prime(void)
+{
+  const unsigned int first = decode(buffers[0]);
+  const unsigned int second = decode(buffers[1]);
+
+  // writing the counters clears ENDTX and TXBUFE
+  DACC->DACC_TPR = (uint32_t)(uintptr_t)buffers[0];
+  DACC->DACC_TCR = first;
+  DACC->DACC_TNPR = (uint32_t)(uintptr_t)buffers[1];
+  DACC->DACC_TNCR = second;
+  next_buffer = 0;
+  return first;
+}
+
+// PDC has sent the buffer and continues with the next one - the sent one is decoded again
+void DACC_Handler(void)
+{
+  const uint32_t status = DACC->DACC_ISR;
+  if ( ( ! bPlaying ) || ( ( status & DACC_ISR_ENDTX ) == 0 ) ) return;
+
+  const uint32_t started = (STATS_ENABLED) ? (DWT->CYCCNT) : (0);
+
+  unsigned int count;
+  if ( status & DACC_ISR_TXBUFE )
+  {
+    // the next buffer is sent too, the interrupt has come too late: PDC has stopped,
+    // it is restarted with both buffers decoded again
+    ++stats.underruns;
+    count = prime();
+  }
+  else
+  {
+    count = decode(buffers[next_buffer]);
+    if ( count > 0 )
+    {
+      // writing the counter clears ENDTX
+      DACC->DACC_TNPR = (uint32_t)(uintptr_t)buffers[next_buffer];
+      DACC->DACC_TNCR = count;
+      next_buffer ^= 1;
+    }
+  }
+
+  if ( count > 0 )
+  {
+    ++stats.buffers;
+  }
+  else
+  {
+    // the end of the alarm - the last buffer is being sent, the DAC is stopped by the main loop
+    DACC->DACC_IDR = DACC_IDR_ENDTX;
+    bPlaying = false;
+  }
+
+  if ( STATS_ENABLED )
+  {
+    const uint32_t now = DWT->CYCCNT;
+    stats.decode_cycles = now - started;
+    if ( stats.decode_cycles > stats.max_decode_cycles ) stats.max_decode_cycles = stats.decode_cycles;
+    busy_cycles += stats.decode_cycles;
+    elapsed_cycles += now - last_cycles;
+    last_cycles = now;
+    stats.load_ppm = ( busy_cycles * 1000000ULL ) / elapsed_cycles;
+  }
+}
+
+// the routine to play the clip - it is repeated for PERIOD_ALARM
+void theSpeaker_start(const uint8_t clip)
+{
+  theSpeaker_stop();
+
+  pClip = &(cClips[( clip < speaker_clip_max ) ? (clip) : (speaker_clip_chime)]);
+  position = 0;
+  predictor = pClip->predictor;
+  step_index = pClip->index;
+  left = PERIOD_ALARM * ( SPEAKER_SAMPLE_RATE / 1000 );
+  ++stats.clips;
+
+  // both buffers are decoded ahead, then the interrupt keeps one buffer ahead
+  prime();
+
+  busy_cycles = 0;
+  elapsed_cycles = 0;
+  last_cycles = (STATS_ENABLED) ? (DWT->CYCCNT) : (0);
+
+  bPlaying = true;
+  bRunning = true;
+  DACC->DACC_MR |= DACC_MR_TRGEN;
+  DACC->DACC_IER = DACC_IER_ENDTX;
+  DACC->DACC_PTCR = DACC_PTCR_TXTEN;
+  TC0->TC_CHANNEL[SAMPLES_CHANNEL].TC_CCR = TC_CCR_CLKEN | TC_CCR_SWTRG;
+}
+
+// stops the clip
+void theSpeaker_stop(void)
+{
+  DACC->DACC_IDR = DACC_IDR_ENDTX;
+  bPlaying = false;
+  TC0->TC_CHANNEL[SAMPLES_CHANNEL].TC_CCR = TC_CCR_CLKDIS;
+  DACC->DACC_PTCR = DACC_PTCR_TXTDIS;
+  DACC->DACC_TNCR = 0;
+  DACC->DACC_TCR = 0;
+  // the output is left at the middle (no DC on the speaker): the trigger is off, so the value
+  // is converted right away, not on the next period of the stopped timer
+  DACC->DACC_MR &= ~DACC_MR_TRGEN;
+  DACC->DACC_CDR = DAC_MIDSCALE;
+  bRunning = false;
+}
+
+bool theSpeaker_isPlaying(void)
+{
+  return bPlaying;
+}
+
+void theSpeaker_getStats(theSpeaker_stats_t *const pStats)
+{
+  // the consistent copy of the interrupt statistics
+  noInterrupts();
+  *pStats = stats;
+  interrupts();
+}
+
+// periodic function, called pretty fast - the clip is played by the interrupt,
+// only the DAC is stopped after the alarm
+void theSpeaker_process(const unsigned long timestamp)
+{
+  (void)timestamp;
+
+  // the last buffer is sent
+  if ( ( ! bPlaying ) && bRunning && ( DACC->DACC_ISR & DACC_ISR_TXBUFE ) )
+  {
+    theSpeaker_stop();
+  }
+}
@@ -0,0 +1,31 @@
+#if !defined(__THE_CLOCK_THE_SPEAKER_HEADER_INCLUDED_)
+#define __THE_CLOCK_THE_SPEAKER_HEADER_INCLUDED_
+
+extern void theSpeaker_init(void);
+extern void theSpeaker_process(const unsigned long timestamp);
+
+// sampled alarm sounds
+typedef enum {
+  speaker_clip_chime,       // bell chime (E5), once per second
+  speaker_clip_max
+} theSpeaker_clip_t;
+
+// the clip is repeated for PERIOD_ALARM
+extern void theSpeaker_start(const uint8_t clip);
+extern void theSpeaker_stop(void);
+extern bool theSpeaker_isPlaying(void);
+
+// the playback load
+typedef struct {
+  uint32_t clips;               // clips started
+  uint32_t buffers;             // buffers decoded by the interrupt
+  uint32_t underruns;           // both buffers were sent before the interrupt has come (PDC is restarted with both buffers)
+  uint32_t decode_cycles;       // the last buffer decoded by the interrupt, CPU cycles
+  uint32_t max_decode_cycles;   // the worst buffer decoded by the interrupt, CPU cycles
+  uint32_t load_ppm;            // CPU time of the interrupt per the playback time, parts per million
+} theSpeaker_stats_t;
+
+extern void theSpeaker_getStats(theSpeaker_stats_t *const pStats);
+
+
+#endif // __THE_CLOCK_THE_SPEAKER_HEADER_INCLUDED_
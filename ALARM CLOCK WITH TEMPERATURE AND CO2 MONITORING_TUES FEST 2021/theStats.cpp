@@ -0,0 +1,393 @@
+#include <Arduino.h>
+// Libraries: none
+// project includes
+#include "hwconfig.h"
+#include "theData.h"
+#include "theNVM.h"
+#include "theLog.h"
+#include "theAlarms.h"
+#include "theRTC.h"
+#include "theTime.h"
+#include "theBus.h"
+#include "theBuzzer.h"
+#include "theSpeaker.h"
+#include "thePanel.h"
+#include "theDisplay.h"
+#include "theBitmaps.h"
+#include "theCanvas.h"
+#include "theMirror.h"
+// own declarations
+#include "theStats.h"
+
+// timestamp last called
+static unsigned long timer = 0;
+
+// internal routines
+static void report_nvm(void);
+static void report_adjust(void);
+static void report_config(void);
+static void report_log(void);
+static void report_alarms(void);
+static void report_rtc(void);
+static void report_time(void);
+static void report_bus(void);
+static void report_bus_faults(const char *const pName, const theBus_busStats_t *const pBus);
+static void report_buzzer(void);
+static void report_speaker(void);
+static void report_panel(void);
+static void report_display(void);
+static void report_profile(const char *const pName, const theDisplay_profileStats_t *const pProfile);
+static void report_bitmaps(void);
+static void report_mirror(void);
+static void report_value(const char *const pName, const unsigned long value);
+
+//----------------------------------------------------------
+
+void theStats_init(void)
+{
+  // nothing to initialize, Serial is started in the main file
+}
+
+// helper routine to print " name=value"
+static void report_value(const char *const pName, const unsigned long value)
+{
+  Serial.print(" ");
+  Serial.print(pName);
+  Serial.print("=");
+  Serial.print(value);
+}
+
+// settings NVM commits (theData)
+static void report_nvm(void)
+{
+  theData_nvmStats_t stats;
+  theData_getNvmStats(&stats);
+
+  Serial.print("nvm:");
+  report_value("changes", stats.changes);
+  report_value("commits", stats.commits);
+  report_value("session_changes", stats.session_changes);
+  report_value("stall_us", stats.last_stall_us);
+  report_value("max_stall_us", stats.max_stall_us);
+  Serial.println();
+}
+
+// the adjustment latency (theData)
+static void report_adjust(void)
+{
+  theData_adjustStats_t stats;
+  theData_getAdjustStats(&stats);
+
+  Serial.print("adjust:");
+  report_value("adjustments", stats.adjustments);
+  report_value("latency_us", stats.latency_us);
+  report_value("max_latency_us", stats.max_latency_us);
+  Serial.println();
+}
+
+// the snapshot readers (theData)
+static void report_snapshot(void)
+{
+  theData_stressStats_t stats;
+  theData_getStressStats(&stats);
+
+  Serial.print("snapshot:");
+  report_value("retries", stats.retries);
+  report_value("publications", stats.publications);
+  report_value("checks", stats.checks);
+  report_value("torn", stats.torn);
+  Serial.println();
+}
+
+// settings config store (theNVM)
+static void report_config(void)
+{
+  theNVM_stats_t stats;
+  theNVM_getStats(&stats);
+
+  Serial.print("config:");
+  report_value("boot_scan_us", stats.boot_scan_us);
+  report_value("boot_records", stats.boot_records);
+  report_value("records", stats.records);
+  report_value("compactions", stats.compactions);
+  report_value("user_bytes", stats.user_bytes);
+  report_value("flash_bytes", stats.flash_bytes);
+  // write amplification in 1/100
+  report_value("amplification_x100", (stats.user_bytes > 0) ? ( (100UL * stats.flash_bytes) / stats.user_bytes ) : (0));
+  Serial.println();
+}
+
+// readings log (theLog)
+static void report_log(void)
+{
+  theLog_stats_t stats;
+  theLog_getStats(&stats);
+
+  Serial.print("log:");
+  report_value("rows", stats.rows);
+  report_value("samples", stats.samples);
+  report_value("bits", stats.bits);
+  // bits per sample in 1/100
+  report_value("bits_per_sample_x100", (stats.samples > 0) ? ( (100ULL * stats.bits) / stats.samples ) : (0));
+  report_value("pages", stats.pages);
+  report_value("flushes", stats.flushes);
+  report_value("append_us", stats.append_us);
+  report_value("max_append_us", stats.max_append_us);
+  report_value("query_rows", stats.query_rows);
+  report_value("query_us", stats.query_us);
+  Serial.println();
+}
+
+// alarms schedule (theAlarms)
+static void report_alarms(void)
+{
+  theAlarms_stats_t stats;
+  theAlarms_getStats(&stats);
+
+  Serial.print("alarms:");
+  report_value("alarms", stats.alarms);
+  report_value("occurrences", stats.occurrences);
+  report_value("rebuilds", stats.rebuilds);
+  report_value("rebuild_us", stats.rebuild_us);
+  report_value("lookups", stats.lookups);
+  report_value("lookup_us", stats.lookup_us);
+  report_value("max_lookup_us", stats.max_lookup_us);
+  report_value("armed", stats.armed);
+  report_value("fired", stats.fired);
+  report_value("commits", stats.commits);
+  Serial.println();
+}
+
+// time and date read outs (theRTC)
+static void report_rtc(void)
+{
+  theRTC_stats_t stats;
+  theRTC_getStats(&stats);
+
+  const unsigned long ms = millis();
+
+  Serial.print("rtc:");
+  report_value("reads", stats.reads);
+  report_value("syncs", stats.syncs);
+  report_value("minutes", stats.minutes);
+  report_value("ticks", stats.ticks);
+  report_value("transactions_per_hour", (ms > 0) ? (unsigned long)( ( 3600000ULL * stats.transactions ) / ms ) : (0));
+  report_value("failures", stats.failures);
+  report_value("read_us", stats.read_us);
+  report_value("max_read_us", stats.max_read_us);
+  report_value("alarms", stats.alarms);
+  report_value("alarm_latency_us", stats.alarm_latency_us);
+  report_value("max_alarm_latency_us", stats.max_alarm_latency_us);
+  report_value("adjustments", stats.adjustments);
+  report_value("writes", stats.writes);
+  report_value("reverts", stats.reverts);
+  report_value("alarm_mismatches", stats.alarm_mismatches);
+  Serial.println();
+}
+
+// civil date conversions cost, measured at start (theTime)
+static void report_time(void)
+{
+  theTime_stats_t stats;
+  theTime_getStats(&stats);
+
+  Serial.print("time:");
+  report_value("days_from_civil_ns", stats.days_from_civil_ns);
+  report_value("civil_from_days_ns", stats.civil_from_days_ns);
+  Serial.println();
+}
+
+// I2C faults and recovery, the main loop stall (theBus)
+static void report_bus(void)
+{
+  theBus_stats_t stats;
+  theBus_getStats(&stats);
+
+  Serial.print("loop:");
+  report_value("max_loop_us", stats.max_loop_us);
+  report_value("max_fault_loop_us", stats.max_fault_loop_us);
+  report_value("injected", stats.injected);
+  Serial.println();
+
+  report_bus_faults("bus_rtc:", &(stats.buses[bus_rtc]));
+  report_bus_faults("bus_display:", &(stats.buses[bus_display]));
+}
+
+static void report_bus_faults(const char *const pName, const theBus_busStats_t *const pBus)
+{
+  Serial.print(pName);
+  report_value("faults", pBus->faults);
+  report_value("failures", pBus->failures);
+  report_value("stuck", pBus->stuck);
+  report_value("recoveries", pBus->recoveries);
+  report_value("recovery_us", pBus->recovery_us);
+  report_value("max_recovery_us", pBus->max_recovery_us);
+  report_value("recovery_ms", pBus->recovery_ms);
+  report_value("max_recovery_ms", pBus->max_recovery_ms);
+  Serial.println();
+}
+
+// PWM start cost, measured at start, and the timing of the sound steps (theBuzzer)
+static void report_buzzer(void)
+{
+  theBuzzer_stats_t stats;
+  theBuzzer_getStats(&stats);
+
+  Serial.print("buzzer:");
+  report_value("start_cycles", stats.start_cycles);
+  report_value("start_const_cycles", stats.start_const_cycles);
+  report_value("edges", stats.edges);
+  report_value("edge_error_us", stats.edge_error_us);
+  report_value("max_edge_error_us", stats.max_edge_error_us);
+  report_value("loop_edge_error_us", stats.loop_edge_error_us);
+  report_value("max_loop_edge_error_us", stats.max_loop_edge_error_us);
+  Serial.println();
+}
+
+// the sampled sounds playback load (theSpeaker)
+static void report_speaker(void)
+{
+  theSpeaker_stats_t stats;
+  theSpeaker_getStats(&stats);
+
+  Serial.print("speaker:");
+  report_value("clips", stats.clips);
+  report_value("buffers", stats.buffers);
+  report_value("underruns", stats.underruns);
+  report_value("decode_cycles", stats.decode_cycles);
+  report_value("max_decode_cycles", stats.max_decode_cycles);
+  report_value("load_ppm", stats.load_ppm);
+  Serial.println();
+}
+
+// display transfers (thePanel)
+static void report_panel(void)
+{
+  thePanel_stats_t stats;
+  thePanel_getStats(&stats);
+
+  Serial.print("panel:");
+  report_value("frames", stats.frames);
+  report_value("bytes", stats.bytes);
+  report_value("transactions", stats.transactions);
+  report_value("busy_us", stats.busy_us);
+  report_value("cpu_us", stats.cpu_us);
+  report_value("avg_bytes", (stats.frames > 0) ? (stats.total_bytes / stats.frames) : (0));
+  report_value("max_bytes", stats.max_bytes);
+  report_value("max_busy_us", stats.max_busy_us);
+  report_value("full_bytes", stats.full_bytes);
+  report_value("failures", stats.failures);
+  Serial.println();
+}
+
+// frame drawing (theDisplay)
+static void report_display(void)
+{
+  theDisplay_stats_t stats;
+  theDisplay_getStats(&stats);
+  thePanel_stats_t panel;
+  thePanel_getStats(&panel);
+  theCanvas_stats_t canvas;
+  theCanvas_getStats(&canvas);
+
+  Serial.print("display:");
+  report_value("frames", stats.frames);
+  report_value("strip_pages", STRIP_PAGES);
+  report_value("ram_bytes", canvas.ram_bytes + panel.ram_bytes);
+  report_value("frame_us", stats.frame_us);
+  report_value("render_us", stats.render_us);
+  report_value("avg_render_us", (stats.frames > 0) ? (stats.total_render_us / stats.frames) : (0));
+  report_value("max_render_us", stats.max_render_us);
+  report_value("chart_updates", stats.chart_updates);
+  report_value("chart_bytes", stats.chart_bytes);
+  report_value("avg_chart_bytes", (stats.chart_updates > 0) ? (stats.total_chart_bytes / stats.chart_updates) : (0));
+  Serial.println();
+
+  report_profile("day:", &(stats.day));
+  report_profile("night:", &(stats.night));
+}
+
+// display profile (day, night) time, I2C bytes per hour and CPU time per hour
+static void report_profile(const char *const pName, const theDisplay_profileStats_t *const pProfile)
+{
+  const uint64_t ms = pProfile->ms;
+
+  Serial.print(pName);
+  report_value("minutes", (unsigned long)( ms / 60000UL ));
+  report_value("kbytes", (unsigned long)( pProfile->bytes / 1024UL ));
+  report_value("bytes_per_hour", (ms > 0) ? (unsigned long)( ( 3600000ULL * pProfile->bytes ) / ms ) : (0));
+  report_value("cpu_ms_per_hour", (ms > 0) ? (unsigned long)( ( 3600ULL * pProfile->cpu_us ) / ms ) : (0));
+  Serial.println();
+}
+
+// bitmaps storage (theBitmaps) and drawing (theCanvas)
+static void report_bitmaps(void)
+{
+  theBitmaps_stats_t stats;
+  theBitmaps_getStats(&stats);
+  theCanvas_stats_t canvas;
+  theCanvas_getStats(&canvas);
+
+  Serial.print("bitmaps:");
+  report_value("count", stats.bitmaps);
+  report_value("flash_bytes", stats.flash_bytes);
+  report_value("raw_bytes", stats.raw_bytes);
+  report_value("table_bytes", stats.table_bytes);
+  report_value("drawn", canvas.bitmaps);
+  // 64-bit: the drawing time in ns overflows 32 bits after ~72 minutes of drawing
+  report_value("avg_draw_ns", (canvas.bitmaps > 0) ? (unsigned long)( ( 1000ULL * canvas.bitmaps_us ) / canvas.bitmaps ) : (0));
+  Serial.println();
+}
+
+// display stream check (theMirror) and the picture on the display
+static void report_mirror(void)
+{
+  theMirror_stats_t stats;
+  theMirror_getStats(&stats);
+
+  Serial.print("mirror:");
+  report_value("frames", stats.frames);
+  report_value("mismatches", stats.mismatches);
+  report_value("transactions", stats.transactions);
+  report_value("bytes", stats.bytes);
+  report_value("data_bytes", stats.data_bytes);
+  report_value("avg_bytes", (stats.frames > 0) ? (stats.bytes / stats.frames) : (0));
+  report_value("unknown_commands", stats.unknown_commands);
+  report_value("overruns", stats.overruns);
+  Serial.println();
+
+  // the picture follows the line, to be cut out and compared with the expected one
+  theMirror_dump(&Serial);
+  Serial.println();
+}
+
+// periodic function, called pretty fast, so we have to take
+// care execute it with specific periodicy
+void theStats_process(const unsigned long timestamp)
+{
+  // the statistics are for development only, they are not reported by default
+  if ( ! STATS_ENABLED ) return;
+
+  // if the time since last execution exceeds specified period
+  if ( ( timestamp - timer ) >= PERIOD_STATS )
+  {
+    report_nvm();
+    report_adjust();
+    report_snapshot();
+    report_config();
+    report_log();
+    report_alarms();
+    report_rtc();
+    report_time();
+    report_bus();
+    report_buzzer();
+    report_speaker();
+    report_panel();
+    report_display();
+    report_bitmaps();
+    if ( PANEL_MIRROR ) report_mirror();
+
+    // remember when the function was executed last time
+    timer = timestamp;
+  }
+}
@@ -0,0 +1,8 @@
+#if !defined(__THE_CLOCK_THE_STATS_HEADER_INCLUDED_)
+#define __THE_CLOCK_THE_STATS_HEADER_INCLUDED_
+
+extern void theStats_init(void);
+extern void theStats_process(const unsigned long timestamp);
+
+
+#endif // __THE_CLOCK_THE_STATS_HEADER_INCLUDED_
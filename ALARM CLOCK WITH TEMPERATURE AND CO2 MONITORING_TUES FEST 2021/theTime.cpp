@@ -0,0 +1,71 @@
+#include <Arduino.h>
+// Libraries: none
+// project includes
+#include "hwconfig.h"
+// own declarations
+#include "theTime.h"
+
+// the conversions are checked by the compiler
+static_assert(theTime_daysFromCivil(2000, 1, 1) == 0, "the epoch is day 0");
+static_assert(theTime_daysFromCivil(2000, 3, 1) == 60, "2000 is leap");
+static_assert(theTime_daysFromCivil(2100, 3, 1) - theTime_daysFromCivil(2100, 2, 28) == 1, "2100 is not leap");
+static_assert(theTime_daysFromCivil(2021, 5, 14) == 7804, "TUES Fest 2021");
+static_assert(theTime_civilFromDays(59).month == 2 && theTime_civilFromDays(59).day == 29, "2000-02-29");
+static_assert(theTime_civilFromDays(7804).year == 2021 && theTime_civilFromDays(7804).month == 5 &&
+              theTime_civilFromDays(7804).day == 14, "TUES Fest 2021");
+static_assert(theTime_civilFromDays(36524).year == 2099 && theTime_civilFromDays(36524).day == 31, "2099-12-31");
+static_assert(theTime_dayOfWeek(0) == 6, "2000-01-01 is Saturday");
+static_assert(theTime_dayOfWeek(7804) == 5, "2021-05-14 is Friday");
+static_assert(theTime_daysInMonth(2024, 2) == 29 && theTime_daysInMonth(2023, 2) == 28, "February");
+static_assert(theTime_daysInMonth(2023, 7) == 31 && theTime_daysInMonth(2023, 8) == 31 &&
+              theTime_daysInMonth(2023, 9) == 30 && theTime_daysInMonth(2023, 12) == 31, "months");
+
+#define BENCHMARK_COUNT       (1000)        // conversions measured at start
+
+static theTime_stats_t stats;
+
+// internal routines
+static void benchmark(void);
+
+//----------------------------------------------------------
+
+// initialization - called once at the device start
+void theTime_init(void)
+{
+  // the statistics are for development only, the start is not delayed by default
+  if ( STATS_ENABLED )
+  {
+    benchmark();
+  }
+}
+
+// measure the conversions of all the days of ~3 years; the inputs and the results are volatile,
+// so the compiler can neither compute them in advance nor drop them
+static void benchmark(void)
+{
+  volatile int32_t days = 0;
+  volatile int sink = 0;
+
+  unsigned long started = micros();
+  for ( int i = 0; i < BENCHMARK_COUNT; i++ )
+  {
+    const theTime_date_t date = theTime_civilFromDays(days + i);
+    sink = date.year + date.month + date.day;
+  }
+  stats.civil_from_days_ns = ( ( micros() - started ) * 1000UL ) / BENCHMARK_COUNT;
+
+  volatile int year = 2021;
+  started = micros();
+  for ( int i = 0; i < BENCHMARK_COUNT; i++ )
+  {
+    sink = theTime_daysFromCivil(year, 1 + ( i % 12 ), 1 + ( i % 28 ));
+  }
+  stats.days_from_civil_ns = ( ( micros() - started ) * 1000UL ) / BENCHMARK_COUNT;
+
+  (void)sink;
+}
+
+void theTime_getStats(theTime_stats_t *const pStats)
+{
+  *pStats = stats;
+}
@@ -0,0 +1,102 @@
+#if !defined(__THE_CLOCK_THE_TIME_HEADER_INCLUDED_)
+#define __THE_CLOCK_THE_TIME_HEADER_INCLUDED_
+
+// The time is kept as seconds since the epoch 2000-01-01 00:00:00 (Saturday). The civil date is
+// converted to and from the days since the epoch by the algorithms of Howard Hinnant
+// ("chrono-Compatible Low-Level Date Algorithms"): the year starts in March, so the leap day is
+// the last day of the year, and the month lengths come from the formula - no tables, no loops,
+// only the divisions by constants. All the routines are constexpr, so the constants are computed
+// by the compiler. The dates before the epoch are not supported (the days are never negative).
+
+// no periodic actions, the conversions are called by other modules
+extern void theTime_init(void);
+
+#define TIME_EPOCH_YEAR       (2000)
+#define TIME_SECONDS_PER_DAY  (86400UL)
+#define TIME_DAYS_TO_EPOCH    (730425L)     // days from 0000-03-01 to 2000-01-01
+#define TIME_DAYS_PER_ERA     (146097L)     // days in 400 years
+
+// the civil date
+typedef struct {
+  int year;                 // 2000...
+  int month;                // 1...12
+  int day;                  // 1...31
+} theTime_date_t;
+
+// internal steps of the conversions (C++11 constexpr routine is a single return statement)
+constexpr int32_t time_days_from_march(const int32_t year, const int32_t day_of_year)
+{
+  return ( ( year / 400 ) * TIME_DAYS_PER_ERA ) + ( ( year % 400 ) * 365 ) + ( ( year % 400 ) / 4 ) -
+         ( ( year % 400 ) / 100 ) + day_of_year - TIME_DAYS_TO_EPOCH;
+}
+
+constexpr theTime_date_t time_civil_from_month(const int32_t year, const int32_t day_of_year, const int32_t month)
+{
+  return theTime_date_t{ (int)( year + ( ( month >= 10 ) ? (1) : (0) ) ),
+                         (int)( ( month < 10 ) ? ( month + 3 ) : ( month - 9 ) ),
+                         (int)( day_of_year - ( ( ( 153 * month ) + 2 ) / 5 ) + 1 ) };
+}
+
+constexpr theTime_date_t time_civil_from_year(const int32_t year, const int32_t day_of_year)
+{
+  return time_civil_from_month(year, day_of_year, ( ( 5 * day_of_year ) + 2 ) / 153);
+}
+
+constexpr theTime_date_t time_civil_from_year_of_era(const int32_t era, const int32_t day_of_era, const int32_t year_of_era)
+{
+  return time_civil_from_year(( era * 400 ) + year_of_era,
+                              day_of_era - ( ( 365 * year_of_era ) + ( year_of_era / 4 ) - ( year_of_era / 100 ) ));
+}
+
+constexpr theTime_date_t time_civil_from_era(const int32_t era, const int32_t day_of_era)
+{
+  return time_civil_from_year_of_era(era, day_of_era,
+                                     ( day_of_era - ( day_of_era / 1460 ) + ( day_of_era / 36524 ) - ( day_of_era / 146096 ) ) / 365);
+}
+
+// days since the epoch of the civil date
+constexpr int32_t theTime_daysFromCivil(const int year, const int month, const int day)
+{
+  return time_days_from_march(year - ( ( month <= 2 ) ? (1) : (0) ),
+                              ( ( ( 153 * ( ( month > 2 ) ? ( month - 3 ) : ( month + 9 ) ) ) + 2 ) / 5 ) + day - 1);
+}
+
+// the civil date of the days since the epoch
+constexpr theTime_date_t theTime_civilFromDays(const int32_t days)
+{
+  return time_civil_from_era(( days + TIME_DAYS_TO_EPOCH ) / TIME_DAYS_PER_ERA, ( days + TIME_DAYS_TO_EPOCH ) % TIME_DAYS_PER_ERA);
+}
+
+// day of week of the days since the epoch, 1 - Monday ... 7 - Sunday (the epoch is Saturday)
+constexpr int theTime_dayOfWeek(const int32_t days)
+{
+  return ( ( days + 5 ) % 7 ) + 1;
+}
+
+constexpr bool theTime_isLeap(const int year)
+{
+  return ( ( year % 4 ) == 0 ) && ( ( ( year % 100 ) != 0 ) || ( ( year % 400 ) == 0 ) );
+}
+
+// 31 or 30 days alternate, and the order flips in August
+constexpr int theTime_daysInMonth(const int year, const int month)
+{
+  return ( month == 2 ) ? ( 28 + ( theTime_isLeap(year) ? (1) : (0) ) ) : ( 30 + ( ( month + ( month >> 3 ) ) & 1 ) );
+}
+
+// seconds since the epoch
+constexpr uint32_t theTime_seconds(const int32_t days, const int hour, const int minute, const int seconds)
+{
+  return ( (uint32_t)days * TIME_SECONDS_PER_DAY ) + ( hour * 3600UL ) + ( minute * 60UL ) + seconds;
+}
+
+// conversions cost, measured at start when the statistics are enabled
+typedef struct {
+  uint32_t days_from_civil_ns;  // one conversion of the civil date to days, nanoseconds
+  uint32_t civil_from_days_ns;  // one conversion of days to the civil date, nanoseconds
+} theTime_stats_t;
+
+extern void theTime_getStats(theTime_stats_t *const pStats);
+
+
+#endif // __THE_CLOCK_THE_TIME_HEADER_INCLUDED_
@@ -0,0 +1,132 @@
+#include <Arduino.h>
+// Libraries: none
+// project includes
+#include "hwconfig.h"
+#include "theData.h"
+#include "theBitmaps.h"
+#include "theCanvas.h"
+// own declarations
+#include "theTrend.h"
+
+// The history of every channel is the ring of TREND_SAMPLES samples. It is drawn into any width
+// by one pass from the oldest sample to the newest: the samples falling into the same column are
+// reduced to their minimum and maximum, and the column is drawn as soon as the next one starts.
+// So the peaks are never lost, and only one column is kept in RAM while drawing.
+
+#define NO_VALUE              (INT16_MIN)
+
+// the rings of all the channels
+static int16_t rings[data_channel_max][TREND_SAMPLES];
+static uint32_t count = 0;
+
+// timestamp last called
+static unsigned long timer = 0;
+
+// internal routines
+static void draw_column(const int x, const int y, const int h, const int32_t min, const int32_t max, const int32_t lowest, const int32_t highest);
+static int scale(const int32_t value, const int h, const int32_t min, const int32_t max);
+
+//----------------------------------------------------------
+
+void theTrend_init(void)
+{
+  count = 0;
+}
+
+uint32_t theTrend_getCount(void)
+{
+  return count;
+}
+
+bool theTrend_getExtents(const unsigned int channel, int32_t *const pMin, int32_t *const pMax)
+{
+  if ( channel >= data_channel_max ) return false;
+
+  const unsigned int kept = ( count < TREND_SAMPLES ) ? (count) : (TREND_SAMPLES);
+  bool bFound = false;
+
+  for ( unsigned int i = 0; i < kept; i++ )
+  {
+    const int16_t value = rings[channel][i];
+    if ( value == NO_VALUE ) continue;
+
+    if ( ( ! bFound ) || ( value < *pMin ) ) *pMin = value;
+    if ( ( ! bFound ) || ( value > *pMax ) ) *pMax = value;
+    bFound = true;
+  }
+
+  return bFound;
+}
+
+// the value to the pixels above the rectangle bottom, 0...h-1
+static int scale(const int32_t value, const int h, const int32_t min, const int32_t max)
+{
+  if ( value <= min ) return 0;
+  if ( value >= max ) return h - 1;
+  return ( ( value - min ) * ( h - 1 ) ) / ( max - min );
+}
+
+static void draw_column(const int x, const int y, const int h, const int32_t min, const int32_t max, const int32_t lowest, const int32_t highest)
+{
+  const int top = y + h - 1 - scale(highest, h, min, max);
+  const int bottom = y + h - 1 - scale(lowest, h, min, max);
+  theCanvas_vline(x, top, bottom - top + 1);
+}
+
+void theTrend_draw(const unsigned int channel, const int x, const int y, const int w, const int h, const int32_t min, const int32_t max)
+{
+  if ( ( channel >= data_channel_max ) || ( w <= 0 ) || ( h <= 0 ) || ( max <= min ) ) return;
+
+  const unsigned int kept = ( count < TREND_SAMPLES ) ? (count) : (TREND_SAMPLES);
+  // less samples than columns - one sample per column, aligned to the right;
+  // more samples than columns - several samples per column, the whole width
+  const unsigned int span = ( kept > (unsigned int)w ) ? (kept) : (w);
+  const unsigned int offset = ( kept < (unsigned int)w ) ? (w - kept) : (0);
+
+  int column = -1;
+  int32_t lowest = 0;
+  int32_t highest = 0;
+
+  for ( unsigned int i = 0; i < kept; i++ )
+  {
+    // from the oldest sample
+    const int16_t value = rings[channel][(count - kept + i) % TREND_SAMPLES];
+    if ( value == NO_VALUE ) continue;
+
+    const int next = offset + ( ( i * w ) / span );
+    if ( next != column )
+    {
+      // the previous column is completed
+      if ( column >= 0 ) draw_column(x + column, y, h, min, max, lowest, highest);
+      column = next;
+      lowest = value;
+      highest = value;
+    }
+    else
+    {
+      if ( value < lowest ) lowest = value;
+      if ( value > highest ) highest = value;
+    }
+  }
+
+  if ( column >= 0 ) draw_column(x + column, y, h, min, max, lowest, highest);
+}
+
+// periodic function, called pretty fast, so we have to take
+// care execute it with specific periodicy
+void theTrend_process(const unsigned long timestamp)
+{
+  // if the time since last execution exceeds specified period
+  if ( ( timestamp - timer ) >= PERIOD_TREND )
+  {
+    for ( unsigned int channel = 0; channel < data_channel_max; channel++ )
+    {
+      theData_sample_t sample;
+      rings[channel][count % TREND_SAMPLES] = ( theData_getSample(channel, &sample) ) ? ( (int16_t)sample.value ) : (NO_VALUE);
+    }
+    ++count;
+
+    // remember when the function was executed last time
+    timer = timestamp;
+  }
+}
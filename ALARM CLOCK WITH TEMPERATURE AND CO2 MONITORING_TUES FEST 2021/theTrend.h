@@ -0,0 +1,18 @@
+#if !defined(__THE_CLOCK_THE_TREND_HEADER_INCLUDED_)
+#define __THE_CLOCK_THE_TREND_HEADER_INCLUDED_
+
+extern void theTrend_init(void);
+extern void theTrend_process(const unsigned long timestamp);
+
+// samples taken since the start, one per PERIOD_TREND (the last TREND_SAMPLES of them are kept)
+extern uint32_t theTrend_getCount(void);
+// the lowest and the highest kept sample of the channel (data_channel_*),
+// returns false if there are no valid samples
+extern bool theTrend_getExtents(const unsigned int channel, int32_t *const pMin, int32_t *const pMax);
+// draw the kept samples of the channel into the rectangle, the oldest on the left, the newest
+// on the right; every column is the line from the lowest to the highest sample of that column.
+// min and max are the values of the rectangle bottom and top
+extern void theTrend_draw(const unsigned int channel, const int x, const int y, const int w, const int h, const int32_t min, const int32_t max);
+
+
+#endif // __THE_CLOCK_THE_TREND_HEADER_INCLUDED_
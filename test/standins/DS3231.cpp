@@ -0,0 +1,285 @@
+#include "DS3231.h"
+
+// the registers of the datasheet ("Timekeeping Registers")
+#define REG_SECONDS           (0x00)
+#define REG_MINUTES           (0x01)
+#define REG_HOURS             (0x02)
+#define REG_DAY               (0x03)
+#define REG_DATE              (0x04)
+#define REG_MONTH             (0x05)
+#define REG_YEAR              (0x06)
+#define REG_ALARM1            (0x07)
+#define REG_ALARM2            (0x0B)
+#define REG_CONTROL           (0x0E)
+#define REG_STATUS            (0x0F)
+#define REG_TEMPERATURE_MSB   (0x11)
+#define REG_TEMPERATURE_LSB   (0x12)
+
+#define HOURS_12H             (0x40)
+#define HOURS_PM              (0x20)
+#define MONTH_CENTURY         (0x80)
+#define ALARM_MASK            (0x80)        // AxMy - the register is not compared
+#define ALARM_DY              (0x40)        // DY/DT - the day of week, not the date
+#define CONTROL_INTCN         (0x04)
+#define CONTROL_A2IE          (0x02)
+#define CONTROL_A1IE          (0x01)
+#define STATUS_OSF            (0x80)
+#define STATUS_EN32KHZ        (0x08)
+#define STATUS_A2F            (0x02)
+#define STATUS_A1F            (0x01)
+
+#define SECONDS_PER_DAY       (86400UL)
+
+// internal routines
+static int from_bcd(const uint8_t value);
+static uint8_t to_bcd(const int value);
+static int days_in_month(const int year, const int month);
+
+//----------------------------------------------------------
+
+// the power-on state: 00:00:00 01/01/00, the oscillator was stopped, INTCN set, the alarms off
+DS3231::DS3231(const uint32_t pin, const uint64_t phase_us) :
+  transactions(0), timeWrites(0), seconds(0), alarm1(0), alarm2(0), edges(0),
+  pin(pin), pointer(0), next_us(host_now() + phase_us), bResponding(true), writeFaults(0), bIntConnected(true), bLow(false)
+{
+  memset(registers, 0, sizeof(registers));
+  memset(stuck, 0, sizeof(stuck));
+  registers[REG_DAY] = 1;
+  registers[REG_DATE] = 1;
+  registers[REG_MONTH] = 1;
+  registers[REG_CONTROL] = 0x1C;
+  registers[REG_STATUS] = STATUS_OSF | STATUS_EN32KHZ;
+  host_attach(this);
+}
+
+DS3231::~DS3231(void)
+{
+  host_holdPin(pin, false);
+  host_detach(this);
+}
+
+static int from_bcd(const uint8_t value)
+{
+  return ( ( value >> 4 ) * 10 ) + ( value & 0x0F );
+}
+
+static uint8_t to_bcd(const int value)
+{
+  return (uint8_t)( ( ( value / 10 ) << 4 ) | ( value % 10 ) );
+}
+
+// the leap years of the chip: the year divisible by 4 (2000...2099)
+static int days_in_month(const int year, const int month)
+{
+  static const int cDays[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+  return ( ( month == 2 ) && ( ( year % 4 ) == 0 ) ) ? (29) : ( cDays[month - 1] );
+}
+
+void DS3231::setTime(const uint32_t time)
+{
+  uint32_t days = time / SECONDS_PER_DAY;
+  const uint32_t second = time % SECONDS_PER_DAY;
+  int year = 0;
+  int month = 1;
+  // 2000-01-01 is Saturday, the days of week are 1 (Monday)...7 (Sunday) as the sketch counts them
+  registers[REG_DAY] = (uint8_t)( ( ( days + 5 ) % 7 ) + 1 );
+  while ( days >= (uint32_t)( ( ( year % 4 ) == 0 ) ? (366) : (365) ) ) days -= ( ( year++ % 4 ) == 0 ) ? (366) : (365);
+  while ( days >= (uint32_t)days_in_month(year, month) ) days -= days_in_month(year, month++);
+
+  registers[REG_SECONDS] = to_bcd(second % 60);
+  registers[REG_MINUTES] = to_bcd(( second / 60 ) % 60);
+  registers[REG_HOURS] = to_bcd(second / 3600);
+  registers[REG_DATE] = to_bcd(days + 1);
+  registers[REG_MONTH] = to_bcd(month);
+  registers[REG_YEAR] = to_bcd(year);
+  registers[REG_STATUS] &= ~STATUS_OSF;
+}
+
+uint32_t DS3231::time(void) const
+{
+  const uint8_t hours = registers[REG_HOURS];
+  int hour = from_bcd(hours & 0x3F);
+  if ( hours & HOURS_12H ) hour = ( from_bcd(hours & 0x1F) % 12 ) + ( ( hours & HOURS_PM ) ? (12) : (0) );
+  const int year = from_bcd(registers[REG_YEAR]);
+  const int month = from_bcd(registers[REG_MONTH] & 0x1F);
+
+  uint32_t days = from_bcd(registers[REG_DATE] & 0x3F) - 1;
+  for ( int y = 0; y < year; y++ ) days += ( ( y % 4 ) == 0 ) ? (366) : (365);
+  for ( int m = 1; m < month; m++ ) days += days_in_month(year, m);
+  return ( days * SECONDS_PER_DAY ) + ( hour * 3600UL ) + ( from_bcd(registers[REG_MINUTES]) * 60UL ) + from_bcd(registers[REG_SECONDS]);
+}
+
+// the first byte is the register pointer, the next ones are written from it (the pointer wraps);
+// writing the seconds resets the countdown chain: the next second update is 1 second later
+bool DS3231::write(const uint8_t *const pData, const size_t size)
+{
+  if ( ! bResponding ) return false;
+  if ( writeFaults > 0 )
+  {
+    --writeFaults;
+    return false;
+  }
+  ++transactions;
+  if ( size == 0 ) return true;
+
+  pointer = pData[0] % DS3231_REGISTERS;
+  for ( size_t i = 1; i < size; i++ )
+  {
+    const uint8_t value = pData[i];
+    if ( pointer == REG_SECONDS )
+    {
+      next_us = host_now() + 1000000;
+      ++timeWrites;
+    }
+    if ( pointer == REG_STATUS )
+    {
+      // the flags are only cleared by writing 0, the busy bit is read only
+      registers[REG_STATUS] = ( registers[REG_STATUS] & ( value | ~( STATUS_OSF | STATUS_A2F | STATUS_A1F ) ) & ~STATUS_EN32KHZ ) |
+                              ( value & STATUS_EN32KHZ );
+    }
+    else if ( ( pointer == REG_TEMPERATURE_MSB ) || ( pointer == REG_TEMPERATURE_LSB ) )
+    {
+      // read only
+    }
+    else
+    {
+      registers[pointer] = value;
+    }
+    pointer = ( pointer + 1 ) % DS3231_REGISTERS;
+  }
+  update();
+  return true;
+}
+
+bool DS3231::read(uint8_t *const pData, const size_t size)
+{
+  if ( ! bResponding ) return false;
+  ++transactions;
+  for ( size_t i = 0; i < size; i++ )
+  {
+    pData[i] = registers[pointer] | stuck[pointer];
+    pointer = ( pointer + 1 ) % DS3231_REGISTERS;
+  }
+  return true;
+}
+
+void DS3231::step(const uint64_t now_us)
+{
+  while ( now_us >= next_us )
+  {
+    next_us += 1000000;
+    tick();
+  }
+}
+
+// the second update: the time and date carry, then the alarms are compared
+void DS3231::tick(void)
+{
+  ++seconds;
+  int second = from_bcd(registers[REG_SECONDS]) + 1;
+  if ( second >= 60 )
+  {
+    second = 0;
+    int minute = from_bcd(registers[REG_MINUTES]) + 1;
+    if ( minute >= 60 )
+    {
+      minute = 0;
+      // the hours carry in the mode of the register: 11 AM -> 12 PM -> 1 PM ... 11 PM -> 12 AM
+      const uint8_t hours = registers[REG_HOURS];
+      bool bNextDay = false;
+      if ( hours & HOURS_12H )
+      {
+        int hour = from_bcd(hours & 0x1F);
+        bool bPm = ( hours & HOURS_PM ) != 0;
+        if ( hour == 11 ) { bPm = ! bPm; bNextDay = ! bPm; }
+        hour = ( hour % 12 ) + 1;
+        registers[REG_HOURS] = HOURS_12H | ( ( bPm ) ? (HOURS_PM) : (0) ) | to_bcd(hour);
+      }
+      else
+      {
+        const int hour = ( from_bcd(hours & 0x3F) + 1 ) % 24;
+        bNextDay = ( hour == 0 );
+        registers[REG_HOURS] = to_bcd(hour);
+      }
+
+      if ( bNextDay )
+      {
+        registers[REG_DAY] = (uint8_t)( ( registers[REG_DAY] % 7 ) + 1 );
+        int year = from_bcd(registers[REG_YEAR]);
+        int month = from_bcd(registers[REG_MONTH] & 0x1F);
+        int date = from_bcd(registers[REG_DATE] & 0x3F) + 1;
+        uint8_t century = registers[REG_MONTH] & MONTH_CENTURY;
+        if ( date > days_in_month(year, month) )
+        {
+          date = 1;
+          if ( ++month > 12 )
+          {
+            month = 1;
+            if ( ++year > 99 )
+            {
+              year = 0;
+              century ^= MONTH_CENTURY;
+            }
+          }
+        }
+        registers[REG_DATE] = to_bcd(date);
+        registers[REG_MONTH] = century | to_bcd(month);
+        registers[REG_YEAR] = to_bcd(year);
+      }
+    }
+    registers[REG_MINUTES] = to_bcd(minute);
+  }
+  registers[REG_SECONDS] = to_bcd(second);
+
+  // Alarm1: seconds, minutes, hours, day/date; Alarm2: minutes, hours, day/date at the seconds 00
+  if ( matches(REG_ALARM1, 4) )
+  {
+    registers[REG_STATUS] |= STATUS_A1F;
+    ++alarm1;
+  }
+  if ( ( second == 0 ) && matches(REG_ALARM2, 3) )
+  {
+    registers[REG_STATUS] |= STATUS_A2F;
+    ++alarm2;
+  }
+  update();
+}
+
+// the alarm registers from 'first' are compared with the time registers from the seconds
+// (Alarm1) or the minutes (Alarm2); the masked ones match, the last one is the day or the date
+bool DS3231::matches(const uint8_t first, const unsigned int count) const
+{
+  const uint8_t time_first = ( count == 4 ) ? (REG_SECONDS) : (REG_MINUTES);
+  for ( unsigned int i = 0; i < count; i++ )
+  {
+    const uint8_t value = registers[first + i];
+    if ( value & ALARM_MASK ) continue;
+    if ( i == ( count - 1 ) )
+    {
+      const bool bSame = ( value & ALARM_DY ) ? ( ( value & 0x0F ) == registers[REG_DAY] ) :
+                                                ( ( value & 0x3F ) == registers[REG_DATE] );
+      if ( ! bSame ) return false;
+    }
+    else if ( ( value & 0x7F ) != registers[time_first + i] )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// INT/SQW (open drain) is low while an alarm flag is set with its interrupt enabled
+void DS3231::update(void)
+{
+  const uint8_t control = registers[REG_CONTROL];
+  const uint8_t status = registers[REG_STATUS];
+  const bool bActive = ( control & CONTROL_INTCN ) &&
+                       ( ( ( control & CONTROL_A1IE ) && ( status & STATUS_A1F ) ) ||
+                         ( ( control & CONTROL_A2IE ) && ( status & STATUS_A2F ) ) );
+  const bool bLine = bActive && bIntConnected;
+  if ( bLine == bLow ) return;
+
+  bLow = bLine;
+  if ( bLow ) ++edges;
+  host_holdPin(pin, bLow);
+}
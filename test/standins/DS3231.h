@@ -0,0 +1,69 @@
+#if !defined(__STANDIN_DS3231_HEADER_INCLUDED_)
+#define __STANDIN_DS3231_HEADER_INCLUDED_
+
+// Stand-in of the DS3231 real time clock on I2C: the registers (time, date, both alarms, control
+// and status) by the datasheet, the seconds counted by the simulated time, the alarms matched
+// at the second updates and the INT/SQW output held low while an enabled alarm flag is set
+// (INTCN mode; the square wave is not played). It is written from the datasheet, not from the
+// sketch, so theRTC is checked by something which does not share its code.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <host.h>
+
+#define DS3231_REGISTERS      (0x13)
+
+class DS3231 : public host_Device, public host_I2CDevice
+{
+public:
+  // INT/SQW is connected to the pin; the first second update comes after 'phase_us'
+  DS3231(const uint32_t pin, const uint64_t phase_us);
+  ~DS3231(void);
+
+  void step(const uint64_t now_us);
+  bool write(const uint8_t *const pData, const size_t size);
+  bool read(uint8_t *const pData, const size_t size);
+
+  // the registers kept by the battery (no bus transaction, no countdown reset)
+  void set(const uint8_t reg, const uint8_t value) { registers[reg % DS3231_REGISTERS] = value; update(); }
+  uint8_t get(const uint8_t reg) const { return registers[reg % DS3231_REGISTERS]; }
+  // the time and date registers set to the time (seconds since 2000-01-01 00:00:00), 24h mode
+  void setTime(const uint32_t time);
+  // the time of the registers, seconds since 2000-01-01 00:00:00
+  uint32_t time(void) const;
+  // the simulated time (microseconds) when the current second has started
+  uint64_t secondStarted(void) const { return next_us - 1000000; }
+
+  // the faults: the chip does not answer on the bus (NACK); INT/SQW is not wired to the pin;
+  // the bits of the register always read as set (a clone chip, or the bits set by the chip itself);
+  // the next write transactions are not acknowledged (a glitch on the bus)
+  void setResponding(const bool isResponding) { bResponding = isResponding; }
+  void setIntConnected(const bool isConnected) { bIntConnected = isConnected; update(); }
+  void setStuckBits(const uint8_t reg, const uint8_t mask) { stuck[reg % DS3231_REGISTERS] = mask; }
+  void failWrites(const unsigned int count) { writeFaults = count; }
+
+  // the counters since the start
+  uint32_t transactions;        // transactions answered (the register pointer writes included)
+  uint32_t timeWrites;          // transactions which have written the seconds register
+  uint32_t seconds;             // second updates
+  uint32_t alarm1;              // Alarm1 matches (A1F set)
+  uint32_t alarm2;              // Alarm2 matches (A2F set)
+  uint32_t edges;               // INT/SQW falling edges on the pin
+
+private:
+  void tick(void);
+  bool matches(const uint8_t first, const unsigned int count) const;
+  void update(void);
+
+  const uint32_t pin;
+  uint8_t registers[DS3231_REGISTERS];
+  uint8_t stuck[DS3231_REGISTERS];
+  uint8_t pointer;
+  uint64_t next_us;             // the next second update
+  bool bResponding;
+  unsigned int writeFaults;     // the next write transactions not acknowledged
+  bool bIntConnected;
+  bool bLow;                    // INT/SQW is held low
+};
+
+#endif // __STANDIN_DS3231_HEADER_INCLUDED_
@@ -0,0 +1,195 @@
+#include "DacPdc.h"
+#include <chrono>
+
+// the fields of the datasheet ("DACC Mode Register", "TC Channel Mode Register: Waveform Mode")
+#define MR_TRGSEL_Msk         (0x7u << 1)
+#define MR_TRGSEL_TIOA0       (0x1u << 1)
+#define MR_USER_SEL_Msk       (0x3u << 16)
+#define CMR_WAVSEL_Msk        (0x3u << 13)
+#define CMR_ACPC_Msk          (0x3u << 18)
+#define CDR_DATA_Msk          (0xFFFu)
+
+// TIMER_CLOCK1 is MCK/2
+#define TIMER_CLOCK1_HZ       ( VARIANT_MCK / 2 )
+
+#define SAMPLES_CHANNEL       (0)
+
+//----------------------------------------------------------
+
+// the registers of DACC are played from now on, the peripheral is after the reset
+DacPdc::DacPdc(void) :
+  triggers(0), held(0), interrupts(0), handler_ns(0),
+  bClock(false), bPdc(false), bEndTx(false), bPending(false), last(0), next_ns(0), last_ns(host_now() * 1000), due_ns(0), latency_ns(0)
+{
+  host_Register *const pRegisters = &(DACC->DACC_CR);
+  for ( size_t i = 0; i < ( sizeof(Dacc) / sizeof(host_Register) ); i++ )
+  {
+    pRegisters[i].value = 0;
+    pRegisters[i].pPeripheral = this;
+  }
+  host_attach(this);
+}
+
+DacPdc::~DacPdc(void)
+{
+  host_Register *const pRegisters = &(DACC->DACC_CR);
+  for ( size_t i = 0; i < ( sizeof(Dacc) / sizeof(host_Register) ); i++ ) pRegisters[i].pPeripheral = NULL;
+  host_detach(this);
+}
+
+// ENDTX is kept till a counter is written, TXBUFE is both counters at 0
+uint32_t DacPdc::status(void) const
+{
+  uint32_t isr = 0;
+  if ( bEndTx ) isr |= DACC_ISR_ENDTX;
+  if ( ( DACC->DACC_TCR.value == 0 ) && ( DACC->DACC_TNCR.value == 0 ) ) isr |= DACC_ISR_TXBUFE;
+  return isr;
+}
+
+uint32_t DacPdc::readRegister(host_Register *const pRegister)
+{
+  if ( pRegister == &(DACC->DACC_ISR) ) return status();
+  return pRegister->value;
+}
+
+// the control registers act and read 0, the interrupt mask and the channels are set and cleared
+// by their own registers, a counter written clears ENDTX
+void DacPdc::writeRegister(host_Register *const pRegister, const uint32_t value)
+{
+  if ( pRegister == &(DACC->DACC_CR) )
+  {
+    if ( value & DACC_CR_SWRST )
+    {
+      DACC->DACC_MR.value = 0;
+      DACC->DACC_IMR.value = 0;
+      DACC->DACC_CHSR.value = 0;
+    }
+  }
+  else if ( pRegister == &(DACC->DACC_IER) )
+  {
+    DACC->DACC_IMR.value |= value;
+  }
+  else if ( pRegister == &(DACC->DACC_IDR) )
+  {
+    DACC->DACC_IMR.value &= ~value;
+  }
+  else if ( pRegister == &(DACC->DACC_CHER) )
+  {
+    DACC->DACC_CHSR.value |= value;
+  }
+  else if ( pRegister == &(DACC->DACC_CHDR) )
+  {
+    DACC->DACC_CHSR.value &= ~value;
+  }
+  else if ( pRegister == &(DACC->DACC_PTCR) )
+  {
+    if ( value & DACC_PTCR_TXTEN ) bPdc = true;
+    if ( value & DACC_PTCR_TXTDIS ) bPdc = false;
+    DACC->DACC_PTSR.value = ( bPdc ) ? (DACC_PTCR_TXTEN) : (0);
+  }
+  else if ( pRegister == &(DACC->DACC_CDR) )
+  {
+    // the free running mode converts the value at once, the triggered one on the next edge
+    pRegister->value = value;
+    if ( ( DACC->DACC_MR.value & DACC_MR_TRGEN ) == 0 ) convert(value);
+  }
+  else if ( ( pRegister == &(DACC->DACC_IMR) ) || ( pRegister == &(DACC->DACC_ISR) ) ||
+            ( pRegister == &(DACC->DACC_CHSR) ) || ( pRegister == &(DACC->DACC_PTSR) ) )
+  {
+    // read only
+  }
+  else
+  {
+    pRegister->value = value;
+    if ( ( ( pRegister == &(DACC->DACC_TCR) ) || ( pRegister == &(DACC->DACC_TNCR) ) ) && ( value != 0 ) ) bEndTx = false;
+  }
+}
+
+// the value goes out if the channel selected by USER_SEL is enabled
+void DacPdc::convert(const uint32_t data)
+{
+  const uint32_t channel = ( DACC->DACC_MR.value & MR_USER_SEL_Msk ) >> DACC_MR_USER_SEL_Pos;
+  if ( ( DACC->DACC_CHSR.value & ( 1u << channel ) ) == 0 ) return;
+
+  last = (uint16_t)( data & CDR_DATA_Msk );
+  output.push_back(last);
+}
+
+// the rising edge of TIOA0: PDC moves the next half-word to CDR, it is converted
+void DacPdc::trigger(const uint64_t now_ns)
+{
+  const uint32_t mr = DACC->DACC_MR.value;
+  if ( ( ( mr & DACC_MR_TRGEN ) == 0 ) || ( ( mr & MR_TRGSEL_Msk ) != MR_TRGSEL_TIOA0 ) ) return;
+  ++triggers;
+
+  if ( ( ! bPdc ) || ( DACC->DACC_TCR.value == 0 ) )
+  {
+    ++held;
+    return;
+  }
+
+  const uint16_t data = *(const uint16_t*)(uintptr_t)( DACC->DACC_TPR.value );
+  DACC->DACC_TPR.value += 2;
+  if ( --DACC->DACC_TCR.value == 0 )
+  {
+    bEndTx = true;
+    if ( DACC->DACC_TNCR.value > 0 )
+    {
+      DACC->DACC_TPR.value = DACC->DACC_TNPR.value;
+      DACC->DACC_TCR.value = DACC->DACC_TNCR.value;
+      DACC->DACC_TNCR.value = 0;
+    }
+  }
+  DACC->DACC_CDR.value = data;
+  convert(data);
+  interrupt(now_ns);
+}
+
+// the enabled flag is set: the handler is called after the latency, and again while the flag stays
+void DacPdc::interrupt(const uint64_t now_ns)
+{
+  if ( ( status() & DACC->DACC_IMR.value ) == 0 )
+  {
+    bPending = false;
+    return;
+  }
+  if ( ! bPending )
+  {
+    bPending = true;
+    due_ns = now_ns + latency_ns;
+  }
+  if ( due_ns > now_ns ) return;
+
+  bPending = false;
+  ++interrupts;
+  const std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+  DACC_Handler();
+  handler_ns += (uint64_t)std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+}
+
+// TC_CCR is write only: the commands are taken at the step after the sketch has written them
+void DacPdc::step(const uint64_t now_us)
+{
+  const uint64_t now_ns = now_us * 1000;
+  TcChannel *const pChannel = &(TC0->TC_CHANNEL[SAMPLES_CHANNEL]);
+  const uint32_t ccr = pChannel->TC_CCR;
+  pChannel->TC_CCR = 0;
+  if ( ccr & TC_CCR_CLKDIS ) bClock = false;
+  else if ( ccr & TC_CCR_CLKEN ) bClock = true;
+
+  // the waveform up to RC, TIOA0 set on RC compare; the software trigger restarts the counter
+  const uint32_t cmr = pChannel->TC_CMR;
+  const bool bWave = ( cmr & TC_CMR_WAVE ) && ( ( cmr & CMR_WAVSEL_Msk ) == TC_CMR_WAVSEL_UP_RC ) &&
+                     ( ( cmr & CMR_ACPC_Msk ) == TC_CMR_ACPC_SET ) && ( pChannel->TC_RC > 0 );
+  const uint64_t period_ns = ( bWave ) ? ( ( pChannel->TC_RC * 1000000000ULL ) / TIMER_CLOCK1_HZ ) : (0);
+  if ( bClock && ( ccr & TC_CCR_SWTRG ) ) next_ns = last_ns + period_ns;
+
+  while ( bClock && bWave && ( next_ns <= now_ns ) )
+  {
+    interrupt(next_ns);
+    trigger(next_ns);
+    next_ns += period_ns;
+  }
+  interrupt(now_ns);
+  last_ns = now_ns;
+}
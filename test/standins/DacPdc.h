@@ -0,0 +1,58 @@
+#if !defined(__STANDIN_DAC_PDC_HEADER_INCLUDED_)
+#define __STANDIN_DAC_PDC_HEADER_INCLUDED_
+
+// Stand-in of the SAM3X8E DACC with its PDC channel, triggered by TIOA0 of TC0 channel 0: on
+// every rising edge of TIOA0 (RC compare) one half-word is taken by PDC from TPR and converted;
+// when TCR reaches 0 ENDTX is set and the next buffer (TNPR/TNCR) is taken, TXBUFE is set when
+// both counters are 0, and the flags are cleared by writing a counter. The interrupt (DACC_Handler)
+// is called while an enabled flag is set, after the latency given. It is written from the
+// datasheet (DACC, PDC and TC chapters), not from the sketch.
+
+#include <Arduino.h>
+#include <host.h>
+#include <vector>
+
+class DacPdc : public host_Device, public host_Peripheral
+{
+public:
+  DacPdc(void);
+  ~DacPdc(void);
+
+  void step(const uint64_t now_us);
+  uint32_t readRegister(host_Register *const pRegister);
+  void writeRegister(host_Register *const pRegister, const uint32_t value);
+
+  // the interrupt is taken that late after its flag is set (a longer handler, the interrupts disabled)
+  void setLatency(const uint32_t us) { latency_ns = us * 1000ULL; }
+
+  // the output now (the last converted value), and the TIOA0 edges are coming
+  uint16_t value(void) const { return last; }
+  bool isTriggering(void) const { return bClock; }
+
+  // the values converted since the start, in the order of the conversions
+  std::vector<uint16_t> output;
+
+  // the counters since the start
+  uint32_t triggers;            // TIOA0 edges with the trigger enabled
+  uint32_t held;                // the edges without the value from PDC (the output stays)
+  uint32_t interrupts;          // DACC_Handler calls
+  uint64_t handler_ns;          // host time spent in DACC_Handler, nanoseconds
+
+private:
+  void trigger(const uint64_t now_ns);
+  void interrupt(const uint64_t now_ns);
+  void convert(const uint32_t data);
+  uint32_t status(void) const;
+
+  bool bClock;                  // TC0 channel 0 is clocked
+  bool bPdc;                    // PDC transmitter is enabled
+  bool bEndTx;                  // TCR has reached 0 since the last write of a counter
+  bool bPending;                // the interrupt is waiting for its latency
+  uint16_t last;
+  uint64_t next_ns;             // the next RC compare
+  uint64_t last_ns;             // the previous step (the sketch has run since then)
+  uint64_t due_ns;              // the pending interrupt is taken
+  uint64_t latency_ns;
+};
+
+#endif // __STANDIN_DAC_PDC_HEADER_INCLUDED_
@@ -0,0 +1,120 @@
+#include "SH1107.h"
+
+#include "hwconfig.h"
+
+// the control byte: Co - one byte follows, then the next control byte; D/C - the bytes are RAM data
+#define CONTROL_CO            (0x80)
+#define CONTROL_DC            (0x40)
+
+// the panel: the COM lines are the RAM rows (128), the segments are the visible columns
+#define PANEL_ROWS            (128)
+#define PANEL_SEGMENTS        (DISPLAY_COLUMNS)
+
+SH1107::SH1107(void) :
+  transactions(0), bytes(0), dataBytes(0), commands(0), unknownCommands(0), hiddenWrites(0),
+  page(0), column(0), argumentOf(0), bOn(false), bInverse(false), bEntireOn(false), contrastValue(0x80), start(0)
+{
+  // the RAM content is random after the power on
+  for ( unsigned int i = 0; i < sizeof(memory); i++ ) ( &memory[0][0] )[i] = (uint8_t)( ( i * 151 ) >> 3 );
+}
+
+// the commands of the datasheet (SH1107 rev 0.1, "Command Table")
+void SH1107::command(const uint8_t value)
+{
+  ++commands;
+
+  if ( argumentOf != 0 )
+  {
+    if ( argumentOf == 0x81 ) contrastValue = value;
+    if ( argumentOf == 0xDC ) start = value & 0x7F;
+    argumentOf = 0;
+    return;
+  }
+
+  if ( value <= 0x0F ) column = ( column & 0x70 ) | value;                       // lower column address
+  else if ( value <= 0x17 ) column = ( ( value & 0x07 ) << 4 ) | ( column & 0x0F ); // higher column address
+  else if ( ( value & 0xF0 ) == 0xB0 ) page = value & 0x0F;                      // page address
+  else if ( ( value == 0xAE ) || ( value == 0xAF ) ) bOn = ( value == 0xAF );
+  else if ( ( value == 0xA6 ) || ( value == 0xA7 ) ) bInverse = ( value == 0xA7 );
+  else if ( ( value == 0xA4 ) || ( value == 0xA5 ) ) bEntireOn = ( value == 0xA5 );
+  else if ( ( value == 0x20 ) || ( value == 0x21 ) || ( value == 0xA0 ) || ( value == 0xA1 ) ||
+            ( ( value & 0xF0 ) == 0xC0 ) || ( value == 0xE0 ) || ( value == 0xEE ) || ( value == 0xE3 ) )
+  {
+    // the addressing mode, the remaps, read-modify-write and NOP are not used by the frames
+  }
+  else if ( ( value == 0x81 ) || ( value == 0xA8 ) || ( value == 0xAD ) || ( value == 0xD3 ) || ( value == 0xD5 ) ||
+            ( value == 0xD9 ) || ( value == 0xDB ) || ( value == 0xDC ) )
+  {
+    argumentOf = value;
+  }
+  else
+  {
+    ++unknownCommands;
+  }
+}
+
+// page addressing mode: the column moves on after every byte, the page stays
+void SH1107::data(const uint8_t value)
+{
+  ++dataBytes;
+  if ( ( column < DISPLAY_COLUMN_OFFSET ) || ( column >= ( DISPLAY_COLUMN_OFFSET + PANEL_SEGMENTS ) ) ) ++hiddenWrites;
+  memory[page][column & 0x7F] = value;
+  column = ( column + 1 ) & 0x7F;
+}
+
+bool SH1107::write(const uint8_t *const pData, const size_t size)
+{
+  ++transactions;
+  bytes += 1 + size;
+
+  size_t i = 0;
+  while ( i < size )
+  {
+    const uint8_t control = pData[i++];
+    if ( control & CONTROL_CO )
+    {
+      if ( i >= size ) break;
+      if ( control & CONTROL_DC ) data(pData[i++]); else command(pData[i++]);
+      continue;
+    }
+    while ( i < size )
+    {
+      if ( control & CONTROL_DC ) data(pData[i++]); else command(pData[i++]);
+    }
+  }
+  return true;
+}
+
+// the status byte: bit 6 - the display is off
+bool SH1107::read(uint8_t *const pData, const size_t size)
+{
+  memset(pData, ( bOn ) ? (0x00) : (0x40), size);
+  return true;
+}
+
+// the module is mounted rotated: the panel x is the RAM row (from the start line),
+// the panel y is the column from the right end
+std::string SH1107::pbm(void) const
+{
+  char header[32];
+  snprintf(header, sizeof(header), "P4\n%u %u\n", PANEL_ROWS, PANEL_SEGMENTS);
+  std::string image(header);
+
+  for ( unsigned int y = 0; y < PANEL_SEGMENTS; y++ )
+  {
+    const unsigned int segment = DISPLAY_COLUMN_OFFSET + PANEL_SEGMENTS - 1 - y;
+    for ( unsigned int x = 0; x < PANEL_ROWS; x += 8 )
+    {
+      uint8_t pixels = 0;
+      for ( unsigned int bit = 0; bit < 8; bit++ )
+      {
+        const unsigned int row = ( x + bit + start ) % PANEL_ROWS;
+        bool bLit = ( ( memory[row >> 3][segment] >> ( row & 7 ) ) & 1 ) != 0;
+        bLit = bOn && ( bEntireOn || ( bLit != bInverse ) );
+        if ( bLit ) pixels |= 0x80 >> bit;
+      }
+      image += (char)pixels;
+    }
+  }
+  return image;
+}
@@ -0,0 +1,54 @@
+#if !defined(__STANDIN_SH1107_HEADER_INCLUDED_)
+#define __STANDIN_SH1107_HEADER_INCLUDED_
+
+// Stand-in of the SH1107 OLED controller of the 128x64 module (hwconfig.h geometry) on I2C:
+// it decodes the transactions by the datasheet (control bytes, commands with their arguments,
+// the display RAM writes in the page addressing mode) into its own 128x128 RAM, and draws
+// what the panel shows as PBM. It is written from the datasheet, not from the sketch, so the
+// frames sent by thePanel are checked by something which does not share its code.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <string>
+
+class SH1107 : public host_I2CDevice
+{
+public:
+  SH1107(void);
+
+  bool write(const uint8_t *const pData, const size_t size);
+  bool read(uint8_t *const pData, const size_t size);
+
+  // what the panel shows: binary PBM, the rotated module is 128 pixels wide and 64 high
+  std::string pbm(void) const;
+  // the RAM byte, 8 rows of the column
+  uint8_t ram(const unsigned int page, const unsigned int column) const { return memory[page & 0x0F][column & 0x7F]; }
+
+  bool isOn(void) const { return bOn; }
+  uint8_t contrast(void) const { return contrastValue; }
+  uint8_t startLine(void) const { return start; }
+
+  // the counters since the start
+  uint32_t transactions;
+  uint32_t bytes;               // I2C bytes, the address bytes included
+  uint32_t dataBytes;
+  uint32_t commands;
+  uint32_t unknownCommands;
+  uint32_t hiddenWrites;        // the data written outside of the visible columns
+
+private:
+  void command(const uint8_t value);
+  void data(const uint8_t value);
+
+  uint8_t memory[16][128];
+  unsigned int page;
+  unsigned int column;
+  uint8_t argumentOf;           // the command waiting for its argument byte (0 - none)
+  bool bOn;
+  bool bInverse;
+  bool bEntireOn;
+  uint8_t contrastValue;
+  uint8_t start;
+};
+
+#endif // __STANDIN_SH1107_HEADER_INCLUDED_
@@ -0,0 +1,22 @@
+#include "SdaHolder.h"
+
+SdaHolder::SdaHolder(const uint32_t sda, const uint32_t scl) :
+  clocks(0), sda(sda), scl(scl), left(0)
+{
+  host_watchPin(scl, this);
+}
+
+void SdaHolder::hold(const unsigned int bits)
+{
+  left = bits;
+  host_holdPin(sda, ( left > 0 ));
+}
+
+// the slave shifts its next bit out on every SCL clock, SDA is released after the last one
+void SdaHolder::line(const uint32_t pin, const int level)
+{
+  if ( ( pin != scl ) || ( level != HIGH ) || ( left == 0 ) ) return;
+
+  ++clocks;
+  if ( --left == 0 ) host_holdPin(sda, false);
+}
@@ -0,0 +1,34 @@
+#if !defined(__STANDIN_SDA_HOLDER_HEADER_INCLUDED_)
+#define __STANDIN_SDA_HOLDER_HEADER_INCLUDED_
+
+// Stand-in of the slave which has lost the clock in the middle of its byte (a glitch on SCL,
+// the master reset during the read): it holds SDA low till SCL has clocked the rest of its
+// bits out, then it releases the line. Every transaction on the bus fails meanwhile. It is
+// the behaviour of any I2C slave (I2C-bus specification, "Bus clear"), not of a certain chip.
+
+#include <Arduino.h>
+#include <host.h>
+
+class SdaHolder : public host_Device
+{
+public:
+  // SCL is watched for the clocks
+  SdaHolder(const uint32_t sda, const uint32_t scl);
+
+  void step(const uint64_t now_us) { (void)now_us; }
+  void line(const uint32_t pin, const int level);
+
+  // SDA is held low till the SCL rising edges of the 'bits' left
+  void hold(const unsigned int bits);
+  bool isHolding(void) const { return ( left > 0 ); }
+
+  // SCL rising edges seen while SDA was held
+  uint32_t clocks;
+
+private:
+  const uint32_t sda;
+  const uint32_t scl;
+  unsigned int left;
+};
+
+#endif // __STANDIN_SDA_HOLDER_HEADER_INCLUDED_
@@ -0,0 +1,19 @@
+#if !defined(__HOST_ADAFRUIT_GFX_HEADER_INCLUDED_)
+#define __HOST_ADAFRUIT_GFX_HEADER_INCLUDED_
+
+// Host stand-in of Adafruit GFX: the sketch draws by itself (theCanvas), only the class is used
+
+#include <Arduino.h>
+
+class Adafruit_GFX
+{
+public:
+  Adafruit_GFX(int16_t width, int16_t height) : width(width), height(height) {}
+  virtual ~Adafruit_GFX() {}
+
+protected:
+  int16_t width;
+  int16_t height;
+};
+
+#endif // __HOST_ADAFRUIT_GFX_HEADER_INCLUDED_
@@ -0,0 +1,24 @@
+#if !defined(__HOST_ADAFRUIT_SH110X_HEADER_INCLUDED_)
+#define __HOST_ADAFRUIT_SH110X_HEADER_INCLUDED_
+
+// Host stand-in of Adafruit SH110X: begin() sends the initialization commands of the
+// SH1107 (the display stand-in sees them on Wire1), the frames are sent by thePanel
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_GFX.h>
+
+#define SH110X_BLACK          (0)
+#define SH110X_WHITE          (1)
+
+class Adafruit_SH110X : public Adafruit_GFX
+{
+public:
+  Adafruit_SH110X(uint16_t width, uint16_t height, TwoWire *pWire);
+  bool begin(uint8_t address, bool reset = true);
+
+private:
+  TwoWire *pWire;
+};
+
+#endif // __HOST_ADAFRUIT_SH110X_HEADER_INCLUDED_
@@ -0,0 +1,90 @@
+#if !defined(__HOST_ARDUINO_HEADER_INCLUDED_)
+#define __HOST_ARDUINO_HEADER_INCLUDED_
+
+// Host stand-in of the Arduino Due core, only what the sketch uses. The time is simulated
+// (it moves only when the test or a device stand-in moves it), the pins and the interrupts
+// are driven by the tests and the device stand-ins, see host.h.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "sam.h"
+
+#define HIGH                  (1)
+#define LOW                   (0)
+
+#define INPUT                 (0)
+#define OUTPUT                (1)
+#define INPUT_PULLUP          (2)
+
+#define CHANGE                (2)
+#define FALLING               (3)
+#define RISING                (4)
+
+#define DEC                   (10)
+#define HEX                   (16)
+
+#define VARIANT_MCK           (84000000)
+
+// the pins of the board (the interrupt number is the pin number on Due)
+#define PINS_COUNT            (79)
+#define digitalPinToInterrupt(p) (p)
+
+extern unsigned long millis(void);
+extern unsigned long micros(void);
+extern void delay(unsigned long ms);
+extern void delayMicroseconds(unsigned int us);
+
+extern void pinMode(uint32_t pin, uint32_t mode);
+extern void digitalWrite(uint32_t pin, uint32_t value);
+extern int digitalRead(uint32_t pin);
+extern void attachInterrupt(uint32_t pin, void (*callback)(void), uint32_t mode);
+extern void detachInterrupt(uint32_t pin);
+
+extern void noInterrupts(void);
+extern void interrupts(void);
+extern void yield(void);
+
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t value) = 0;
+  size_t write(const uint8_t *pData, size_t size);
+
+  size_t print(const char *pStr);
+  size_t print(char value);
+  size_t print(int value, int base = DEC);
+  size_t print(unsigned int value, int base = DEC);
+  size_t print(long value, int base = DEC);
+  size_t print(unsigned long value, int base = DEC);
+  size_t println(void);
+  size_t println(const char *pStr);
+  size_t println(int value, int base = DEC);
+  size_t println(unsigned int value, int base = DEC);
+  size_t println(long value, int base = DEC);
+  size_t println(unsigned long value, int base = DEC);
+};
+
+// the output is kept by the host (host_serialOutput), nothing is received
+class HardwareSerial : public Print
+{
+public:
+  void begin(unsigned long baud);
+  void end(void);
+  int available(void);
+  int read(void);
+  void flush(void);
+  size_t write(uint8_t value);
+  using Print::write;
+  operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial3;
+
+#endif // __HOST_ARDUINO_HEADER_INCLUDED_
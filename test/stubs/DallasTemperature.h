@@ -0,0 +1,30 @@
+#if !defined(__HOST_DALLAS_TEMPERATURE_HEADER_INCLUDED_)
+#define __HOST_DALLAS_TEMPERATURE_HEADER_INCLUDED_
+
+// Host stand-in of Dallas Temperature: the sensors on the bus and their temperatures are set by the test
+
+#include <Arduino.h>
+#include <OneWire.h>
+
+typedef uint8_t DeviceAddress[8];
+
+#define DEVICE_DISCONNECTED_RAW (-7040)
+
+class DallasTemperature
+{
+public:
+  DallasTemperature(OneWire *pWire);
+  void begin(void);
+  void setWaitForConversion(bool wait);
+  void requestTemperatures(void);
+  uint8_t getDeviceCount(void);
+  bool getAddress(uint8_t *pAddress, uint8_t index);
+  // the raw value (1/128 Celsius)
+  int16_t getTemp(const uint8_t *pAddress);
+};
+
+// the sensors found by the next begin(), and their raw temperatures (DEVICE_DISCONNECTED_RAW - failure)
+extern void host_termoSensors(const unsigned int count);
+extern void host_termoRaw(const unsigned int sensor, const int16_t raw);
+
+#endif // __HOST_DALLAS_TEMPERATURE_HEADER_INCLUDED_
@@ -0,0 +1,122 @@
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+
+#include "host.h"
+
+#define PAGES                 ( IFLASH1_SIZE / IFLASH1_PAGE_SIZE )
+
+static uint8_t flash[IFLASH1_SIZE];
+static uint32_t erases[PAGES];
+static uint32_t programs = 0;
+static uint32_t tear = 0;
+
+// internal routines
+static bool erased(void);
+
+// the flash is erased when the board comes from the factory
+static const bool bErased = erased();
+
+//----------------------------------------------------------
+
+static bool erased(void)
+{
+  memset(flash, 0xFF, sizeof(flash));
+  return true;
+}
+
+uint8_t *host_flash(const uint32_t offset)
+{
+  return &(flash[offset]);
+}
+
+uint32_t host_flashErases(const unsigned int page)
+{
+  return ( page < PAGES ) ? (erases[page]) : (0);
+}
+
+uint32_t host_flashPrograms(void)
+{
+  return programs;
+}
+
+void host_flashTear(const uint32_t bytes)
+{
+  tear = bytes;
+}
+
+uint8_t DueFlashStorage::read(uint32_t address)
+{
+  return flash[address];
+}
+
+uint8_t *DueFlashStorage::readAddress(uint32_t address)
+{
+  return &(flash[address]);
+}
+
+bool DueFlashStorage::write(uint32_t address, uint8_t value)
+{
+  return write(address, &value, 1);
+}
+
+bool DueFlashStorage::write(uint32_t address, uint8_t *pData, uint32_t size)
+{
+  const uint32_t target = (uint32_t)(uintptr_t)readAddress(address);
+  if ( flash_unlock(target, target + size - 1, 0, 0) != FLASH_RC_OK ) return false;
+  const bool result = ( flash_write(target, pData, size, 1) == FLASH_RC_OK );
+  flash_lock(target, target + size - 1, 0, 0);
+  return result;
+}
+
+uint32_t flash_unlock(uint32_t start, uint32_t end, uint32_t *pActualStart, uint32_t *pActualEnd)
+{
+  if ( pActualStart != NULL ) *pActualStart = start;
+  if ( pActualEnd != NULL ) *pActualEnd = end;
+  return FLASH_RC_OK;
+}
+
+uint32_t flash_lock(uint32_t start, uint32_t end, uint32_t *pActualStart, uint32_t *pActualEnd)
+{
+  if ( pActualStart != NULL ) *pActualStart = start;
+  if ( pActualEnd != NULL ) *pActualEnd = end;
+  return FLASH_RC_OK;
+}
+
+// every page touched is programmed from the page latch: with the erase the page is the old content
+// overlaid by the data, without the erase the data bits are ANDed into the page
+uint32_t flash_write(uint32_t address, const void *pBuffer, uint32_t size, const uint32_t erase)
+{
+  uint8_t *const pTarget = (uint8_t *)(uintptr_t)address;
+  if ( ( pTarget < flash ) || ( ( pTarget + size ) > ( flash + sizeof(flash) ) ) ) return FLASH_RC_ERROR;
+  const uint32_t offset = pTarget - flash;
+  const uint8_t *const pData = (const uint8_t *)pBuffer;
+  const uint32_t written = ( ( tear > 0 ) && ( tear < size ) ) ? (tear) : (size);
+  const bool bTorn = ( tear > 0 );
+  tear = 0;
+
+  for ( uint32_t page = offset / IFLASH1_PAGE_SIZE; page <= ( offset + size - 1 ) / IFLASH1_PAGE_SIZE; page++ )
+  {
+    uint8_t latch[IFLASH1_PAGE_SIZE];
+    memcpy(latch, &(flash[page * IFLASH1_PAGE_SIZE]), IFLASH1_PAGE_SIZE);
+    for ( uint32_t i = 0; i < IFLASH1_PAGE_SIZE; i++ )
+    {
+      const uint32_t at = page * IFLASH1_PAGE_SIZE + i;
+      if ( ( at < offset ) || ( at >= ( offset + size ) ) ) continue;
+      if ( at >= ( offset + written ) )
+      {
+        // the torn program: the erased bytes stay erased, the others stay as they were
+        if ( erase ) latch[i] = 0xFF;
+        continue;
+      }
+      latch[i] = ( erase ) ? (pData[at - offset]) : ( latch[i] & pData[at - offset] );
+    }
+    if ( erase )
+    {
+      ++erases[page];
+      memset(&(flash[page * IFLASH1_PAGE_SIZE]), 0xFF, IFLASH1_PAGE_SIZE);
+    }
+    for ( uint32_t i = 0; i < IFLASH1_PAGE_SIZE; i++ ) flash[page * IFLASH1_PAGE_SIZE + i] &= latch[i];
+    ++programs;
+  }
+  return ( bTorn ) ? (FLASH_RC_ERROR) : (FLASH_RC_OK);
+}
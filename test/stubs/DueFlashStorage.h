@@ -0,0 +1,38 @@
+#if !defined(__HOST_DUE_FLASH_STORAGE_HEADER_INCLUDED_)
+#define __HOST_DUE_FLASH_STORAGE_HEADER_INCLUDED_
+
+// Host stand-in of DueFlashStorage and the EEFC flash routines it is built on. The flash bank 1
+// is a RAM array: the erased bits are ones, the write without the erase only clears bits, the
+// write with the erase programs the whole page. The erases are counted per page, and the
+// program could be torn (stopped in the middle) to play a power loss.
+
+#include <Arduino.h>
+
+#define IFLASH1_ADDR          (0xC0000u)
+#define IFLASH1_SIZE          (0x40000u)
+#define IFLASH1_PAGE_SIZE     (256)
+#define FLASH_RC_OK           (0)
+#define FLASH_RC_ERROR        (0x10)
+
+class DueFlashStorage
+{
+public:
+  uint8_t read(uint32_t address);
+  uint8_t *readAddress(uint32_t address);
+  bool write(uint32_t address, uint8_t value);
+  bool write(uint32_t address, uint8_t *pData, uint32_t size);
+};
+
+extern uint32_t flash_unlock(uint32_t start, uint32_t end, uint32_t *pActualStart, uint32_t *pActualEnd);
+extern uint32_t flash_lock(uint32_t start, uint32_t end, uint32_t *pActualStart, uint32_t *pActualEnd);
+// the address is the one given by readAddress()
+extern uint32_t flash_write(uint32_t address, const void *pBuffer, uint32_t size, const uint32_t erase);
+
+// the flash of the host, offsets from the start of the bank
+extern uint8_t *host_flash(const uint32_t offset);
+extern uint32_t host_flashErases(const unsigned int page);
+extern uint32_t host_flashPrograms(void);
+// the next flash_write programs only 'bytes' bytes and fails (0 - no tear)
+extern void host_flashTear(const uint32_t bytes);
+
+#endif // __HOST_DUE_FLASH_STORAGE_HEADER_INCLUDED_
@@ -0,0 +1,18 @@
+#if !defined(__HOST_MHZ19_HEADER_INCLUDED_)
+#define __HOST_MHZ19_HEADER_INCLUDED_
+
+// Host stand-in of MH-Z19: the reading is set by the test
+
+#include <Arduino.h>
+
+class MHZ19
+{
+public:
+  void begin(HardwareSerial &serial);
+  // ppm, 0 - no answer
+  int getCO2(void);
+};
+
+extern void host_co2(const int ppm);
+
+#endif // __HOST_MHZ19_HEADER_INCLUDED_
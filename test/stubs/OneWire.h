@@ -0,0 +1,17 @@
+#if !defined(__HOST_ONE_WIRE_HEADER_INCLUDED_)
+#define __HOST_ONE_WIRE_HEADER_INCLUDED_
+
+// Host stand-in of OneWire: the bus is played by DallasTemperature stand-in
+
+#include <Arduino.h>
+
+class OneWire
+{
+public:
+  OneWire(uint8_t pin) : pin(pin) {}
+
+private:
+  uint8_t pin;
+};
+
+#endif // __HOST_ONE_WIRE_HEADER_INCLUDED_
@@ -0,0 +1,252 @@
+#include <Arduino.h>
+#include <Wire.h>
+
+// Wire is TWI1 on SDA/SCL (pins 20, 21), Wire1 is TWI0 on SDA1/SCL1 (pins 70, 71)
+TwoWire Wire(20, 21, TWI1);
+TwoWire Wire1(70, 71, TWI0);
+
+TwoWire::TwoWire(const uint32_t sda, const uint32_t scl, Twi *const pTwi) :
+  sda(sda), scl(scl), frequency(100000), address(0), txSize(0), rxSize(0), rxIndex(0), count(0),
+  pTwi(pTwi), bAttached(false), bPdc(false), bHolding(false), holding(0), bStop(false), bus_ns(0), twiSize(0), twiBytes(0)
+{
+  memset(devices, 0, sizeof(devices));
+}
+
+void TwoWire::begin(void)
+{
+  host_peripheralPin(sda);
+  host_peripheralPin(scl);
+  frequency = 100000;
+
+  if ( ! bAttached )
+  {
+    host_attach(this);
+    host_Register *const pRegisters = &(pTwi->TWI_CR);
+    for ( size_t i = 0; i < ( sizeof(Twi) / sizeof(host_Register) ); i++ ) pRegisters[i].pPeripheral = this;
+  }
+  bAttached = true;
+  reset();
+}
+
+// the peripheral is reset: nothing to send, the last transaction is complete
+void TwoWire::reset(void)
+{
+  bPdc = false;
+  bHolding = false;
+  bStop = false;
+  twiSize = 0;
+  pTwi->TWI_TCR.value = 0;
+  pTwi->TWI_TNCR.value = 0;
+  pTwi->TWI_PTSR.value = 0;
+  pTwi->TWI_SR.value = TWI_SR_TXCOMP;
+  status();
+}
+
+void TwoWire::begin(const int address)
+{
+  (void)address;
+  begin();
+}
+
+void TwoWire::setClock(const uint32_t frequency)
+{
+  this->frequency = frequency;
+}
+
+void TwoWire::attach(const uint8_t address, host_I2CDevice *const pDevice)
+{
+  devices[address & 0x7F] = pDevice;
+}
+
+// the transfer of the bytes (and the address) takes its time; the stuck bus takes the timeout
+bool TwoWire::busy(const size_t bytes)
+{
+  ++count;
+  if ( host_line(sda) == LOW )
+  {
+    host_advance(HOST_WIRE_TIMEOUT_US);
+    return false;
+  }
+  host_advance(( ( bytes + 1 ) * 9 * 1000000ULL ) / frequency);
+  return true;
+}
+
+void TwoWire::beginTransmission(const uint8_t address)
+{
+  this->address = address;
+  txSize = 0;
+}
+
+void TwoWire::beginTransmission(const int address)
+{
+  beginTransmission((uint8_t)address);
+}
+
+size_t TwoWire::write(const uint8_t value)
+{
+  if ( txSize >= sizeof(txBuffer) ) return 0;
+  txBuffer[txSize++] = value;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *const pData, const size_t size)
+{
+  for ( size_t i = 0; i < size; i++ )
+  {
+    if ( write(pData[i]) == 0 ) return i;
+  }
+  return size;
+}
+
+// 0 - success, 2 - NACK of the address, 3 - NACK of the data, 4 - the bus error
+uint8_t TwoWire::endTransmission(const uint8_t sendStop)
+{
+  (void)sendStop;
+  if ( ! busy(txSize) ) return 4;
+  host_I2CDevice *const pDevice = devices[address & 0x7F];
+  if ( pDevice == NULL ) return 2;
+  return ( pDevice->write(txBuffer, txSize) ) ? (0) : (3);
+}
+
+// the internal address is written first (TWI_IADR), then the bytes are read
+uint8_t TwoWire::requestFrom(const uint8_t address, const uint8_t quantity, const uint32_t iaddress, const uint8_t isize, const uint8_t sendStop)
+{
+  (void)sendStop;
+  rxSize = 0;
+  rxIndex = 0;
+  const size_t size = ( quantity < sizeof(rxBuffer) ) ? (quantity) : (sizeof(rxBuffer));
+  if ( ! busy(isize + size) ) return 0;
+  host_I2CDevice *const pDevice = devices[address & 0x7F];
+  if ( pDevice == NULL ) return 0;
+  if ( isize > 0 )
+  {
+    uint8_t internal[4];
+    for ( unsigned int i = 0; i < isize; i++ ) internal[i] = (uint8_t)( iaddress >> ( 8 * ( isize - 1 - i ) ) );
+    if ( ! pDevice->write(internal, isize) ) return 0;
+  }
+  if ( ! pDevice->read(rxBuffer, size) ) return 0;
+  rxSize = size;
+  return (uint8_t)size;
+}
+
+// the STOP is on the bus: the transaction is given to the device at TWI_MMR address
+void TwoWire::stop(void)
+{
+  host_I2CDevice *const pDevice = devices[( pTwi->TWI_MMR.value >> 16 ) & 0x7F];
+  const bool bAck = ( pDevice != NULL ) && pDevice->write(twiBuffer, twiSize);
+
+  ++count;
+  twiSize = 0;
+  bStop = false;
+  pTwi->TWI_SR.value |= TWI_SR_TXCOMP | ( ( bAck ) ? (0) : (TWI_SR_NACK) );
+}
+
+// the flags of the buffers: THR is free, the PDC counters are done
+void TwoWire::status(void)
+{
+  uint32_t sr = pTwi->TWI_SR.value & ( TWI_SR_TXCOMP | TWI_SR_NACK );
+  if ( ! bHolding ) sr |= TWI_SR_TXRDY;
+  if ( pTwi->TWI_TCR.value == 0 ) sr |= TWI_SR_ENDTX;
+  if ( ( pTwi->TWI_TCR.value == 0 ) && ( pTwi->TWI_TNCR.value == 0 ) ) sr |= TWI_SR_TXBUFE;
+  pTwi->TWI_SR.value = sr;
+}
+
+// NACK is cleared by the read of the status
+uint32_t TwoWire::readRegister(host_Register *const pRegister)
+{
+  const uint32_t value = pRegister->value;
+  if ( pRegister == &(pTwi->TWI_SR) ) pRegister->value &= ~TWI_SR_NACK;
+  return value;
+}
+
+// the control registers act and read 0, THR is taken by the peripheral, the counters update the flags
+void TwoWire::writeRegister(host_Register *const pRegister, const uint32_t value)
+{
+  if ( pRegister == &(pTwi->TWI_CR) )
+  {
+    if ( value & TWI_CR_SWRST ) reset();
+    if ( value & TWI_CR_STOP ) bStop = true;
+  }
+  else if ( pRegister == &(pTwi->TWI_PTCR) )
+  {
+    if ( value & TWI_PTCR_TXTEN ) bPdc = true;
+    if ( value & TWI_PTCR_TXTDIS ) bPdc = false;
+    pTwi->TWI_PTSR.value = ( bPdc ) ? (TWI_PTCR_TXTEN) : (0);
+  }
+  else if ( pRegister == &(pTwi->TWI_THR) )
+  {
+    holding = (uint8_t)value;
+    bHolding = true;
+  }
+  else
+  {
+    pRegister->value = value;
+  }
+  status();
+}
+
+// the bytes go out at the bus clock: PDC bytes first, then the THR byte
+void TwoWire::step(const uint64_t now_us)
+{
+  const uint64_t now_ns = now_us * 1000;
+  const uint64_t byte_ns = ( 9 * 1000000000ULL ) / frequency;
+  // the stuck bus moves nothing
+  while ( ( bus_ns <= now_ns ) && ( host_line(sda) != LOW ) )
+  {
+    bool bLast = false;
+    uint8_t value;
+    if ( bPdc && ( pTwi->TWI_TCR.value > 0 ) )
+    {
+      value = *(const uint8_t*)(uintptr_t)( pTwi->TWI_TPR.value++ );
+      // the next buffer is taken when the current one is done
+      if ( ( --pTwi->TWI_TCR.value == 0 ) && ( pTwi->TWI_TNCR.value > 0 ) )
+      {
+        pTwi->TWI_TPR.value = pTwi->TWI_TNPR.value;
+        pTwi->TWI_TCR.value = pTwi->TWI_TNCR.value;
+        pTwi->TWI_TNCR.value = 0;
+      }
+    }
+    else if ( bHolding )
+    {
+      value = holding;
+      bHolding = false;
+      bLast = bStop;
+    }
+    else
+    {
+      break;
+    }
+
+    // the address byte starts the transaction
+    if ( twiSize == 0 )
+    {
+      pTwi->TWI_SR.value &= ~( TWI_SR_TXCOMP | TWI_SR_NACK );
+      bus_ns += byte_ns;
+      ++twiBytes;
+    }
+    if ( twiSize < HOST_TWI_BUFFER ) twiBuffer[twiSize++] = value;
+    bus_ns += byte_ns;
+    ++twiBytes;
+
+    if ( bLast ) stop();
+  }
+  // the idle bus does not save the time for later
+  if ( bus_ns < now_ns ) bus_ns = now_ns;
+
+  status();
+}
+
+uint8_t TwoWire::requestFrom(const uint8_t address, const uint8_t quantity)
+{
+  return requestFrom(address, quantity, 0, 0, true);
+}
+
+int TwoWire::available(void)
+{
+  return (int)( rxSize - rxIndex );
+}
+
+int TwoWire::read(void)
+{
+  return ( rxIndex < rxSize ) ? (rxBuffer[rxIndex++]) : (-1);
+}
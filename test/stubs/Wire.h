@@ -0,0 +1,96 @@
+#if !defined(__HOST_WIRE_HEADER_INCLUDED_)
+#define __HOST_WIRE_HEADER_INCLUDED_
+
+// Host stand-in of the Arduino Due Wire library. The transfers go to the device stand-ins
+// attached to the bus; a transfer takes the bus time (9 clocks per byte) and fails while
+// SDA is held low, the way the TWI peripheral times out on the stuck bus.
+// The TWI peripheral of the bus is played too, for the sketch which drives its registers
+// (thePanel): the PDC and THR bytes go out at the bus clock, the transaction is given to the
+// device at its STOP, and the status (TXRDY, ENDTX, TXBUFE, TXCOMP, NACK read-clear) follows.
+
+#include <Arduino.h>
+#include "host.h"
+
+// the slave on the bus
+class host_I2CDevice
+{
+public:
+  virtual ~host_I2CDevice() {}
+  // the master has written the bytes (after the address), false - NACK
+  virtual bool write(const uint8_t *const pData, const size_t size) = 0;
+  // the master reads the bytes, false - NACK of the address
+  virtual bool read(uint8_t *const pData, const size_t size) = 0;
+};
+
+// the time the TWI peripheral waits for the stuck bus before it gives up, microseconds
+#define HOST_WIRE_TIMEOUT_US  (1000)
+// the longest transaction sent through the registers
+#define HOST_TWI_BUFFER       (256)
+
+class TwoWire : public host_Device, public host_Peripheral
+{
+public:
+  TwoWire(const uint32_t sda, const uint32_t scl, Twi *const pTwi);
+
+  void begin(void);
+  void begin(const int address);
+  void setClock(const uint32_t frequency);
+
+  void beginTransmission(const uint8_t address);
+  void beginTransmission(const int address);
+  uint8_t endTransmission(const uint8_t sendStop = true);
+  size_t write(const uint8_t value);
+  size_t write(const uint8_t *const pData, const size_t size);
+
+  uint8_t requestFrom(const uint8_t address, const uint8_t quantity, const uint32_t iaddress, const uint8_t isize, const uint8_t sendStop);
+  uint8_t requestFrom(const uint8_t address, const uint8_t quantity);
+  int available(void);
+  int read(void);
+
+  // the device answers at the address (NULL - nobody answers)
+  void attach(const uint8_t address, host_I2CDevice *const pDevice);
+  // transfers done (successful or not) since the start
+  uint32_t transfers(void) const { return count; }
+  // bytes sent through the TWI registers (the address bytes included) since the start
+  uint64_t registerBytes(void) const { return twiBytes; }
+
+  // the TWI peripheral, stepped by the time and accessed by the sketch
+  void step(const uint64_t now_us);
+  uint32_t readRegister(host_Register *const pRegister);
+  void writeRegister(host_Register *const pRegister, const uint32_t value);
+
+private:
+  bool busy(const size_t bytes);
+  void reset(void);
+  void stop(void);
+  void status(void);
+
+  const uint32_t sda;
+  const uint32_t scl;
+  uint32_t frequency;
+  host_I2CDevice *devices[128];
+  uint8_t address;
+  uint8_t txBuffer[64];
+  size_t txSize;
+  uint8_t rxBuffer[64];
+  size_t rxSize;
+  size_t rxIndex;
+  uint32_t count;
+
+  // the TWI peripheral played for its registers
+  Twi *const pTwi;
+  bool bAttached;
+  bool bPdc;                    // PDC transmit is enabled (TWI_PTCR_TXTEN)
+  bool bHolding;                // the byte written to TWI_THR is not sent yet
+  uint8_t holding;
+  bool bStop;                   // STOP after the THR byte (TWI_CR_STOP)
+  uint64_t bus_ns;              // the bus is busy till then
+  uint8_t twiBuffer[HOST_TWI_BUFFER];
+  size_t twiSize;
+  uint64_t twiBytes;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif // __HOST_WIRE_HEADER_INCLUDED_
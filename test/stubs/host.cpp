@@ -0,0 +1,384 @@
+#include <Arduino.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "host.h"
+
+// the peripherals of the board (sam.h)
+Pio host_pioa, host_piob, host_pioc, host_piod;
+Pwm host_pwm;
+Twi host_twi0, host_twi1;
+Dacc host_dacc;
+Tc host_tc0;
+DWT_Type host_dwt;
+CoreDebug_Type host_coredebug;
+
+HardwareSerial Serial;
+HardwareSerial Serial3;
+
+// the mode of the pin given to the peripheral (not driven by GPIO)
+#define MODE_PERIPHERAL       (0xFF)
+
+static struct {
+  uint32_t mode;
+  uint32_t level;             // driven level (OUTPUT)
+  bool bHeld;                 // held low by a device
+  int line;                   // the last level of the line
+  void (*callback)(void);
+  uint32_t edge;              // the interrupt edge (CHANGE, FALLING, RISING)
+  std::vector<host_Device *> watchers;
+} pins[PINS_COUNT];
+
+// the time is read by the threads of the tests too
+static uint64_t now_us = 0;
+static std::vector<host_Device *> devices;
+static bool bStepping = false;
+static std::string serial_output;
+
+// internal routines
+static int level(const uint32_t pin);
+static void update(const uint32_t pin);
+static bool released(void);
+
+// the lines are released (pulled up) at the power-on
+static const bool bReleased = released();
+
+//----------------------------------------------------------
+
+void host_attach(host_Device *const pDevice)
+{
+  devices.push_back(pDevice);
+}
+
+void host_detach(host_Device *const pDevice)
+{
+  devices.erase(std::remove(devices.begin(), devices.end(), pDevice), devices.end());
+}
+
+uint64_t host_now(void)
+{
+  return __atomic_load_n(&now_us, __ATOMIC_RELAXED);
+}
+
+// the devices see the steps of HOST_STEP_US at most; a device moving the time while it is
+// stepped (an interrupt handler waiting) just moves the time
+void host_advance(const uint64_t us)
+{
+  const uint64_t until = host_now() + us;
+  if ( bStepping )
+  {
+    __atomic_store_n(&now_us, until, __ATOMIC_RELAXED);
+    return;
+  }
+  bStepping = true;
+  while ( host_now() < until )
+  {
+    // no device stand-in to step - the time jumps to the end at once
+    const uint64_t left = until - host_now();
+    const uint64_t step = ( devices.empty() || ( left < HOST_STEP_US ) ) ? (left) : (HOST_STEP_US);
+    __atomic_store_n(&now_us, host_now() + step, __ATOMIC_RELAXED);
+    host_dwt.CYCCNT = (uint32_t)( host_now() * ( VARIANT_MCK / 1000000 ) );
+    for ( size_t i = 0; i < devices.size(); i++ ) devices[i]->step(host_now());
+  }
+  bStepping = false;
+}
+
+unsigned long millis(void)
+{
+  return (unsigned long)( host_now() / 1000 );
+}
+
+unsigned long micros(void)
+{
+  return (unsigned long)host_now();
+}
+
+void delay(unsigned long ms)
+{
+  host_advance((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  host_advance(us);
+}
+
+void yield(void)
+{
+}
+
+void noInterrupts(void)
+{
+}
+
+void interrupts(void)
+{
+}
+
+//----------------------------------------------------------
+
+static bool released(void)
+{
+  for ( uint32_t pin = 0; pin < PINS_COUNT; pin++ ) pins[pin].line = HIGH;
+  return true;
+}
+
+// the line is low when it is driven low or held low by a device, the pull-up makes it high otherwise
+static int level(const uint32_t pin)
+{
+  if ( pins[pin].bHeld ) return LOW;
+  if ( ( pins[pin].mode == OUTPUT ) && ( pins[pin].level == LOW ) ) return LOW;
+  return HIGH;
+}
+
+// the watchers see every change of the line, the attached interrupt fires on its edge
+static void update(const uint32_t pin)
+{
+  const int line = level(pin);
+  if ( line == pins[pin].line ) return;
+  pins[pin].line = line;
+  for ( size_t i = 0; i < pins[pin].watchers.size(); i++ ) pins[pin].watchers[i]->line(pin, line);
+  if ( pins[pin].callback == NULL ) return;
+  if ( ( pins[pin].edge == CHANGE ) || ( ( pins[pin].edge == FALLING ) && ( line == LOW ) ) ||
+       ( ( pins[pin].edge == RISING ) && ( line == HIGH ) ) )
+  {
+    pins[pin].callback();
+  }
+}
+
+void host_holdPin(const uint32_t pin, const bool low)
+{
+  if ( pin >= PINS_COUNT ) return;
+  pins[pin].bHeld = low;
+  update(pin);
+}
+
+int host_line(const uint32_t pin)
+{
+  if ( pin >= PINS_COUNT ) return HIGH;
+  return level(pin);
+}
+
+void host_watchPin(const uint32_t pin, host_Device *const pDevice)
+{
+  if ( pin >= PINS_COUNT ) return;
+  pins[pin].watchers.push_back(pDevice);
+}
+
+void host_peripheralPin(const uint32_t pin)
+{
+  if ( pin >= PINS_COUNT ) return;
+  pins[pin].mode = MODE_PERIPHERAL;
+  update(pin);
+}
+
+void pinMode(uint32_t pin, uint32_t mode)
+{
+  if ( pin >= PINS_COUNT ) return;
+  pins[pin].mode = mode;
+  update(pin);
+}
+
+void digitalWrite(uint32_t pin, uint32_t value)
+{
+  if ( pin >= PINS_COUNT ) return;
+  pins[pin].level = ( value == LOW ) ? (LOW) : (HIGH);
+  update(pin);
+}
+
+int digitalRead(uint32_t pin)
+{
+  return host_line(pin);
+}
+
+void attachInterrupt(uint32_t pin, void (*callback)(void), uint32_t mode)
+{
+  if ( pin >= PINS_COUNT ) return;
+  pins[pin].line = level(pin);
+  pins[pin].callback = callback;
+  pins[pin].edge = mode;
+}
+
+void detachInterrupt(uint32_t pin)
+{
+  if ( pin >= PINS_COUNT ) return;
+  pins[pin].callback = NULL;
+}
+
+//----------------------------------------------------------
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+  (void)irq;
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq)
+{
+  (void)irq;
+}
+
+uint32_t pmc_enable_periph_clk(uint32_t id)
+{
+  (void)id;
+  return 0;
+}
+
+uint32_t PIO_Configure(Pio *pPio, const EPioType type, const uint32_t mask, const uint32_t attribute)
+{
+  (void)attribute;
+  if ( ( type == PIO_PERIPH_A ) || ( type == PIO_PERIPH_B ) )
+  {
+    pPio->PIO_PDR = mask;
+    pPio->PIO_PSR &= ~mask;
+    pPio->PIO_ABSR = ( type == PIO_PERIPH_B ) ? ( pPio->PIO_ABSR | mask ) : ( pPio->PIO_ABSR & ~mask );
+  }
+  return 1;
+}
+
+void PWMC_ConfigureChannelExt(Pwm *pPwm, uint32_t channel, uint32_t prescaler, uint32_t alignment, uint32_t polarity,
+                              uint32_t countEventSelect, uint32_t DTEnable, uint32_t DTHInverte, uint32_t DTLInverte)
+{
+  pPwm->PWM_CH_NUM[channel].PWM_CMR = prescaler | alignment | polarity | countEventSelect | DTEnable | DTHInverte | DTLInverte;
+}
+
+void PWMC_SetPeriod(Pwm *pPwm, uint32_t channel, uint16_t period)
+{
+  if ( pPwm->PWM_SR & ( 1u << channel ) )
+  {
+    pPwm->PWM_CH_NUM[channel].PWM_CPRDUPD = period;
+  }
+  else
+  {
+    pPwm->PWM_CH_NUM[channel].PWM_CPRD = period;
+  }
+}
+
+void PWMC_EnableChannel(Pwm *pPwm, uint32_t channel)
+{
+  pPwm->PWM_ENA = 1u << channel;
+  pPwm->PWM_SR |= 1u << channel;
+}
+
+void PWMC_DisableChannel(Pwm *pPwm, uint32_t channel)
+{
+  pPwm->PWM_DIS = 1u << channel;
+  pPwm->PWM_SR &= ~( 1u << channel );
+}
+
+//----------------------------------------------------------
+
+const char *host_serialOutput(void)
+{
+  return serial_output.c_str();
+}
+
+void host_serialClear(void)
+{
+  serial_output.clear();
+}
+
+size_t Print::write(const uint8_t *pData, size_t size)
+{
+  for ( size_t i = 0; i < size; i++ ) write(pData[i]);
+  return size;
+}
+
+size_t Print::print(const char *pStr)
+{
+  return write((const uint8_t *)pStr, strlen(pStr));
+}
+
+size_t Print::print(char value)
+{
+  return write((uint8_t)value);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+  char text[72];
+  char *p = &(text[sizeof(text) - 1]);
+  *p = 0;
+  do {
+    const unsigned int digit = value % base;
+    *--p = (char)( ( digit < 10 ) ? ( '0' + digit ) : ( 'A' + digit - 10 ) );
+    value /= base;
+  } while ( value > 0 );
+  return print(p);
+}
+
+size_t Print::print(long value, int base)
+{
+  if ( ( value < 0 ) && ( base == DEC ) ) return print('-') + print((unsigned long)( -value ), base);
+  return print((unsigned long)value, base);
+}
+
+size_t Print::print(int value, int base)
+{
+  return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+  return print((unsigned long)value, base);
+}
+
+size_t Print::println(void)
+{
+  return print("\r\n");
+}
+
+size_t Print::println(const char *pStr)
+{
+  return print(pStr) + println();
+}
+
+size_t Print::println(int value, int base)
+{
+  return print(value, base) + println();
+}
+
+size_t Print::println(unsigned int value, int base)
+{
+  return print(value, base) + println();
+}
+
+size_t Print::println(long value, int base)
+{
+  return print(value, base) + println();
+}
+
+size_t Print::println(unsigned long value, int base)
+{
+  return print(value, base) + println();
+}
+
+void HardwareSerial::begin(unsigned long baud)
+{
+  (void)baud;
+}
+
+void HardwareSerial::end(void)
+{
+}
+
+int HardwareSerial::available(void)
+{
+  return 0;
+}
+
+int HardwareSerial::read(void)
+{
+  return -1;
+}
+
+void HardwareSerial::flush(void)
+{
+}
+
+size_t HardwareSerial::write(uint8_t value)
+{
+  if ( this == &Serial ) serial_output.push_back((char)value);
+  return 1;
+}
@@ -0,0 +1,45 @@
+#if !defined(__HOST_HOST_HEADER_INCLUDED_)
+#define __HOST_HOST_HEADER_INCLUDED_
+
+// The simulated board of the host tests: the clock, the pins and the devices on them.
+// Nothing moves by itself - the time is moved by the test (host_advance) or by the sketch
+// waiting (delay, delayMicroseconds, the I2C transfers), and every move steps the devices.
+
+#include <Arduino.h>
+
+// the device stand-in: stepped whenever the time moves, it plays the hardware behind the
+// registers and the pins (see test/standins)
+class host_Device
+{
+public:
+  virtual ~host_Device() {}
+  // the time has moved to 'now_us' (the steps are never longer than HOST_STEP_US)
+  virtual void step(const uint64_t now_us) = 0;
+  // the line of the pin has changed its level (the pins watched by host_watchPin)
+  virtual void line(const uint32_t pin, const int level) { (void)pin; (void)level; }
+};
+
+// the longest time step the devices see, microseconds
+#define HOST_STEP_US          (100)
+
+extern void host_attach(host_Device *const pDevice);
+extern void host_detach(host_Device *const pDevice);
+
+// the simulated time, microseconds from the start of the test
+extern uint64_t host_now(void);
+extern void host_advance(const uint64_t us);
+
+// the lines: a line is low when the sketch drives it low (OUTPUT, LOW) or a device holds it low,
+// otherwise it is pulled up. The interrupts attached by the sketch fire on the line edges.
+extern void host_holdPin(const uint32_t pin, const bool low);
+extern int host_line(const uint32_t pin);
+extern void host_watchPin(const uint32_t pin, host_Device *const pDevice);
+// the pins given to the peripheral (Wire begin) are not driven by GPIO any more
+extern void host_peripheralPin(const uint32_t pin);
+
+// the serial output of the sketch (Serial), cleared by the test
+extern const char *host_serialOutput(void);
+extern void host_serialClear(void);
+
+
+#endif // __HOST_HOST_HEADER_INCLUDED_
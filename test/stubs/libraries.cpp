@@ -0,0 +1,115 @@
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_SH110X.h>
+#include <DallasTemperature.h>
+#include <MHZ19.h>
+
+#include "host.h"
+
+// the sensors of the 1-Wire bus
+#define TERMO_MAX             (8)
+
+static unsigned int termo_count = 0;
+static unsigned int termo_found = 0;
+static int16_t termo_raw[TERMO_MAX];
+static int co2_ppm = 0;
+
+//----------------------------------------------------------
+
+Adafruit_SH110X::Adafruit_SH110X(uint16_t width, uint16_t height, TwoWire *pWire) :
+  Adafruit_GFX(width, height), pWire(pWire)
+{
+}
+
+// the initialization commands of SH1107 64x128 (as the library sends them)
+bool Adafruit_SH110X::begin(uint8_t address, bool reset)
+{
+  (void)reset;
+  static const uint8_t cInit[] = {
+    0x00,                                     // the command stream
+    0xAE,                                     // display off
+    0xD5, 0x51,                               // clock divider
+    0x81, 0x4F,                               // contrast
+    0xAD, 0x8A,                               // DC-DC on
+    0xA0,                                     // segment remap
+    0xC0,                                     // common scan direction
+    0xDC, 0x00,                               // display start line
+    0xD3, 0x60,                               // display offset
+    0xD9, 0x22,                               // pre-charge period
+    0xDB, 0x35,                               // VCOM deselect level
+    0xA8, 0x3F,                               // multiplex ratio
+    0xA4,                                     // the RAM is shown
+    0xA6,                                     // normal (not inverted)
+    0xAF,                                     // display on
+  };
+  pWire->beginTransmission(address);
+  pWire->write(cInit, sizeof(cInit));
+  return ( pWire->endTransmission() == 0 );
+}
+
+//----------------------------------------------------------
+
+void host_termoSensors(const unsigned int count)
+{
+  termo_count = ( count < TERMO_MAX ) ? (count) : (TERMO_MAX);
+}
+
+void host_termoRaw(const unsigned int sensor, const int16_t raw)
+{
+  if ( sensor < TERMO_MAX ) termo_raw[sensor] = raw;
+}
+
+DallasTemperature::DallasTemperature(OneWire *pWire)
+{
+  (void)pWire;
+}
+
+void DallasTemperature::begin(void)
+{
+  termo_found = termo_count;
+}
+
+void DallasTemperature::setWaitForConversion(bool wait)
+{
+  (void)wait;
+}
+
+void DallasTemperature::requestTemperatures(void)
+{
+}
+
+uint8_t DallasTemperature::getDeviceCount(void)
+{
+  return (uint8_t)termo_found;
+}
+
+// the address is the sensor index in the first byte
+bool DallasTemperature::getAddress(uint8_t *pAddress, uint8_t index)
+{
+  if ( index >= termo_found ) return false;
+  memset(pAddress, 0, sizeof(DeviceAddress));
+  pAddress[0] = index;
+  return true;
+}
+
+int16_t DallasTemperature::getTemp(const uint8_t *pAddress)
+{
+  return ( pAddress[0] < termo_found ) ? (termo_raw[pAddress[0]]) : (DEVICE_DISCONNECTED_RAW);
+}
+
+//----------------------------------------------------------
+
+void host_co2(const int ppm)
+{
+  co2_ppm = ppm;
+}
+
+void MHZ19::begin(HardwareSerial &serial)
+{
+  (void)serial;
+}
+
+int MHZ19::getCO2(void)
+{
+  return co2_ppm;
+}
@@ -0,0 +1,250 @@
+#if !defined(__HOST_SAM_HEADER_INCLUDED_)
+#define __HOST_SAM_HEADER_INCLUDED_
+
+// Host stand-in of the SAM3X8E CMSIS definitions used by the sketch. The peripherals are plain
+// structs in RAM (host.cpp); a device stand-in (test/standins) plays the hardware behind the
+// registers, e.g. PDC counters are moved by it, the write-only registers are consumed by it.
+
+#include <stdint.h>
+
+typedef volatile uint32_t RwReg;
+typedef volatile uint32_t RoReg;
+typedef volatile uint32_t WoReg;
+
+typedef struct {
+  RwReg PIO_PER, PIO_PDR, PIO_PSR, PIO_OER, PIO_ODR, PIO_OSR, PIO_SODR, PIO_CODR, PIO_ODSR, PIO_PDSR;
+  RwReg PIO_IER, PIO_IDR, PIO_IMR, PIO_ISR, PIO_MDER, PIO_MDDR, PIO_PUDR, PIO_PUER, PIO_ABSR;
+} Pio;
+
+typedef struct {
+  RwReg PWM_CMR, PWM_CDTY, PWM_CDTYUPD, PWM_CPRD, PWM_CPRDUPD, PWM_CCNT, PWM_DT, PWM_DTUPD;
+} PwmCh_num;
+
+typedef struct {
+  RwReg PWM_CLK, PWM_ENA, PWM_DIS, PWM_SR, PWM_IER1, PWM_IDR1, PWM_IMR1, PWM_ISR1;
+  PwmCh_num PWM_CH_NUM[8];
+} Pwm;
+
+// The register of the peripheral played by a device stand-in (host_Peripheral): the sketch
+// reads and writes it the way it does the hardware one, and the stand-in sees every access -
+// the status is read as it is at the moment (and its read-clear bits are cleared), the write
+// of a counter updates its flags at once, the write-only registers are consumed.
+// No constructor: the peripherals are zero before the stand-ins take their registers.
+struct host_Register;
+
+class host_Peripheral
+{
+public:
+  virtual ~host_Peripheral() {}
+  virtual uint32_t readRegister(host_Register *const pRegister) = 0;
+  virtual void writeRegister(host_Register *const pRegister, const uint32_t value) = 0;
+};
+
+struct host_Register
+{
+  uint32_t value;                     // the content, as the stand-in keeps it
+  host_Peripheral *pPeripheral;       // the stand-in (NULL - the register is plain memory)
+
+  operator uint32_t() { return ( pPeripheral != NULL ) ? ( pPeripheral->readRegister(this) ) : (value); }
+  host_Register &operator=(const uint32_t data)
+  {
+    if ( pPeripheral != NULL ) pPeripheral->writeRegister(this, data); else value = data;
+    return *this;
+  }
+  host_Register &operator|=(const uint32_t data) { return *this = ( (uint32_t)*this | data ); }
+  host_Register &operator&=(const uint32_t data) { return *this = ( (uint32_t)*this & data ); }
+};
+
+typedef struct {
+  host_Register TWI_CR, TWI_MMR, TWI_SMR, TWI_IADR, TWI_CWGR, TWI_SR, TWI_IER, TWI_IDR, TWI_IMR, TWI_RHR, TWI_THR;
+  host_Register TWI_RPR, TWI_RCR, TWI_TPR, TWI_TCR, TWI_RNPR, TWI_RNCR, TWI_TNPR, TWI_TNCR, TWI_PTCR, TWI_PTSR;
+} Twi;
+
+typedef struct {
+  host_Register DACC_CR, DACC_MR, DACC_CHER, DACC_CHDR, DACC_CHSR, DACC_CDR, DACC_IER, DACC_IDR, DACC_IMR, DACC_ISR;
+  host_Register DACC_TPR, DACC_TCR, DACC_TNPR, DACC_TNCR, DACC_PTCR, DACC_PTSR;
+} Dacc;
+
+typedef struct {
+  RwReg TC_CCR, TC_CMR, TC_SMMR, TC_CV, TC_RA, TC_RB, TC_RC, TC_SR, TC_IER, TC_IDR, TC_IMR;
+} TcChannel;
+
+typedef struct {
+  TcChannel TC_CHANNEL[3];
+} Tc;
+
+typedef struct {
+  RwReg CTRL, CYCCNT;
+} DWT_Type;
+
+typedef struct {
+  RwReg DEMCR;
+} CoreDebug_Type;
+
+extern Pio host_pioa, host_piob, host_pioc, host_piod;
+extern Pwm host_pwm;
+extern Twi host_twi0, host_twi1;
+extern Dacc host_dacc;
+extern Tc host_tc0;
+extern DWT_Type host_dwt;
+extern CoreDebug_Type host_coredebug;
+
+#define PIOA                  (&host_pioa)
+#define PIOB                  (&host_piob)
+#define PIOC                  (&host_pioc)
+#define PIOD                  (&host_piod)
+#define PWM                   (&host_pwm)
+#define TWI0                  (&host_twi0)
+#define TWI1                  (&host_twi1)
+#define DACC                  (&host_dacc)
+#define TC0                   (&host_tc0)
+#define DWT                   (&host_dwt)
+#define CoreDebug             (&host_coredebug)
+
+#define PWM_INTERFACE         PWM
+#define PWM_INTERFACE_ID      ID_PWM
+
+// peripheral identifiers
+#define ID_PIOA               (11)
+#define ID_PIOB               (12)
+#define ID_PIOC               (13)
+#define ID_PIOD               (14)
+#define ID_TWI0               (22)
+#define ID_TWI1               (23)
+#define ID_TC0                (27)
+#define ID_PWM                (36)
+#define ID_DACC               (38)
+
+typedef enum {
+  TWI0_IRQn = ID_TWI0,
+  TWI1_IRQn = ID_TWI1,
+  TC0_IRQn = ID_TC0,
+  PWM_IRQn = ID_PWM,
+  DACC_IRQn = ID_DACC
+} IRQn_Type;
+
+typedef enum {
+  PIO_NOT_A_PIN,
+  PIO_PERIPH_A,
+  PIO_PERIPH_B,
+  PIO_INPUT,
+  PIO_OUTPUT_0,
+  PIO_OUTPUT_1
+} EPioType;
+
+#define PIO_DEFAULT           (0u)
+
+typedef enum {
+  PWM_CH0, PWM_CH1, PWM_CH2, PWM_CH3, PWM_CH4, PWM_CH5, PWM_CH6, PWM_CH7
+} EPWMChannel;
+
+// the PWM pins (peripheral B)
+#define PIO_PA8B_PWMH0        (1u << 8)
+#define PIO_PA9B_PWMH3        (1u << 9)
+#define PIO_PA12B_PWML1       (1u << 12)
+#define PIO_PA13B_PWMH2       (1u << 13)
+#define PIO_PA19B_PWMH1       (1u << 19)
+#define PIO_PA20B_PWML2       (1u << 20)
+#define PIO_PA21B_PWML0       (1u << 21)
+#define PIO_PA0B_PWML3        (1u << 0)
+#define PIO_PB12B_PWMH0       (1u << 12)
+#define PIO_PB13B_PWMH1       (1u << 13)
+#define PIO_PB14B_PWMH2       (1u << 14)
+#define PIO_PB15B_PWMH3       (1u << 15)
+#define PIO_PB16B_PWML0       (1u << 16)
+#define PIO_PB17B_PWML1       (1u << 17)
+#define PIO_PB18B_PWML2       (1u << 18)
+#define PIO_PB19B_PWML3       (1u << 19)
+#define PIO_PC2B_PWML0        (1u << 2)
+#define PIO_PC3B_PWMH0        (1u << 3)
+#define PIO_PC4B_PWML1        (1u << 4)
+#define PIO_PC5B_PWMH1        (1u << 5)
+#define PIO_PC6B_PWML2        (1u << 6)
+#define PIO_PC7B_PWMH2        (1u << 7)
+#define PIO_PC8B_PWML3        (1u << 8)
+#define PIO_PC9B_PWMH3        (1u << 9)
+#define PIO_PC18B_PWMH6       (1u << 18)
+#define PIO_PC19B_PWMH5       (1u << 19)
+#define PIO_PC20B_PWMH4       (1u << 20)
+#define PIO_PC21B_PWML4       (1u << 21)
+#define PIO_PC22B_PWML5       (1u << 22)
+#define PIO_PC23B_PWML6       (1u << 23)
+#define PIO_PC24B_PWML7       (1u << 24)
+
+#define PWM_CMR_CPRE_MCK          (0x0u)
+#define PWM_CMR_CPRE_MCK_DIV_2    (0x1u)
+#define PWM_CMR_CPRE_MCK_DIV_4    (0x2u)
+#define PWM_CMR_CPRE_MCK_DIV_8    (0x3u)
+#define PWM_CMR_CPRE_MCK_DIV_16   (0x4u)
+#define PWM_CMR_CPRE_MCK_DIV_32   (0x5u)
+#define PWM_CMR_CPRE_MCK_DIV_64   (0x6u)
+#define PWM_CMR_CPRE_MCK_DIV_128  (0x7u)
+#define PWM_CMR_CPRE_MCK_DIV_256  (0x8u)
+#define PWM_CMR_CPRE_MCK_DIV_512  (0x9u)
+#define PWM_CMR_CPRE_MCK_DIV_1024 (0xAu)
+#define PWM_CMR_CPRE_CLKA         (0xBu)
+#define PWM_CMR_CPRE_CLKB         (0xCu)
+
+#define TWI_CR_START          (1u << 0)
+#define TWI_CR_STOP           (1u << 1)
+#define TWI_CR_MSEN           (1u << 2)
+#define TWI_CR_MSDIS          (1u << 3)
+#define TWI_CR_SVDIS          (1u << 5)
+#define TWI_CR_SWRST          (1u << 7)
+#define TWI_MMR_IADRSZ_1_BYTE (1u << 8)
+#define TWI_MMR_MREAD         (1u << 12)
+#define TWI_MMR_DADR(value)   ( ( 0x7Fu << 16 ) & ( (uint32_t)(value) << 16 ) )
+#define TWI_SR_TXCOMP         (1u << 0)
+#define TWI_SR_RXRDY          (1u << 1)
+#define TWI_SR_TXRDY          (1u << 2)
+#define TWI_SR_NACK           (1u << 8)
+#define TWI_SR_ENDRX          (1u << 12)
+#define TWI_SR_ENDTX          (1u << 13)
+#define TWI_SR_TXBUFE         (1u << 15)
+#define TWI_PTCR_RXTEN        (1u << 0)
+#define TWI_PTCR_RXTDIS       (1u << 1)
+#define TWI_PTCR_TXTEN        (1u << 8)
+#define TWI_PTCR_TXTDIS       (1u << 9)
+
+#define DACC_CR_SWRST         (1u << 0)
+#define DACC_MR_TRGEN         (1u << 0)
+#define DACC_MR_TRGEN_EN      (1u << 0)
+#define DACC_MR_TRGSEL(value) ( ( 0x7u << 1 ) & ( (uint32_t)(value) << 1 ) )
+#define DACC_MR_REFRESH(value) ( ( 0xFFu << 8 ) & ( (uint32_t)(value) << 8 ) )
+#define DACC_MR_USER_SEL_Pos  (16)
+#define DACC_MR_STARTUP_1024  (0x10u << 24)
+#define DACC_IER_ENDTX        (1u << 2)
+#define DACC_IDR_ENDTX        (1u << 2)
+#define DACC_ISR_ENDTX        (1u << 2)
+#define DACC_ISR_TXBUFE       (1u << 3)
+#define DACC_PTCR_TXTEN       (1u << 8)
+#define DACC_PTCR_TXTDIS      (1u << 9)
+
+#define TC_CCR_CLKEN          (1u << 0)
+#define TC_CCR_CLKDIS         (1u << 1)
+#define TC_CCR_SWTRG          (1u << 2)
+#define TC_CMR_TCCLKS_TIMER_CLOCK1 (0x0u)
+#define TC_CMR_WAVSEL_UP_RC   (0x2u << 13)
+#define TC_CMR_WAVE           (1u << 15)
+#define TC_CMR_ACPA_CLEAR     (0x2u << 16)
+#define TC_CMR_ACPC_SET       (0x1u << 18)
+
+#define CoreDebug_DEMCR_TRCENA_Msk (1u << 24)
+#define DWT_CTRL_CYCCNTENA_Msk (1u << 0)
+
+extern void NVIC_EnableIRQ(IRQn_Type irq);
+extern void NVIC_DisableIRQ(IRQn_Type irq);
+extern uint32_t pmc_enable_periph_clk(uint32_t id);
+extern uint32_t PIO_Configure(Pio *pPio, const EPioType type, const uint32_t mask, const uint32_t attribute);
+
+extern void PWMC_ConfigureChannelExt(Pwm *pPwm, uint32_t channel, uint32_t prescaler, uint32_t alignment, uint32_t polarity,
+                                     uint32_t countEventSelect, uint32_t DTEnable, uint32_t DTHInverte, uint32_t DTLInverte);
+extern void PWMC_SetPeriod(Pwm *pPwm, uint32_t channel, uint16_t period);
+extern void PWMC_EnableChannel(Pwm *pPwm, uint32_t channel);
+extern void PWMC_DisableChannel(Pwm *pPwm, uint32_t channel);
+
+extern "C" void PWM_Handler(void);
+extern "C" void DACC_Handler(void);
+extern "C" int sysTickHook(void);
+
+#endif // __HOST_SAM_HEADER_INCLUDED_
@@ -0,0 +1,75 @@
+#if !defined(__THE_CLOCK_TEST_HEADER_INCLUDED_)
+#define __THE_CLOCK_TEST_HEADER_INCLUDED_
+
+// The checks of the host tests: a failed check is printed and counted, the test goes on,
+// TEST_END() is the exit code of the test program (ctest sees the failure).
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static unsigned int test_checks = 0;
+static unsigned int test_failures = 0;
+
+#define CHECK(condition) \
+  do { \
+    ++test_checks; \
+    if ( ! (condition) ) \
+    { \
+      ++test_failures; \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+    } \
+  } while ( 0 )
+
+#define CHECK_EQUAL(expected, actual) \
+  do { \
+    ++test_checks; \
+    const long long test_expected = (long long)(expected); \
+    const long long test_actual = (long long)(actual); \
+    if ( test_expected != test_actual ) \
+    { \
+      ++test_failures; \
+      printf("%s:%d: CHECK_EQUAL(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #expected, #actual, \
+             test_expected, test_actual); \
+    } \
+  } while ( 0 )
+
+// the data is the same as the golden file test/golden/<name> (the tests run in test folder),
+// the golden files are written instead when TEST_GOLDEN_UPDATE is set in the environment
+#define CHECK_GOLDEN(name, pData, size) \
+  do { \
+    ++test_checks; \
+    if ( ! test_golden((name), (pData), (size)) ) \
+    { \
+      ++test_failures; \
+      printf("%s:%d: CHECK_GOLDEN(%s) failed: golden/%s differs\n", __FILE__, __LINE__, #name, (name)); \
+    } \
+  } while ( 0 )
+
+static inline bool test_golden(const char *const pName, const void *const pData, const size_t size)
+{
+  char path[256];
+  snprintf(path, sizeof(path), "golden/%s", pName);
+
+  if ( getenv("TEST_GOLDEN_UPDATE") != NULL )
+  {
+    FILE *const pFile = fopen(path, "wb");
+    if ( pFile == NULL ) return false;
+    const bool bWritten = ( fwrite(pData, 1, size, pFile) == size );
+    fclose(pFile);
+    return bWritten;
+  }
+
+  FILE *const pFile = fopen(path, "rb");
+  if ( pFile == NULL ) return false;
+  bool bSame = true;
+  const unsigned char *const pBytes = (const unsigned char*)pData;
+  for ( size_t i = 0; bSame && ( i < size ); i++ ) bSame = ( fgetc(pFile) == pBytes[i] );
+  bSame = bSame && ( fgetc(pFile) == EOF );
+  fclose(pFile);
+  return bSame;
+}
+
+#define TEST_END() \
+  ( printf("%u checks, %u failed\n", test_checks, test_failures), ( test_failures == 0 ) ? 0 : 1 )
+
+#endif // __THE_CLOCK_TEST_HEADER_INCLUDED_
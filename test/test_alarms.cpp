@@ -0,0 +1,395 @@
+// theAlarms on the host: the time is reported to theData second by second, and DS3231 Alarm1
+// is played by the test - theRTC_setAlarm() is wrapped by the linker (see CMakeLists.txt), the
+// alarm matches at ss=00 of the programmed minute, and its flag is handled up to 3 seconds later
+// (after theAlarms_process has seen the new minute). Every due occurrence must be matched and
+// sound with the sound of its first slot, nothing else may match, the one-shot alarms are done
+// once they have sounded, and the next due one is armed after every alarm. The slots survive
+// the restart from flash, only the changed pages are written, and the lookup and the rebuild
+// are timed with all the slots used.
+
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+#include <host.h>
+#include <chrono>
+
+#include "hwconfig.h"
+#include "pwm_lib.h"
+#include "theTime.h"
+#include "theNVM.h"
+#include "theAlarms.h"
+#include "theData.h"
+#include "theBuzzer.h"
+#include "theSpeaker.h"
+#include "test.h"
+
+#define SECOND_US             (1000000ULL)
+#define MINUTES_PER_DAY       (1440)
+#define MINUTES_PER_WEEK      ( 7 * MINUTES_PER_DAY )
+#define SECONDS_PER_WEEK      ( MINUTES_PER_WEEK * 60UL )
+#define NO_SLOT               (-1)
+
+// the first tone of the sound, PWM ticks of the buzzer channel: the melody starts at 1047 Hz,
+// the beeps (beep, fast, double) at BUZZER_FREQUENCY; the chime is played by theSpeaker
+#define BUZZER_CHANNEL        ( arduino_due::pwm_lib::pin_traits<arduino_due::pwm_lib::pwm_pin::BUZZER_PWM_PIN>::channel )
+#define TONE_CLOCK            ( arduino_due::pwm_lib::pwm_core::clock_for_period(BUZZER_REST_PERIOD) )
+#define TONE_TICKS(period)    ( arduino_due::pwm_lib::pwm_core::to_ticks((period), TONE_CLOCK) )
+#define MELODY_PERIOD         ( 100000000UL / 1047 )
+
+// DS3231 Alarm1 as theRTC programs it, and its flag (A1F) with the time it was set
+static struct {
+  bool bEnabled;
+  int dow;
+  int hour;
+  int minute;
+  uint32_t writes;
+  bool bFlag;
+  uint32_t flag_time;
+} chip;
+
+// the slots as the test has set them (the free one has an invalid hour), and the first slot
+// due at every minute of the week (Monday 00:00 is 0)
+static theAlarms_alarm_t slots[ALARMS_MAX];
+static int16_t first_due[MINUTES_PER_WEEK];
+
+// the alarms as they have gone
+static struct {
+  uint32_t due;                 // the occurrences due by the slots
+  uint32_t matched;             // the chip has matched Alarm1
+  uint32_t right;               // the alarm has sounded with the sound of its first slot
+  uint32_t wrong;               // another sound, or none
+  uint32_t missed;              // due, but the chip has not matched
+  uint32_t spurious;            // matched, but nothing was due
+  uint32_t misarmed;            // the next one armed after the alarm is not the next due
+  uint64_t lookups;             // the minutes seen by theAlarms_process
+  double lookup_ns;             // theAlarms_process of the new minute (host time)
+} result;
+
+// seconds since 2000-01-01 00:00:00 of the simulated clock
+static uint32_t now_time = 0;
+
+// theRTC_setAlarm() of theAlarms comes here: the linker wraps the (mangled) symbol
+extern "C" void __wrap__Z15theRTC_setAlarmbiii(const bool enabled, const int dow, const int hour, const int minute)
+{
+  chip.bEnabled = enabled;
+  chip.dow = dow;
+  chip.hour = hour;
+  chip.minute = minute;
+  ++chip.writes;
+}
+
+static unsigned int week_minute(const uint32_t time)
+{
+  return ( ( theTime_dayOfWeek(time / TIME_SECONDS_PER_DAY) - 1 ) * MINUTES_PER_DAY ) + ( ( time % TIME_SECONDS_PER_DAY ) / 60 );
+}
+
+// the expected schedule, by the slots and independently of theAlarms.cpp
+static void schedule(void)
+{
+  for ( unsigned int minute = 0; minute < MINUTES_PER_WEEK; minute++ )
+  {
+    first_due[minute] = NO_SLOT;
+    const unsigned int day = minute / MINUTES_PER_DAY;
+    const unsigned int of_day = minute % MINUTES_PER_DAY;
+    for ( unsigned int slot = 0; ( slot < ALARMS_MAX ) && ( first_due[minute] == NO_SLOT ); slot++ )
+    {
+      const theAlarms_alarm_t *const pSlot = &(slots[slot]);
+      if ( ( pSlot->hour < 24 ) && ( pSlot->flags & ALARM_ENABLED ) && ( pSlot->weekdays & ( 1 << day ) ) &&
+           ( ( ( pSlot->hour * 60 ) + pSlot->minute ) == (int)of_day ) )
+      {
+        first_due[minute] = slot;
+      }
+    }
+  }
+}
+
+static void set(const unsigned int slot, const int hour, const int minute, const uint8_t weekdays, const uint8_t flags)
+{
+  const theAlarms_alarm_t alarm = { (uint8_t)hour, (uint8_t)minute, weekdays, flags };
+  CHECK(theAlarms_set(slot, &alarm));
+  slots[slot] = alarm;
+}
+
+static void clear(void)
+{
+  for ( unsigned int slot = 0; slot < ALARMS_MAX; slot++ )
+  {
+    CHECK(theAlarms_set(slot, NULL));
+    memset(&(slots[slot]), 0xFF, sizeof(theAlarms_alarm_t));
+  }
+}
+
+// the beeps start with the same tone
+static int sound_of(const uint8_t flags)
+{
+  const int sound = flags & ALARM_SOUND_MASK;
+  return ( ( sound == buzzer_sound_fast ) || ( sound == buzzer_sound_double ) ) ? (buzzer_sound_beep) : (sound);
+}
+
+// what is sounding: -1 nothing, buzzer_sound_beep (any beeps), buzzer_sound_melody or buzzer_sound_chime
+static int heard(void)
+{
+  if ( theSpeaker_isPlaying() ) return buzzer_sound_chime;
+  if ( ! theBuzzer_isBuzzing() ) return -1;
+  const uint32_t ticks = PWM_INTERFACE->PWM_CH_NUM[BUZZER_CHANNEL].PWM_CPRDUPD;
+  if ( ticks == TONE_TICKS(BUZZER_PERIOD) ) return buzzer_sound_beep;
+  if ( ticks == TONE_TICKS(MELODY_PERIOD) ) return buzzer_sound_melody;
+  return buzzer_sound_max;
+}
+
+static void report(void)
+{
+  const int32_t days = now_time / TIME_SECONDS_PER_DAY;
+  const uint32_t seconds = now_time % TIME_SECONDS_PER_DAY;
+  const theTime_date_t date = theTime_civilFromDays(days);
+  theData_reportRTC_date(date.year - TIME_EPOCH_YEAR, date.month, date.day, theTime_dayOfWeek(days));
+  theData_reportRTC_time(seconds / 3600, ( seconds / 60 ) % 60, seconds % 60, millis());
+}
+
+static void set_time(const uint32_t time)
+{
+  now_time = time;
+  report();
+}
+
+// the flag is handled: the alarm sounds, the one-shot slots of the minute are done,
+// and the next due occurrence after the minute is armed
+static void handle_flag(void)
+{
+  chip.bFlag = false;
+  const unsigned int minute = week_minute(chip.flag_time);
+  theData_reportRTC_alarm();
+  const int sound = heard();
+  theBuzzer_stop();
+
+  const int slot = first_due[minute];
+  if ( slot == NO_SLOT ) return;
+  if ( sound == sound_of(slots[slot].flags) ) ++result.right; else ++result.wrong;
+
+  for ( unsigned int i = 0; i < ALARMS_MAX; i++ )
+  {
+    const theAlarms_alarm_t *const pSlot = &(slots[i]);
+    if ( ( pSlot->hour < 24 ) && ( pSlot->flags & ALARM_ONE_SHOT ) && ( pSlot->flags & ALARM_ENABLED ) &&
+         ( ( minute % MINUTES_PER_DAY ) == (unsigned int)( ( pSlot->hour * 60 ) + pSlot->minute ) ) &&
+         ( pSlot->weekdays & ( 1 << ( minute / MINUTES_PER_DAY ) ) ) )
+    {
+      slots[i].flags &= ~ALARM_ENABLED;
+    }
+  }
+  schedule();
+
+  int next = NO_SLOT;
+  unsigned int next_minute = minute;
+  for ( unsigned int i = 1; ( i <= MINUTES_PER_WEEK ) && ( next == NO_SLOT ); i++ )
+  {
+    next_minute = ( minute + i ) % MINUTES_PER_WEEK;
+    next = first_due[next_minute];
+  }
+  const bool bArmed = ( next != NO_SLOT ) && chip.bEnabled && ( chip.dow == (int)( next_minute / MINUTES_PER_DAY ) + 1 ) &&
+                      ( ( ( chip.hour * 60 ) + chip.minute ) == (int)( next_minute % MINUTES_PER_DAY ) );
+  if ( ( next == NO_SLOT ) ? (chip.bEnabled) : ( ! bArmed ) ) ++result.misarmed;
+}
+
+// the main loop second by second: the chip updates its second (and matches Alarm1 at ss=00),
+// theData gets the time, theAlarms sees it, then the flag is handled 'late' seconds after
+// the match (0...3, by turns)
+static void run(const uint32_t seconds)
+{
+  for ( uint32_t i = 0; i < seconds; i++ )
+  {
+    host_advance(SECOND_US);
+    ++now_time;
+    const unsigned int minute = week_minute(now_time);
+    if ( ( now_time % 60 ) == 0 )
+    {
+      const bool bMatch = chip.bEnabled && ( chip.dow == (int)( minute / MINUTES_PER_DAY ) + 1 ) &&
+                          ( ( ( chip.hour * 60 ) + chip.minute ) == (int)( minute % MINUTES_PER_DAY ) );
+      const bool bDue = ( first_due[minute] != NO_SLOT );
+      if ( bDue ) ++result.due;
+      if ( bDue && ( ! bMatch ) ) ++result.missed;
+      if ( bMatch && ( ! bDue ) ) ++result.spurious;
+      if ( bMatch )
+      {
+        ++result.matched;
+        chip.bFlag = true;
+        chip.flag_time = now_time;
+      }
+    }
+    report();
+
+    const std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+    theAlarms_process(millis());
+    if ( ( now_time % 60 ) == 0 )
+    {
+      ++result.lookups;
+      result.lookup_ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+    }
+
+    if ( chip.bFlag && ( ( now_time - chip.flag_time ) >= ( result.matched % 4 ) ) ) handle_flag();
+  }
+}
+
+static void print(const char *const pName)
+{
+  printf("%s: %u due, %u matched, %u right sounds, %u wrong, %u missed, %u spurious, %u misarmed\n", pName,
+         result.due, result.matched, result.right, result.wrong, result.missed, result.spurious, result.misarmed);
+}
+
+static void check_result(void)
+{
+  CHECK(result.due > 0);
+  CHECK_EQUAL(result.due, result.matched);
+  CHECK_EQUAL(result.due, result.right);
+  CHECK_EQUAL(0, result.wrong);
+  CHECK_EQUAL(0, result.missed);
+  CHECK_EQUAL(0, result.spurious);
+  CHECK_EQUAL(0, result.misarmed);
+}
+
+// the alarms page of the slot (flash page erases)
+static uint32_t erases(const unsigned int page)
+{
+  return host_flashErases(( NVM_ALARMS_OFFSET / NVM_PAGE_SIZE ) + page);
+}
+
+int main(void)
+{
+  theNVM_init();
+  theAlarms_init();
+  theData_init();
+  theBuzzer_init();
+  theSpeaker_init();
+
+  // 07:00 and 07:01 every day for 3 weeks, the flag handled 0...3 s after the minute: the alarm
+  // of 07:00 is kept armed till its flag is handled, it sounds with its own sound, not the next one's
+  set_time(theTime_seconds(theTime_daysFromCivil(2021, 3, 1), 0, 0, 0));
+  clear();
+  set(1, 7, 0, ALARM_EVERY_DAY, ALARM_ENABLED | buzzer_sound_beep);
+  set(2, 7, 1, ALARM_EVERY_DAY, ALARM_ENABLED | buzzer_sound_melody);
+  schedule();
+  run(3 * SECONDS_PER_WEEK);
+  print("07:00 and 07:01");
+  CHECK_EQUAL(42, result.due);
+  check_result();
+
+  // the weekday masks, the slots of the same minute (the first one sounds, all the one-shots are done),
+  // the ends of the week, the disabled and empty masks; 2 weeks from Sunday 23:58
+  memset(&result, 0, sizeof(result));
+  clear();
+  set(3, 6, 30, 0x1F, ALARM_ENABLED | buzzer_sound_beep);
+  set(4, 8, 0, 0x60, ALARM_ENABLED | buzzer_sound_melody);
+  set(5, 6, 30, ALARM_EVERY_DAY, ALARM_ENABLED | buzzer_sound_chime);
+  set(10, 12, 0, 0x04, ALARM_ENABLED | ALARM_ONE_SHOT | buzzer_sound_melody);
+  set(11, 12, 0, 0x04, ALARM_ENABLED | ALARM_ONE_SHOT | buzzer_sound_chime);
+  set(20, 23, 59, 0x40, ALARM_ENABLED | buzzer_sound_beep);
+  set(21, 0, 0, 0x01, ALARM_ENABLED | buzzer_sound_melody);
+  set(30, 15, 45, 0x0A, ALARM_ENABLED | buzzer_sound_fast);
+  set(31, 9, 0, ALARM_EVERY_DAY, buzzer_sound_beep);
+  set(32, 10, 0, 0x00, ALARM_ENABLED | buzzer_sound_beep);
+  set(100, 7, 15, 0x10, ALARM_ENABLED | ALARM_ONE_SHOT | buzzer_sound_double);
+  set(200, 21, 0, 0x21, ALARM_ENABLED | buzzer_sound_chime);
+  set(255, 0, 1, ALARM_EVERY_DAY, ALARM_ENABLED | buzzer_sound_melody);
+  schedule();
+  set_time(theTime_seconds(theTime_daysFromCivil(2021, 3, 7), 23, 58, 0));
+  run(SECONDS_PER_WEEK);
+
+  // a one-shot alarm set 2 minutes ahead while the clock runs
+  const uint32_t ahead = now_time + 120;
+  set(50, ( ahead % TIME_SECONDS_PER_DAY ) / 3600, ( ahead / 60 ) % 60, ALARM_EVERY_DAY, ALARM_ENABLED | ALARM_ONE_SHOT | buzzer_sound_beep);
+  schedule();
+  run(SECONDS_PER_WEEK);
+  print("schedule");
+  check_result();
+  theAlarms_stats_t stats;
+  theAlarms_getStats(&stats);
+  CHECK_EQUAL(8, stats.alarms);
+  CHECK_EQUAL(5 + 2 + 7 + 1 + 1 + 2 + 2 + 7, stats.occurrences);
+  const unsigned int one_shots[] = { 10, 11, 50, 100 };
+  for ( unsigned int i = 0; i < ( sizeof(one_shots) / sizeof(one_shots[0]) ); i++ )
+  {
+    theAlarms_alarm_t alarm;
+    CHECK(theAlarms_get(one_shots[i], &alarm));
+    CHECK_EQUAL(ALARM_ONE_SHOT, alarm.flags & ( ALARM_ENABLED | ALARM_ONE_SHOT ));
+  }
+
+  // flash: the slot is written PERIOD_NVM_COMMIT after the change, only its page; the same alarm
+  // is not written again; after the restart the slots are the ones set
+  const unsigned int slots_per_page = NVM_PAGE_SIZE / sizeof(theAlarms_alarm_t);
+  uint32_t before[4];
+  for ( unsigned int page = 0; page < 4; page++ ) before[page] = erases(page);
+  theAlarms_getStats(&stats);
+  const uint32_t commits = stats.commits;
+  set(200, 21, 30, 0x21, ALARM_ENABLED | buzzer_sound_chime);
+  schedule();
+  run(( PERIOD_NVM_COMMIT / 1000 ) - 1);
+  CHECK_EQUAL(before[200 / slots_per_page], erases(200 / slots_per_page));
+  run(2);
+  set(200, 21, 30, 0x21, ALARM_ENABLED | buzzer_sound_chime);
+  run(2 * ( PERIOD_NVM_COMMIT / 1000 ));
+  theAlarms_getStats(&stats);
+  CHECK_EQUAL(1, stats.commits - commits);
+  for ( unsigned int page = 0; page < 4; page++ )
+  {
+    CHECK_EQUAL(before[page] + ( ( page == ( 200 / slots_per_page ) ) ? (1) : (0) ), erases(page));
+  }
+
+  theAlarms_init();
+  unsigned int differ = 0;
+  for ( unsigned int slot = 0; slot < ALARMS_MAX; slot++ )
+  {
+    theAlarms_alarm_t alarm;
+    const bool bStored = theAlarms_get(slot, &alarm);
+    if ( bStored != ( slots[slot].hour < 24 ) ) ++differ;
+    else if ( bStored && ( memcmp(&alarm, &(slots[slot]), sizeof(alarm)) != 0 ) ) ++differ;
+  }
+  printf("flash: %u pages written for one slot changed, %u slots differ after the restart\n", stats.commits - commits, differ);
+  CHECK_EQUAL(0, differ);
+
+  // all the slots used (the pseudo-random alarms of ALARMS_BENCHMARK): one week with all of them
+  // matched, the rebuild and the lookup timed on the host
+  memset(&result, 0, sizeof(result));
+  clear();
+  uint32_t random = 12345;
+  unsigned int occurrences = 0;
+  for ( unsigned int slot = 1; slot < ALARMS_MAX; slot++ )
+  {
+    random = ( random * 1103515245UL ) + 12345UL;
+    const uint8_t weekdays = 1 + ( ( random >> 19 ) % ALARM_EVERY_DAY );
+    set(slot, ( random >> 8 ) % 24, ( random >> 13 ) % 60, weekdays, ALARM_ENABLED | ( ( random >> 27 ) % buzzer_sound_max ));
+    occurrences += __builtin_popcount(weekdays);
+  }
+  schedule();
+  const std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+  theAlarms_process(millis());
+  const double rebuild_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+  run(SECONDS_PER_WEEK);
+  theAlarms_getStats(&stats);
+  print("all the slots");
+  check_result();
+  CHECK_EQUAL(ALARMS_MAX - 1, stats.alarms);
+  CHECK_EQUAL(occurrences, stats.occurrences);
+
+  // the lookup without the schedule: every slot is checked for its next occurrence
+  const unsigned int minute = week_minute(now_time);
+  volatile unsigned int found = 0;
+  const std::chrono::steady_clock::time_point scanned = std::chrono::steady_clock::now();
+  for ( unsigned int i = 0; i < 1000; i++ )
+  {
+    unsigned int best = MINUTES_PER_WEEK;
+    for ( unsigned int slot = 1; slot < ALARMS_MAX; slot++ )
+    {
+      for ( unsigned int day = 0; day < 7; day++ )
+      {
+        if ( ( slots[slot].weekdays & ( 1 << day ) ) == 0 ) continue;
+        const unsigned int at = ( day * MINUTES_PER_DAY ) + ( slots[slot].hour * 60 ) + slots[slot].minute;
+        const unsigned int distance = ( at + MINUTES_PER_WEEK - minute - 1 ) % MINUTES_PER_WEEK;
+        if ( distance < best ) best = distance;
+      }
+    }
+    found = found + best + i;
+  }
+  const double scan_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - scanned).count() / 1000;
+  printf("lookup: %u alarms, %u occurrences, %.0f ns per minute (binary search), %.0f ns by the scan of the slots, rebuild %.0f ns (host)\n",
+         stats.alarms, stats.occurrences, result.lookup_ns / result.lookups, scan_ns, rebuild_ns);
+
+  return TEST_END();
+}
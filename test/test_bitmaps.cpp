@@ -0,0 +1,136 @@
+// theBitmaps generated by the compiler: every bitmap decodes to its size, the identical rows are
+// coalesced, the seven-segment digits are lit only where '8' is, the icons are the pictures,
+// and all the bitmaps drawn as text are the same as the golden file golden/bitmaps.txt.
+
+#include <Arduino.h>
+#include <string>
+
+#include "hwconfig.h"
+#include "theBitmaps.h"
+#include "test.h"
+
+static const char glyphs[] = "0123456789:- ";
+
+// the icons, drawn independently of theBitmaps.cpp
+static const char *const icon_pictures[bitmaps_icon_max] = {
+  "###."
+  "...#"
+  ".##."
+  "#..."
+  "####",
+
+  ".##."
+  "#..#"
+  "#..#"
+  ".##."
+};
+
+static const uint8_t icon_sizes[bitmaps_icon_max][3] = { { 4, 5, 5 }, { 4, 4, 5 } };
+static const uint8_t digits_sizes[bitmaps_digits_max][3] = { { 10, 16, 12 }, { 6, 11, 8 } };
+
+// the rows of the bitmap, decoded the way theCanvas draws them
+static void decode(const theBitmaps_bitmap_t *const pBitmap, uint16_t *const pRows)
+{
+  unsigned int y = 0;
+  for ( unsigned int entry = 0; entry < pBitmap->count; entry++ )
+  {
+    const uint16_t value = pBitmap->pRows[entry];
+    const unsigned int repeat = ( value >> BITMAP_ROW_REPEAT ) + 1;
+    // no pixels past the width, the neighbour entries differ (else they would be one entry)
+    CHECK_EQUAL(0, ( value & BITMAP_ROW_PIXELS ) >> pBitmap->width);
+    if ( entry > 0 ) CHECK(( value & BITMAP_ROW_PIXELS ) != ( pBitmap->pRows[entry - 1] & BITMAP_ROW_PIXELS ));
+    for ( unsigned int i = 0; ( i < repeat ) && ( y < BITMAP_HEIGHT_MAX ); i++ ) pRows[y++] = value & BITMAP_ROW_PIXELS;
+  }
+  CHECK_EQUAL(pBitmap->height, y);
+}
+
+// the bitmap as text: '#' is lit, '.' is not
+static void draw(std::string *const pText, const char *const pName, const theBitmaps_bitmap_t *const pBitmap)
+{
+  uint16_t pixels[BITMAP_HEIGHT_MAX] = { 0 };
+  decode(pBitmap, pixels);
+
+  *pText += pName;
+  *pText += "\n";
+  for ( unsigned int y = 0; y < pBitmap->height; y++ )
+  {
+    for ( unsigned int x = 0; x < pBitmap->width; x++ ) *pText += ( ( pixels[y] >> x ) & 1 ) ? '#' : '.';
+    *pText += "\n";
+  }
+}
+
+int main(void)
+{
+  theBitmaps_init();
+  std::string text;
+
+  for ( unsigned int size = 0; size < bitmaps_digits_max; size++ )
+  {
+    uint16_t eight[BITMAP_HEIGHT_MAX] = { 0 };
+    decode(theBitmaps_getDigit((theBitmaps_digits_t)size, '8'), eight);
+
+    for ( unsigned int i = 0; glyphs[i] != 0; i++ )
+    {
+      const theBitmaps_bitmap_t *const pBitmap = theBitmaps_getDigit((theBitmaps_digits_t)size, glyphs[i]);
+      CHECK(pBitmap != NULL);
+      if ( pBitmap == NULL ) continue;
+      CHECK_EQUAL(digits_sizes[size][0], pBitmap->width);
+      CHECK_EQUAL(digits_sizes[size][1], pBitmap->height);
+      CHECK_EQUAL(digits_sizes[size][2], pBitmap->advance);
+
+      // the segments of any digit are the segments of '8', ' ' is empty
+      uint16_t pixels[BITMAP_HEIGHT_MAX] = { 0 };
+      decode(pBitmap, pixels);
+      unsigned int lit = 0;
+      for ( unsigned int y = 0; y < pBitmap->height; y++ )
+      {
+        if ( glyphs[i] != ':' ) CHECK_EQUAL(0, pixels[y] & ~eight[y]);
+        lit += __builtin_popcount(pixels[y]);
+      }
+      CHECK(( glyphs[i] == ' ' ) ? ( lit == 0 ) : ( lit > 0 ));
+
+      char name[32];
+      snprintf(name, sizeof(name), "digit %s '%c'", ( size == bitmaps_digits_large ) ? "large" : "medium", glyphs[i]);
+      draw(&text, name, pBitmap);
+    }
+
+    // the other characters have no bitmap
+    CHECK(theBitmaps_getDigit((theBitmaps_digits_t)size, 'A') == NULL);
+    CHECK(theBitmaps_getDigit((theBitmaps_digits_t)size, '.') == NULL);
+  }
+
+  for ( unsigned int icon = 0; icon < bitmaps_icon_max; icon++ )
+  {
+    const theBitmaps_bitmap_t *const pBitmap = theBitmaps_getIcon((theBitmaps_icon_t)icon);
+    CHECK_EQUAL(icon_sizes[icon][0], pBitmap->width);
+    CHECK_EQUAL(icon_sizes[icon][1], pBitmap->height);
+    CHECK_EQUAL(icon_sizes[icon][2], pBitmap->advance);
+
+    uint16_t pixels[BITMAP_HEIGHT_MAX] = { 0 };
+    decode(pBitmap, pixels);
+    unsigned int differ = 0;
+    for ( unsigned int y = 0; y < pBitmap->height; y++ )
+    {
+      for ( unsigned int x = 0; x < pBitmap->width; x++ )
+      {
+        const bool bLit = ( icon_pictures[icon][( y * pBitmap->width ) + x] == '#' );
+        if ( bLit != ( ( ( pixels[y] >> x ) & 1 ) != 0 ) ) ++differ;
+      }
+    }
+    CHECK_EQUAL(0, differ);
+
+    char name[32];
+    snprintf(name, sizeof(name), "icon %u", icon);
+    draw(&text, name, pBitmap);
+  }
+
+  CHECK_GOLDEN("bitmaps.txt", text.data(), text.size());
+
+  theBitmaps_stats_t stats;
+  theBitmaps_getStats(&stats);
+  CHECK_EQUAL(( bitmaps_digits_max * 13 ) + bitmaps_icon_max, stats.bitmaps);
+  printf("bitmaps: %u bitmaps, %u entries (%u bytes, raw rows %u bytes), %u bytes of descriptions\n",
+         stats.bitmaps, (unsigned int)( stats.flash_bytes / sizeof(uint16_t) ), stats.flash_bytes, stats.raw_bytes, stats.table_bytes);
+
+  return TEST_END();
+}
@@ -0,0 +1,273 @@
+// theBus on both I2C buses with the faults injected: a slave holding SDA low (the SDA holder
+// stand-in) is released by clocking SCL out and the bus works again, the retries are backed
+// off while it does not; the writes of theRTC not acknowledged are repeated (the adjustment is
+// not lost, the day of week is corrected), the failure is shown till the chip is read out again;
+// thePanel drops the frame on the stuck bus and sends the next one completely, and a main loop
+// stall is not taken for a stuck transaction. The recovery time and the longest main loop pass
+// are measured.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <host.h>
+
+#include "hwconfig.h"
+#include "theTime.h"
+#include "theBus.h"
+#include "theNVM.h"
+#include "theAlarms.h"
+#include "theData.h"
+#include "theRTC.h"
+#include "thePanel.h"
+#include "theBitmaps.h"
+#include "theCanvas.h"
+#include "theChart.h"
+#include "theTrend.h"
+#include "theDisplay.h"
+#include "DS3231.h"
+#include "SH1107.h"
+#include "SdaHolder.h"
+#include "test.h"
+
+// one pass of the main loop every LOOP_US of the simulated time
+#define LOOP_US               (1000)
+#define SECOND_US             (1000000ULL)
+
+static DS3231 *pChip = NULL;
+static SH1107 panel;
+
+// what the clock shows, followed by the main loop
+static struct {
+  uint32_t failed_loops;          // the failure is shown
+  uint32_t hidden_loops;          // the failure is not shown after it was, while the chip does not answer
+  uint64_t time_errors;           // the loops when the shown time is not the chip time
+} shown;
+static bool bFailing = false;     // the chip does not answer from the first failure on
+
+static void observe(void)
+{
+  theData_snapshot_t snapshot;
+  theData_getSnapshot(&snapshot);
+  const bool bFailure = ( strcmp(snapshot.time, "--:--") == 0 );
+  if ( bFailure ) ++shown.failed_loops;
+  if ( bFailing && bFailure ) bFailing = false;
+  if ( ( ! bFailing ) && ( ! bFailure ) && ( shown.failed_loops > 0 ) && ( ! pChip->time() ) ) ++shown.hidden_loops;
+
+  // the software second may start up to a read out period after the chip second,
+  // or up to a millisecond before it (it is counted by millis())
+  theData_timestamp_t now;
+  theData_getTimestamp(&now);
+  const uint32_t time = now.rtc + ( now.ms / 1000 );
+  const uint64_t into = host_now() - pChip->secondStarted();
+  const bool bLate = ( ( time + 1 ) == pChip->time() ) && ( into <= ( ( PERIOD_RTC + 2 ) * 1000ULL ) );
+  const bool bEarly = ( time == ( pChip->time() + 1 ) ) && ( into >= ( SECOND_US - 1000 ) );
+  if ( ( time != pChip->time() ) && ( ! bLate ) && ( ! bEarly ) ) ++shown.time_errors;
+}
+
+// the main loop for the time given, the modules in the order of TheClock.ino
+static void run(const uint64_t us)
+{
+  const uint64_t until = host_now() + us;
+  while ( host_now() < until )
+  {
+    const unsigned long timestamp = millis();
+    theBus_process(timestamp);
+    theData_process(timestamp);
+    theAlarms_process(timestamp);
+    theRTC_process(timestamp);
+    theDisplay_process(timestamp);
+    thePanel_process(timestamp);
+    theChart_process(timestamp);
+    theTrend_process(timestamp);
+    observe();
+    host_advance(LOOP_US);
+  }
+}
+
+// the main loop till the chip second of the minute, 'after_us' into it
+static void run_to(const unsigned int second, const uint64_t after_us)
+{
+  while ( ( ( pChip->time() % 60 ) != second ) || ( ( host_now() - pChip->secondStarted() ) < after_us ) ) run(LOOP_US);
+}
+
+// the display RAM is the frame drawn, after the transfers
+static unsigned int frame_differs(void)
+{
+  while ( thePanel_isBusy() ) run(LOOP_US);
+  const uint8_t *const pFrame = theCanvas_getBuffer();
+  unsigned int differ = 0;
+  for ( unsigned int page = 0; page < DISPLAY_PAGES; page++ )
+  {
+    for ( unsigned int column = 0; column < DISPLAY_COLUMNS; column++ )
+    {
+      if ( panel.ram(page, DISPLAY_COLUMN_OFFSET + column) != pFrame[( page * DISPLAY_COLUMNS ) + column] ) ++differ;
+    }
+  }
+  return differ;
+}
+
+int main(void)
+{
+  // Monday 01 Mar 2021 06:58:30, INT/SQW is wired
+  DS3231 chip(RTC_INT, 123400);
+  pChip = &chip;
+  SdaHolder rtc_holder(RTC_SDA, RTC_SCL);
+  SdaHolder display_holder(DISPLAY_SDA, DISPLAY_SCL);
+  chip.setTime(theTime_seconds(theTime_daysFromCivil(2021, 3, 1), 6, 58, 30));
+  Wire.attach(ADDRESS_RTC, &chip);
+  Wire1.attach(ADDRESS_DISPLAY, &panel);
+
+  theTime_init();
+  theBus_init();
+  theNVM_init();
+  theAlarms_init();
+  theData_init();
+  theRTC_init();
+  thePanel_init();
+  theBitmaps_init();
+  theCanvas_init();
+  theChart_init();
+  theTrend_init();
+  theDisplay_init();
+  run(2 * 60 * SECOND_US);
+  memset(&shown, 0, sizeof(shown));
+
+  // the slave holds SDA with 5 bits of its byte left at the minute edge: the flags read fails,
+  // SCL is clocked out, the retry reads them, the minute tick is counted
+  theBus_stats_t bus;
+  theRTC_stats_t before, stats;
+  theRTC_getStats(&before);
+  const uint32_t chip_minutes = chip.alarm2;
+  run_to(59, 900000);
+  rtc_holder.hold(5);
+  run_to(1, 0);
+  theBus_getStats(&bus);
+  theRTC_getStats(&stats);
+  printf("SDA held 5 bits: %u failures, %u stuck, %u released by %u clocks, recovered in %u ms, SCL clocking %u us\n",
+         bus.buses[bus_rtc].failures, bus.buses[bus_rtc].stuck, bus.buses[bus_rtc].recoveries, rtc_holder.clocks,
+         bus.buses[bus_rtc].recovery_ms, bus.buses[bus_rtc].recovery_us);
+  CHECK(! rtc_holder.isHolding());
+  CHECK(host_line(RTC_SDA) == HIGH);
+  CHECK_EQUAL(1, bus.buses[bus_rtc].failures);
+  CHECK_EQUAL(1, bus.buses[bus_rtc].recoveries);
+  CHECK_EQUAL(5, rtc_holder.clocks);
+  CHECK(bus.buses[bus_rtc].recovery_ms <= ( PERIOD_BUS_RETRY + 2 ));
+  CHECK_EQUAL(chip.alarm2 - chip_minutes, stats.minutes - before.minutes);
+  CHECK_EQUAL(0, shown.time_errors);
+
+  // 25 bits left: every recovery gives 9 clocks and the STOP one, the retries are backed off,
+  // SDA is released by the 3rd recovery
+  run_to(59, 900000);
+  rtc_holder.hold(25);
+  run_to(2, 0);
+  theBus_stats_t held;
+  theBus_getStats(&held);
+  printf("SDA held 25 bits: %u failures, %u stuck, released by %u clocks, recovered in %u ms\n",
+         held.buses[bus_rtc].failures - bus.buses[bus_rtc].failures, held.buses[bus_rtc].stuck - bus.buses[bus_rtc].stuck,
+         rtc_holder.clocks - 5, held.buses[bus_rtc].recovery_ms);
+  CHECK(host_line(RTC_SDA) == HIGH);
+  CHECK_EQUAL(3, held.buses[bus_rtc].failures - bus.buses[bus_rtc].failures);
+  CHECK_EQUAL(1, held.buses[bus_rtc].recoveries - bus.buses[bus_rtc].recoveries);
+  CHECK(held.buses[bus_rtc].recovery_ms >= ( PERIOD_BUS_RETRY * ( 1 + 2 + 4 ) ));
+  CHECK(held.buses[bus_rtc].recovery_ms <= ( PERIOD_BUS_RETRY * ( 1 + 2 + 4 ) + 3 ));
+  CHECK_EQUAL(0, shown.time_errors);
+
+  // the adjustment burst is not acknowledged: it stays pending and is written by the retry,
+  // the chip counts the adjusted time
+  run_to(10, 500000);
+  for ( int element = 0; element < 5; element++ ) theData_nextBlinker();
+  theRTC_getStats(&before);
+  const uint32_t writes = chip.timeWrites;
+  const uint32_t adjusted = chip.time() + 60;
+  theData_nextValue();
+  chip.failWrites(1);
+  run(SECOND_US);
+  theData_stopBlinker();
+  theRTC_getStats(&stats);
+  printf("adjustment write failed: %u writes, %u written by the chip, %u reverts, the chip at +%d s\n",
+         stats.writes - before.writes, chip.timeWrites - writes, stats.reverts - before.reverts, (int)( chip.time() - adjusted ));
+  CHECK_EQUAL(2, stats.writes - before.writes);
+  CHECK_EQUAL(1, chip.timeWrites - writes);
+  CHECK_EQUAL(0, stats.reverts - before.reverts);
+  CHECK(( chip.time() - adjusted ) <= 1);
+
+  // the day of week register is wrong, its correction is not acknowledged: the failure is counted
+  // and shown, the registers are read out again as soon as theBus allows, and corrected then
+  chip.setIntConnected(false);
+  run(( PERIOD_RTC_TICK_LOST + 2000 ) * 1000ULL);
+  run_to(20, 0);
+  memset(&shown, 0, sizeof(shown));
+  theRTC_getStats(&before);
+  const uint8_t dow = chip.get(0x03);
+  chip.set(0x03, ( dow % 7 ) + 1);
+  chip.failWrites(1);
+  run(SECOND_US);
+  theRTC_getStats(&stats);
+  printf("day of week write failed: %u failed transactions, the failure shown for %u ms, the register %s\n",
+         stats.failures - before.failures, shown.failed_loops, ( chip.get(0x03) == dow ) ? "corrected" : "wrong");
+  CHECK_EQUAL(1, stats.failures - before.failures);
+  CHECK_EQUAL(dow, chip.get(0x03));
+  CHECK(shown.failed_loops >= PERIOD_BUS_RETRY);
+  CHECK(shown.failed_loops <= ( PERIOD_BUS_RETRY + 2 ));
+  chip.setIntConnected(true);
+  run(2 * 60 * SECOND_US);
+
+  // the chip does not answer for 3 seconds from just before the minute edge: the failure is shown
+  // all the time, and not after the next read out
+  run_to(59, 500000);
+  memset(&shown, 0, sizeof(shown));
+  chip.setResponding(false);
+  bFailing = true;
+  uint32_t hidden = 0;
+  const uint64_t until = host_now() + ( 3 * SECOND_US );
+  while ( host_now() < until )
+  {
+    run(LOOP_US);
+    theData_snapshot_t snapshot;
+    theData_getSnapshot(&snapshot);
+    if ( ( ! bFailing ) && ( strcmp(snapshot.time, "--:--") != 0 ) ) ++hidden;
+  }
+  const uint32_t failed_loops = shown.failed_loops;
+  chip.setResponding(true);
+  run(PERIOD_BUS_RETRY_MAX * 1000ULL + SECOND_US);
+  theData_snapshot_t snapshot;
+  theData_getSnapshot(&snapshot);
+  printf("no answer for 3 s: the failure shown for %u ms, hidden for %u ms meanwhile, shown after the recovery: %s\n",
+         failed_loops, hidden, ( strcmp(snapshot.time, "--:--") == 0 ) ? "yes" : "no");
+  CHECK(failed_loops >= 2400);
+  CHECK_EQUAL(0, hidden);
+  CHECK(strcmp(snapshot.time, "--:--") != 0);
+
+  // the display bus: the slave holds SDA in the middle of the frame, the frame is dropped after
+  // PERIOD_PANEL_TIMEOUT, SCL is clocked out, and the next frame is sent completely
+  thePanel_stats_t panel_before, panel_after;
+  thePanel_getStats(&panel_before);
+  theBus_getStats(&bus);
+  while ( ! thePanel_isBusy() ) run(LOOP_US);
+  display_holder.hold(5);
+  run(2 * SECOND_US);
+  thePanel_getStats(&panel_after);
+  theBus_getStats(&held);
+  printf("display SDA held: %u frames dropped, %u released by %u clocks, recovered in %u ms, the display RAM differs in %u bytes\n",
+         panel_after.failures - panel_before.failures, held.buses[bus_display].recoveries - bus.buses[bus_display].recoveries,
+         display_holder.clocks, held.buses[bus_display].recovery_ms, frame_differs());
+  CHECK_EQUAL(1, panel_after.failures - panel_before.failures);
+  CHECK_EQUAL(1, held.buses[bus_display].recoveries - bus.buses[bus_display].recoveries);
+  CHECK(host_line(DISPLAY_SDA) == HIGH);
+  CHECK_EQUAL(0, frame_differs());
+
+  // the main loop stalls for 30 ms while the frame is sent: PDC completes it meanwhile, it is not dropped
+  thePanel_getStats(&panel_before);
+  while ( ! thePanel_isBusy() ) run(LOOP_US);
+  host_advance(30000);
+  run(SECOND_US);
+  thePanel_getStats(&panel_after);
+  CHECK_EQUAL(0, panel_after.failures - panel_before.failures);
+  CHECK_EQUAL(0, frame_differs());
+
+  theBus_getStats(&bus);
+  printf("main loop: the longest pass %u us, %u us while a bus was failing (the loop is %u us)\n",
+         bus.max_loop_us, bus.max_fault_loop_us, LOOP_US);
+  CHECK(bus.max_fault_loop_us <= ( LOOP_US + ( 2 * HOST_WIRE_TIMEOUT_US ) ));
+
+  return TEST_END();
+}
@@ -0,0 +1,137 @@
+// theData snapshots: every copy must be one publication. The writer (theData_process publishing
+// every update) runs in its own thread against the reader threads (theData_getSnapshot), and then
+// in a timer signal handler which preempts the reader in the middle of its copy, the way SysTick does
+// on the board (DATA_STRESS).
+
+#include <Arduino.h>
+#include <thread>
+#include <atomic>
+#include <signal.h>
+#include <sys/time.h>
+
+#include "hwconfig.h"
+#include "theData.h"
+#include "test.h"
+
+// the publications of the writer thread
+#define PUBLICATIONS          (200000)
+#define READERS               (3)
+// the timer signals to the reader, every handler publishes twice: both buffers are written,
+// so the reader preempted in its copy always sees the copied buffer changed
+#define SIGNALS               (20000)
+#define SIGNAL_PERIOD_US      (20)
+
+static std::atomic<bool> bWriting(true);
+static std::atomic<unsigned int> copies(0);
+static std::atomic<unsigned int> torn(0);
+static std::atomic<unsigned int> reversed(0);
+
+static volatile unsigned int handled = 0;
+
+// every publication 'k' has CO2 'k' ppm and all the sensors at (k % 64) degrees, so the copy
+// mixed from two publications has the temperatures of the other CO2 value
+static void publish(const unsigned int k)
+{
+  const int co2 = k % 10000;
+  theData_reportCO2_value(co2);
+  for ( unsigned int sensor = 0; sensor < COUNT_TERMO; sensor++ )
+  {
+    theData_reportTermo_value(sensor, ( co2 % 64 ) * 128);
+  }
+  theData_process(millis());
+}
+
+static void writer(void)
+{
+  for ( unsigned int k = 0; k < PUBLICATIONS; k++ ) publish(k);
+  bWriting = false;
+}
+
+// the reader is preempted by the writer, as the main loop is by SysTick
+static void on_signal(int signal)
+{
+  (void)signal;
+  if ( handled >= SIGNALS ) return;
+  const unsigned int k = PUBLICATIONS + 2 * handled;
+  publish(k);
+  publish(k + 1);
+  if ( ++handled >= SIGNALS ) bWriting = false;
+}
+
+// the copies are checked till the writer has finished
+static void reader(void)
+{
+  uint32_t last = 0;
+  while ( bWriting )
+  {
+    theData_snapshot_t snapshot;
+    theData_getSnapshot(&snapshot);
+    ++copies;
+
+    // the sequences are even and never go back
+    if ( snapshot.sequence & 1 ) ++torn;
+    if ( snapshot.sequence < last ) ++reversed;
+    last = snapshot.sequence;
+
+    if ( ! snapshot.samples[data_channel_co2].valid ) continue;
+    const int32_t expected = ( snapshot.samples[data_channel_co2].value % 64 ) * 100;
+    for ( unsigned int sensor = 0; sensor < COUNT_TERMO; sensor++ )
+    {
+      const theData_sample_t *const pSample = &(snapshot.samples[data_channel_termo_0 + sensor]);
+      if ( ( ! pSample->valid ) || ( pSample->value != expected ) )
+      {
+        ++torn;
+        break;
+      }
+    }
+  }
+}
+
+int main(void)
+{
+  theData_init();
+  theData_reportTermo_sensorCount(COUNT_TERMO);
+  theData_process(millis());
+
+  // the writer thread against the reader threads
+  std::thread readers[READERS];
+  for ( unsigned int i = 0; i < READERS; i++ ) readers[i] = std::thread(reader);
+  std::thread publisher(writer);
+  publisher.join();
+  for ( unsigned int i = 0; i < READERS; i++ ) readers[i].join();
+
+  theData_stressStats_t stats;
+  theData_getStressStats(&stats);
+  printf("threads: publications %u, copies %u, retries %u, torn %u, reversed %u\n", PUBLICATIONS, copies.load(),
+         stats.retries, torn.load(), reversed.load());
+  CHECK(copies > 0);
+  CHECK_EQUAL(0, torn);
+  CHECK_EQUAL(0, reversed);
+
+  // the last publication is the one seen after the writer has finished
+  theData_snapshot_t snapshot;
+  theData_getSnapshot(&snapshot);
+  CHECK_EQUAL(( PUBLICATIONS - 1 ) % 10000, snapshot.samples[data_channel_co2].value);
+  CHECK_EQUAL(( ( ( PUBLICATIONS - 1 ) % 10000 ) % 64 ) * 100, snapshot.samples[data_channel_termo_0].value);
+
+  // the timer signal writer preempting the reader (this thread)
+  const uint32_t retries = stats.retries;
+  copies = 0;
+  bWriting = true;
+  signal(SIGALRM, on_signal);
+  struct itimerval timer = { { 0, SIGNAL_PERIOD_US }, { 0, SIGNAL_PERIOD_US } };
+  setitimer(ITIMER_REAL, &timer, NULL);
+  reader();
+  timer.it_value.tv_usec = 0;
+  setitimer(ITIMER_REAL, &timer, NULL);
+  signal(SIGALRM, SIG_DFL);
+
+  theData_getStressStats(&stats);
+  printf("signals: publications %u, copies %u, retries %u, torn %u, reversed %u\n", 2 * SIGNALS, copies.load(),
+         stats.retries - retries, torn.load(), reversed.load());
+  CHECK(copies > 0);
+  CHECK_EQUAL(0, torn);
+  CHECK_EQUAL(0, reversed);
+
+  return TEST_END();
+}
@@ -0,0 +1,196 @@
+// theDisplay, theCanvas and thePanel on the display stand-in: the frames go through the TWI
+// registers (PDC, THR, STOP) of Wire1 to the SH1107 stand-in, which decodes them by the datasheet.
+// Every view is compared with its golden image (golden/display_<view>.pbm), the display RAM with
+// the frame drawn, and the I2C bandwidth of the views is measured against sending full frames.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <host.h>
+#include <chrono>
+
+#include "hwconfig.h"
+#include "theTime.h"
+#include "theBus.h"
+#include "theNVM.h"
+#include "theAlarms.h"
+#include "theData.h"
+#include "thePanel.h"
+#include "theBitmaps.h"
+#include "theCanvas.h"
+#include "theChart.h"
+#include "theTrend.h"
+#include "theDisplay.h"
+#include "SH1107.h"
+#include "test.h"
+
+// one pass of the main loop every LOOP_US of the simulated time
+#define LOOP_US               (1000)
+#define SECOND_US             (1000000ULL)
+#define BUS_BYTES_PER_SECOND  ( SPEED_DISPLAY / 9 )
+
+static SH1107 panel;
+
+static const char *const view_names[] = { "clock", "chart", "co2", "termo", "stats" };
+
+// the RTC time of the start: Monday, 01 Mar 2021 12:34:00
+static const uint32_t start_time = theTime_seconds(theTime_daysFromCivil(2021, 3, 1), 12, 34, 0);
+static uint64_t reported_second = 0xFFFFFFFF;
+
+static double loop_ns = 0;
+
+// RTC reports the new second, the sensors follow the slow waves of the room
+static void report(void)
+{
+  const uint64_t second = host_now() / SECOND_US;
+  if ( second == reported_second ) return;
+  reported_second = second;
+
+  const uint32_t time = start_time + (uint32_t)second;
+  const int32_t days = time / TIME_SECONDS_PER_DAY;
+  const uint32_t seconds = time % TIME_SECONDS_PER_DAY;
+  const theTime_date_t date = theTime_civilFromDays(days);
+  theData_reportRTC_date(date.year - TIME_EPOCH_YEAR, date.month, date.day, theTime_dayOfWeek(days));
+  theData_reportRTC_time(seconds / 3600, ( seconds / 60 ) % 60, seconds % 60, millis());
+
+  // triangle waves: CO2 400...1000 ppm in 40 minutes, the sensors 20...24 degrees in 2 hours
+  const int co2_phase = (int)( second % 2400 );
+  theData_reportCO2_value(400 + ( ( co2_phase < 1200 ) ? (co2_phase) : ( 2400 - co2_phase ) ) / 2);
+  const int termo_phase = (int)( second % 7200 );
+  const int termo = ( termo_phase < 3600 ) ? (termo_phase) : ( 7200 - termo_phase );
+  theData_reportTermo_value(0, (int16_t)( ( 20 * 128 ) + ( ( termo * 4 * 128 ) / 3600 / 8 ) * 8 ));
+  theData_reportTermo_value(1, (int16_t)( ( 23 * 128 ) - ( ( termo * 2 * 128 ) / 3600 / 8 ) * 8 ));
+}
+
+// the main loop for the time given, the modules in the order of TheClock.ino
+static void run(const uint64_t us)
+{
+  const uint64_t until = host_now() + us;
+  while ( host_now() < until )
+  {
+    report();
+    const unsigned long timestamp = millis();
+    const std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+    theBus_process(timestamp);
+    theData_process(timestamp);
+    theDisplay_process(timestamp);
+    thePanel_process(timestamp);
+    theChart_process(timestamp);
+    theTrend_process(timestamp);
+    loop_ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+    host_advance(LOOP_US);
+  }
+}
+
+// the frame is on the display: wait for the transfers, the display RAM is the canvas then
+static void check_frame(const char *const pName)
+{
+  run(200000);
+  CHECK(! thePanel_isBusy());
+
+  const uint8_t *const pFrame = theCanvas_getBuffer();
+  unsigned int differ = 0;
+  for ( unsigned int page = 0; page < DISPLAY_PAGES; page++ )
+  {
+    for ( unsigned int column = 0; column < DISPLAY_COLUMNS; column++ )
+    {
+      if ( panel.ram(page, DISPLAY_COLUMN_OFFSET + column) != pFrame[( page * DISPLAY_COLUMNS ) + column] ) ++differ;
+    }
+  }
+  CHECK_EQUAL(0, differ);
+
+  char name[64];
+  snprintf(name, sizeof(name), "display_%s.pbm", pName);
+  const std::string image = panel.pbm();
+  CHECK_GOLDEN(name, image.data(), image.size());
+}
+
+// the bandwidth of the view: I2C bytes per second of the frames, and of the full frames at the same rate
+static void measure(const char *const pName, const uint64_t us)
+{
+  thePanel_stats_t before, after;
+  theDisplay_stats_t display_before, display_after;
+  thePanel_getStats(&before);
+  theDisplay_getStats(&display_before);
+  const uint32_t transfers = panel.bytes;
+  run(us);
+  thePanel_getStats(&after);
+  theDisplay_getStats(&display_after);
+
+  const double seconds = (double)us / SECOND_US;
+  const double rate = ( after.total_bytes - before.total_bytes ) / seconds;
+  const double full = (double)( after.frames - before.frames ) * after.full_bytes / seconds;
+  printf("bandwidth %-6s %6.0f B/s (%4.1f%% of the bus), full frames would be %6.0f B/s (%5.1f%%), %.1f fps\n",
+         pName, rate, 100.0 * rate / BUS_BYTES_PER_SECOND, full, 100.0 * full / BUS_BYTES_PER_SECOND,
+         ( after.frames - before.frames ) / seconds);
+  const uint32_t updates = display_after.chart_updates - display_before.chart_updates;
+  if ( updates > 0 )
+  {
+    printf("bandwidth %-6s %u chart updates of %u B\n", pName, updates,
+           ( display_after.total_chart_bytes - display_before.total_chart_bytes ) / updates);
+  }
+  // the stand-in has got every byte thePanel has counted
+  CHECK_EQUAL(after.total_bytes - before.total_bytes, panel.bytes - transfers);
+}
+
+int main(void)
+{
+  Wire1.attach(ADDRESS_DISPLAY, &panel);
+
+  theTime_init();
+  theBus_init();
+  theNVM_init();
+  theAlarms_init();
+  theData_init();
+  theData_reportTermo_sensorCount(2);
+  thePanel_init();
+  theBitmaps_init();
+  theCanvas_init();
+  theChart_init();
+  theTrend_init();
+  theDisplay_init();
+
+  // the library has initialized the display, the first frame is sent completely
+  CHECK(panel.isOn());
+  check_frame("clock");
+  CHECK_EQUAL(CONTRAST_DAY, panel.contrast());
+  CHECK_EQUAL(0, panel.unknownCommands);
+  CHECK_EQUAL(0, panel.hiddenWrites);
+
+  // the clock changes its minutes and the flashing dot only
+  measure("clock", 60 * SECOND_US);
+
+  // the display is not acknowledged for a while: the frames are dropped, then the whole frame is sent again
+  thePanel_stats_t panel_stats;
+  Wire1.attach(ADDRESS_DISPLAY, NULL);
+  run(2 * SECOND_US);
+  Wire1.attach(ADDRESS_DISPLAY, &panel);
+  thePanel_getStats(&panel_stats);
+  CHECK(panel_stats.failures > 0);
+  run(2 * SECOND_US);
+  check_frame("clock_after_nack");
+
+  // the chart and the history take their samples for 2 hours
+  run(2 * 3600 * SECOND_US);
+  check_frame("clock_later");
+
+  for ( unsigned int view = 1; view < ( sizeof(view_names) / sizeof(view_names[0]) ); view++ )
+  {
+    theDisplay_nextView();
+    check_frame(view_names[view]);
+    if ( view == 1 ) measure("chart", 60 * SECOND_US);
+    if ( view == 2 ) measure("co2", 600 * SECOND_US);
+  }
+  theDisplay_nextView();
+  check_frame("clock_again");
+  CHECK_EQUAL(0, panel.unknownCommands);
+  CHECK_EQUAL(0, panel.hiddenWrites);
+
+  theDisplay_stats_t display;
+  theDisplay_getStats(&display);
+  thePanel_getStats(&panel_stats);
+  printf("full frame %u B, %u frames drawn, %u dropped, %u I2C transactions of %u bytes seen by the stand-in\n",
+         panel_stats.full_bytes, display.frames, panel_stats.failures, panel.transactions, panel.bytes);
+  printf("host main loop %.0f ns per frame (drawing, diff, transfer steps)\n", loop_ns / display.frames);
+
+  return TEST_END();
+}
@@ -0,0 +1,217 @@
+// theLog readings log on the flash stand-in: the query gives back exactly the rows appended
+// (the gaps, the clock adjustments and the failed sensors included), the rows since the last
+// flush are the only loss on reset, and the ring keeps the newest rows. The benchmark logs a
+// year of minute rows of the synthetic readings and reports the size and the cost of the log.
+
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+#include <host.h>
+#include <vector>
+#include <chrono>
+
+#include "hwconfig.h"
+#include "theTime.h"
+#include "theNVM.h"
+#include "theData.h"
+#include "theLog.h"
+#include "test.h"
+
+#define MINUTES_PER_MONTH     (60.0 * 24.0 * 30.44)
+// the benchmark: one year of minute rows, more than the ring keeps
+#define BENCH_ROWS            (365 * 24 * 60)
+
+typedef struct {
+  uint32_t time;
+  int32_t values[data_channel_max];
+  uint8_t valid;
+} row_t;
+
+// the rows appended, and how many of them are in flash
+static std::vector<row_t> appended;
+static size_t durable = 0;
+
+static uint32_t clock_time = 0;
+static double append_ns = 0;
+static double max_append_ns = 0;
+static uint32_t seed = 12345;
+
+// the rows found by the query
+static std::vector<row_t> found;
+
+static void on_row(const uint32_t time, const int32_t *const pValues, const uint8_t valid, void *const pContext)
+{
+  (void)pContext;
+  row_t row;
+  row.time = time;
+  row.valid = valid;
+  for ( unsigned int channel = 0; channel < data_channel_max; channel++ ) row.values[channel] = pValues[channel];
+  found.push_back(row);
+}
+
+static uint32_t next_random(const uint32_t range)
+{
+  seed = ( seed * 1103515245UL ) + 12345UL;
+  return ( seed >> 8 ) % range;
+}
+
+// RTC reports the time, the sensors their values, then one pass of the main loop
+static void log_minute(const int co2, const int16_t *const pRaw, const uint8_t valid)
+{
+  const int32_t days = clock_time / TIME_SECONDS_PER_DAY;
+  const uint32_t seconds = clock_time % TIME_SECONDS_PER_DAY;
+  const theTime_date_t date = theTime_civilFromDays(days);
+  theData_reportRTC_date(date.year - TIME_EPOCH_YEAR, date.month, date.day, theTime_dayOfWeek(days));
+  theData_reportRTC_time(seconds / 3600, ( seconds / 60 ) % 60, seconds % 60, millis());
+
+  row_t row;
+  row.time = clock_time;
+  row.valid = valid;
+  if ( valid & 1 ) theData_reportCO2_value(co2); else theData_reportCO2_failure();
+  for ( unsigned int sensor = 0; sensor < COUNT_TERMO; sensor++ )
+  {
+    const unsigned int channel = data_channel_termo_0 + sensor;
+    if ( ( valid >> channel ) & 1 ) theData_reportTermo_value(sensor, pRaw[sensor]); else theData_reportTermo_failure(sensor);
+  }
+  theData_process(millis());
+
+  theLog_stats_t before, after;
+  theLog_getStats(&before);
+  const std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+  theLog_process(millis());
+  const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+  theLog_getStats(&after);
+  append_ns += ns;
+  if ( ns > max_append_ns ) max_append_ns = ns;
+
+  // the published sample (in centidegrees) is the one the log takes
+  for ( unsigned int channel = 0; channel < data_channel_max; channel++ )
+  {
+    theData_sample_t sample;
+    theData_getSample(channel, &sample);
+    row.values[channel] = sample.value;
+  }
+  appended.push_back(row);
+  // the row which did not fit the written page starts the next one, it is in RAM only
+  if ( after.pages != before.pages ) durable = appended.size() - 1;
+  if ( after.flushes != before.flushes ) durable = appended.size();
+
+  host_advance(60 * 1000000ULL);
+  clock_time += 60;
+}
+
+// the rows from 'first' of the appended ones are found, and only them
+static void check_rows(const size_t first, const size_t count)
+{
+  found.clear();
+  CHECK_EQUAL(count, theLog_query(0, 0xFFFFFFFF, on_row, NULL));
+  CHECK_EQUAL(count, found.size());
+  size_t mismatches = 0;
+  for ( size_t i = 0; ( i < count ) && ( i < found.size() ); i++ )
+  {
+    const row_t *const pExpected = &(appended[first + i]);
+    bool bSame = ( pExpected->time == found[i].time ) && ( pExpected->valid == found[i].valid );
+    for ( unsigned int channel = 0; channel < data_channel_max; channel++ )
+    {
+      if ( ( pExpected->valid >> channel ) & 1 ) bSame = bSame && ( pExpected->values[channel] == found[i].values[channel] );
+    }
+    if ( ! bSame ) ++mismatches;
+  }
+  CHECK_EQUAL(0, mismatches);
+}
+
+// the readings of the room: CO2 walks, the sensors follow the daily swing with 1/16 degree steps
+// and flicker by one step now and then
+static void log_synthetic(const unsigned int rows)
+{
+  static int co2 = 600;
+  static int32_t temperature[COUNT_TERMO] = { 2100 * 128 / 100, 2200 * 128 / 100, 1900 * 128 / 100, 2300 * 128 / 100 };
+  for ( unsigned int i = 0; i < rows; i++ )
+  {
+    co2 += (int)next_random(11) - 5;
+    if ( co2 < 400 ) co2 = 400;
+    if ( co2 > 2000 ) co2 = 2000;
+
+    const double swing = 2.0 * sin(( clock_time % TIME_SECONDS_PER_DAY ) * 2.0 * M_PI / TIME_SECONDS_PER_DAY);
+    int16_t raw[COUNT_TERMO];
+    for ( unsigned int sensor = 0; sensor < COUNT_TERMO; sensor++ )
+    {
+      const int32_t noise = ( next_random(10) == 0 ) ? ( (int32_t)next_random(2) * 2 - 1 ) : (0);
+      raw[sensor] = (int16_t)( ( ( temperature[sensor] + (int32_t)( swing * 128 ) ) / 8 + noise ) * 8 );
+    }
+    log_minute(co2, raw, (uint8_t)( ( 1 << data_channel_max ) - 1 ));
+  }
+}
+
+int main(void)
+{
+  theNVM_init();
+  theData_init();
+  theLog_init();
+  // the log checks the RTC time once per second since the start
+  host_advance(1000000);
+  clock_time = theTime_seconds(theTime_daysFromCivil(2021, 3, 1), 0, 0, 0);
+
+  // nothing logged yet
+  found.clear();
+  CHECK_EQUAL(0, theLog_query(0, 0xFFFFFFFF, on_row, NULL));
+
+  // the rows with all kinds of values: big jumps, the failed sensors, the gaps and the clock adjusted back
+  int16_t raw[COUNT_TERMO] = { 2688, 2816, -1280, 0 };
+  for ( unsigned int i = 0; i < 600; i++ )
+  {
+    uint8_t valid = (uint8_t)( ( 1 << data_channel_max ) - 1 );
+    if ( ( i % 50 ) >= 45 ) valid &= ~( 1 << data_channel_termo_0 );
+    if ( ( i % 170 ) == 7 ) valid = 0;
+    if ( ( i % 13 ) == 0 ) raw[1] = (int16_t)( (int)next_random(2000) * 8 - 8000 );
+    if ( i == 300 ) raw[2] = 125 * 128;
+    raw[0] += 8;
+    if ( i == 100 ) clock_time += 7 * 60;            // the device was off
+    if ( i == 200 ) clock_time -= 3 * 60;            // the clock was adjusted back
+    if ( i == 400 ) clock_time += 86400 * 40;        // and forward
+    log_minute(( i == 250 ) ? (9999) : ( 400 + i ), raw, valid);
+  }
+  check_rows(0, appended.size());
+
+  // a time range in the middle
+  found.clear();
+  const uint32_t from = appended[420].time;
+  const uint32_t to = appended[480].time;
+  CHECK_EQUAL(61, theLog_query(from, to, on_row, NULL));
+  CHECK_EQUAL(from, found.front().time);
+  CHECK_EQUAL(to, found.back().time);
+
+  // reset: the rows since the last flush are lost, the log goes on after the flushed page
+  log_synthetic(100);
+  theLog_init();
+  printf("reset: %u of %u rows kept\n", (unsigned int)durable, (unsigned int)appended.size());
+  CHECK(durable < appended.size());
+  appended.resize(durable);
+  check_rows(0, appended.size());
+  log_synthetic(100);
+  check_rows(0, appended.size());
+
+  // the benchmark: the ring goes around, the newest rows are kept
+  theLog_stats_t before, after;
+  theLog_getStats(&before);
+  append_ns = 0;
+  max_append_ns = 0;
+  log_synthetic(BENCH_ROWS);
+  theLog_getStats(&after);
+
+  found.clear();
+  const std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+  const unsigned int kept = theLog_query(0, 0xFFFFFFFF, on_row, NULL);
+  const double query_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+  CHECK(kept < BENCH_ROWS);
+  check_rows(appended.size() - kept, kept);
+
+  const uint32_t bits = after.bits - before.bits;
+  const uint32_t rows = after.rows - before.rows;
+  const uint32_t samples = after.samples - before.samples;
+  printf("bench: %u rows, %.1f bits/row, %.3f bytes/sample, %u rows kept = %.1f months of minute rows\n",
+         rows, (double)bits / rows, (double)bits / 8 / samples, kept, kept / MINUTES_PER_MONTH);
+  printf("bench: append %.0f ns avg, %.0f ns max (with the page write), query %.1f ns/row (%u pages)\n",
+         append_ns / rows, max_append_ns, query_ns / kept, (unsigned int)NVM_LOG_PAGES);
+
+  return TEST_END();
+}
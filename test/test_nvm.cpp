@@ -0,0 +1,137 @@
+// theNVM config store on the flash stand-in: the values survive the resets (the index is
+// rebuilt by the scan), the erases are spread over the ring, the torn record is skipped.
+
+#include <Arduino.h>
+#include <DueFlashStorage.h>
+
+#include "hwconfig.h"
+#include "theNVM.h"
+#include "test.h"
+
+// the flash pages of the ring
+#define FIRST_PAGE            ( NVM_CONFIG_OFFSET / NVM_PAGE_SIZE )
+#define WRITES                (10000)
+
+static uint16_t values[NVM_CONFIG_KEYS];
+
+// every key reads its last written value
+static void check_values(void)
+{
+  for ( uint8_t key = 0; key < NVM_CONFIG_KEYS; key++ )
+  {
+    uint16_t value = 0;
+    CHECK(theNVM_read(key, &value));
+    CHECK_EQUAL(values[key], value);
+  }
+}
+
+static bool write(const uint8_t key, const uint16_t value)
+{
+  const theNVM_setting_t setting = { key, value };
+  if ( ! theNVM_write(&setting, 1) ) return false;
+  values[key] = value;
+  return true;
+}
+
+int main(void)
+{
+  // the erased flash has no settings
+  theNVM_init();
+  for ( uint8_t key = 0; key < NVM_CONFIG_KEYS; key++ )
+  {
+    uint16_t value;
+    CHECK(! theNVM_read(key, &value));
+  }
+
+  // all the keys in one write, then read after the reset
+  theNVM_setting_t settings[NVM_CONFIG_KEYS];
+  for ( uint8_t key = 0; key < NVM_CONFIG_KEYS; key++ )
+  {
+    settings[key].key = key;
+    settings[key].value = 1000 + key;
+    values[key] = settings[key].value;
+  }
+  CHECK(theNVM_write(settings, NVM_CONFIG_KEYS));
+  check_values();
+  theNVM_init();
+  check_values();
+
+  // the unchanged values are not written again
+  theNVM_stats_t before, after;
+  theNVM_getStats(&before);
+  CHECK(theNVM_write(settings, NVM_CONFIG_KEYS));
+  theNVM_getStats(&after);
+  CHECK_EQUAL(before.records, after.records);
+
+  // the reset in the middle of the write: the torn record is ignored, the older value is read
+  const uint16_t old_value = values[5];
+  const theNVM_setting_t torn = { 5, 0x5555 };
+  host_flashTear(3);
+  CHECK(! theNVM_write(&torn, 1));
+  theNVM_init();
+  check_values();
+  CHECK_EQUAL(old_value, values[5]);
+
+  // the next writes go after the torn record, which never becomes valid
+  CHECK(write(5, 0x1234));
+  CHECK(write(6, 0x4321));
+  theNVM_init();
+  check_values();
+
+  // the failed program without the reset: the slots could be programmed partly, they are not used again
+  const theNVM_setting_t failed = { 5, 0x0F0F };
+  host_flashTear(6);
+  CHECK(! theNVM_write(&failed, 1));
+  CHECK(write(5, 0xF0F0));
+  check_values();
+  theNVM_init();
+  check_values();
+
+  // the reset in the middle of the write of several keys: the records before the tear are stored
+  const uint16_t old_second = values[2];
+  for ( uint8_t key = 0; key < 3; key++ )
+  {
+    settings[key].key = key;
+    settings[key].value = 0x7000 + key;
+  }
+  host_flashTear(8 + 3);
+  CHECK(! theNVM_write(settings, 3));
+  theNVM_init();
+  values[0] = 0x7000;
+  check_values();
+  CHECK_EQUAL(old_second, values[2]);
+
+  // the ring goes around many times, with a reset every 97 writes
+  uint32_t erases_before[NVM_CONFIG_PAGES];
+  for ( unsigned int page = 0; page < NVM_CONFIG_PAGES; page++ ) erases_before[page] = host_flashErases(FIRST_PAGE + page);
+  theNVM_getStats(&before);
+  for ( unsigned int i = 0; i < WRITES; i++ )
+  {
+    CHECK(write(i % 3, (uint16_t)i));
+    if ( ( i % 97 ) == 0 )
+    {
+      theNVM_init();
+      check_values();
+    }
+  }
+  theNVM_init();
+  check_values();
+  theNVM_getStats(&after);
+
+  uint32_t min_erases = 0xFFFFFFFF, max_erases = 0;
+  for ( unsigned int page = 0; page < NVM_CONFIG_PAGES; page++ )
+  {
+    const uint32_t erases = host_flashErases(FIRST_PAGE + page) - erases_before[page];
+    if ( erases < min_erases ) min_erases = erases;
+    if ( erases > max_erases ) max_erases = erases;
+  }
+  // the pages around the ring are erased in turn, the neighbour pages are never touched
+  CHECK(min_erases > 0);
+  CHECK(( max_erases - min_erases ) <= 1);
+  CHECK_EQUAL(0, host_flashErases(FIRST_PAGE - 1));
+  CHECK_EQUAL(0, host_flashErases(FIRST_PAGE + NVM_CONFIG_PAGES));
+  printf("wear: %u writes, erases per page %u...%u, write amplification %.2f\n", WRITES, min_erases, max_erases,
+         (double)( after.flash_bytes - before.flash_bytes ) / ( after.user_bytes - before.user_bytes ));
+
+  return TEST_END();
+}
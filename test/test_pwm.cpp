@@ -0,0 +1,227 @@
+// pwm_lib conversions against the exact ticks: the period (or the duty) in 1e-8 s units is
+// period * MCK / 1e8 / 2^power ticks of the clock, rounded down, computed here by 64 bits; the
+// integer path of to_ticks() must give it for every period of every clock, find_clock() must
+// pick the first clock the period fits (CPRD within 16 bits) the same way the compiler does it for
+// start<PERIOD, DUTY>(), and both starts must write the same registers. The double conversion
+// which was there before is counted against the same ticks, and the costs of the starts are
+// compared.
+
+#include <Arduino.h>
+#include <chrono>
+
+#include "hwconfig.h"
+#include "pwm_lib.h"
+#include "test.h"
+
+using namespace arduino_due::pwm_lib;
+
+#define SWEEP_PERIODS         (1UL << 21)
+#define RANDOM_PERIODS        (1000000)
+#define BENCHMARK_STARTS      (1000000)
+
+#define CHANNEL               ( pin_traits<pwm_pin::BUZZER_PWM_PIN>::channel )
+
+// the buzzer starts are resolved by the compiler
+static_assert(pwm_core::clock_for_period(BUZZER_PERIOD) == 1, "the buzzer tone is clocked by MCK/2");
+static_assert(pwm_core::to_ticks(BUZZER_PERIOD, 1) == 15555, "37037 units are 15555.54 ticks of MCK/2");
+static_assert(pwm_core::to_ticks(BUZZER_REST_PERIOD, pwm_core::clock_for_period(BUZZER_REST_PERIOD)) == 42000, "1 ms is 42000 ticks of MCK/2");
+
+static pwm<pwm_pin::BUZZER_PWM_PIN> the_pwm;
+
+// the exact ticks: value * num / ( den * 2^power ), rounded down
+static uint32_t exact_ticks(const uint32_t value, const uint32_t clock)
+{
+  return (uint32_t)( ( (uint64_t)value * pwm_core::ticks_num ) / ( (uint64_t)pwm_core::ticks_den << pwm_core::two_power(clock) ) );
+}
+
+// the double conversion pwm_lib had: seconds divided by the tick time of the clock
+static uint32_t double_ticks(const uint32_t value, const uint32_t clock)
+{
+  const double tick_time = static_cast<uint32_t>(1 << pwm_core::two_power_values[clock]) / static_cast<double>(VARIANT_MCK);
+  return static_cast<uint32_t>(( static_cast<double>(value) / 100000000 ) / tick_time);
+}
+
+// the clock pwm_lib found by double: the period in seconds against 65536 ticks of the clock
+static uint32_t double_clock(const uint32_t period)
+{
+  uint32_t clock = 1;
+  while ( ( clock <= pwm_core::max_clocks ) &&
+          ( ( static_cast<double>(period) / 100000000 ) >
+            ( ( static_cast<uint64_t>(1) << ( 16 + pwm_core::two_power_values[clock] ) ) / static_cast<double>(VARIANT_MCK) ) ) ) ++clock;
+  return clock;
+}
+
+// the first clock of the exact ticks within 16 bits
+static uint32_t exact_clock(const uint32_t period)
+{
+  uint32_t clock = 1;
+  while ( ( clock <= pwm_core::max_clocks ) && ( exact_ticks(period, clock) > 0xFFFF ) ) ++clock;
+  return clock;
+}
+
+// the registers of the channel written by the start
+typedef struct {
+  uint32_t clk;
+  uint32_t cmr;
+  uint32_t cprd;
+  uint32_t cdty;
+} registers_t;
+
+static registers_t read_registers(void)
+{
+  const registers_t registers = { PWM->PWM_CLK, PWM->PWM_CH_NUM[CHANNEL].PWM_CMR, PWM->PWM_CH_NUM[CHANNEL].PWM_CPRD,
+                                  PWM->PWM_CH_NUM[CHANNEL].PWM_CDTY };
+  return registers;
+}
+
+static bool same_registers(const registers_t &first, const registers_t &second)
+{
+  return ( first.clk == second.clk ) && ( first.cmr == second.cmr ) && ( first.cprd == second.cprd ) && ( first.cdty == second.cdty );
+}
+
+// the periods of the sweep, the ones around the clock limits and the random ones, by the index
+static uint32_t period_of(const uint32_t index)
+{
+  if ( index < SWEEP_PERIODS ) return index;
+
+  const uint32_t around = index - SWEEP_PERIODS;
+  if ( around < ( pwm_core::max_clocks * 2000 ) )
+  {
+    const uint64_t limit = pwm_core::max_period(1 + ( around / 2000 ));
+    const uint64_t period = limit + ( around % 2000 ) - 1000;
+    return ( period > 0xFFFFFFFFULL ) ? ( 0xFFFFFFFFUL - ( around % 2000 ) ) : ( (uint32_t)period );
+  }
+
+  // xorshift, the same periods on every run
+  static uint32_t random = 2463534242UL;
+  random ^= random << 13;
+  random ^= random >> 17;
+  random ^= random << 5;
+  return random;
+}
+
+int main(void)
+{
+  // the ticks of every clock, the clock of every period
+  const uint32_t periods = SWEEP_PERIODS + ( pwm_core::max_clocks * 2000 ) + RANDOM_PERIODS;
+  unsigned int tick_errors = 0;
+  unsigned int double_errors = 0;
+  unsigned int clock_errors = 0;
+  unsigned int compile_errors = 0;
+  uint32_t max_cprd = 0;
+  uint32_t first_double_error = 0;
+  for ( uint32_t index = 0; index < periods; index++ )
+  {
+    const uint32_t period = period_of(index);
+    for ( uint32_t clock = 1; clock <= pwm_core::max_clocks; clock++ )
+    {
+      const uint32_t exact = exact_ticks(period, clock);
+      if ( pwm_core::to_ticks(period, clock) != exact ) ++tick_errors;
+      if ( double_ticks(period, clock) != exact )
+      {
+        if ( double_errors == 0 ) first_double_error = period;
+        ++double_errors;
+      }
+    }
+
+    uint32_t clock = 0;
+    const bool bFound = pwm_core::find_clock(period, clock);
+    const uint32_t expected = exact_clock(period);
+    if ( ( bFound != ( expected <= pwm_core::max_clocks ) ) || ( bFound && ( clock != expected ) ) ) ++clock_errors;
+    if ( pwm_core::clock_for_period(period) != expected ) ++compile_errors;
+    if ( bFound && ( pwm_core::to_ticks(period, clock) > max_cprd ) ) max_cprd = pwm_core::to_ticks(period, clock);
+  }
+  printf("%u periods x %u clocks: %u tick errors, %u clock errors (%u of the compile time path), the longest CPRD %u\n",
+         periods, pwm_core::max_clocks, tick_errors, clock_errors, compile_errors, max_cprd);
+  printf("the double conversion: %u tick errors, the first at %u units (%u ticks, exact %u)\n",
+         double_errors, first_double_error, double_ticks(first_double_error, exact_clock(first_double_error)),
+         exact_ticks(first_double_error, exact_clock(first_double_error)));
+  CHECK_EQUAL(0, tick_errors);
+  CHECK_EQUAL(0, clock_errors);
+  CHECK_EQUAL(0, compile_errors);
+  CHECK_EQUAL(0xFFFF, max_cprd);
+  CHECK_EQUAL(441, pwm_core::to_ticks(1050, 1));
+
+  // the limits: the longest period of MCK/131072 is 4.29e9 units (43 seconds) and fits, nothing is longer
+  uint32_t clock = 0;
+  CHECK(pwm_core::find_clock(0xFFFFFFFFUL, clock));
+  CHECK_EQUAL(pwm_core::max_clocks, clock);
+  CHECK(pwm_core::find_clock(pwm_core::max_periods[1], clock));
+  CHECK_EQUAL(1, clock);
+  CHECK(pwm_core::find_clock(pwm_core::max_periods[1] + 1, clock));
+  CHECK_EQUAL(2, clock);
+
+  // the clocks A and B are MCK/2048 and MCK/131072
+  the_pwm.start<BUZZER_PERIOD, BUZZER_DUTY>();
+  const registers_t compiled = read_registers();
+  the_pwm.stop();
+  CHECK_EQUAL(2048, 1024 * ( compiled.clk & 0xFF ));
+  CHECK_EQUAL(131072, 1024 * ( ( compiled.clk >> 16 ) & 0xFF ));
+
+  // both starts write the same registers, the duty is written before the channel is enabled
+  volatile uint32_t period = BUZZER_PERIOD;
+  volatile uint32_t duty = BUZZER_DUTY;
+  memset(PWM, 0, sizeof(*PWM));
+  CHECK(the_pwm.start(period, duty));
+  const registers_t runtime = read_registers();
+  CHECK(! the_pwm.start(period, duty));
+  the_pwm.stop();
+  memset(PWM, 0, sizeof(*PWM));
+  the_pwm.start<BUZZER_PERIOD, BUZZER_DUTY>();
+  CHECK(same_registers(read_registers(), runtime));
+  CHECK_EQUAL(pwm_core::clock_masks[1], runtime.cmr & 0x0F);
+  CHECK_EQUAL(15555, runtime.cprd);
+  CHECK_EQUAL(7777, runtime.cdty);
+  CHECK_EQUAL(1, the_pwm.get_clock());
+  the_pwm.stop();
+  the_pwm.start<BUZZER_REST_PERIOD, 0>();
+  const registers_t rest = read_registers();
+  the_pwm.stop();
+  period = BUZZER_REST_PERIOD;
+  duty = 0;
+  the_pwm.start(period, duty);
+  CHECK(same_registers(read_registers(), rest));
+  CHECK_EQUAL(42000, rest.cprd);
+  the_pwm.stop();
+
+  // the cost of the starts (the registers are RAM here, the conversions are the difference)
+  std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+  for ( uint32_t i = 0; i < BENCHMARK_STARTS; i++ )
+  {
+    the_pwm.start(period, duty);
+    the_pwm.stop();
+  }
+  const double runtime_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count() / BENCHMARK_STARTS;
+
+  started = std::chrono::steady_clock::now();
+  for ( uint32_t i = 0; i < BENCHMARK_STARTS; i++ )
+  {
+    the_pwm.start<BUZZER_REST_PERIOD, 0>();
+    the_pwm.stop();
+  }
+  const double compiled_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count() / BENCHMARK_STARTS;
+
+  // the conversions alone: the clock and the ticks of the period and the duty
+  volatile uint32_t sink = 0;
+  started = std::chrono::steady_clock::now();
+  for ( uint32_t i = 0; i < BENCHMARK_STARTS; i++ )
+  {
+    pwm_core::find_clock(period + i, clock);
+    sink = pwm_core::to_ticks(period + i, clock) + pwm_core::to_ticks(duty + i, clock);
+  }
+  const double integer_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count() / BENCHMARK_STARTS;
+
+  started = std::chrono::steady_clock::now();
+  for ( uint32_t i = 0; i < BENCHMARK_STARTS; i++ )
+  {
+    clock = double_clock(period + i);
+    sink = double_ticks(period + i, clock) + double_ticks(duty + i, clock);
+  }
+  const double double_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count() / BENCHMARK_STARTS;
+  (void)sink;
+
+  printf("cost (host): start() %.1f ns, start<PERIOD, DUTY>() %.1f ns; the conversions %.1f ns, by double %.1f ns\n",
+         runtime_ns, compiled_ns, integer_ns, double_ns);
+
+  return TEST_END();
+}
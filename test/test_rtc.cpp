@@ -0,0 +1,263 @@
+// theRTC on the DS3231 stand-in: the chip counts the time by the datasheet, theRTC reads it out
+// through Wire and reports it to theData. Without INT/SQW edges the software clock is set by the
+// polled read outs, and the flashing dot of theData must keep the phase of the chip second
+// (on once per second, not re-based by every read out). With the edges every minute tick is
+// counted, the alarm of theAlarms is matched by the chip and reported within the main loop pass,
+// and the bus failing at the edge delays it only by the retries of theBus. The time adjusted by
+// the keys is shown at once and written to the chip by one burst after the presses, the century
+// bit kept set by the chip does not revert it.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <host.h>
+
+#include "hwconfig.h"
+#include "theTime.h"
+#include "theBus.h"
+#include "theNVM.h"
+#include "theAlarms.h"
+#include "theData.h"
+#include "theRTC.h"
+#include "DS3231.h"
+#include "test.h"
+
+// one pass of the main loop every LOOP_US of the simulated time
+#define LOOP_US               (1000)
+#define SECOND_US             (1000000ULL)
+#define HOUR_US               (3600 * SECOND_US)
+
+// what the clock shows, followed by the main loop
+static struct {
+  bool bDot;
+  uint32_t dot_changes;
+  uint64_t max_dot_offset_us;     // the dot is on that late after the chip second has started
+  uint64_t time_errors;           // the loops when the shown time is not the chip time
+  uint32_t alarms;                // the alarms reported by theRTC
+  uint32_t alarm_time;            // the chip time of the last one
+  uint64_t alarm_us;              // the last one after the chip second has started
+} shown;
+
+static DS3231 *pChip = NULL;
+
+// the shown time is the chip time, the dot is switched on at the chip second start
+static void observe(void)
+{
+  // the display draws every snapshot (the adjustment latency is measured till then)
+  theData_snapshot_t snapshot;
+  theData_getSnapshot(&snapshot);
+  theData_reportShown(snapshot.sequence);
+  const bool bDot = ( snapshot.time[2] == ':' );
+  if ( bDot != shown.bDot )
+  {
+    shown.bDot = bDot;
+    ++shown.dot_changes;
+    const uint64_t offset = host_now() - pChip->secondStarted();
+    if ( bDot && ( offset > shown.max_dot_offset_us ) ) shown.max_dot_offset_us = offset;
+  }
+
+  // the software second may start up to a read out period after the chip second,
+  // or up to a millisecond before it (it is counted by millis())
+  theData_timestamp_t now;
+  theData_getTimestamp(&now);
+  const uint32_t time = now.rtc + ( now.ms / 1000 );
+  const uint64_t into = host_now() - pChip->secondStarted();
+  const bool bLate = ( ( time + 1 ) == pChip->time() ) && ( into <= ( ( PERIOD_RTC + 2 ) * 1000ULL ) );
+  const bool bEarly = ( time == ( pChip->time() + 1 ) ) && ( into >= ( SECOND_US - 1000 ) );
+  if ( ( time != pChip->time() ) && ( ! bLate ) && ( ! bEarly ) ) ++shown.time_errors;
+
+  theRTC_stats_t stats;
+  theRTC_getStats(&stats);
+  if ( stats.alarms != shown.alarms )
+  {
+    shown.alarms = stats.alarms;
+    shown.alarm_time = pChip->time();
+    shown.alarm_us = host_now() - pChip->secondStarted();
+  }
+}
+
+// the main loop for the time given, the modules in the order of TheClock.ino
+static void run(const uint64_t us)
+{
+  const uint64_t until = host_now() + us;
+  while ( host_now() < until )
+  {
+    const unsigned long timestamp = millis();
+    theBus_process(timestamp);
+    theData_process(timestamp);
+    theAlarms_process(timestamp);
+    theRTC_process(timestamp);
+    observe();
+    host_advance(LOOP_US);
+  }
+}
+
+// the main loop till the chip second of the minute, 'after_us' into it
+static void run_to(const unsigned int second, const uint64_t after_us)
+{
+  while ( ( ( pChip->time() % 60 ) != second ) || ( ( host_now() - pChip->secondStarted() ) < after_us ) ) run(LOOP_US);
+}
+
+static void reset_shown(void)
+{
+  theRTC_stats_t stats;
+  theRTC_getStats(&stats);
+  memset(&shown, 0, sizeof(shown));
+  theData_snapshot_t snapshot;
+  theData_getSnapshot(&snapshot);
+  shown.bDot = ( snapshot.time[2] == ':' );
+  shown.alarms = stats.alarms;
+}
+
+// the minute adjusted by the key: the time is shown in the next main loop pass
+static void press_minute(const uint32_t expected)
+{
+  theData_nextValue();
+  run(LOOP_US);
+  theData_timestamp_t now;
+  theData_getTimestamp(&now);
+  CHECK_EQUAL(expected / 60, ( now.rtc + ( now.ms / 1000 ) ) / 60);
+}
+
+// the alarm every day 'minutes' after the current chip minute
+static uint32_t set_alarm(const unsigned int minutes)
+{
+  const uint32_t time = ( ( pChip->time() / 60 ) + minutes ) * 60;
+  theAlarms_alarm_t alarm;
+  alarm.hour = (uint8_t)( ( time % TIME_SECONDS_PER_DAY ) / 3600 );
+  alarm.minute = (uint8_t)( ( time / 60 ) % 60 );
+  alarm.weekdays = ALARM_EVERY_DAY;
+  alarm.flags = ALARM_ENABLED;
+  theAlarms_set(1, &alarm);
+  return time;
+}
+
+int main(void)
+{
+  // the chip second starts 123.4 ms after the power on, the time is Monday 01 Mar 2021 06:58:30
+  DS3231 chip(RTC_INT, 123400);
+  pChip = &chip;
+  chip.setTime(theTime_seconds(theTime_daysFromCivil(2021, 3, 1), 6, 58, 30));
+  Wire.attach(ADDRESS_RTC, &chip);
+
+  theTime_init();
+  theBus_init();
+  theNVM_init();
+  theAlarms_init();
+  theData_init();
+  theRTC_init();
+
+  // INT/SQW is not wired: the registers are read out every PERIOD_RTC, the dot keeps the chip phase
+  chip.setIntConnected(false);
+  run(2 * SECOND_US);
+  reset_shown();
+  run(HOUR_US);
+  theRTC_stats_t stats;
+  theRTC_getStats(&stats);
+  printf("no edges: %u dot changes in 1 hour, the dot on %.1f ms after the chip second at most, %u read outs, %u syncs\n",
+         shown.dot_changes, shown.max_dot_offset_us / 1000.0, stats.reads, stats.syncs);
+  CHECK(( shown.dot_changes >= 7199 ) && ( shown.dot_changes <= 7201 ));
+  CHECK(shown.max_dot_offset_us <= ( ( PERIOD_RTC + 2 ) * 1000ULL ));
+  CHECK_EQUAL(0, shown.time_errors);
+  CHECK_EQUAL(0, stats.failures);
+
+  // INT/SQW is wired: the minute tick and the alarm come by the edges
+  chip.setIntConnected(true);
+  run(2 * 60 * SECOND_US);
+  reset_shown();
+  theRTC_stats_t before;
+  theRTC_getStats(&before);
+  const uint32_t chip_transactions = chip.transactions;
+  const uint32_t chip_minutes = chip.alarm2;
+  uint32_t alarm_time = set_alarm(3);
+  run(HOUR_US);
+  theRTC_getStats(&stats);
+  printf("edges: %u minute ticks of %u, alarm %u at %02u:%02u:%02u %.3f ms after the chip second, %u transactions in 1 hour\n",
+         stats.minutes - before.minutes, chip.alarm2 - chip_minutes, shown.alarms - before.alarms,
+         (unsigned int)( ( shown.alarm_time / 3600 ) % 24 ), (unsigned int)( ( shown.alarm_time / 60 ) % 60 ),
+         (unsigned int)( shown.alarm_time % 60 ), shown.alarm_us / 1000.0, chip.transactions - chip_transactions);
+  CHECK_EQUAL(chip.alarm2 - chip_minutes, stats.minutes - before.minutes);
+  CHECK_EQUAL(1, shown.alarms - before.alarms);
+  CHECK_EQUAL(alarm_time, shown.alarm_time);
+  CHECK(shown.alarm_us <= ( 2 * LOOP_US ));
+  CHECK_EQUAL(0, shown.time_errors);
+  CHECK_EQUAL(0, stats.alarm_mismatches);
+  CHECK_EQUAL(0, stats.failures - before.failures);
+
+  // the chip does not answer from just before the alarm edge till 50 ms after it: the flags are
+  // read as soon as theBus retries, the alarm is not left till the minute tick is seen as lost
+  run_to(30, 0);
+  alarm_time = set_alarm(1);
+  theRTC_getStats(&before);
+  run_to(59, 900000);
+  chip.setResponding(false);
+  run_to(0, 50000);
+  chip.setResponding(true);
+  run(2 * SECOND_US);
+  theRTC_getStats(&stats);
+  printf("edge fault: alarm at %02u:%02u:%02u %.3f ms after the chip second, %u failed transactions\n",
+         (unsigned int)( ( shown.alarm_time / 3600 ) % 24 ), (unsigned int)( ( shown.alarm_time / 60 ) % 60 ),
+         (unsigned int)( shown.alarm_time % 60 ), shown.alarm_us / 1000.0, stats.failures - before.failures);
+  CHECK_EQUAL(alarm_time, shown.alarm_time);
+  CHECK(shown.alarm_us <= 100000);
+  CHECK(host_line(RTC_INT) == HIGH);
+
+  // the chip does not answer for 2 minutes: the seconds are counted by millis(), the minute ticks
+  // go on after the fault, and the shown time is the chip time again
+  chip.setResponding(false);
+  run(2 * 60 * SECOND_US);
+  chip.setResponding(true);
+  run(5 * SECOND_US);
+  reset_shown();
+  theRTC_getStats(&before);
+  const uint32_t fault_minutes = chip.alarm2;
+  run(10 * 60 * SECOND_US);
+  theRTC_getStats(&stats);
+  theBus_stats_t bus;
+  theBus_getStats(&bus);
+  printf("long fault: %u faults, %u failed transactions, %u ms to recover, then %u minute ticks of %u\n",
+         bus.buses[bus_rtc].faults, bus.buses[bus_rtc].failures, bus.buses[bus_rtc].recovery_ms,
+         stats.minutes - before.minutes, chip.alarm2 - fault_minutes);
+  CHECK_EQUAL(chip.alarm2 - fault_minutes, stats.minutes - before.minutes);
+  CHECK_EQUAL(0, shown.time_errors);
+  CHECK_EQUAL(0, stats.alarm_mismatches);
+
+  // the minute adjusted 3 times in a row by the keys: every press is shown at once, the chip is
+  // written once, 300 ms after the last press, and read back with the adjusted time
+  run_to(10, 500000);
+  for ( int element = 0; element < 5; element++ ) theData_nextBlinker();
+  theRTC_getStats(&before);
+  const uint32_t writes = chip.timeWrites;
+  const uint32_t adjusted = chip.time() + ( 3 * 60 );
+  for ( unsigned int press = 1; press <= 3; press++ )
+  {
+    press_minute(chip.time() + ( press * 60 ));
+    run(100000 - LOOP_US);
+  }
+  run(SECOND_US);
+  theRTC_getStats(&stats);
+  theData_adjustStats_t adjust;
+  theData_getAdjustStats(&adjust);
+  printf("adjustment: 3 presses shown %u us after the press at most, %u chip writes, %u reverts, the chip at +%d s\n",
+         adjust.max_latency_us, chip.timeWrites - writes, stats.reverts - before.reverts, (int)( chip.time() - adjusted ));
+  CHECK_EQUAL(3, adjust.adjustments);
+  CHECK(adjust.max_latency_us <= LOOP_US);
+  CHECK_EQUAL(1, chip.timeWrites - writes);
+  CHECK_EQUAL(1, stats.writes - before.writes);
+  CHECK_EQUAL(0, stats.reverts - before.reverts);
+  CHECK(( chip.time() - adjusted ) <= 2);
+
+  // the chip keeps the century bit of the month register set: it is not written, the read back
+  // does not revert the adjustment for it
+  chip.setStuckBits(0x05, 0x80);
+  theRTC_getStats(&before);
+  const uint32_t century_adjusted = chip.time() + 60;
+  press_minute(century_adjusted);
+  run(SECOND_US);
+  theRTC_getStats(&stats);
+  printf("century bit: %u reverts, the chip at +%d s\n", stats.reverts - before.reverts, (int)( chip.time() - century_adjusted ));
+  CHECK_EQUAL(0, stats.reverts - before.reverts);
+  CHECK(( chip.time() - century_adjusted ) <= 1);
+  theData_stopBlinker();
+
+  return TEST_END();
+}
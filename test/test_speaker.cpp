@@ -0,0 +1,153 @@
+// theSpeaker on the DACC/PDC stand-in: the chime is decoded by the interrupt into the two PDC
+// buffers and converted on TIOA0 at 8 kHz. The DAC output of the clip must be the one of the
+// encoder (golden/speaker_chime.txt, the samples the IMA-ADPCM encoder has reconstructed), the
+// gap is mid-scale, and the clip is repeated for the whole alarm without a sample missed or held.
+// The interrupt late by less than a buffer does not matter; later than both buffers, PDC is
+// restarted with both of them and the clip goes on from where it was. After the alarm (and on
+// stop) the trigger is off and the output is at mid-scale. The CPU time of the interrupt is
+// measured against the playback time.
+
+#include <Arduino.h>
+#include <host.h>
+#include <string>
+
+#include "hwconfig.h"
+#include "theSpeaker.h"
+#include "DacPdc.h"
+#include "test.h"
+
+// one pass of the main loop every LOOP_US of the simulated time
+#define LOOP_US               (1000)
+#define SECOND_US             (1000000ULL)
+#define DAC_MIDSCALE          (0x800)
+
+// the chime: 500 ms of the clip, 500 ms of the gap
+#define CLIP_SAMPLES          ( SPEAKER_SAMPLE_RATE / 2 )
+#define PERIOD_SAMPLES        (SPEAKER_SAMPLE_RATE)
+
+static DacPdc *pDac = NULL;
+
+static void run(const uint64_t us)
+{
+  const uint64_t until = host_now() + us;
+  while ( host_now() < until )
+  {
+    theSpeaker_process(millis());
+    host_advance(LOOP_US);
+  }
+}
+
+// the first period of the alarm, the clip and the gap
+static std::vector<uint16_t> reference;
+
+// the output against the period repeated, the mismatches of the first 'count' samples
+static size_t mismatches(const size_t count)
+{
+  size_t differ = 0;
+  for ( size_t i = 0; i < count; i++ )
+  {
+    if ( pDac->output[i] != reference[i % PERIOD_SAMPLES] ) ++differ;
+  }
+  return differ;
+}
+
+int main(void)
+{
+  DacPdc dac;
+  pDac = &dac;
+  theSpeaker_init();
+  run(SECOND_US);
+  CHECK_EQUAL(0, dac.output.size());
+  CHECK(! dac.isTriggering());
+
+  // the whole alarm; the start stops the previous clip first, the output is set to mid-scale
+  theSpeaker_start(speaker_clip_chime);
+  CHECK_EQUAL(DAC_MIDSCALE, dac.value());
+  dac.output.clear();
+  uint32_t held_playing = 0;
+  while ( theSpeaker_isPlaying() )
+  {
+    run(LOOP_US);
+    held_playing = dac.held;
+  }
+  const uint64_t played_us = host_now() - SECOND_US;
+  run(SECOND_US);
+  theSpeaker_stats_t stats;
+  theSpeaker_getStats(&stats);
+  const size_t samples = PERIOD_ALARM * ( SPEAKER_SAMPLE_RATE / 1000 );
+  printf("alarm: %u samples converted in %.3f s, %u held while playing, %u after the end, %u interrupts for %u buffers\n",
+         (unsigned int)dac.output.size(), played_us / 1e6, held_playing, dac.held - held_playing, dac.interrupts, stats.buffers);
+  CHECK_EQUAL(samples + 1, dac.output.size());
+  CHECK_EQUAL(0, held_playing);
+  CHECK(( dac.held - held_playing ) <= ( ( LOOP_US * SPEAKER_SAMPLE_RATE ) / SECOND_US ));
+  CHECK_EQUAL(( samples / SPEAKER_BUFFER ) - 2, stats.buffers);
+  CHECK_EQUAL(stats.buffers + 1, dac.interrupts);
+  CHECK_EQUAL(0, stats.underruns);
+
+  // the clip is the encoder one, the gap is silent, every period is the same
+  std::string clip;
+  for ( size_t i = 0; i < CLIP_SAMPLES; i++ ) clip += std::to_string(dac.output[i]) + "\n";
+  CHECK_GOLDEN("speaker_chime.txt", clip.data(), clip.size());
+  size_t gap_errors = 0;
+  for ( size_t i = CLIP_SAMPLES; i < PERIOD_SAMPLES; i++ ) if ( dac.output[i] != DAC_MIDSCALE ) ++gap_errors;
+  CHECK_EQUAL(0, gap_errors);
+  reference.assign(dac.output.begin(), dac.output.begin() + PERIOD_SAMPLES);
+  CHECK_EQUAL(0, mismatches(samples));
+
+  // the end: the trigger is off, the output is at mid-scale, the interrupt is disabled
+  CHECK(! dac.isTriggering());
+  CHECK_EQUAL(DAC_MIDSCALE, dac.value());
+  CHECK_EQUAL(0, DACC->DACC_MR & DACC_MR_TRGEN);
+  CHECK_EQUAL(0, DACC->DACC_IMR);
+
+  // the CPU time of the interrupt per the playback time (the host, the device has the DWT cycles)
+  const double handler_ns = (double)dac.handler_ns / dac.interrupts;
+  const double load = ( (double)dac.handler_ns / 1000.0 ) / played_us;
+  printf("interrupt: %.1f per second, %.0f ns each (%.1f ns per sample), the load %.4f%% of the host CPU\n",
+         dac.interrupts / ( played_us / 1e6 ), handler_ns, handler_ns / SPEAKER_BUFFER, load * 100);
+
+  // the interrupt 20 ms late (less than a buffer): nothing changes
+  dac.setLatency(20000);
+  const uint32_t held_before = dac.held;
+  theSpeaker_start(speaker_clip_chime);
+  dac.output.clear();
+  run(5 * SECOND_US);
+  theSpeaker_getStats(&stats);
+  const size_t late = dac.output.size();
+  printf("interrupt 20 ms late: %u samples, %u held, %u underruns\n", (unsigned int)late, dac.held - held_before, stats.underruns);
+  CHECK_EQUAL(0, dac.held - held_before);
+  CHECK_EQUAL(0, stats.underruns);
+  CHECK(late >= ( 5 * SPEAKER_SAMPLE_RATE - 8 ));
+  CHECK_EQUAL(0, mismatches(late));
+
+  // stopped in the middle: mid-scale at once, no more conversions
+  theSpeaker_stop();
+  CHECK_EQUAL(DAC_MIDSCALE, dac.value());
+  const size_t stopped = dac.output.size();
+  run(SECOND_US);
+  CHECK_EQUAL(stopped, dac.output.size());
+  CHECK(! theSpeaker_isPlaying());
+
+  // the interrupt 40 ms late: both buffers are sent before it, PDC is restarted with both of them
+  // by every interrupt; the output waits, but no sample is lost or repeated
+  dac.setLatency(40000);
+  const uint32_t held_late = dac.held;
+  theSpeaker_getStats(&stats);
+  const uint32_t underruns_before = stats.underruns;
+  theSpeaker_start(speaker_clip_chime);
+  dac.output.clear();
+  run(5 * SECOND_US);
+  theSpeaker_stop();
+  theSpeaker_getStats(&stats);
+  const uint32_t underruns = stats.underruns - underruns_before;
+  const size_t order_errors = mismatches(dac.output.size() - 1);
+  printf("interrupt 40 ms late: %u underruns, %u samples, %u held (%.1f per underrun), %u out of order\n",
+         underruns, (unsigned int)dac.output.size(), dac.held - held_late, (double)( dac.held - held_late ) / underruns,
+         (unsigned int)order_errors);
+  CHECK(underruns > 0);
+  CHECK_EQUAL(0, order_errors);
+  CHECK(( dac.output.size() + ( dac.held - held_late ) ) >= ( 5 * SPEAKER_SAMPLE_RATE - 8 ));
+  CHECK_EQUAL(DAC_MIDSCALE, dac.value());
+
+  return TEST_END();
+}
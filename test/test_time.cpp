@@ -0,0 +1,131 @@
+// theTime conversions against the naive calendar: every day from the epoch through 2399 (the
+// whole 400 years era) is counted day by day, the civil date, the day of week and back the days
+// must be the same; the month lengths and the leap years by the Gregorian rules; the seconds of
+// the last time kept in 32 bits. The cost of the conversions is compared with the naive one.
+
+#include <Arduino.h>
+#include <chrono>
+
+#include "hwconfig.h"
+#include "theTime.h"
+#include "test.h"
+
+#define LAST_YEAR             (2399)
+#define BENCHMARK_DAYS        (100000)
+
+// the conversions are constant expressions
+static constexpr theTime_date_t leap_day = theTime_civilFromDays(theTime_daysFromCivil(2400, 2, 29));
+static_assert(( leap_day.year == 2400 ) && ( leap_day.month == 2 ) && ( leap_day.day == 29 ), "2400 is leap");
+
+static bool is_leap(const int year)
+{
+  if ( ( year % 400 ) == 0 ) return true;
+  if ( ( year % 100 ) == 0 ) return false;
+  return ( year % 4 ) == 0;
+}
+
+static int days_in_month(const int year, const int month)
+{
+  static const int cDays[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+  return ( ( month == 2 ) && is_leap(year) ) ? (29) : ( cDays[month - 1] );
+}
+
+// the date of the days since the epoch, counted by the years and the months
+static theTime_date_t naive_date(int32_t days)
+{
+  theTime_date_t date = { TIME_EPOCH_YEAR, 1, 1 };
+  while ( days >= ( is_leap(date.year) ? (366) : (365) ) ) days -= is_leap(date.year++) ? (366) : (365);
+  while ( days >= days_in_month(date.year, date.month) ) days -= days_in_month(date.year, date.month++);
+  date.day += days;
+  return date;
+}
+
+int main(void)
+{
+  theTime_init();
+
+  // day by day: the date, the day of week (the epoch is Saturday) and back
+  theTime_date_t date = { TIME_EPOCH_YEAR, 1, 1 };
+  int dow = 6;
+  int32_t days = 0;
+  unsigned int date_errors = 0;
+  unsigned int dow_errors = 0;
+  unsigned int days_errors = 0;
+  for ( ; date.year <= LAST_YEAR; days++ )
+  {
+    const theTime_date_t converted = theTime_civilFromDays(days);
+    if ( ( converted.year != date.year ) || ( converted.month != date.month ) || ( converted.day != date.day ) ) ++date_errors;
+    if ( theTime_dayOfWeek(days) != dow ) ++dow_errors;
+    if ( theTime_daysFromCivil(date.year, date.month, date.day) != days ) ++days_errors;
+
+    dow = ( dow % 7 ) + 1;
+    if ( ++date.day > days_in_month(date.year, date.month) )
+    {
+      date.day = 1;
+      if ( ++date.month > 12 )
+      {
+        date.month = 1;
+        ++date.year;
+      }
+    }
+  }
+  printf("calendar: %d days 2000-01-01...%d-12-31, %u date errors, %u day of week errors, %u days errors\n",
+         days, LAST_YEAR, date_errors, dow_errors, days_errors);
+  CHECK_EQUAL(TIME_DAYS_PER_ERA, days);
+  CHECK_EQUAL(0, date_errors);
+  CHECK_EQUAL(0, dow_errors);
+  CHECK_EQUAL(0, days_errors);
+
+  // the month lengths and the leap years
+  unsigned int month_errors = 0;
+  for ( int year = TIME_EPOCH_YEAR; year <= LAST_YEAR; year++ )
+  {
+    if ( theTime_isLeap(year) != is_leap(year) ) ++month_errors;
+    for ( int month = 1; month <= 12; month++ )
+    {
+      if ( theTime_daysInMonth(year, month) != days_in_month(year, month) ) ++month_errors;
+    }
+  }
+  CHECK_EQUAL(0, month_errors);
+  CHECK_EQUAL(28, theTime_daysInMonth(2100, 2));
+  CHECK_EQUAL(29, theTime_daysInMonth(2000, 2));
+
+  // the seconds: 2136-02-07 06:28:15 is the last one of 32 bits
+  const int32_t last_day = theTime_daysFromCivil(2136, 2, 7);
+  CHECK_EQUAL(0xFFFFFFFFUL, theTime_seconds(last_day, 6, 28, 15));
+  CHECK_EQUAL(last_day, 0xFFFFFFFFUL / TIME_SECONDS_PER_DAY);
+  CHECK_EQUAL(7804 * TIME_SECONDS_PER_DAY + 45296, theTime_seconds(theTime_daysFromCivil(2021, 5, 14), 12, 34, 56));
+
+  // the cost: the inputs and the results are volatile, so nothing is computed in advance or dropped
+  volatile int32_t first = 0;
+  volatile int year = 2021;
+  volatile int sink = 0;
+  std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+  for ( int32_t i = 0; i < BENCHMARK_DAYS; i++ )
+  {
+    const theTime_date_t converted = theTime_civilFromDays(first + i);
+    sink = converted.year + converted.month + converted.day;
+  }
+  const double civil_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count() / BENCHMARK_DAYS;
+
+  started = std::chrono::steady_clock::now();
+  for ( int32_t i = 0; i < BENCHMARK_DAYS; i++ )
+  {
+    sink = theTime_daysFromCivil(year + ( i % 100 ), 1 + ( i % 12 ), 1 + ( i % 28 ));
+  }
+  const double days_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count() / BENCHMARK_DAYS;
+
+  started = std::chrono::steady_clock::now();
+  for ( int32_t i = 0; i < BENCHMARK_DAYS; i++ )
+  {
+    const theTime_date_t converted = naive_date(first + i);
+    sink = converted.year + converted.month + converted.day;
+  }
+  const double naive_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count() / BENCHMARK_DAYS;
+
+  printf("cost (host): civil from days %.1f ns, days from civil %.1f ns, the naive loop %.1f ns (days 0...%d)\n",
+         civil_ns, days_ns, naive_ns, BENCHMARK_DAYS - 1);
+  (void)sink;
+
+  return TEST_END();
+}